@@ -0,0 +1,89 @@
+#include "AdmissionControl.h"
+#include <algorithm>
+#include <cmath>
+
+namespace AdmissionControl {
+
+    // peso da amostra nova na media movel do tempo de servico
+    static const double kServiceTimeAlpha = 0.2;
+
+    Gate::Gate(const std::string& name, const GateConfig& config)
+        : name_(name), config_(config) {
+        if (config_.maxConcurrent == 0) config_.maxConcurrent = 1;
+    }
+
+    double Gate::estimatedWaitMs(unsigned position) const {
+        // cada "rodada" libera maxConcurrent vagas a cada tempo medio de servico
+        double rounds = std::ceil(static_cast<double>(position) / config_.maxConcurrent);
+        return rounds * avgServiceMs_;
+    }
+
+    unsigned Gate::retryAfterFor(double waitMs) const {
+        double seconds = std::ceil(std::max(waitMs, avgServiceMs_) / 1000.0);
+        return static_cast<unsigned>(std::max(1.0, seconds));
+    }
+
+    bool Gate::acquire(unsigned& retryAfterSeconds) {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if (active_ < config_.maxConcurrent && waiting_ == 0) {
+            ++active_;
+            ++admitted_;
+            return true;
+        }
+
+        double expectedWait = estimatedWaitMs(waiting_ + 1);
+        if (waiting_ >= config_.maxQueue || expectedWait > config_.latencyTargetMs) {
+            ++rejected_;
+            retryAfterSeconds = retryAfterFor(expectedWait);
+            return false;
+        }
+
+        // aguarda vaga no maximo ate o alvo de latencia
+        ++waiting_;
+        auto deadline = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::milli>(config_.latencyTargetMs));
+        bool gotSlot = cv_.wait_until(lock, deadline, [this] { return active_ < config_.maxConcurrent; });
+        --waiting_;
+
+        if (!gotSlot) {
+            ++rejected_;
+            retryAfterSeconds = retryAfterFor(config_.latencyTargetMs);
+            return false;
+        }
+
+        ++active_;
+        ++admitted_;
+        return true;
+    }
+
+    void Gate::release(double serviceMs) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (active_ > 0) --active_;
+            avgServiceMs_ = (avgServiceMs_ == 0.0)
+                ? serviceMs
+                : kServiceTimeAlpha * serviceMs + (1.0 - kServiceTimeAlpha) * avgServiceMs_;
+        }
+        cv_.notify_one();
+    }
+
+    GateStats Gate::stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return GateStats{ active_, waiting_, admitted_, rejected_, avgServiceMs_ };
+    }
+
+    Ticket::Ticket(Gate& gate)
+        : gate_(gate), start_(std::chrono::steady_clock::now()) {
+        admitted_ = gate_.acquire(retryAfter_);
+        // o tempo de servico comeca a contar depois da espera na fila
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    Ticket::~Ticket() {
+        if (!admitted_) return;
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_;
+        gate_.release(elapsed.count());
+    }
+}
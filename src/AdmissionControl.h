@@ -0,0 +1,71 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+namespace AdmissionControl {
+
+    struct GateConfig {
+        unsigned maxConcurrent;     // Requisicoes executando ao mesmo tempo
+        unsigned maxQueue;          // Requisicoes aguardando vaga
+        double latencyTargetMs;     // Espera maxima aceitavel na fila
+    };
+
+    struct GateStats {
+        unsigned active;
+        unsigned waiting;
+        unsigned long long admitted;
+        unsigned long long rejected;
+        double avgServiceMs;        // Media movel do tempo de servico
+    };
+
+    // Limita a concorrencia de uma classe de trabalho (assinatura, verificacao)
+    // e rejeita cedo quando a espera estimada na fila passa do alvo de latencia
+    class Gate {
+    public:
+        Gate(const std::string& name, const GateConfig& config);
+
+        // retorna false se a requisicao deve ser recusada, preenchendo retryAfterSeconds
+        bool acquire(unsigned& retryAfterSeconds);
+
+        void release(double serviceMs);
+
+        GateStats stats();
+
+        const std::string& name() const { return name_; }
+
+    private:
+        double estimatedWaitMs(unsigned position) const;
+        unsigned retryAfterFor(double waitMs) const;
+
+        std::string name_;
+        GateConfig config_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        unsigned active_ = 0;
+        unsigned waiting_ = 0;
+        unsigned long long admitted_ = 0;
+        unsigned long long rejected_ = 0;
+        double avgServiceMs_ = 0.0;
+    };
+
+    // RAII: entra no gate no construtor e libera no destrutor informando o tempo de servico
+    class Ticket {
+    public:
+        explicit Ticket(Gate& gate);
+        ~Ticket();
+
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+
+        bool admitted() const { return admitted_; }
+        unsigned retryAfterSeconds() const { return retryAfter_; }
+
+    private:
+        Gate& gate_;
+        bool admitted_;
+        unsigned retryAfter_ = 0;
+        std::chrono::steady_clock::time_point start_;
+    };
+}
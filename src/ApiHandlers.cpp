@@ -0,0 +1,291 @@
+#include "ApiHandlers.h"
+#include "Poco/JSON/Object.h"
+#include "Poco/Base64Encoder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+
+#include "DigestService.h"
+#include "Logger.h"
+#include "OpenSSLPool.h"
+#include "RequestTrace.h"
+#include "Utils.h"
+#include "VerifierService.h"
+
+namespace ApiHandlers {
+
+    static HttpStream::Response textResponse(int status, const std::string& body) {
+        HttpStream::Response response;
+        response.status = status;
+        response.body = body;
+        return response;
+    }
+
+    static HttpStream::Response jsonResponse(const Poco::JSON::Object& json) {
+        RequestTrace::Span encode("encode");
+        std::ostringstream body;
+        json.stringify(body, 2);
+
+        HttpStream::Response response;
+        response.contentType = "application/json";
+        response.body = body.str();
+        RequestTrace::attribute("response_bytes", static_cast<long long>(response.body.size()));
+        return response;
+    }
+
+    static std::string fileOf(const Files& files, const std::string& name) {
+        auto it = files.find(name);
+        return it == files.end() ? "" : it->second;
+    }
+
+    // Guarda o DER pelo SHA-512 do documento; retorna o hash (hex) ou vazio se nao guardou.
+    // Falhar aqui nao derruba a assinatura, que segue na resposta como sempre
+    static std::string storeSignature(const Context& context, const SignatureStore::Hash& hash, BIO* der) {
+        RequestTrace::Span store("store");
+        char* data = nullptr;
+        long length = BIO_get_mem_data(der, &data);
+        if (length <= 0) return "";
+
+        std::string error;
+        if (!context.store->put(hash, reinterpret_cast<const unsigned char*>(data), static_cast<size_t>(length), error)) {
+            Logger::logRateLimited(Logger::Level::Warn, "signature_store_put", "Falha ao guardar assinatura", { { "erro", error } });
+            return "";
+        }
+        return SignatureStore::hashHex(hash);
+    }
+
+    PendingSignature sign(const Context& context, const Fields& fields, const Files& files) {
+        PendingSignature pending;
+        try {
+            auto passwordIt = fields.find("password");
+            std::string password = passwordIt == fields.end() ? "" : passwordIt->second;
+            auto certsIt = fields.find("certs");
+            SignerService::CertMode certMode = SignerService::parseCertMode(certsIt == fields.end() ? "" : certsIt->second, context.certMode);
+
+            std::string docPath = fileOf(files, "file");
+            std::string p12Path = fileOf(files, "p12");
+            if (docPath.empty() || p12Path.empty() || password.empty()) {
+                pending.response = textResponse(400, "Faltando arquivos: file, p12, or password.");
+            } else {
+                // etapas separadas (credenciais, CMS) para aparecerem no trace
+                PKCS12* p12 = nullptr;
+                EVP_PKEY* pkey = nullptr;
+                X509* cert = nullptr;
+                STACK_OF(X509)* ca = nullptr;
+
+                RequestTrace::Span credentials("credentials");
+                bool loaded = SignerService::loadCredentials(p12Path, password, &p12, &pkey, &cert, &ca);
+                credentials.end();
+
+                OpenSSLPool::P12Ptr p12Guard(p12);
+                OpenSSLPool::PkeyPtr pkeyGuard(pkey);
+                OpenSSLPool::X509Ptr certGuard(cert);
+                OpenSSLPool::X509StackPtr caGuard(ca);
+
+                if (!loaded) {
+                    Utils::printOpenSSLError("Falha ao carregar credenciais P12");
+                } else {
+                    RequestTrace::Span sign("cms_sign");
+                    pending.cms.reset(SignerService::signData(docPath, cert, pkey, ca, certMode));
+                    sign.end();
+
+                    // o documento temporario sai daqui: a chave no armazem eh calculada agora
+                    if (pending.cms && context.store) {
+                        std::vector<unsigned char> digest = DigestService::calculateSHA512Bytes(docPath);
+                        pending.stored = digest.size() == pending.docHash.size();
+                        if (pending.stored) std::copy(digest.begin(), digest.end(), pending.docHash.begin());
+                    }
+                }
+                if (!pending.cms) pending.response = textResponse(500, "Failed to sign document.");
+            }
+        }
+        catch (const std::exception& e) {
+            Logger::logRateLimited(Logger::Level::Error, "signature_error", "Signature error", { { "erro", e.what() } });
+            pending.cms.reset();
+            pending.response = textResponse(500, "Internal server error");
+        }
+
+        for (const auto& entry : files) std::remove(entry.second.c_str());
+        pending.response.headers.emplace_back("Access-Control-Allow-Origin", "*");
+        return pending;
+    }
+
+    // CMS ja carimbado (ou sem carimbo) -> Base64 na resposta; o CMS vai direto da
+    // memoria para o Base64, sem arquivo intermediario
+    static HttpStream::Response completeSignature(const Context& context, PendingSignature& pending, bool timestampMissing) {
+        if (!pending.cms) return std::move(pending.response);
+
+        HttpStream::Response response;
+        try {
+            if (timestampMissing) {
+                response = textResponse(503, "Carimbo de tempo indisponivel.");
+                response.headers.emplace_back("Retry-After", "1");
+            } else {
+                RequestTrace::Span encode("encode");
+                // BIO proprio: o DER tem o tamanho do documento e nao deve ficar retido no pool
+                OpenSSLPool::BioPtr der(BIO_new(BIO_s_mem()));
+                char* derData = nullptr;
+                long derLength = 0;
+                if (der && i2d_CMS_bio(der.get(), pending.cms.get()) && (derLength = BIO_get_mem_data(der.get(), &derData)) > 0) {
+                    std::ostringstream oss;
+                    Poco::Base64Encoder encoder(oss);
+                    encoder.write(derData, derLength);
+                    encoder.close();
+                    response.body = oss.str();
+                    RequestTrace::attribute("response_bytes", static_cast<long long>(response.body.size()));
+
+                    std::string storedHash = pending.stored ? storeSignature(context, pending.docHash, der.get()) : "";
+                    if (!storedHash.empty()) {
+                        response.headers.emplace_back("X-Signature-Hash", storedHash);
+                        response.headers.emplace_back("Access-Control-Expose-Headers", "X-Signature-Hash");
+                    }
+                } else {
+                    Utils::printOpenSSLError("Falha ao escrever arquivo de assinatura");
+                    response = textResponse(500, "Failed to sign document.");
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            Logger::logRateLimited(Logger::Level::Error, "signature_error", "Signature error", { { "erro", e.what() } });
+            response = textResponse(500, "Internal server error");
+        }
+
+        response.headers.emplace_back("Access-Control-Allow-Origin", "*");
+        return response;
+    }
+
+    HttpStream::Response finishSignature(const Context& context, PendingSignature& pending) {
+        bool timestampMissing = false;
+        // pedidos simultaneos dividem uma consulta a TSA (ver TimestampService::Batcher);
+        // a falha ja foi registrada no log pelo Batcher
+        if (pending.cms && context.timestamps) {
+            RequestTrace::Span tsa("tsa");
+            std::string error;
+            timestampMissing = !context.timestamps->stampCms(pending.cms.get(), error) && context.timestamps->config().required;
+        }
+        return completeSignature(context, pending, timestampMissing);
+    }
+
+    void finishSignatureAsync(const Context& context, PendingSignature pending, std::function<void(HttpStream::Response)> reply) {
+        if (!pending.cms || !context.timestamps) {
+            reply(finishSignature(context, pending));
+            return;
+        }
+
+        std::shared_ptr<PendingSignature> shared = std::make_shared<PendingSignature>(std::move(pending));
+        bool required = context.timestamps->config().required;
+        context.timestamps->stampCmsAsync(shared->cms.get(), [context, shared, required, reply](bool ok, const std::string&) {
+            reply(completeSignature(context, *shared, !ok && required));
+        });
+    }
+
+    static HttpStream::Response verificationResponse(const VerifierService::VerificationResult& result) {
+        Poco::JSON::Object json;
+        json.set("status", result.status);
+        if (!result.revocation.empty()) {
+            Poco::JSON::Object revocation;
+            revocation.set("status", result.revocation);
+            if (!result.revocationDetail.empty()) revocation.set("detalhe", result.revocationDetail);
+            json.set("revogacao", revocation);
+        }
+        if (!result.timestamp.empty()) {
+            Poco::JSON::Object timestamp;
+            timestamp.set("status", result.timestamp);
+            timestamp.set("data", result.timestampTime);
+            timestamp.set("tsa_confiavel", result.timestampTrusted);
+            timestamp.set("lote", result.timestampBatch);
+            json.set("carimbo_tempo", timestamp);
+        }
+
+        if (result.isValid) {
+            Poco::JSON::Object infos;
+            infos.set("nome_signatario", result.signerName);
+            infos.set("data_assinatura", result.signingTime);
+            infos.set("hash_documento", result.hashHex);
+            infos.set("algoritmo_hash", result.hashAlgo);
+            infos.set("algoritmo_assinatura", result.signatureAlgo);
+            json.set("infos", infos);
+        }
+        return jsonResponse(json);
+    }
+
+    HttpStream::Response verify(const Context& context, const Files& files) {
+        std::string sigPath = fileOf(files, "file");
+        if (sigPath.empty()) return textResponse(400, "Falta o arquivo assinado (campo 'file').");
+
+        RequestTrace::Span verify("cms_verify");
+        auto result = VerifierService::verifyAndGetDetails(sigPath, context.certIndex, context.revocation);
+        verify.end();
+
+        std::remove(sigPath.c_str());
+
+        return verificationResponse(result);
+    }
+
+    HttpStream::Response inspect(const Context& context, const Files& files) {
+        std::string sigPath = fileOf(files, "file");
+        if (sigPath.empty()) return textResponse(400, "Falta o arquivo assinado (campo 'file').");
+
+        auto result = VerifierService::inspect(sigPath, context.certIndex);
+
+        std::remove(sigPath.c_str());
+
+        if (!result.parsed) return textResponse(400, "Arquivo nao contem uma assinatura CMS valida.");
+
+        Poco::JSON::Object json;
+        json.set("status", "NAO_VERIFICADO");
+
+        Poco::JSON::Object infos;
+        infos.set("nome_signatario", result.signerName);
+        infos.set("data_assinatura", result.signingTime);
+        infos.set("hash_documento", result.hashHex);
+        infos.set("algoritmo_hash", result.hashAlgo);
+        infos.set("algoritmo_assinatura", result.signatureAlgo);
+        infos.set("tipo_conteudo", result.contentType);
+        infos.set("tamanho_conteudo", static_cast<Poco::UInt64>(result.contentLength));
+        json.set("infos", infos);
+        return jsonResponse(json);
+    }
+
+    // Assinatura guardada ou a resposta de erro (armazem desligado, hash invalido, ausente)
+    static bool findStored(const Context& context, const std::string& hashHex, SignatureStore::View& view,
+                           HttpStream::Response& error) {
+        SignatureStore::Hash hash;
+        if (!context.store) {
+            error = textResponse(404, "Armazem de assinaturas desativado.");
+        } else if (!SignatureStore::parseHash(hashHex, hash)) {
+            error = textResponse(400, "Hash invalido: esperado o SHA-512 do documento em hexadecimal (128 digitos).");
+        } else if (!(view = context.store->get(hash))) {
+            error = textResponse(404, "Assinatura nao encontrada.");
+        }
+        return static_cast<bool>(view);
+    }
+
+    HttpStream::Response storedSignature(const Context& context, const std::string& hashHex) {
+        HttpStream::Response response;
+        SignatureStore::View view;
+        if (findStored(context, hashHex, view, response)) {
+            // o corpo aponta para o segmento mapeado; o View segura o mapeamento ate o envio
+            response.contentType = "application/pkcs7-signature";
+            response.bodyOwner = view.owner();
+            response.bodyData = reinterpret_cast<const char*>(view.data());
+            response.bodyLength = view.size();
+            RequestTrace::attribute("response_bytes", static_cast<long long>(view.size()));
+        }
+        response.headers.emplace_back("Access-Control-Allow-Origin", "*");
+        return response;
+    }
+
+    HttpStream::Response verifyStored(const Context& context, const std::string& hashHex) {
+        HttpStream::Response error;
+        SignatureStore::View view;
+        if (!findStored(context, hashHex, view, error)) return error;
+
+        RequestTrace::Span verify("cms_verify");
+        auto result = VerifierService::verifyBuffer(view.data(), view.size(), context.certIndex, context.revocation);
+        verify.end();
+
+        return verificationResponse(result);
+    }
+}
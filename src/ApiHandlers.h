@@ -0,0 +1,63 @@
+#pragma once
+#include <functional>
+#include <map>
+#include <string>
+#include "CertIndex.h"
+#include "HttpStream.h"
+#include "OpenSSLPool.h"
+#include "RevocationService.h"
+#include "SignatureStore.h"
+#include "SignerService.h"
+#include "TimestampService.h"
+
+// Regras dos endpoints /signature, /verify, /inspect e das rotas do armazem
+// (/signature/{hash}, /verify/{hash}) independentes do front end:
+// recebem os campos e arquivos temporarios ja lidos do formulario e devolvem a
+// resposta completa. Os handlers do Poco e o front end epoll usam as mesmas
+// funcoes, entao status, mensagens e JSON sao identicos nos dois.
+// Os arquivos temporarios sao removidos assim que deixam de ser necessarios.
+namespace ApiHandlers {
+
+    struct Context {
+        SignerService::CertMode certMode;   // certificados embutidos por padrao no /signature
+        const CertIndex::Index* certIndex;  // signatarios de assinaturas compactas
+        RevocationService::Checker* revocation; // nulo com REVOCATION_CHECK=off
+        TimestampService::Batcher* timestamps;  // nulo sem TSA_URL
+        SignatureStore::Store* store;           // nulo sem SIGNATURE_STORE_DIR
+    };
+
+    using Fields = std::map<std::string, std::string>;
+    using Files = std::map<std::string, std::string>;   // campo -> arquivo temporario
+
+    // Assinatura em duas etapas, para a espera pela TSA nao ocupar a vaga de assinatura
+    // nem uma thread de criptografia: sign() faz credenciais e CMS; finishSignature()
+    // carimba e monta a resposta
+    struct PendingSignature {
+        OpenSSLPool::CmsPtr cms;            // nulo: response ja traz o erro
+        SignatureStore::Hash docHash{};     // chave no armazem (SHA-512 do documento)
+        bool stored = false;                // guardar no armazem ao final
+        HttpStream::Response response;
+    };
+
+    // file, p12, password (e certs opcional) -> CMS assinado
+    PendingSignature sign(const Context& context, const Fields& fields, const Files& files);
+
+    // carimbo (bloqueia ate o lote sair), CMS em Base64 e, com o armazem ativo, o CMS
+    // guardado com X-Signature-Hash trazendo o SHA-512 do documento
+    HttpStream::Response finishSignature(const Context& context, PendingSignature& pending);
+
+    // igual, sem bloquear: reply recebe a resposta na thread do Batcher
+    void finishSignatureAsync(const Context& context, PendingSignature pending, std::function<void(HttpStream::Response)> reply);
+
+    // file (CMS) -> JSON com status e dados do signatario
+    HttpStream::Response verify(const Context& context, const Files& files);
+
+    // file (CMS) -> JSON com os metadados, sem verificar a assinatura
+    HttpStream::Response inspect(const Context& context, const Files& files);
+
+    // SHA-512 do documento (hex) -> CMS DER guardado, enviado direto do mmap do segmento
+    HttpStream::Response storedSignature(const Context& context, const std::string& hashHex);
+
+    // SHA-512 do documento (hex) -> mesmo JSON do /verify, verificando o CMS guardado sem upload
+    HttpStream::Response verifyStored(const Context& context, const std::string& hashHex);
+}
@@ -0,0 +1,460 @@
+#include "BatchPipeline.h"
+#include "BoundedQueue.h"
+#include "OpenSSLPool.h"
+#include "SignerService.h"
+#include "VerifierService.h"
+#include "Utils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <openssl/cms.h>
+#include <openssl/evp.h>
+#include <openssl/objects.h>
+
+namespace fs = std::filesystem;
+
+namespace BatchPipeline {
+
+    using Clock = std::chrono::steady_clock;
+
+    static const char* kReportHeader = "arquivo,assinatura,status,algoritmo_hash,hash,tamanho,ms,detalhe,modificado";
+
+    // Bytes de documentos em memoria somados entre os estagios: o hash espera aqui
+    // (em vez de reler o arquivo depois) ate o assinante liberar espaco
+    class ByteBudget {
+    public:
+        explicit ByteBudget(size_t capacity) : capacity_(capacity) {}
+
+        size_t capacity() const { return capacity_; }
+
+        void acquire(size_t bytes) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            released_.wait(lock, [&] { return used_ + bytes <= capacity_; });
+            used_ += bytes;
+            peak_ = std::max(peak_, used_);
+        }
+
+        void release(size_t bytes) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                used_ -= bytes;
+            }
+            released_.notify_all();
+        }
+
+        size_t peak() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return peak_;
+        }
+
+    private:
+        const size_t capacity_;
+        std::mutex mutex_;
+        std::condition_variable released_;
+        size_t used_ = 0;
+        size_t peak_ = 0;
+    };
+
+    // documento em transito entre os estagios; itens com erro seguem ate o relatorio sem trabalho extra
+    struct Item {
+        Entry entry;
+        std::string content;            // documento em memoria (vazio se grande demais ou com erro)
+        bool inMemory = false;
+        ByteBudget* budget = nullptr;   // de onde saiu o espaco de content
+        unsigned long long size = 0;
+        long long modified = 0;         // data de modificacao lida antes do conteudo
+        std::string hashHex;
+        std::string status;             // vazio enquanto nenhum estagio falhou
+        std::string detail;
+        Clock::time_point start;
+    };
+
+    // ------------------------------------------------------------------
+    // Manifesto e relatorio
+    // ------------------------------------------------------------------
+
+    static std::string trim(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) return "";
+        size_t last = text.find_last_not_of(" \t\r\n");
+        return text.substr(first, last - first + 1);
+    }
+
+    static std::string defaultSignaturePath(const std::string& docPath, const std::string& outDir) {
+        if (outDir.empty()) return docPath + ".p7s";
+        // relative_path remove a raiz de caminhos absolutos e mantem a estrutura de pastas
+        fs::path relative = fs::path(docPath).relative_path();
+        return (fs::path(outDir) / relative).string() + ".p7s";
+    }
+
+    std::vector<Entry> readManifest(const std::string& manifestPath, const std::string& outDir) {
+        std::vector<Entry> entries;
+        std::ifstream in(manifestPath);
+        if (!in) {
+            Utils::logInfo("Nao foi possivel abrir o manifesto: " + manifestPath);
+            return entries;
+        }
+
+        std::string line;
+        while (std::getline(in, line)) {
+            line = trim(line);
+            if (line.empty() || line[0] == '#') continue;
+
+            Entry entry;
+            size_t sep = line.find(';');
+            entry.docPath = trim(line.substr(0, sep));
+            entry.signaturePath = (sep == std::string::npos) ? "" : trim(line.substr(sep + 1));
+            if (entry.docPath.empty()) continue;
+            if (entry.signaturePath.empty()) entry.signaturePath = defaultSignaturePath(entry.docPath, outDir);
+            entries.push_back(std::move(entry));
+        }
+        return entries;
+    }
+
+    bool writeManifest(const std::string& dir, const std::string& manifestPath) {
+        std::error_code ec;
+        std::vector<std::string> files;
+        for (fs::recursive_directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+            if (!it->is_regular_file(ec)) continue;
+            if (it->path().extension() == ".p7s") continue;
+            files.push_back(it->path().generic_string());
+        }
+        if (ec) {
+            Utils::logInfo("Falha ao listar a pasta: " + dir);
+            return false;
+        }
+        std::sort(files.begin(), files.end());
+
+        std::ofstream out(manifestPath, std::ios::trunc);
+        if (!out) {
+            Utils::logInfo("Nao foi possivel criar o manifesto: " + manifestPath);
+            return false;
+        }
+        out << "# gerado a partir de " << dir << "\n";
+        for (const std::string& file : files) out << file << "\n";
+        return static_cast<bool>(out);
+    }
+
+    static std::string csvField(const std::string& value) {
+        if (value.find_first_of(",\"\n\r") == std::string::npos) return value;
+        std::string quoted = "\"";
+        for (char c : value) {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    static std::vector<std::string> parseCsvLine(const std::string& line) {
+        std::vector<std::string> fields(1);
+        bool quoted = false;
+        for (size_t i = 0; i < line.size(); ++i) {
+            char c = line[i];
+            if (quoted) {
+                if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                    fields.back() += '"';
+                    ++i;
+                } else if (c == '"') {
+                    quoted = false;
+                } else {
+                    fields.back() += c;
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields.emplace_back();
+            } else if (c != '\r') {
+                fields.back() += c;
+            }
+        }
+        return fields;
+    }
+
+    static long long modifiedTime(const std::string& path, std::error_code& ec) {
+        return static_cast<long long>(fs::last_write_time(path, ec).time_since_epoch().count());
+    }
+
+    std::set<std::string> completedEntries(const std::string& reportPath) {
+        // o relatorio so recebe linhas novas: vale a ultima linha de cada documento
+        std::map<std::string, std::vector<std::string>> last;
+        std::ifstream in(reportPath);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.rfind("arquivo,", 0) == 0) continue;
+            std::vector<std::string> fields = parseCsvLine(line);
+            if (fields.size() < 3) continue;
+            last[fields[0]] = std::move(fields);
+        }
+
+        // o mesmo caminho com outro conteudo precisa de assinatura nova: tamanho e data de
+        // modificacao tem de bater com os registrados (relatorios sem a coluna refazem tudo)
+        std::set<std::string> done;
+        for (const auto& [doc, row] : last) {
+            std::error_code ec;
+            if (row[2] != "VALIDO" || row.size() < 9 || !fs::exists(row[1], ec)) continue;
+            unsigned long long size = fs::file_size(doc, ec);
+            if (ec || std::to_string(size) != row[5]) continue;
+            long long modified = modifiedTime(doc, ec);
+            if (!ec && std::to_string(modified) == row[8]) done.insert(doc);
+        }
+        return done;
+    }
+
+    // ------------------------------------------------------------------
+    // Estagios
+    // ------------------------------------------------------------------
+
+    // libera a memoria do documento e devolve o espaco ao orcamento
+    static void releaseContent(Item& item) {
+        if (item.budget) item.budget->release(item.content.size());
+        item.budget = nullptr;
+        item.content.clear();
+        item.content.shrink_to_fit();
+    }
+
+    static void fail(Item& item, const std::string& status, const std::string& detail) {
+        item.status = status;
+        item.detail = detail;
+        releaseContent(item);
+    }
+
+    // le o documento e calcula o digest do tipo de chave (o mesmo do messageDigest assinado)
+    static void hashItem(Item& item, const EVP_MD* md, size_t maxInMemoryBytes, ByteBudget& budget) {
+        std::error_code ec;
+        item.modified = modifiedTime(item.entry.docPath, ec);
+        std::ifstream file(item.entry.docPath, std::ios::binary | std::ios::ate);
+        if (!file) {
+            fail(item, "ERRO_LEITURA", "arquivo nao encontrado");
+            return;
+        }
+        item.size = static_cast<unsigned long long>(file.tellg());
+        file.seekg(0);
+
+        EVP_MD_CTX* ctx = OpenSSLPool::threadDigestContext();
+        if (!ctx || !EVP_DigestInit_ex(ctx, md, nullptr)) {
+            fail(item, "ERRO_LEITURA", "falha ao iniciar o digest");
+            return;
+        }
+
+        bool ok = true;
+        if (item.size <= maxInMemoryBytes && item.size <= budget.capacity()) {
+            // documento pequeno: uma leitura so, reaproveitada pelo assinante
+            budget.acquire(static_cast<size_t>(item.size));
+            item.budget = &budget;
+            item.content.resize(static_cast<size_t>(item.size));
+            file.read(&item.content[0], static_cast<std::streamsize>(item.content.size()));
+            ok = static_cast<size_t>(file.gcount()) == item.content.size() &&
+                 EVP_DigestUpdate(ctx, item.content.data(), item.content.size());
+            item.inMemory = ok;
+        } else {
+            static const size_t kChunkSize = 64 * 1024;
+            std::vector<unsigned char>& buffer = OpenSSLPool::scratchBuffer(kChunkSize);
+            while (ok && (file.read(reinterpret_cast<char*>(buffer.data()), kChunkSize) || file.gcount() > 0)) {
+                ok = EVP_DigestUpdate(ctx, buffer.data(), static_cast<size_t>(file.gcount())) == 1;
+            }
+            ok = ok && !file.bad();
+        }
+
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int length = 0;
+        if (!ok || !EVP_DigestFinal_ex(ctx, digest, &length)) {
+            fail(item, "ERRO_LEITURA", "falha ao ler o arquivo");
+            return;
+        }
+        item.hashHex = OpenSSLPool::toHex(digest, length, true);
+    }
+
+    static void signItem(Item& item, X509* cert, EVP_PKEY* pkey, STACK_OF(X509)* ca, SignerService::CertMode certMode) {
+        OpenSSLPool::CmsPtr cms(item.inMemory
+            ? SignerService::signBuffer(reinterpret_cast<const unsigned char*>(item.content.data()), item.content.size(), cert, pkey, ca, certMode)
+            : SignerService::signData(item.entry.docPath, cert, pkey, ca, certMode));
+
+        // o documento nao eh mais necessario: libera a memoria antes da verificacao
+        releaseContent(item);
+
+        if (!cms) {
+            fail(item, "ERRO_ASSINATURA", "falha ao gerar o CMS");
+            return;
+        }
+
+        std::error_code ec;
+        fs::path sigPath(item.entry.signaturePath);
+        if (sigPath.has_parent_path()) fs::create_directories(sigPath.parent_path(), ec);
+
+        // grava num temporario e renomeia: uma interrupcao nunca deixa assinatura pela metade
+        std::string tmpPath = item.entry.signaturePath + ".tmp";
+        {
+            OpenSSLPool::BioPtr out(BIO_new_file(tmpPath.c_str(), "wb"));
+            if (!out || !i2d_CMS_bio(out.get(), cms.get())) {
+                Utils::printOpenSSLError("Falha ao escrever arquivo de assinatura");
+                fail(item, "ERRO_ASSINATURA", "falha ao gravar a assinatura");
+                return;
+            }
+        }
+        fs::rename(tmpPath, sigPath, ec);
+        if (ec) {
+            fs::remove(tmpPath, ec);
+            fail(item, "ERRO_ASSINATURA", "falha ao gravar a assinatura");
+        }
+    }
+
+    static void verifyItem(Item& item, const CertIndex::Index& certIndex) {
+        VerifierService::VerificationResult res = VerifierService::verifyAndGetDetails(item.entry.signaturePath, &certIndex);
+        if (!res.isValid) {
+            fail(item, "INVALIDO", "assinatura gravada nao confere");
+        } else if (res.hashHex != item.hashHex) {
+            fail(item, "INVALIDO", "hash assinado difere do documento");
+        } else {
+            item.status = "VALIDO";
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // Execucao
+    // ------------------------------------------------------------------
+
+    Summary run(const Config& config) {
+        Summary summary;
+        Clock::time_point started = Clock::now();
+
+        if (!std::ifstream(config.manifestPath)) {
+            Utils::logInfo("Nao foi possivel abrir o manifesto: " + config.manifestPath);
+            return summary;
+        }
+        std::vector<Entry> entries = readManifest(config.manifestPath, config.outDir);
+        summary.total = entries.size();
+
+        std::set<std::string> done;
+        if (config.resume) done = completedEntries(config.reportPath);
+        std::vector<Entry> pending;
+        for (Entry& entry : entries) {
+            if (done.count(entry.docPath)) ++summary.skipped;
+            else pending.push_back(std::move(entry));
+        }
+
+        PKCS12* p12 = nullptr;
+        EVP_PKEY* pkey = nullptr;
+        X509* cert = nullptr;
+        STACK_OF(X509)* ca = nullptr;
+
+        bool loaded = SignerService::loadCredentials(config.p12Path, config.password, &p12, &pkey, &cert, &ca);
+
+        OpenSSLPool::P12Ptr p12Guard(p12);
+        OpenSSLPool::PkeyPtr pkeyGuard(pkey);
+        OpenSSLPool::X509Ptr certGuard(cert);
+        OpenSSLPool::X509StackPtr caGuard(ca);
+
+        if (!loaded) {
+            Utils::printOpenSSLError("Falha ao carregar credenciais P12");
+            return summary;
+        }
+        const EVP_MD* md = SignerService::digestForKey(pkey);
+
+        // assinaturas compactas sao verificadas com o certificado do proprio P12
+        CertIndex::Index certIndex;
+        certIndex.add(cert);
+        for (int i = 0; ca && i < sk_X509_num(ca); ++i) certIndex.add(sk_X509_value(ca, i));
+        // mesmo nome do algoritmo_hash do /verify (ex: sha512)
+        const char* mdName = OBJ_nid2ln(EVP_MD_get_type(md));
+
+        // relatorio em modo append na retomada; linhas gravadas (e descarregadas) uma a uma
+        std::error_code ec;
+        bool appendReport = config.resume && fs::exists(config.reportPath, ec) && fs::file_size(config.reportPath, ec) > 0;
+        std::ofstream report(config.reportPath, appendReport ? std::ios::app : std::ios::trunc);
+        if (!report) {
+            Utils::logInfo("Nao foi possivel criar o relatorio: " + config.reportPath);
+            return summary;
+        }
+        if (!appendReport) report << kReportHeader << "\n" << std::flush;
+        summary.ok = true;
+
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        unsigned hashers = std::max(1u, config.hashers);
+        unsigned signers = config.signers ? config.signers : cores;
+        unsigned verifiers = config.verifiers ? config.verifiers : std::max(1u, cores / 2);
+
+        Logger::log(Logger::Level::Info, "Lote iniciado", {
+            { "documentos", std::to_string(pending.size()) }, { "pulados", std::to_string(summary.skipped) },
+            { "hash", std::to_string(hashers) }, { "assinatura", std::to_string(signers) },
+            { "verificacao", std::to_string(verifiers) } });
+
+        ByteBudget budget(config.maxBufferedBytes);
+        BoundedQueue<Item> toSign(config.queueCapacity);
+        BoundedQueue<Item> toVerify(config.queueCapacity);
+        BoundedQueue<Item> toReport(config.queueCapacity);
+
+        // o ultimo trabalhador de cada estagio fecha a fila seguinte
+        std::atomic<size_t> nextEntry{ 0 };
+        std::atomic<unsigned> hashersLeft{ hashers };
+        std::atomic<unsigned> signersLeft{ signers };
+        std::atomic<unsigned> verifiersLeft{ verifiers };
+
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < hashers; ++i) {
+            threads.emplace_back([&]() {
+                for (size_t index = nextEntry++; index < pending.size(); index = nextEntry++) {
+                    Item item;
+                    item.entry = pending[index];
+                    item.start = Clock::now();
+                    hashItem(item, md, config.maxInMemoryBytes, budget);
+                    toSign.push(std::move(item));
+                }
+                if (--hashersLeft == 0) toSign.close();
+            });
+        }
+        for (unsigned i = 0; i < signers; ++i) {
+            threads.emplace_back([&]() {
+                Item item;
+                while (toSign.pop(item)) {
+                    if (item.status.empty()) signItem(item, cert, pkey, ca, config.certMode);
+                    toVerify.push(std::move(item));
+                }
+                if (--signersLeft == 0) toVerify.close();
+            });
+        }
+        for (unsigned i = 0; i < verifiers; ++i) {
+            threads.emplace_back([&]() {
+                Item item;
+                while (toVerify.pop(item)) {
+                    if (item.status.empty()) verifyItem(item, certIndex);
+                    toReport.push(std::move(item));
+                }
+                if (--verifiersLeft == 0) toReport.close();
+            });
+        }
+
+        // relatorio na thread chamadora, na ordem em que os documentos terminam
+        Item item;
+        while (toReport.pop(item)) {
+            long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - item.start).count();
+            report << csvField(item.entry.docPath) << ',' << csvField(item.entry.signaturePath) << ','
+                   << item.status << ',' << mdName << ',' << item.hashHex << ',' << item.size << ','
+                   << ms << ',' << csvField(item.detail) << ',' << item.modified << "\n" << std::flush;
+
+            if (item.status == "VALIDO") {
+                ++summary.valid;
+            } else {
+                if (item.status == "INVALIDO") ++summary.invalid;
+                else ++summary.errors;
+                Logger::log(Logger::Level::Warn, "Documento do lote falhou", {
+                    { "arquivo", item.entry.docPath }, { "status", item.status }, { "detalhe", item.detail } });
+            }
+        }
+
+        for (std::thread& t : threads) t.join();
+        summary.peakBufferedBytes = budget.peak();
+
+        summary.seconds = std::chrono::duration<double>(Clock::now() - started).count();
+        Logger::log(Logger::Level::Info, "Lote concluido", {
+            { "validos", std::to_string(summary.valid) }, { "invalidos", std::to_string(summary.invalid) },
+            { "erros", std::to_string(summary.errors) }, { "pulados", std::to_string(summary.skipped) },
+            { "segundos", std::to_string(summary.seconds) } });
+        return summary;
+    }
+}
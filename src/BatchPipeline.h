@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <set>
+#include <string>
+#include <vector>
+#include "SignerService.h"
+
+// Assinatura e auto-verificacao em lote a partir de um manifesto.
+// Tres estagios concorrentes ligados por filas limitadas:
+//   hash (leitura + digest) -> assinatura (chave privada) -> verificacao (arquivo gravado)
+// As filas limitam o numero de itens e os documentos lidos para a memoria dividem um
+// orcamento de bytes, entao documentos grandes nao multiplicam o pico de memoria.
+// As credenciais do P12 sao carregadas uma unica vez e compartilhadas pelos assinantes.
+// Cada documento vira uma linha no relatorio CSV, gravada assim que termina,
+// o que permite retomar um lote interrompido pulando o que ja esta VALIDO e nao
+// mudou desde entao (mesmo tamanho e data de modificacao).
+namespace BatchPipeline {
+
+    struct Entry {
+        std::string docPath;
+        std::string signaturePath;
+    };
+
+    struct Config {
+        std::string manifestPath;
+        std::string reportPath;
+        std::string outDir;             // vazio: assinatura ao lado do documento (<doc>.p7s)
+        std::string p12Path;
+        std::string password;
+        unsigned hashers = 2;
+        unsigned signers = 0;           // 0: numero de nucleos
+        unsigned verifiers = 0;         // 0: metade dos nucleos
+        size_t queueCapacity = 64;      // itens por fila entre estagios
+        size_t maxInMemoryBytes = 32 * 1024 * 1024; // acima disso o assinante rele o arquivo
+        size_t maxBufferedBytes = 256 * 1024 * 1024; // soma dos documentos em memoria entre os estagios
+        bool resume = true;
+        SignerService::CertMode certMode = SignerService::CertMode::Full;
+    };
+
+    struct Summary {
+        bool ok = false;                // false apenas se o lote nem comecou (manifesto, P12, relatorio)
+        size_t total = 0;
+        size_t skipped = 0;             // ja VALIDO num relatorio anterior
+        size_t valid = 0;
+        size_t invalid = 0;
+        size_t errors = 0;
+        size_t peakBufferedBytes = 0;   // maior soma de documentos em memoria ao mesmo tempo
+        double seconds = 0;
+    };
+
+    // Manifesto: um documento por linha, opcionalmente "documento;assinatura".
+    // Linhas vazias e iniciadas por '#' sao ignoradas
+    std::vector<Entry> readManifest(const std::string& manifestPath, const std::string& outDir);
+
+    // Lista os arquivos de dir (recursivo, ordenado, sem .p7s) em um novo manifesto
+    bool writeManifest(const std::string& dir, const std::string& manifestPath);
+
+    // Documentos com status VALIDO no relatorio cuja assinatura ainda existe e cujo
+    // tamanho e data de modificacao continuam os registrados
+    std::set<std::string> completedEntries(const std::string& reportPath);
+
+    Summary run(const Config& config);
+}
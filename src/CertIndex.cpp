@@ -0,0 +1,173 @@
+#include "CertIndex.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/pkcs12.h>
+
+namespace fs = std::filesystem;
+
+namespace CertIndex {
+
+    // chave issuer + serial: DER do nome do emissor seguido do DER do numero de serie
+    static std::string issuerSerialKey(X509_NAME* issuer, const ASN1_INTEGER* serial) {
+        unsigned char* name = nullptr;
+        unsigned char* number = nullptr;
+        int nameLen = i2d_X509_NAME(issuer, &name);
+        int numberLen = i2d_ASN1_INTEGER(serial, &number);
+
+        std::string key;
+        if (nameLen > 0 && numberLen > 0) {
+            key.assign(reinterpret_cast<char*>(name), static_cast<size_t>(nameLen));
+            key.append(reinterpret_cast<char*>(number), static_cast<size_t>(numberLen));
+        }
+        OPENSSL_free(name);
+        OPENSSL_free(number);
+        return key;
+    }
+
+    static std::string nameKey(X509_NAME* name) {
+        unsigned char* der = nullptr;
+        int len = i2d_X509_NAME(name, &der);
+        std::string key;
+        if (len > 0) key.assign(reinterpret_cast<char*>(der), static_cast<size_t>(len));
+        OPENSSL_free(der);
+        return key;
+    }
+
+    static std::string skiKey(const ASN1_OCTET_STRING* ski) {
+        if (!ski) return "";
+        return std::string(reinterpret_cast<const char*>(ASN1_STRING_get0_data(ski)), static_cast<size_t>(ASN1_STRING_length(ski)));
+    }
+
+    bool Index::add(X509* cert) {
+        if (!cert) return false;
+        std::string key = issuerSerialKey(X509_get_issuer_name(cert), X509_get0_serialNumber(cert));
+        if (key.empty() || byIssuerSerial_.count(key)) return false;
+
+        X509_up_ref(cert);
+        byIssuerSerial_.emplace(key, OpenSSLPool::X509Ptr(cert));
+
+        std::string ski = skiKey(X509_get0_subject_key_id(cert));
+        if (!ski.empty()) bySki_.emplace(ski, cert);
+        bySubject_.emplace(nameKey(X509_get_subject_name(cert)), cert);
+        return true;
+    }
+
+    bool Index::loadPkcs12(const std::string& path, const std::string& password) {
+        OpenSSLPool::BioPtr bio(BIO_new_file(path.c_str(), "rb"));
+        if (!bio) return false;
+        OpenSSLPool::P12Ptr p12(d2i_PKCS12_bio(bio.get(), nullptr));
+        if (!p12) return false;
+
+        // a chave privada nao eh necessaria, mas o PKCS12_parse sempre a extrai
+        EVP_PKEY* pkey = nullptr;
+        X509* cert = nullptr;
+        STACK_OF(X509)* ca = nullptr;
+        if (!PKCS12_parse(p12.get(), password.c_str(), &pkey, &cert, &ca)) return false;
+
+        OpenSSLPool::PkeyPtr pkeyGuard(pkey);
+        OpenSSLPool::X509Ptr certGuard(cert);
+        OpenSSLPool::X509StackPtr caGuard(ca);
+
+        add(cert);
+        for (int i = 0; ca && i < sk_X509_num(ca); ++i) add(sk_X509_value(ca, i));
+        return cert != nullptr;
+    }
+
+    bool Index::loadCertificateFile(const std::string& path) {
+        OpenSSLPool::BioPtr bio(BIO_new_file(path.c_str(), "rb"));
+        if (!bio) return false;
+
+        // PEM pode trazer varios certificados; se nao houver nenhum tenta DER
+        bool any = false;
+        while (X509* cert = PEM_read_bio_X509(bio.get(), nullptr, nullptr, nullptr)) {
+            OpenSSLPool::X509Ptr guard(cert);
+            any = add(cert) || any;
+        }
+        if (any) {
+            ERR_clear_error();
+            return true;
+        }
+
+        BIO_reset(bio.get());
+        OpenSSLPool::X509Ptr cert(d2i_X509_bio(bio.get(), nullptr));
+        ERR_clear_error();
+        return cert && add(cert.get());
+    }
+
+    size_t Index::loadDirectory(const std::string& dir, const std::string& p12Password) {
+        size_t before = size();
+        std::error_code ec;
+        for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+            if (!it->is_regular_file(ec)) continue;
+            std::string ext = it->path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+            std::string path = it->path().string();
+            if (ext == ".pfx" || ext == ".p12") {
+                if (!loadPkcs12(path, p12Password)) {
+                    ERR_clear_error();
+                    Logger::log(Logger::Level::Warn, "P12 ignorado no indice de certificados", { { "arquivo", path } });
+                }
+            } else if (ext == ".pem" || ext == ".crt" || ext == ".cer" || ext == ".der") {
+                loadCertificateFile(path);
+            }
+        }
+        return size() - before;
+    }
+
+    X509* Index::find(CMS_SignerInfo* si) const {
+        ASN1_OCTET_STRING* keyid = nullptr;
+        X509_NAME* issuer = nullptr;
+        ASN1_INTEGER* serial = nullptr;
+        if (!CMS_SignerInfo_get0_signer_id(si, &keyid, &issuer, &serial)) return nullptr;
+
+        if (keyid) {
+            auto it = bySki_.find(skiKey(keyid));
+            return it == bySki_.end() ? nullptr : it->second;
+        }
+        if (issuer && serial) {
+            auto it = byIssuerSerial_.find(issuerSerialKey(issuer, serial));
+            return it == byIssuerSerial_.end() ? nullptr : it->second.get();
+        }
+        return nullptr;
+    }
+
+    X509* Index::findIssuer(X509* cert) const {
+        if (!cert) return nullptr;
+        auto range = bySubject_.equal_range(nameKey(X509_get_issuer_name(cert)));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (X509_check_issued(it->second, cert) != X509_V_OK) continue;
+            // mesmo nome nao basta: o certificado precisa estar assinado pela chave do emissor
+            EVP_PKEY* key = X509_get0_pubkey(it->second);
+            if (key && X509_verify(cert, key) == 1) return it->second;
+            ERR_clear_error();
+        }
+        return nullptr;
+    }
+
+    bool resolveSigners(CMS_ContentInfo* cms, const Index* index) {
+        // primeiro os certificados embutidos (se houver); falhas aqui nao sao erro
+        CMS_set1_signers_certs(cms, nullptr, 0);
+        ERR_clear_error();
+
+        STACK_OF(CMS_SignerInfo)* signers = CMS_get0_SignerInfos(cms);
+        if (!signers) return false;
+
+        bool allResolved = true;
+        for (int i = 0; i < sk_CMS_SignerInfo_num(signers); ++i) {
+            CMS_SignerInfo* si = sk_CMS_SignerInfo_value(signers, i);
+            X509* signer = nullptr;
+            CMS_SignerInfo_get0_algs(si, nullptr, &signer, nullptr, nullptr);
+            if (signer) continue;
+
+            X509* cert = index ? index->find(si) : nullptr;
+            if (cert) CMS_SignerInfo_set1_signer_cert(si, cert);
+            else allResolved = false;
+        }
+        return allResolved;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <openssl/cms.h>
+#include <openssl/x509.h>
+#include "OpenSSLPool.h"
+
+// Indice local de certificados para assinaturas compactas (sem certificados embutidos).
+// Os signatarios sao resolvidos pelo SignerIdentifier do SignerInfo: issuer + serial
+// ou subjectKeyIdentifier, ambos com busca em tabela hash.
+// Carregado uma vez e somente lido depois: seguro para varias threads.
+namespace CertIndex {
+
+    class Index {
+    public:
+        // mantem uma referencia propria ao certificado; retorna false se ja indexado
+        bool add(X509* cert);
+
+        // .pem/.crt/.cer/.der (PEM ou DER) e .pfx/.p12 abertos com a senha; retorna quantos entraram
+        size_t loadDirectory(const std::string& dir, const std::string& p12Password);
+
+        // certificado e cadeia de um P12
+        bool loadPkcs12(const std::string& path, const std::string& password);
+
+        // ponteiro interno ao indice (valido enquanto o indice existir) ou nulo
+        X509* find(CMS_SignerInfo* si) const;
+
+        // emissor de cert (nome do sujeito, X509_check_issued e assinatura conferida) ou nulo;
+        // usado na checagem de revogacao
+        X509* findIssuer(X509* cert) const;
+
+        size_t size() const { return byIssuerSerial_.size(); }
+
+    private:
+        bool loadCertificateFile(const std::string& path);
+
+        std::unordered_map<std::string, OpenSSLPool::X509Ptr> byIssuerSerial_;
+        std::unordered_map<std::string, X509*> bySki_;
+        std::unordered_multimap<std::string, X509*> bySubject_;
+    };
+
+    // Associa a cada SignerInfo sem certificado o certificado embutido correspondente
+    // ou, na falta dele, o do indice. Retorna false se algum signatario ficar sem certificado
+    bool resolveSigners(CMS_ContentInfo* cms, const Index* index);
+}
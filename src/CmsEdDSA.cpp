@@ -0,0 +1,165 @@
+#include "CmsEdDSA.h"
+#include "OpenSSLPool.h"
+#include <algorithm>
+#include <openssl/asn1.h>
+#include <openssl/objects.h>
+#include <openssl/x509.h>
+
+namespace CmsEdDSA {
+
+    static void appendDerHeader(std::vector<unsigned char>& out, unsigned char tag, size_t length) {
+        out.push_back(tag);
+        if (length < 0x80) {
+            out.push_back(static_cast<unsigned char>(length));
+            return;
+        }
+        unsigned char bytes[sizeof(size_t)];
+        int n = 0;
+        for (size_t v = length; v > 0; v >>= 8) bytes[n++] = static_cast<unsigned char>(v & 0xFF);
+        out.push_back(static_cast<unsigned char>(0x80 | n));
+        while (n > 0) out.push_back(bytes[--n]);
+    }
+
+    bool isEdDSA(EVP_PKEY* pkey) {
+        return pkey && EVP_PKEY_base_id(pkey) == EVP_PKEY_ED25519;
+    }
+
+    bool isEdDSA(CMS_SignerInfo* si) {
+        X509_ALGOR* signatureAlg = nullptr;
+        CMS_SignerInfo_get0_algs(si, nullptr, nullptr, nullptr, &signatureAlg);
+        if (!signatureAlg) return false;
+
+        const ASN1_OBJECT* oid = nullptr;
+        X509_ALGOR_get0(&oid, nullptr, nullptr, signatureAlg);
+        return oid && OBJ_obj2nid(oid) == NID_ED25519;
+    }
+
+    bool encodeSignedAttributes(CMS_SignerInfo* si, bool sort, std::vector<unsigned char>& der) {
+        int count = CMS_signed_get_attr_count(si);
+        if (count <= 0) return false;
+
+        std::vector<std::vector<unsigned char>> encoded;
+        encoded.reserve(static_cast<size_t>(count));
+        size_t total = 0;
+        for (int i = 0; i < count; ++i) {
+            X509_ATTRIBUTE* attr = CMS_signed_get_attr(si, i);
+            int len = i2d_X509_ATTRIBUTE(attr, nullptr);
+            if (len <= 0) return false;
+
+            std::vector<unsigned char> item(static_cast<size_t>(len));
+            unsigned char* p = item.data();
+            if (i2d_X509_ATTRIBUTE(attr, &p) != len) return false;
+            total += item.size();
+            encoded.push_back(std::move(item));
+        }
+
+        // DER exige o SET OF ordenado pela codificacao de cada elemento
+        if (sort) std::sort(encoded.begin(), encoded.end());
+
+        der.clear();
+        der.reserve(total + 6);
+        appendDerHeader(der, 0x31, total);
+        for (const auto& item : encoded) der.insert(der.end(), item.begin(), item.end());
+        return true;
+    }
+
+    bool signContent(CMS_ContentInfo* cms, CMS_SignerInfo* si, EVP_PKEY* pkey, BIO* content) {
+        if (!isEdDSA(pkey)) return false;
+
+        // conteudo encapsulado e messageDigest (SHA-512) numa unica leitura
+        static const size_t kChunkSize = 64 * 1024;
+        std::vector<unsigned char>& buffer = OpenSSLPool::scratchBuffer(kChunkSize);
+        EVP_MD_CTX* ctx = OpenSSLPool::threadDigestContext();
+        if (!ctx || !EVP_DigestInit_ex(ctx, OpenSSLPool::sha512(), nullptr)) return false;
+
+        std::vector<unsigned char> data;
+        int n = 0;
+        while ((n = BIO_read(content, buffer.data(), static_cast<int>(kChunkSize))) > 0) {
+            if (!EVP_DigestUpdate(ctx, buffer.data(), static_cast<size_t>(n))) return false;
+            data.insert(data.end(), buffer.data(), buffer.data() + n);
+        }
+
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digestLen = 0;
+        if (!EVP_DigestFinal_ex(ctx, digest, &digestLen)) return false;
+
+        ASN1_OCTET_STRING** eContent = CMS_get0_content(cms);
+        if (!eContent) return false;
+        if (!*eContent) *eContent = ASN1_OCTET_STRING_new();
+        if (!*eContent || !ASN1_OCTET_STRING_set(*eContent, data.data(), static_cast<int>(data.size()))) return false;
+        (*eContent)->flags &= ~ASN1_STRING_FLAG_CONT;
+
+        // mesmos atributos que o CMS_final adicionaria
+        const ASN1_OBJECT* contentType = CMS_get0_eContentType(cms);
+        std::unique_ptr<ASN1_TIME, OpenSSLPool::FnDeleter<ASN1_TIME_free>> signingTime(X509_gmtime_adj(nullptr, 0));
+        if (!contentType || !signingTime) return false;
+
+        if (!CMS_signed_add1_attr_by_NID(si, NID_pkcs9_contentType, V_ASN1_OBJECT, contentType, -1) ||
+            !CMS_signed_add1_attr_by_NID(si, NID_pkcs9_signingTime, signingTime->type, signingTime.get(), -1) ||
+            !CMS_signed_add1_attr_by_NID(si, NID_pkcs9_messageDigest, V_ASN1_OCTET_STRING, digest, static_cast<int>(digestLen))) {
+            return false;
+        }
+
+        std::vector<unsigned char> attrs;
+        if (!encodeSignedAttributes(si, true, attrs)) return false;
+
+        // Ed25519 assina a mensagem inteira: DigestSign sem digest
+        ctx = OpenSSLPool::threadDigestContext();
+        size_t sigLen = 0;
+        if (!EVP_DigestSignInit(ctx, nullptr, nullptr, nullptr, pkey) ||
+            !EVP_DigestSign(ctx, nullptr, &sigLen, attrs.data(), attrs.size())) {
+            return false;
+        }
+        std::vector<unsigned char> signature(sigLen);
+        if (!EVP_DigestSign(ctx, signature.data(), &sigLen, attrs.data(), attrs.size())) return false;
+
+        if (!ASN1_STRING_set(CMS_SignerInfo_get0_signature(si), signature.data(), static_cast<int>(sigLen))) return false;
+
+        X509_ALGOR* signatureAlg = nullptr;
+        CMS_SignerInfo_get0_algs(si, nullptr, nullptr, nullptr, &signatureAlg);
+        return signatureAlg && X509_ALGOR_set0(signatureAlg, OBJ_nid2obj(NID_ED25519), V_ASN1_UNDEF, nullptr);
+    }
+
+    bool verifySignerInfo(CMS_SignerInfo* si) {
+        EVP_PKEY* pkey = nullptr;
+        CMS_SignerInfo_get0_algs(si, &pkey, nullptr, nullptr, nullptr);
+        if (!isEdDSA(pkey) || CMS_signed_get_attr_by_NID(si, NID_pkcs9_messageDigest, -1) < 0) return false;
+
+        // mantem a ordem recebida, como o OpenSSL faz ao verificar
+        std::vector<unsigned char> attrs;
+        if (!encodeSignedAttributes(si, false, attrs)) return false;
+
+        ASN1_OCTET_STRING* signature = CMS_SignerInfo_get0_signature(si);
+        if (!signature) return false;
+
+        EVP_MD_CTX* ctx = OpenSSLPool::threadDigestContext();
+        return ctx &&
+               EVP_DigestVerifyInit(ctx, nullptr, nullptr, nullptr, pkey) == 1 &&
+               EVP_DigestVerify(ctx, ASN1_STRING_get0_data(signature), static_cast<size_t>(ASN1_STRING_length(signature)),
+                                attrs.data(), attrs.size()) == 1;
+    }
+
+    bool verify(CMS_ContentInfo* cms, BIO* out, unsigned int flags) {
+        STACK_OF(CMS_SignerInfo)* signers = CMS_get0_SignerInfos(cms);
+        bool hasEdDSA = false;
+        for (int i = 0; signers && i < sk_CMS_SignerInfo_num(signers); ++i) {
+            if (isEdDSA(sk_CMS_SignerInfo_value(signers, i))) hasEdDSA = true;
+        }
+
+        if (!hasEdDSA) {
+            return CMS_verify(cms, nullptr, nullptr, nullptr, out, flags) == 1;
+        }
+
+        // o CMS_verify ainda confere conteudo x messageDigest; a assinatura dos atributos fica por SignerInfo
+        if (CMS_verify(cms, nullptr, nullptr, nullptr, out, flags | CMS_NO_ATTR_VERIFY) != 1) {
+            return false;
+        }
+
+        for (int i = 0; i < sk_CMS_SignerInfo_num(signers); ++i) {
+            CMS_SignerInfo* si = sk_CMS_SignerInfo_value(signers, i);
+            bool ok = isEdDSA(si) ? verifySignerInfo(si) : CMS_SignerInfo_verify(si) == 1;
+            if (!ok) return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <openssl/cms.h>
+#include <openssl/evp.h>
+
+// Ed25519 em CMS (RFC 8419). O OpenSSL 3.0 nao assina nem verifica SignerInfos
+// EdDSA com atributos assinados (tenta inicializar a chave com um digest), entao
+// a assinatura sobre os signedAttrs eh feita aqui com EVP_DigestSign sem digest.
+// O messageDigest continua SHA-512 e eh conferido pelo proprio CMS_verify.
+namespace CmsEdDSA {
+
+    bool isEdDSA(EVP_PKEY* pkey);
+
+    // SignerInfo declarado como Ed25519 no signatureAlgorithm
+    bool isEdDSA(CMS_SignerInfo* si);
+
+    // DER do SET OF signedAttrs, na ordem canonica (sort) ou na ordem recebida
+    bool encodeSignedAttributes(CMS_SignerInfo* si, bool sort, std::vector<unsigned char>& der);
+
+    // Assina o conteudo e preenche o SignedData (eContent, atributos e assinatura) sem CMS_final
+    bool signContent(CMS_ContentInfo* cms, CMS_SignerInfo* si, EVP_PKEY* pkey, BIO* content);
+
+    // Verifica a assinatura de um SignerInfo Ed25519 com a chave do certificado associado
+    bool verifySignerInfo(CMS_SignerInfo* si);
+
+    // CMS_verify com a verificacao dos atributos feita por SignerInfo: Ed25519 aqui, demais pelo OpenSSL
+    bool verify(CMS_ContentInfo* cms, BIO* out, unsigned int flags);
+}
@@ -1,43 +1,58 @@
 #include "DigestService.h"
+#include "OpenSSLPool.h"
 #include "Utils.h"
 #include <fstream>
-#include <iomanip>
-#include <sstream>
 #include <vector>
 #include <openssl/evp.h>
 
 namespace DigestService {
 
-    std::string calculateSHA512(const std::string& filePath) {
-        // Abre com a flag 'ate' (at the end) para posicionar o cursor no fim e obter o tamanho imediatamente
-        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    std::vector<unsigned char> calculateSHA512Bytes(const std::string& filePath) {
+        std::ifstream file(filePath, std::ios::binary);
         if (!file) {
             Utils::logInfo("N�o foi poss�vel abrir o arquivo: " + filePath);
-            return "";
+            return {};
         }
 
-        std::streamsize size = file.tellg();
-        file.seekg(0, std::ios::beg);
-        std::vector<char> buffer(size);
+        // le em blocos no buffer da thread em vez de carregar o arquivo inteiro
+        static const size_t kChunkSize = 64 * 1024;
+        std::vector<unsigned char>& buffer = OpenSSLPool::scratchBuffer(kChunkSize);
+        EVP_MD_CTX* ctx = OpenSSLPool::threadDigestContext();
+
+        if (!ctx || !EVP_DigestInit_ex(ctx, OpenSSLPool::sha512(), nullptr)) {
+            Utils::printOpenSSLError("Falha ao calcular o hash SHA-512");
+            return {};
+        }
+
+        while (file.read(reinterpret_cast<char*>(buffer.data()), kChunkSize) || file.gcount() > 0) {
+            if (!EVP_DigestUpdate(ctx, buffer.data(), static_cast<size_t>(file.gcount()))) {
+                Utils::printOpenSSLError("Falha ao calcular o hash SHA-512");
+                return {};
+            }
+        }
 
-        if (!file.read(buffer.data(), size)) {
+        if (file.bad()) {
             Utils::logInfo("Falha ao ler o arquivo: " + filePath);
-            return "";
+            return {};
         }
         
         unsigned char hash[EVP_MAX_MD_SIZE];
         unsigned int length = 0;
             
-        if (!EVP_Digest(buffer.data(), size, hash, &length, EVP_sha512(), nullptr)) {
+        if (!EVP_DigestFinal_ex(ctx, hash, &length)) {
             Utils::printOpenSSLError("Falha ao calcular o hash SHA-512");
-            return "";
+            return {};
         }
 
-        std::stringstream ss;
-        for (unsigned int i = 0; i < length; ++i) {
-            ss << std::hex << std::setw(2) << std::setfill('0') << (int)hash[i];
+        return std::vector<unsigned char>(hash, hash + length);
+    }
+
+    std::string calculateSHA512(const std::string& filePath) {
+        std::vector<unsigned char> hash = calculateSHA512Bytes(filePath);
+        if (hash.empty()) {
+            return "";
         }
-        return ss.str();
+        return OpenSSLPool::toHex(hash.data(), hash.size(), false);
     }
 
     bool executeStep1(const std::string& inputFile, const std::string& outputFile) {
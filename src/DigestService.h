@@ -1,8 +1,12 @@
 #pragma once
 #include <string>
+#include <vector>
 
 namespace DigestService {
     std::string calculateSHA512(const std::string& filePath);
+
+    // Mesmo hash em bytes (64), sem a conversao para hexadecimal; vazio em caso de erro
+    std::vector<unsigned char> calculateSHA512Bytes(const std::string& filePath);
     
     bool executeStep1(const std::string& inputFile, const std::string& outputFile);
 }
\ No newline at end of file
@@ -0,0 +1,738 @@
+#include "EventServer.h"
+#include "Logger.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace EventServer {
+
+    bool supported() {
+#ifdef __linux__
+        return true;
+#else
+        return false;
+#endif
+    }
+
+#ifdef __linux__
+
+    using Clock = std::chrono::steady_clock;
+
+    // ids reservados no epoll_event.data.u64; conexoes comecam depois
+    static const std::uint64_t kListenerId = 0;
+    static const std::uint64_t kWakeId = 1;
+
+    // Requisicao completa a caminho do pool e de volta com a resposta
+    struct Job {
+        std::uint64_t connectionId;
+        const Route* route;
+        std::unique_ptr<HttpStream::Request> request;
+        std::unique_ptr<RequestTrace::Trace> trace;
+        std::int64_t queuedUs = 0;
+        bool prepared = false;          // resposta ja definida (erro do parser, 404)
+        HttpStream::Response response;
+    };
+
+    // Respostas prontas devolvidas ao loop (acordado pelo eventfd). Compartilhada com os
+    // Reply de respostas adiadas, que podem chegar depois do servidor parar
+    struct Outbox {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Job>> done;
+        int wakeFd = -1;
+        bool closed = false;
+
+        void post(std::unique_ptr<Job> job) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed) return;
+            done.push_back(std::move(job));
+            std::uint64_t one = 1;
+            ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+            (void)ignored;
+        }
+    };
+
+    // Resposta adiada: quem chegar por ultimo (o handler devolvendo o job ou o Reply
+    // trazendo a resposta) entrega o job ao Outbox
+    struct Deferred {
+        std::mutex mutex;
+        std::unique_ptr<Job> job;
+        bool replied = false;
+        HttpStream::Response response;
+        std::int64_t deferredUs = 0;
+    };
+
+    // job em execucao nesta thread do pool
+    struct RunningJob {
+        std::shared_ptr<Outbox> outbox;
+        std::shared_ptr<Deferred> deferred;
+    };
+    static thread_local RunningJob* runningJob = nullptr;
+
+    Reply deferResponse() {
+        if (!runningJob) return Reply();
+        if (!runningJob->deferred) runningJob->deferred = std::make_shared<Deferred>();
+
+        std::shared_ptr<Outbox> outbox = runningJob->outbox;
+        std::shared_ptr<Deferred> deferred = runningJob->deferred;
+        return [outbox, deferred](HttpStream::Response response) {
+            std::unique_ptr<Job> job;
+            {
+                std::lock_guard<std::mutex> lock(deferred->mutex);
+                if (deferred->replied) return;
+                deferred->replied = true;
+                if (!deferred->job) {
+                    deferred->response = std::move(response);
+                    return;
+                }
+                job = std::move(deferred->job);
+            }
+            job->response = std::move(response);
+            RequestTrace::Trace& trace = *job->trace;
+            trace.addCompleted("deferred", deferred->deferredUs, trace.elapsedUs() - deferred->deferredUs);
+            outbox->post(std::move(job));
+        };
+    }
+
+    struct Connection {
+        int fd;
+        std::uint64_t id;
+        HttpStream::RequestParser parser;
+        std::unique_ptr<RequestTrace::Trace> parsing;   // trace da requisicao sendo recebida
+        std::deque<std::unique_ptr<Job>> ready;         // completas, aguardando a anterior (pipelining)
+        std::unique_ptr<Job> active;                    // resposta sendo escrita
+        bool inPool = false;                            // requisicao atual no pool de criptografia (ou com resposta adiada)
+        std::string out;
+        const char* body = nullptr;                     // corpo externo da resposta de active, enviado depois de out
+        size_t bodyLength = 0;
+        size_t outOffset = 0;                           // posicao em out seguido de body
+        std::int64_t writeStartUs = 0;
+        bool writingResponse = false;                   // out contem a resposta de active (e nao um 100 Continue)
+        bool closeAfterWrite = false;
+        bool failed = false;                            // erro de protocolo: ignora o resto da entrada e fecha
+        bool peerClosed = false;                        // cliente encerrou o envio (shutdown) e aguarda respostas
+        Clock::time_point lastActivity;
+        Clock::time_point requestStart;                 // primeiro byte da requisicao em parsing
+        Clock::time_point lastWrite;                    // ultimo byte aceito pelo socket (ou inicio da saida)
+
+        Connection(int fd_, std::uint64_t id_, const HttpStream::Limits& limits, const std::string& tempDir)
+            : fd(fd_), id(id_), parser(limits, tempDir), lastActivity(Clock::now()) {}
+
+        bool idle() const { return !inPool && !active && ready.empty() && out.empty(); }
+        bool writing() const { return outOffset < out.size() + bodyLength; }
+    };
+
+    // requisicoes encadeadas aceitas por conexao antes de recusar o pipelining
+    static const size_t kMaxPipelined = 32;
+
+    struct Server::Impl {
+        Config config;
+        std::vector<Route> routes;
+        std::string tempDir;
+
+        int listenFd = -1;
+        int epollFd = -1;
+        int wakeFd = -1;
+        unsigned short boundPort = 0;
+
+        std::thread loopThread;
+        std::vector<std::thread> workers;
+        std::atomic<bool> running{ false };
+        std::atomic<size_t> connectionCount{ 0 };
+
+        std::unordered_map<std::uint64_t, std::unique_ptr<Connection>> connections;
+        std::uint64_t nextId = 2;
+        char readBuffer[64 * 1024];
+
+        // pool de criptografia: uma fila compartilhada, limite de pendentes por faixa
+        std::mutex poolMutex;
+        std::condition_variable poolReady;
+        std::deque<std::unique_ptr<Job>> jobs;
+        std::vector<size_t> lanePending;
+        bool poolStopping = false;
+
+        // respostas prontas devolvidas pelo pool (ou por um Reply) ao loop
+        std::shared_ptr<Outbox> outbox;
+
+        Impl(const Config& cfg, std::vector<Route> r) : config(cfg), routes(std::move(r)) {
+            tempDir = config.tempDir.empty() ? std::filesystem::temp_directory_path().string() : config.tempDir;
+            lanePending.assign(config.lanes.size(), 0);
+        }
+
+        bool listen(std::string& error);
+        void loop();
+        void worker();
+
+        bool submit(std::unique_ptr<Job>& job);
+        void wake();
+
+        void accept();
+        void onReadable(Connection& conn);
+        void onWritable(Connection& conn);
+        void onCompleted(std::unique_ptr<Job> job);
+        void dispatch(Connection& conn);
+        void respond(Connection& conn, std::unique_ptr<Job> job);
+        void flush(Connection& conn);
+        void finishResponse(Connection& conn);
+        void fail(Connection& conn, HttpStream::Response response);
+        void close(Connection& conn);
+        void sweepTimeouts();
+        const Route* findRoute(const std::string& path) const;
+    };
+
+    bool Server::Impl::listen(std::string& error) {
+        listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) {
+            error = std::string("socket: ") + std::strerror(errno);
+            return false;
+        }
+
+        int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (config.reusePort) setsockopt(listenFd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(config.port);
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            error = std::string("bind: ") + std::strerror(errno);
+            return false;
+        }
+        if (::listen(listenFd, config.backlog) != 0) {
+            error = std::string("listen: ") + std::strerror(errno);
+            return false;
+        }
+
+        socklen_t len = sizeof(addr);
+        getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+        boundPort = ntohs(addr.sin_port);
+
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epollFd < 0 || wakeFd < 0) {
+            error = std::string("epoll/eventfd: ") + std::strerror(errno);
+            return false;
+        }
+
+        outbox = std::make_shared<Outbox>();
+        outbox->wakeFd = wakeFd;
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.u64 = kListenerId;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+        ev.data.u64 = kWakeId;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+        return true;
+    }
+
+    void Server::Impl::wake() {
+        std::uint64_t one = 1;
+        ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    bool Server::Impl::submit(std::unique_ptr<Job>& job) {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        size_t lane = static_cast<size_t>(job->route->lane);
+        if (poolStopping || lanePending[lane] >= config.lanes[lane].maxPending) return false;
+
+        ++lanePending[lane];
+        job->queuedUs = job->trace->elapsedUs();
+        jobs.push_back(std::move(job));
+        poolReady.notify_one();
+        return true;
+    }
+
+    void Server::Impl::worker() {
+        while (true) {
+            std::unique_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(poolMutex);
+                poolReady.wait(lock, [this] { return poolStopping || !jobs.empty(); });
+                if (poolStopping) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            RequestTrace::Trace& trace = *job->trace;
+            trace.addCompleted("queue", job->queuedUs, trace.elapsedUs() - job->queuedUs);
+
+            RunningJob running{ outbox, nullptr };
+            runningJob = &running;
+            RequestTrace::setCurrent(&trace);
+            try {
+                job->response = job->route->handler(*job->request);
+            } catch (const std::exception& e) {
+                Logger::logRateLimited(Logger::Level::Error, "event_handler_error", "Erro no handler", { { "erro", e.what() } });
+                job->response = HttpStream::errorResponse(500, "Internal server error");
+                running.deferred.reset();
+            }
+            RequestTrace::setCurrent(nullptr);
+            runningJob = nullptr;
+
+            // arquivos temporarios liberados aqui, fora da thread do loop
+            job->request->removeFiles();
+
+            {
+                std::lock_guard<std::mutex> lock(poolMutex);
+                --lanePending[static_cast<size_t>(job->route->lane)];
+            }
+
+            // resposta adiada: a vaga na faixa ja foi liberada, o Reply entrega o job
+            if (running.deferred) {
+                Deferred& deferred = *running.deferred;
+                std::lock_guard<std::mutex> lock(deferred.mutex);
+                if (!deferred.replied) {
+                    deferred.deferredUs = trace.elapsedUs();
+                    deferred.job = std::move(job);
+                    continue;
+                }
+                job->response = std::move(deferred.response);
+            }
+            outbox->post(std::move(job));
+        }
+    }
+
+    const Route* Server::Impl::findRoute(const std::string& path) const {
+        // a rota exata tem precedencia sobre uma de prefixo (terminada em '/')
+        const Route* prefix = nullptr;
+        for (const Route& route : routes) {
+            if (route.path == path) return &route;
+            if (!prefix && route.path.size() > 1 && route.path.back() == '/' && path.size() > route.path.size() &&
+                path.compare(0, route.path.size(), route.path) == 0) {
+                prefix = &route;
+            }
+        }
+        return prefix;
+    }
+
+    void Server::Impl::accept() {
+        // edge-triggered: aceita ate esgotar a fila do socket
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    Logger::logRateLimited(Logger::Level::Warn, "event_accept", "Falha no accept", { { "erro", std::strerror(errno) } });
+                }
+                return;
+            }
+
+            if (connections.size() >= config.maxConnections) {
+                ::close(fd);
+                continue;
+            }
+
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            std::uint64_t id = nextId++;
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            ev.data.u64 = id;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+                ::close(fd);
+                continue;
+            }
+            connections.emplace(id, std::unique_ptr<Connection>(new Connection(fd, id, config.limits, tempDir)));
+            connectionCount.store(connections.size(), std::memory_order_relaxed);
+        }
+    }
+
+    void Server::Impl::onReadable(Connection& conn) {
+        while (true) {
+            ssize_t n = ::recv(conn.fd, readBuffer, sizeof(readBuffer), 0);
+            if (n == 0) {
+                // o cliente encerrou o envio: responde o que ja chegou completo e fecha
+                conn.peerClosed = true;
+                if (conn.idle()) {
+                    close(conn);
+                    return;
+                }
+                break;
+            }
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                close(conn);
+                return;
+            }
+
+            conn.lastActivity = Clock::now();
+            if (conn.failed) continue;
+
+            const char* data = readBuffer;
+            size_t length = static_cast<size_t>(n);
+            while (length > 0) {
+                if (!conn.parsing) {
+                    conn.parsing.reset(new RequestTrace::Trace(""));
+                    conn.requestStart = conn.lastActivity;
+                }
+
+                size_t used = conn.parser.feed(data, length);
+                data += used;
+                length -= used;
+
+                if (conn.parser.takeExpectContinue() && conn.idle()) {
+                    conn.out = "HTTP/1.1 100 Continue\r\n\r\n";
+                    conn.outOffset = 0;
+                    conn.lastWrite = Clock::now();
+                    flush(conn);
+                    if (conn.fd < 0) return;
+                }
+
+                HttpStream::RequestParser::State state = conn.parser.state();
+                if (state == HttpStream::RequestParser::State::Error) {
+                    fail(conn, conn.parser.error());
+                    if (conn.fd < 0) return;
+                    break;
+                }
+                if (state != HttpStream::RequestParser::State::Complete) continue;
+
+                if (conn.ready.size() >= kMaxPipelined) {
+                    fail(conn, HttpStream::errorResponse(503, "Requisicoes encadeadas demais."));
+                    if (conn.fd < 0) return;
+                    break;
+                }
+
+                std::unique_ptr<Job> job(new Job());
+                job->connectionId = conn.id;
+                job->request = conn.parser.take();
+                job->trace = std::move(conn.parsing);
+                job->trace->setRoute(job->request->path);
+                job->trace->addCompleted("parse", 0, job->trace->elapsedUs());
+                job->trace->setAttribute("request_bytes", job->request->contentLength);
+                for (const auto& file : job->request->fileBytes) job->trace->setAttribute(file.first + "_bytes", file.second);
+                job->route = findRoute(job->request->path);
+                conn.ready.push_back(std::move(job));
+            }
+        }
+
+        dispatch(conn);
+    }
+
+    void Server::Impl::dispatch(Connection& conn) {
+        if (conn.inPool || conn.active || conn.ready.empty() || !conn.out.empty()) return;
+
+        std::unique_ptr<Job> job = std::move(conn.ready.front());
+        conn.ready.pop_front();
+
+        if (job->prepared) {
+            respond(conn, std::move(job));
+            return;
+        }
+        if (!job->route) {
+            job->response.status = 404;
+            job->response.body = "Not Found";
+            respond(conn, std::move(job));
+            return;
+        }
+
+        if (job->route->lane < 0) {
+            RequestTrace::setCurrent(job->trace.get());
+            try {
+                job->response = job->route->handler(*job->request);
+            } catch (const std::exception&) {
+                job->response = HttpStream::errorResponse(500, "Internal server error");
+            }
+            RequestTrace::setCurrent(nullptr);
+            respond(conn, std::move(job));
+            return;
+        }
+
+        if (!submit(job)) {
+            // faixa cheia: recusa na hora, como o gate de admissao do front end Poco
+            job->request->removeFiles();
+            job->response = HttpStream::errorResponse(503, "Servidor sobrecarregado, tente novamente mais tarde.");
+            job->response.headers.emplace_back("Retry-After", "1");
+            respond(conn, std::move(job));
+            return;
+        }
+        // a conexao fica ocupada ate o pool devolver o job (pelo id da conexao)
+        conn.inPool = true;
+    }
+
+    void Server::Impl::onCompleted(std::unique_ptr<Job> job) {
+        auto it = connections.find(job->connectionId);
+        if (it == connections.end()) return;    // conexao fechada enquanto o pool trabalhava
+        Connection& conn = *it->second;
+        conn.inPool = false;
+        if (conn.fd < 0) return;
+        respond(conn, std::move(job));
+    }
+
+    void Server::Impl::respond(Connection& conn, std::unique_ptr<Job> job) {
+        HttpStream::Response& response = job->response;
+        response.headers.emplace_back("Server-Timing", job->trace->serverTiming());
+
+        bool keepAlive = job->request->keepAlive && !response.close;
+        conn.out = response.serializeHead(keepAlive);
+        if (response.bodyData) {
+            conn.body = response.bodyData;
+            conn.bodyLength = response.bodyLength;
+        } else {
+            conn.out += response.body;
+        }
+        conn.outOffset = 0;
+        conn.closeAfterWrite = !keepAlive;
+        conn.writingResponse = true;
+        conn.writeStartUs = job->trace->elapsedUs();
+        conn.lastWrite = Clock::now();
+        conn.active = std::move(job);
+        flush(conn);
+    }
+
+    void Server::Impl::flush(Connection& conn) {
+        // cabecalhos e corpo externo num unico sendmsg; o corpo sai direto da memoria do handler
+        while (conn.writing()) {
+            iovec parts[2];
+            size_t count = 0;
+            if (conn.outOffset < conn.out.size()) {
+                parts[count++] = { const_cast<char*>(conn.out.data()) + conn.outOffset, conn.out.size() - conn.outOffset };
+            }
+            size_t bodySent = conn.outOffset > conn.out.size() ? conn.outOffset - conn.out.size() : 0;
+            if (bodySent < conn.bodyLength) {
+                parts[count++] = { const_cast<char*>(conn.body) + bodySent, conn.bodyLength - bodySent };
+            }
+            msghdr message{};
+            message.msg_iov = parts;
+            message.msg_iovlen = count;
+            ssize_t n = ::sendmsg(conn.fd, &message, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return;   // continua no proximo EPOLLOUT
+                close(conn);
+                return;
+            }
+            conn.outOffset += static_cast<size_t>(n);
+            conn.lastWrite = Clock::now();
+        }
+
+        conn.out.clear();
+        conn.body = nullptr;
+        conn.bodyLength = 0;
+        conn.outOffset = 0;
+        if (conn.writingResponse) finishResponse(conn);
+        else dispatch(conn);
+    }
+
+    void Server::Impl::finishResponse(Connection& conn) {
+        std::unique_ptr<Job> job = std::move(conn.active);
+        conn.writingResponse = false;
+
+        RequestTrace::Trace& trace = *job->trace;
+        trace.addCompleted("send", conn.writeStartUs, trace.elapsedUs() - conn.writeStartUs);
+        trace.setAttribute("response_bytes", static_cast<long long>(job->response.contentLength()));
+        if (config.onComplete) config.onComplete(*job->request, job->response.status, trace);
+
+        if (conn.closeAfterWrite || (conn.peerClosed && conn.ready.empty())) {
+            close(conn);
+            return;
+        }
+        conn.lastActivity = Clock::now();
+        dispatch(conn);
+    }
+
+    void Server::Impl::fail(Connection& conn, HttpStream::Response response) {
+        // o erro entra na fila depois das requisicoes ja completas; a conexao fecha ao envia-lo
+        conn.failed = true;
+
+        std::unique_ptr<Job> job(new Job());
+        job->connectionId = conn.id;
+        job->route = nullptr;
+        job->request.reset(new HttpStream::Request());
+        job->request->keepAlive = false;
+        job->trace = conn.parsing ? std::move(conn.parsing) : std::unique_ptr<RequestTrace::Trace>(new RequestTrace::Trace(""));
+        job->prepared = true;
+        job->response = std::move(response);
+        job->response.close = true;
+        conn.ready.push_back(std::move(job));
+        dispatch(conn);
+    }
+
+    void Server::Impl::onWritable(Connection& conn) {
+        if (conn.writing()) flush(conn);
+    }
+
+    void Server::Impl::close(Connection& conn) {
+        if (conn.fd < 0) return;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, conn.fd, nullptr);
+        ::close(conn.fd);
+        conn.fd = -1;
+    }
+
+    void Server::Impl::sweepTimeouts() {
+        // lastActivity sozinho nao basta: um byte a cada poucos segundos o renova e um
+        // cliente que nao le deixa a resposta pendente, e a conexao nunca fica ociosa
+        Clock::time_point now = Clock::now();
+        Clock::time_point idleLimit = now - std::chrono::seconds(config.idleTimeoutSeconds);
+        Clock::time_point writeLimit = now - std::chrono::seconds(config.writeTimeoutSeconds);
+        for (auto& entry : connections) {
+            Connection& conn = *entry.second;
+            if (conn.fd < 0) continue;
+            if (conn.idle() && conn.lastActivity < idleLimit) {
+                close(conn);
+            } else if (conn.writing() && conn.lastWrite < writeLimit) {
+                close(conn);
+            } else if (conn.parsing && !conn.failed) {
+                bool headers = conn.parser.state() == HttpStream::RequestParser::State::Headers;
+                int timeout = headers ? config.headerTimeoutSeconds : config.requestTimeoutSeconds;
+                if (now - conn.requestStart >= std::chrono::seconds(timeout)) {
+                    fail(conn, HttpStream::errorResponse(408, "Tempo esgotado recebendo a requisicao."));
+                }
+            }
+        }
+    }
+
+    void Server::Impl::loop() {
+        std::vector<epoll_event> events(256);
+        Clock::time_point nextSweep = Clock::now() + std::chrono::seconds(1);
+
+        while (running.load()) {
+            int n = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 1000);
+            if (n < 0 && errno != EINTR) break;
+
+            for (int i = 0; i < n; ++i) {
+                std::uint64_t id = events[i].data.u64;
+                if (id == kListenerId) {
+                    accept();
+                    continue;
+                }
+                if (id == kWakeId) {
+                    std::uint64_t count;
+                    while (::read(wakeFd, &count, sizeof(count)) > 0) {}
+
+                    std::vector<std::unique_ptr<Job>> completed;
+                    {
+                        std::lock_guard<std::mutex> lock(outbox->mutex);
+                        completed.swap(outbox->done);
+                    }
+                    for (auto& job : completed) onCompleted(std::move(job));
+                    continue;
+                }
+
+                auto it = connections.find(id);
+                if (it == connections.end()) continue;
+                Connection& conn = *it->second;
+
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    close(conn);
+                } else {
+                    if (events[i].events & EPOLLOUT) onWritable(conn);
+                    if (conn.fd >= 0 && (events[i].events & (EPOLLIN | EPOLLRDHUP))) onReadable(conn);
+                }
+            }
+
+            if (Clock::now() >= nextSweep) {
+                sweepTimeouts();
+                nextSweep = Clock::now() + std::chrono::seconds(1);
+            }
+
+            // conexoes fechadas nesta volta saem do mapa (os jobs no pool sao descartados na volta)
+            for (auto it = connections.begin(); it != connections.end();) {
+                if (it->second->fd < 0) it = connections.erase(it);
+                else ++it;
+            }
+            connectionCount.store(connections.size(), std::memory_order_relaxed);
+        }
+
+        for (auto& entry : connections) close(*entry.second);
+        connections.clear();
+        connectionCount.store(0);
+    }
+
+    Server::Server(const Config& config, std::vector<Route> routes) : impl_(new Impl(config, std::move(routes))) {}
+
+    Server::~Server() {
+        stop();
+    }
+
+    bool Server::start(std::string& error) {
+        if (impl_->running.load()) return true;
+        if (!impl_->listen(error)) {
+            stop();
+            return false;
+        }
+
+        impl_->running.store(true);
+        unsigned threads = impl_->config.cryptoThreads == 0 ? 1 : impl_->config.cryptoThreads;
+        for (unsigned i = 0; i < threads; ++i) impl_->workers.emplace_back([this] { impl_->worker(); });
+        impl_->loopThread = std::thread([this] { impl_->loop(); });
+        return true;
+    }
+
+    void Server::stop() {
+        if (impl_->running.exchange(false)) impl_->wake();
+        if (impl_->loopThread.joinable()) impl_->loopThread.join();
+
+        {
+            std::lock_guard<std::mutex> lock(impl_->poolMutex);
+            impl_->poolStopping = true;
+            impl_->jobs.clear();
+        }
+        impl_->poolReady.notify_all();
+        for (auto& t : impl_->workers) t.join();
+        impl_->workers.clear();
+        if (impl_->outbox) {
+            // Reply tardios (resposta adiada) sao descartados a partir daqui
+            std::lock_guard<std::mutex> lock(impl_->outbox->mutex);
+            impl_->outbox->closed = true;
+            impl_->outbox->done.clear();
+        }
+
+        for (int* fd : { &impl_->listenFd, &impl_->epollFd, &impl_->wakeFd }) {
+            if (*fd >= 0) ::close(*fd);
+            *fd = -1;
+        }
+    }
+
+    unsigned short Server::port() const {
+        return impl_->boundPort;
+    }
+
+    size_t Server::openConnections() const {
+        return impl_->connectionCount.load(std::memory_order_relaxed);
+    }
+
+#else
+
+    Reply deferResponse() {
+        return Reply();
+    }
+
+    struct Server::Impl {};
+
+    Server::Server(const Config&, std::vector<Route>) : impl_(new Impl()) {}
+    Server::~Server() {}
+
+    bool Server::start(std::string& error) {
+        error = "front end epoll disponivel apenas no Linux";
+        return false;
+    }
+
+    void Server::stop() {}
+    unsigned short Server::port() const { return 0; }
+    size_t Server::openConnections() const { return 0; }
+
+#endif
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "HttpStream.h"
+#include "RequestTrace.h"
+
+// Front end orientado a eventos: uma thread com epoll (edge-triggered) cuida de
+// todas as conexoes com sockets nao bloqueantes, le e interpreta as requisicoes
+// aos poucos (HttpStream) e so entrega ao pool de criptografia as requisicoes
+// completas. Conexoes lentas ou ociosas custam um buffer, nao uma thread, e prazos
+// por requisicao (cabecalhos, corpo) e por escrita fecham quem envia a conta-gotas
+// ou nunca le a resposta.
+// O pool tem tamanho fixo (nucleos) e uma fila limitada por faixa (assinatura,
+// verificacao); com a faixa cheia a resposta eh 503 imediato, sem enfileirar.
+// Disponivel apenas no Linux; nas demais plataformas supported() retorna false.
+namespace EventServer {
+
+    using Handler = std::function<HttpStream::Response(const HttpStream::Request&)>;
+
+    struct Lane {
+        std::string name;
+        size_t maxPending;              // em execucao + aguardando no pool
+    };
+
+    struct Route {
+        std::string path;               // terminado em '/' atende os caminhos abaixo dele (ex.: /verify/{hash})
+        Handler handler;
+        int lane;                       // faixa do pool; -1 roda na thread do loop (rotas leves)
+    };
+
+    struct Config {
+        unsigned short port = 8080;     // 0: porta livre escolhida pelo sistema (testes)
+        bool reusePort = false;
+        int backlog = 1024;
+        unsigned cryptoThreads = 1;
+        std::vector<Lane> lanes;
+        HttpStream::Limits limits{ 16 * 1024, 64LL * 1024 * 1024, 128LL * 1024 * 1024, 1024 };
+        std::string tempDir;            // vazio: diretorio temporario do sistema
+        int idleTimeoutSeconds = 30;    // conexao sem receber bytes nem ter resposta pendente
+        int headerTimeoutSeconds = 10;  // do primeiro byte da requisicao ate o fim dos cabecalhos (408)
+        int requestTimeoutSeconds = 120; // do primeiro byte ate o corpo completo (408)
+        int writeTimeoutSeconds = 30;   // resposta pendente sem o cliente aceitar nenhum byte
+        size_t maxConnections = 10000;
+
+        // na thread do loop, depois que a resposta foi escrita no socket
+        std::function<void(const HttpStream::Request&, int status, const RequestTrace::Trace&)> onComplete;
+    };
+
+    bool supported();
+
+    // Resposta adiada: um handler do pool que espera E/S de outro servico (ex.: a TSA)
+    // chama deferResponse() e retorna; a thread de criptografia volta para a fila e o
+    // retorno do handler eh ignorado. A resposta eh entregue depois, de qualquer thread,
+    // chamando o Reply (apenas a primeira chamada vale). Fora de um handler do pool
+    // devolve um Reply vazio e o handler deve responder normalmente
+    using Reply = std::function<void(HttpStream::Response)>;
+    Reply deferResponse();
+
+    class Server {
+    public:
+        Server(const Config& config, std::vector<Route> routes);
+        ~Server();
+
+        Server(const Server&) = delete;
+        Server& operator=(const Server&) = delete;
+
+        // bind, listen e inicio das threads; false (com o motivo em error) se falhar
+        bool start(std::string& error);
+        void stop();
+
+        // porta efetiva (util com port = 0)
+        unsigned short port() const;
+        size_t openConnections() const;
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+}
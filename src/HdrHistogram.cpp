@@ -0,0 +1,202 @@
+#include "HdrHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    int countLeadingZeros(std::uint64_t value) {
+        int n = 0;
+        for (std::uint64_t bit = 1ull << 63; bit && !(value & bit); bit >>= 1) ++n;
+        return n;
+    }
+}
+
+HdrHistogram::HdrHistogram(std::int64_t lowestTrackable, std::int64_t highestTrackable, int significantDigits)
+    : lowestTrackable_(lowestTrackable), highestTrackable_(highestTrackable),
+      minValue_(std::numeric_limits<std::int64_t>::max()) {
+    if (lowestTrackable < 1 || highestTrackable < 2 * lowestTrackable || significantDigits < 1 || significantDigits > 5) {
+        throw std::invalid_argument("HdrHistogram: faixa ou precisao invalida");
+    }
+
+    // menor potencia de 2 que acomoda 2 * 10^digitos valores por bucket
+    std::int64_t largestSingleUnitResolution = 2;
+    for (int i = 0; i < significantDigits; ++i) largestSingleUnitResolution *= 10;
+    int subBucketCountMagnitude = static_cast<int>(std::ceil(std::log2(static_cast<double>(largestSingleUnitResolution))));
+
+    subBucketHalfCountMagnitude_ = std::max(subBucketCountMagnitude, 1) - 1;
+    unitMagnitude_ = static_cast<int>(std::floor(std::log2(static_cast<double>(lowestTrackable))));
+    subBucketCount_ = 1ll << (subBucketHalfCountMagnitude_ + 1);
+    subBucketHalfCount_ = subBucketCount_ / 2;
+    subBucketMask_ = (subBucketCount_ - 1) << unitMagnitude_;
+
+    std::int64_t smallestUntrackable = subBucketCount_ << unitMagnitude_;
+    int buckets = 1;
+    while (smallestUntrackable <= highestTrackable) {
+        if (smallestUntrackable > std::numeric_limits<std::int64_t>::max() / 2) {
+            ++buckets;
+            break;
+        }
+        smallestUntrackable <<= 1;
+        ++buckets;
+    }
+    bucketCount_ = buckets;
+    counts_.assign(static_cast<size_t>((bucketCount_ + 1) * subBucketHalfCount_), 0);
+}
+
+int HdrHistogram::bucketIndexOf(std::int64_t value) const {
+    int pow2Ceiling = 64 - countLeadingZeros(static_cast<std::uint64_t>(value | subBucketMask_));
+    return pow2Ceiling - unitMagnitude_ - (subBucketHalfCountMagnitude_ + 1);
+}
+
+int HdrHistogram::subBucketIndexOf(std::int64_t value, int bucketIndex) const {
+    return static_cast<int>(value >> (bucketIndex + unitMagnitude_));
+}
+
+size_t HdrHistogram::countsIndexOf(std::int64_t value) const {
+    int bucketIndex = bucketIndexOf(value);
+    int subBucketIndex = subBucketIndexOf(value, bucketIndex);
+    std::int64_t bucketBase = static_cast<std::int64_t>(bucketIndex + 1) << subBucketHalfCountMagnitude_;
+    return static_cast<size_t>(bucketBase + (subBucketIndex - subBucketHalfCount_));
+}
+
+std::int64_t HdrHistogram::valueFromIndex(size_t index) const {
+    std::int64_t bucketIndex = static_cast<std::int64_t>(index >> subBucketHalfCountMagnitude_) - 1;
+    std::int64_t subBucketIndex = static_cast<std::int64_t>(index & (subBucketHalfCount_ - 1)) + subBucketHalfCount_;
+    if (bucketIndex < 0) {
+        subBucketIndex -= subBucketHalfCount_;
+        bucketIndex = 0;
+    }
+    return subBucketIndex << (bucketIndex + unitMagnitude_);
+}
+
+std::int64_t HdrHistogram::sizeOfEquivalentRange(std::int64_t value) const {
+    int bucketIndex = bucketIndexOf(value);
+    int subBucketIndex = subBucketIndexOf(value, bucketIndex);
+    int adjustedBucket = (subBucketIndex >= subBucketCount_) ? bucketIndex + 1 : bucketIndex;
+    return 1ll << (unitMagnitude_ + adjustedBucket);
+}
+
+std::int64_t HdrHistogram::lowestEquivalentValue(std::int64_t value) const {
+    int bucketIndex = bucketIndexOf(value);
+    int subBucketIndex = subBucketIndexOf(value, bucketIndex);
+    return static_cast<std::int64_t>(subBucketIndex) << (bucketIndex + unitMagnitude_);
+}
+
+std::int64_t HdrHistogram::highestEquivalentValue(std::int64_t value) const {
+    return lowestEquivalentValue(value) + sizeOfEquivalentRange(value) - 1;
+}
+
+void HdrHistogram::record(std::int64_t value, std::int64_t count) {
+    if (value < 0) value = 0;
+    if (value > highestTrackable_) value = highestTrackable_;
+
+    counts_[countsIndexOf(value)] += count;
+    totalCount_ += count;
+    minValue_ = std::min(minValue_, value);
+    maxValue_ = std::max(maxValue_, value);
+}
+
+void HdrHistogram::merge(const HdrHistogram& other) {
+    if (other.counts_.size() == counts_.size() && other.unitMagnitude_ == unitMagnitude_) {
+        for (size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+        totalCount_ += other.totalCount_;
+        if (other.totalCount_ > 0) {
+            minValue_ = std::min(minValue_, other.minValue_);
+            maxValue_ = std::max(maxValue_, other.maxValue_);
+        }
+        return;
+    }
+
+    // layouts diferentes: reinsere pelo valor representativo de cada posicao
+    for (size_t i = 0; i < other.counts_.size(); ++i) {
+        if (other.counts_[i] > 0) record(other.valueFromIndex(i), other.counts_[i]);
+    }
+}
+
+void HdrHistogram::reset() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    totalCount_ = 0;
+    minValue_ = std::numeric_limits<std::int64_t>::max();
+    maxValue_ = 0;
+}
+
+std::int64_t HdrHistogram::min() const {
+    return totalCount_ == 0 ? 0 : lowestEquivalentValue(minValue_);
+}
+
+std::int64_t HdrHistogram::max() const {
+    return totalCount_ == 0 ? 0 : highestEquivalentValue(maxValue_);
+}
+
+double HdrHistogram::mean() const {
+    if (totalCount_ == 0) return 0.0;
+    double total = 0.0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        if (counts_[i] == 0) continue;
+        std::int64_t value = valueFromIndex(i);
+        // ponto medio da faixa equivalente
+        double median = static_cast<double>(lowestEquivalentValue(value)) + (sizeOfEquivalentRange(value) >> 1);
+        total += median * static_cast<double>(counts_[i]);
+    }
+    return total / static_cast<double>(totalCount_);
+}
+
+std::int64_t HdrHistogram::valueAtPercentile(double percentile) const {
+    if (totalCount_ == 0) return 0;
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+
+    std::int64_t target = static_cast<std::int64_t>(percentile / 100.0 * static_cast<double>(totalCount_) + 0.5);
+    target = std::max<std::int64_t>(target, 1);
+
+    std::int64_t cumulative = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        cumulative += counts_[i];
+        if (cumulative >= target) {
+            return highestEquivalentValue(valueFromIndex(i));
+        }
+    }
+    return max();
+}
+
+void HdrHistogram::printPercentileDistribution(std::ostream& out, double valueScale, int ticksPerHalfDistance) const {
+    out << std::setw(12) << "Value" << " " << std::setw(14) << "Percentile" << " "
+        << std::setw(10) << "TotalCount" << " " << std::setw(14) << "1/(1-Percentile)" << "\n\n";
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed;
+
+    if (totalCount_ > 0) {
+        // percentis a cada metade da distancia restante ate 100%, como no HdrHistogram original
+        double percentile = 0.0;
+        while (true) {
+            std::int64_t value = valueAtPercentile(percentile);
+            std::int64_t countBelow = 0;
+            for (size_t i = 0; i < counts_.size() && valueFromIndex(i) <= value; ++i) countBelow += counts_[i];
+            double actualPercentile = 100.0 * static_cast<double>(countBelow) / static_cast<double>(totalCount_);
+
+            out << std::setw(12) << std::setprecision(3) << value / valueScale << " "
+                << std::setw(14) << std::setprecision(12) << actualPercentile / 100.0 << " "
+                << std::setw(10) << countBelow;
+            if (actualPercentile < 100.0) {
+                out << " " << std::setw(14) << std::setprecision(2) << 1.0 / (1.0 - actualPercentile / 100.0);
+            }
+            out << "\n";
+
+            if (countBelow >= totalCount_) break;
+
+            double halfDistance = std::pow(2.0, std::floor(std::log2(100.0 / (100.0 - percentile))) + 1);
+            double increment = 100.0 / (halfDistance * ticksPerHalfDistance);
+            percentile += increment;
+        }
+    }
+
+    out << std::setprecision(3)
+        << "#[Mean    = " << std::setw(12) << mean() / valueScale
+        << ", Max     = " << std::setw(12) << max() / valueScale << "]\n"
+        << "#[Total count    = " << std::setw(12) << totalCount_ << "]\n";
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Histograma de faixa dinamica alta (HDR) com precisao fixa em digitos significativos.
+// Registra valores inteiros (ex: microssegundos) em O(1) e sem alocacao,
+// e pode ser combinado entre threads com merge().
+class HdrHistogram {
+public:
+    HdrHistogram(std::int64_t lowestTrackable, std::int64_t highestTrackable, int significantDigits);
+
+    // valores fora da faixa sao truncados no maior valor rastreavel
+    void record(std::int64_t value, std::int64_t count = 1);
+    void merge(const HdrHistogram& other);
+    void reset();
+
+    std::int64_t totalCount() const { return totalCount_; }
+    std::int64_t min() const;
+    std::int64_t max() const;
+    double mean() const;
+
+    // percentile em [0, 100]
+    std::int64_t valueAtPercentile(double percentile) const;
+
+    // tabela no formato do HdrHistogram (Value, Percentile, TotalCount, 1/(1-Percentile))
+    void printPercentileDistribution(std::ostream& out, double valueScale = 1.0, int ticksPerHalfDistance = 5) const;
+
+    std::int64_t highestEquivalentValue(std::int64_t value) const;
+    std::int64_t lowestEquivalentValue(std::int64_t value) const;
+
+private:
+    int bucketIndexOf(std::int64_t value) const;
+    int subBucketIndexOf(std::int64_t value, int bucketIndex) const;
+    size_t countsIndexOf(std::int64_t value) const;
+    std::int64_t valueFromIndex(size_t index) const;
+    std::int64_t sizeOfEquivalentRange(std::int64_t value) const;
+
+    std::int64_t lowestTrackable_;
+    std::int64_t highestTrackable_;
+    int unitMagnitude_;
+    int subBucketHalfCountMagnitude_;
+    std::int64_t subBucketCount_;
+    std::int64_t subBucketHalfCount_;
+    std::int64_t subBucketMask_;
+    int bucketCount_;
+
+    std::vector<std::int64_t> counts_;
+    std::int64_t totalCount_ = 0;
+    std::int64_t minValue_;
+    std::int64_t maxValue_ = 0;
+};
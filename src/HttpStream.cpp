@@ -0,0 +1,427 @@
+#include "HttpStream.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace HttpStream {
+
+    static std::string toLower(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return text;
+    }
+
+    static std::string trim(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t");
+        if (first == std::string::npos) return "";
+        size_t last = text.find_last_not_of(" \t\r");
+        return text.substr(first, last - first + 1);
+    }
+
+    // valor de um parametro de cabecalho (name="x"; filename="y"; boundary=z)
+    static std::string headerParam(const std::string& value, const std::string& param) {
+        size_t pos = 0;
+        while ((pos = value.find(';', pos)) != std::string::npos) {
+            ++pos;
+            size_t eq = value.find('=', pos);
+            if (eq == std::string::npos) break;
+            if (toLower(trim(value.substr(pos, eq - pos))) != param) continue;
+
+            size_t start = eq + 1;
+            if (start < value.size() && value[start] == '"') {
+                size_t end = value.find('"', start + 1);
+                return value.substr(start + 1, end == std::string::npos ? std::string::npos : end - start - 1);
+            }
+            size_t end = value.find(';', start);
+            return trim(value.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        }
+        return "";
+    }
+
+    static std::string newTempPath(const std::string& dir) {
+        static std::atomic<unsigned long long> counter{ 0 };
+        return (std::filesystem::path(dir) / ("bry_upload_" + std::to_string(getpid()) + "_" + std::to_string(++counter))).string();
+    }
+
+    // ------------------------------------------------------------------
+    // Request / Response
+    // ------------------------------------------------------------------
+
+    Request::~Request() {
+        removeFiles();
+    }
+
+    std::string Request::header(const std::string& lowerName, const std::string& defaultValue) const {
+        for (const auto& h : headers) {
+            if (h.first == lowerName) return h.second;
+        }
+        return defaultValue;
+    }
+
+    void Request::removeFiles() {
+        for (const auto& entry : files) std::remove(entry.second.c_str());
+        files.clear();
+    }
+
+    const char* reasonPhrase(int status) {
+        switch (status) {
+            case 100: return "Continue";
+            case 200: return "OK";
+            case 400: return "Bad Request";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 408: return "Request Timeout";
+            case 411: return "Length Required";
+            case 413: return "Request Entity Too Large";
+            case 431: return "Request Header Fields Too Large";
+            case 500: return "Internal Server Error";
+            case 501: return "Not Implemented";
+            case 503: return "Service Unavailable";
+            default: return "Unknown";
+        }
+    }
+
+    std::string Response::serializeHead(bool keepAlive) const {
+        std::string out = "HTTP/1.1 " + std::to_string(status) + " " + reasonPhrase(status) + "\r\n";
+        out += "Content-Type: " + contentType + "\r\n";
+        out += "Content-Length: " + std::to_string(contentLength()) + "\r\n";
+        out += (keepAlive && !close) ? "Connection: Keep-Alive\r\n" : "Connection: close\r\n";
+        for (const auto& h : headers) out += h.first + ": " + h.second + "\r\n";
+        out += "\r\n";
+        return out;
+    }
+
+    std::string Response::serialize(bool keepAlive) const {
+        std::string out = serializeHead(keepAlive);
+        if (bodyData) out.append(bodyData, bodyLength);
+        else out += body;
+        return out;
+    }
+
+    Response errorResponse(int status, const std::string& message) {
+        Response response;
+        response.status = status;
+        response.body = message;
+        response.close = true;
+        return response;
+    }
+
+    // ------------------------------------------------------------------
+    // MultipartParser
+    // ------------------------------------------------------------------
+
+    MultipartParser::MultipartParser(const std::string& boundary, const Limits& limits, const std::string& tempDir, Request& request)
+        : dashBoundary_("--" + boundary), delimiter_("\r\n--" + boundary), limits_(limits), tempDir_(tempDir), request_(request) {}
+
+    MultipartParser::~MultipartParser() {
+        // parte interrompida no meio: o arquivo ainda nao entrou em request_.files
+        if (partFile_.is_open()) {
+            partFile_.close();
+            std::remove(partPath_.c_str());
+        }
+    }
+
+    bool MultipartParser::fail(int status, const std::string& message) {
+        errorStatus_ = status;
+        errorMessage_ = message;
+        if (partFile_.is_open()) {
+            partFile_.close();
+            std::remove(partPath_.c_str());
+        }
+        return false;
+    }
+
+    bool MultipartParser::startPart(const std::string& headerBlock) {
+        std::string disposition;
+        size_t pos = 0;
+        while (pos < headerBlock.size()) {
+            size_t end = headerBlock.find("\r\n", pos);
+            if (end == std::string::npos) end = headerBlock.size();
+            std::string line = headerBlock.substr(pos, end - pos);
+            pos = end + 2;
+
+            size_t colon = line.find(':');
+            if (colon != std::string::npos && toLower(trim(line.substr(0, colon))) == "content-disposition") {
+                disposition = line.substr(colon + 1);
+            }
+        }
+
+        partName_ = headerParam(disposition, "name");
+        partIsFile_ = disposition.find("filename=") != std::string::npos;
+        partBytes_ = 0;
+        partValue_.clear();
+
+        // igual ao handler do Poco: partes com filename vazio sao ignoradas
+        if (partIsFile_ && headerParam(disposition, "filename").empty()) partName_.clear();
+
+        if (partIsFile_ && !partName_.empty()) {
+            partPath_ = newTempPath(tempDir_);
+            partFile_.open(partPath_, std::ios::binary | std::ios::trunc);
+            if (!partFile_) return fail(500, "Falha ao criar arquivo temporario");
+        }
+        return true;
+    }
+
+    bool MultipartParser::writePart(const char* data, size_t length) {
+        if (partName_.empty() || length == 0) return true;
+
+        if (partIsFile_) {
+            partBytes_ += static_cast<long long>(length);
+            totalFileBytes_ += static_cast<long long>(length);
+            if (partBytes_ > limits_.maxFieldBytes || totalFileBytes_ > limits_.maxRequestBytes) {
+                return fail(413, "Campo '" + partName_ + "' excede o limite de upload");
+            }
+            partFile_.write(data, static_cast<std::streamsize>(length));
+            if (!partFile_) return fail(500, "Falha ao gravar arquivo temporario");
+            return true;
+        }
+
+        if (partValue_.size() + length > limits_.maxValueLength) {
+            return fail(413, "Campo '" + partName_ + "' excede o limite de tamanho");
+        }
+        partValue_.append(data, length);
+        return true;
+    }
+
+    bool MultipartParser::endPart() {
+        if (partName_.empty()) return true;
+
+        if (partIsFile_) {
+            partFile_.close();
+            if (!partFile_) return fail(500, "Falha ao gravar arquivo temporario");
+
+            // campo repetido: vale o ultimo, como no Poco
+            auto previous = request_.files.find(partName_);
+            if (previous != request_.files.end()) std::remove(previous->second.c_str());
+            request_.files[partName_] = partPath_;
+            request_.fileBytes[partName_] = partBytes_;
+        } else {
+            request_.fields[partName_] = partValue_;
+        }
+        partName_.clear();
+        return true;
+    }
+
+    bool MultipartParser::feed(const char* data, size_t length) {
+        if (errorStatus_) return false;
+        buffer_.append(data, length);
+
+        while (true) {
+            switch (state_) {
+                case State::Preamble: {
+                    size_t pos = buffer_.find(dashBoundary_);
+                    if (pos == std::string::npos) {
+                        // guarda apenas o que ainda pode ser inicio do delimitador
+                        if (buffer_.size() > dashBoundary_.size()) buffer_.erase(0, buffer_.size() - dashBoundary_.size());
+                        return true;
+                    }
+                    buffer_.erase(0, pos + dashBoundary_.size());
+                    state_ = State::AfterBoundary;
+                    break;
+                }
+                case State::AfterBoundary: {
+                    if (buffer_.size() < 2) return true;
+                    if (buffer_.compare(0, 2, "--") == 0) {
+                        state_ = State::Done;
+                        buffer_.clear();
+                        return true;
+                    }
+                    if (buffer_.compare(0, 2, "\r\n") != 0) return fail(400, "Multipart invalido");
+                    buffer_.erase(0, 2);
+                    state_ = State::PartHeaders;
+                    break;
+                }
+                case State::PartHeaders: {
+                    size_t end = buffer_.find("\r\n\r\n");
+                    if (end == std::string::npos) {
+                        if (buffer_.size() > limits_.maxHeaderBytes) return fail(431, "Cabecalhos do multipart muito grandes");
+                        return true;
+                    }
+                    if (!startPart(buffer_.substr(0, end))) return false;
+                    buffer_.erase(0, end + 4);
+                    state_ = State::PartBody;
+                    break;
+                }
+                case State::PartBody: {
+                    size_t pos = buffer_.find(delimiter_);
+                    if (pos == std::string::npos) {
+                        // o final do buffer pode ser o inicio do delimitador: fica para o proximo feed
+                        size_t keep = delimiter_.size() - 1;
+                        if (buffer_.size() > keep) {
+                            size_t safe = buffer_.size() - keep;
+                            if (!writePart(buffer_.data(), safe)) return false;
+                            buffer_.erase(0, safe);
+                        }
+                        return true;
+                    }
+                    if (!writePart(buffer_.data(), pos) || !endPart()) return false;
+                    buffer_.erase(0, pos + delimiter_.size());
+                    state_ = State::AfterBoundary;
+                    break;
+                }
+                case State::Done:
+                    buffer_.clear();
+                    return true;
+            }
+        }
+    }
+
+    bool MultipartParser::finish() {
+        if (errorStatus_) return false;
+        if (state_ != State::Done) return fail(400, "Multipart incompleto");
+        return true;
+    }
+
+    // ------------------------------------------------------------------
+    // RequestParser
+    // ------------------------------------------------------------------
+
+    RequestParser::RequestParser(const Limits& limits, const std::string& tempDir)
+        : limits_(limits), tempDir_(tempDir), request_(new Request) {}
+
+    void RequestParser::reset() {
+        state_ = State::Headers;
+        head_.clear();
+        multipart_.reset();
+        request_.reset(new Request);
+        bodyRemaining_ = 0;
+        received_ = 0;
+        expectContinue_ = false;
+        error_ = Response();
+    }
+
+    bool RequestParser::fail(int status, const std::string& message) {
+        state_ = State::Error;
+        error_ = errorResponse(status, message);
+        multipart_.reset();
+        if (request_) request_->removeFiles();
+        return false;
+    }
+
+    bool RequestParser::takeExpectContinue() {
+        bool value = expectContinue_;
+        expectContinue_ = false;
+        return value;
+    }
+
+    std::unique_ptr<Request> RequestParser::take() {
+        std::unique_ptr<Request> done = std::move(request_);
+        reset();
+        return done;
+    }
+
+    bool RequestParser::parseHead(const std::string& head) {
+        Request& req = *request_;
+
+        size_t lineEnd = head.find("\r\n");
+        std::string requestLine = head.substr(0, lineEnd);
+        size_t sp1 = requestLine.find(' ');
+        size_t sp2 = requestLine.rfind(' ');
+        if (sp1 == std::string::npos || sp2 == sp1) return fail(400, "Linha de requisicao invalida");
+
+        req.method = requestLine.substr(0, sp1);
+        req.target = requestLine.substr(sp1 + 1, sp2 - sp1 - 1);
+        req.version = requestLine.substr(sp2 + 1);
+        if (req.version != "HTTP/1.1" && req.version != "HTTP/1.0") return fail(400, "Versao HTTP nao suportada");
+
+        size_t query = req.target.find('?');
+        req.path = req.target.substr(0, query);
+
+        size_t pos = (lineEnd == std::string::npos) ? head.size() : lineEnd + 2;
+        while (pos < head.size()) {
+            size_t end = head.find("\r\n", pos);
+            if (end == std::string::npos) end = head.size();
+            std::string line = head.substr(pos, end - pos);
+            pos = end + 2;
+            if (line.empty()) continue;
+
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) return fail(400, "Cabecalho invalido");
+            req.headers.emplace_back(toLower(trim(line.substr(0, colon))), trim(line.substr(colon + 1)));
+        }
+
+        std::string connection = toLower(req.header("connection"));
+        req.keepAlive = (req.version == "HTTP/1.1") ? connection != "close" : connection == "keep-alive";
+
+        if (!req.header("transfer-encoding").empty()) return fail(411, "Envie o corpo com Content-Length");
+
+        std::string length = req.header("content-length");
+        if (!length.empty()) {
+            try {
+                req.contentLength = std::stoll(length);
+            } catch (const std::exception&) {
+                return fail(400, "Content-Length invalido");
+            }
+            if (req.contentLength < 0) return fail(400, "Content-Length invalido");
+        }
+        if (req.contentLength > limits_.maxRequestBytes) return fail(413, "Requisicao excede o limite de upload.");
+
+        expectContinue_ = toLower(req.header("expect")) == "100-continue" && req.contentLength > 0;
+
+        std::string contentType = req.header("content-type");
+        if (toLower(contentType).rfind("multipart/form-data", 0) == 0) {
+            std::string boundary = headerParam(contentType, "boundary");
+            if (boundary.empty()) return fail(400, "Multipart sem boundary");
+            multipart_.reset(new MultipartParser(boundary, limits_, tempDir_, req));
+        }
+
+        bodyRemaining_ = req.contentLength;
+        state_ = State::Body;
+        return true;
+    }
+
+    size_t RequestParser::feed(const char* data, size_t length) {
+        size_t used = 0;
+
+        if (state_ == State::Headers) {
+            // procura o fim dos cabecalhos so na parte nova (mais 3 bytes de sobreposicao)
+            size_t searchFrom = head_.size() < 3 ? 0 : head_.size() - 3;
+            size_t room = limits_.maxHeaderBytes + 4 - std::min(head_.size(), limits_.maxHeaderBytes + 4);
+            size_t take = std::min(length, room);
+            head_.append(data, take);
+            received_ += take;
+
+            size_t end = head_.find("\r\n\r\n", searchFrom);
+            if (end == std::string::npos) {
+                if (head_.size() > limits_.maxHeaderBytes) fail(431, "Cabecalhos muito grandes");
+                return take;
+            }
+
+            // bytes alem dos cabecalhos ja sao corpo (ou a proxima requisicao)
+            size_t headEnd = end + 4;
+            used = take - (head_.size() - headEnd);
+            head_.resize(headEnd);
+            if (!parseHead(head_.substr(0, end))) return used;
+        }
+
+        if (state_ == State::Body) {
+            size_t chunk = static_cast<size_t>(std::min<long long>(bodyRemaining_, static_cast<long long>(length - used)));
+            if (chunk > 0) {
+                if (multipart_ && !multipart_->feed(data + used, chunk)) {
+                    fail(multipart_->errorStatus(), multipart_->errorMessage());
+                    return used + chunk;
+                }
+                bodyRemaining_ -= static_cast<long long>(chunk);
+                used += chunk;
+                received_ += chunk;
+            }
+            if (bodyRemaining_ == 0) {
+                if (multipart_ && !multipart_->finish()) {
+                    fail(multipart_->errorStatus(), multipart_->errorMessage());
+                    return used;
+                }
+                multipart_.reset();
+                state_ = State::Complete;
+            }
+        }
+        return used;
+    }
+}
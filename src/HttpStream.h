@@ -0,0 +1,159 @@
+#pragma once
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// HTTP/1.1 e multipart/form-data incrementais para o front end epoll.
+// O parser recebe os bytes na ordem em que chegam do socket, em pedacos de
+// qualquer tamanho, sem bloquear: arquivos do multipart vao direto para
+// arquivos temporarios e so a requisicao completa sai para o handler.
+// Independente de transporte e do Poco.
+namespace HttpStream {
+
+    struct Limits {
+        size_t maxHeaderBytes;          // linha de requisicao + cabecalhos
+        long long maxFieldBytes;        // cada arquivo enviado
+        long long maxRequestBytes;      // corpo inteiro
+        size_t maxValueLength;          // campos texto (ex: password)
+    };
+
+    // Requisicao completa. Os arquivos temporarios pertencem a ela e sao
+    // removidos no destrutor
+    struct Request {
+        std::string method;
+        std::string target;
+        std::string path;
+        std::string version;
+        std::vector<std::pair<std::string, std::string>> headers;  // nomes em minusculas
+        std::map<std::string, std::string> fields;                 // campos texto do formulario
+        std::map<std::string, std::string> files;                  // campo -> arquivo temporario
+        std::map<std::string, long long> fileBytes;
+        long long contentLength = 0;
+        bool keepAlive = true;
+
+        Request() = default;
+        ~Request();
+        Request(const Request&) = delete;
+        Request& operator=(const Request&) = delete;
+
+        std::string header(const std::string& lowerName, const std::string& defaultValue = "") const;
+        void removeFiles();
+    };
+
+    struct Response {
+        int status = 200;
+        std::string contentType = "text/plain";
+        std::string body;
+        std::vector<std::pair<std::string, std::string>> headers;
+        bool close = false;             // fecha a conexao depois de enviar
+
+        // corpo fora da string (ex.: assinatura no mmap do SignatureStore), enviado sem
+        // copia depois dos cabecalhos; bodyOwner mantem a memoria valida ate o envio
+        std::shared_ptr<const void> bodyOwner;
+        const char* bodyData = nullptr;
+        size_t bodyLength = 0;
+
+        size_t contentLength() const { return bodyData ? bodyLength : body.size(); }
+
+        // status e cabecalhos (Content-Length, Connection), sem o corpo
+        std::string serializeHead(bool keepAlive) const;
+
+        // status, cabecalhos e corpo prontos para o socket
+        std::string serialize(bool keepAlive) const;
+    };
+
+    const char* reasonPhrase(int status);
+
+    // Resposta de erro padrao do parser (413, 400, 411...) com Connection: close
+    Response errorResponse(int status, const std::string& message);
+
+    // Corpo multipart/form-data em streaming. O delimitador pode chegar partido
+    // entre dois feeds: o final do buffer que ainda pode ser inicio de delimitador
+    // so eh gravado no feed seguinte
+    class MultipartParser {
+    public:
+        MultipartParser(const std::string& boundary, const Limits& limits, const std::string& tempDir, Request& request);
+        ~MultipartParser();
+
+        // false em erro (status e mensagem em errorStatus/errorMessage)
+        bool feed(const char* data, size_t length);
+
+        // o corpo terminou: valido apenas se o delimitador final foi visto
+        bool finish();
+
+        int errorStatus() const { return errorStatus_; }
+        const std::string& errorMessage() const { return errorMessage_; }
+
+    private:
+        enum class State { Preamble, AfterBoundary, PartHeaders, PartBody, Done };
+
+        bool fail(int status, const std::string& message);
+        bool startPart(const std::string& headerBlock);
+        bool writePart(const char* data, size_t length);
+        bool endPart();
+
+        std::string dashBoundary_;      // "--" + boundary
+        std::string delimiter_;         // "\r\n--" + boundary
+        const Limits& limits_;
+        std::string tempDir_;
+        Request& request_;
+
+        State state_ = State::Preamble;
+        std::string buffer_;
+        std::string partName_;
+        bool partIsFile_ = false;
+        std::string partPath_;
+        std::ofstream partFile_;
+        std::string partValue_;
+        long long partBytes_ = 0;
+        long long totalFileBytes_ = 0;
+        int errorStatus_ = 0;
+        std::string errorMessage_;
+    };
+
+    class RequestParser {
+    public:
+        enum class State { Headers, Body, Complete, Error };
+
+        RequestParser(const Limits& limits, const std::string& tempDir);
+
+        // Consome bytes ate completar a requisicao atual e retorna quantos usou;
+        // o que sobrar pertence a proxima requisicao (pipelining)
+        size_t feed(const char* data, size_t length);
+
+        State state() const { return state_; }
+
+        // cabecalhos completos pedindo "Expect: 100-continue" (consultar uma vez)
+        bool takeExpectContinue();
+
+        // bytes ja recebidos da requisicao atual (cabecalhos + corpo)
+        bool started() const { return received_ > 0; }
+
+        // resposta de erro quando state() == Error
+        const Response& error() const { return error_; }
+
+        // entrega a requisicao completa e prepara o parser para a proxima
+        std::unique_ptr<Request> take();
+
+        void reset();
+
+    private:
+        bool fail(int status, const std::string& message);
+        bool parseHead(const std::string& head);
+
+        Limits limits_;
+        std::string tempDir_;
+        State state_ = State::Headers;
+        std::string head_;
+        std::unique_ptr<Request> request_;
+        std::unique_ptr<MultipartParser> multipart_;
+        long long bodyRemaining_ = 0;
+        unsigned long long received_ = 0;
+        bool expectContinue_ = false;
+        Response error_;
+    };
+}
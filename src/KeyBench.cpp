@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+
+#include "OpenSSLPool.h"
+#include "SignerService.h"
+#include "VerifierService.h"
+#include "Utils.h"
+
+using Clock = std::chrono::steady_clock;
+
+// ------------------------------------------------------------------
+// Compara assinaturas/s e verificacoes/s por tipo de chave (uma thread)
+// Uso: Bry_KeyBench --duration=3 --doc-size=4k
+//                   --p12=resources/pkcs12/certificado_teste_ecdsa_p256.pfx --p12=...
+// Sem --p12 usa todos os certificados de teste em resources/pkcs12
+// ------------------------------------------------------------------
+
+struct Options {
+    double durationSeconds = 3.0;   // por tipo de chave e por operacao
+    size_t docSize = 4096;
+    std::vector<std::string> p12Paths;
+    std::string password;
+};
+
+struct BenchResult {
+    std::string p12Path;
+    std::string keyType;
+    std::string digest;
+    double signPerSecond = 0;
+    double verifyPerSecond = 0;
+    size_t signatureBytes = 0;
+};
+
+static const std::vector<std::string> kDefaultP12 = {
+    "resources/pkcs12/certificado_teste_hub.pfx",
+    "resources/pkcs12/certificado_teste_rsa4096.pfx",
+    "resources/pkcs12/certificado_teste_ecdsa_p256.pfx",
+    "resources/pkcs12/certificado_teste_ecdsa_p384.pfx",
+    "resources/pkcs12/certificado_teste_ed25519.pfx",
+};
+
+size_t parseSize(const std::string& text) {
+    size_t value = std::stoull(text);
+    char suffix = text.empty() ? '\0' : static_cast<char>(std::tolower(static_cast<unsigned char>(text.back())));
+    if (suffix == 'k') value *= 1024;
+    else if (suffix == 'm') value *= 1024 * 1024;
+    return value;
+}
+
+bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            std::cerr << "Argumento invalido: " << arg << std::endl;
+            return false;
+        }
+        std::string key = arg.substr(2, eq - 2);
+        std::string value = arg.substr(eq + 1);
+
+        if (key == "duration") opt.durationSeconds = std::max(0.1, std::stod(value));
+        else if (key == "doc-size") opt.docSize = parseSize(value);
+        else if (key == "p12") opt.p12Paths.push_back(value);
+        else if (key == "password") opt.password = value;
+        else {
+            std::cerr << "Opcao desconhecida: --" << key << std::endl;
+            return false;
+        }
+    }
+    if (opt.p12Paths.empty()) opt.p12Paths = kDefaultP12;
+    return true;
+}
+
+std::string describeKey(EVP_PKEY* pkey) {
+    int bits = EVP_PKEY_bits(pkey);
+    switch (EVP_PKEY_base_id(pkey)) {
+        case EVP_PKEY_RSA:
+        case EVP_PKEY_RSA_PSS: return "RSA-" + std::to_string(bits);
+        case EVP_PKEY_EC: return "ECDSA P-" + std::to_string(bits);
+        case EVP_PKEY_ED25519: return "Ed25519";
+        default: return "desconhecida";
+    }
+}
+
+// repete op ate completar a duracao e devolve operacoes por segundo
+template <typename Op>
+double measure(double seconds, Op op) {
+    Clock::time_point start = Clock::now();
+    Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    long long count = 0;
+    Clock::time_point now = start;
+    do {
+        if (!op()) return -1;
+        ++count;
+        now = Clock::now();
+    } while (now < end);
+    return count / std::chrono::duration<double>(now - start).count();
+}
+
+bool runBench(const Options& opt, const std::string& p12Path, const std::string& docPath, BenchResult& result) {
+    PKCS12* p12 = nullptr;
+    EVP_PKEY* pkey = nullptr;
+    X509* cert = nullptr;
+    STACK_OF(X509)* ca = nullptr;
+
+    bool loaded = SignerService::loadCredentials(p12Path, opt.password, &p12, &pkey, &cert, &ca);
+
+    OpenSSLPool::P12Ptr p12Guard(p12);
+    OpenSSLPool::PkeyPtr pkeyGuard(pkey);
+    OpenSSLPool::X509Ptr certGuard(cert);
+    OpenSSLPool::X509StackPtr caGuard(ca);
+
+    if (!loaded) return false;
+
+    result.p12Path = p12Path;
+    result.keyType = describeKey(pkey);
+    result.digest = EVP_MD_get0_name(SignerService::digestForKey(pkey));
+
+    // assinatura: CMS completo em memoria, credenciais ja carregadas
+    result.signPerSecond = measure(opt.durationSeconds, [&]() {
+        OpenSSLPool::CmsPtr cms(SignerService::signData(docPath, cert, pkey, ca));
+        OpenSSLPool::PooledMemBio out;
+        return cms && i2d_CMS_bio(out.get(), cms.get()) == 1;
+    });
+    if (result.signPerSecond < 0) return false;
+
+    // verificacao: mesmo caminho do /verify a partir do arquivo gerado uma vez
+    std::string sigPath = "keybench_" + std::to_string(std::hash<std::string>{}(p12Path)) + ".p7s";
+    if (!SignerService::generateSignature(p12Path, opt.password, docPath, sigPath)) return false;
+
+    std::ifstream sig(sigPath, std::ios::binary | std::ios::ate);
+    result.signatureBytes = static_cast<size_t>(sig.tellg());
+    sig.close();
+
+    result.verifyPerSecond = measure(opt.durationSeconds, [&]() {
+        return VerifierService::verifyAndGetDetails(sigPath).isValid;
+    });
+    std::remove(sigPath.c_str());
+
+    return result.verifyPerSecond >= 0;
+}
+
+int main(int argc, char** argv) {
+    Utils::loadEnvFile();
+
+    Options opt;
+    opt.password = Utils::getEnvVar("P12_PASSWORD");
+    if (!parseOptions(argc, argv, opt)) return 1;
+
+    if (Utils::getEnvVar("OPENSSL_POOL_ALLOCATOR", "1") != "0") OpenSSLPool::installAllocator();
+    OpenSSL_add_all_algorithms();
+    ERR_load_crypto_strings();
+
+    const std::string docPath = "keybench_doc.bin";
+    {
+        std::ofstream doc(docPath, std::ios::binary);
+        std::string block(opt.docSize, 'x');
+        doc << block;
+    }
+
+    std::vector<BenchResult> results;
+    for (const std::string& p12Path : opt.p12Paths) {
+        BenchResult result;
+        if (!runBench(opt, p12Path, docPath, result)) {
+            Utils::printOpenSSLError("Falha no benchmark de " + p12Path);
+            continue;
+        }
+        results.push_back(result);
+    }
+    std::remove(docPath.c_str());
+    Logger::flush();
+
+    std::cout << std::endl << "Documento de " << opt.docSize << " bytes, " << opt.durationSeconds
+              << " s por operacao, 1 thread" << std::endl << std::endl;
+    std::cout << std::left << std::setw(14) << "Chave" << std::setw(10) << "Digest"
+              << std::right << std::setw(14) << "Assin./s" << std::setw(14) << "Verif./s"
+              << std::setw(14) << "Bytes CMS" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (const BenchResult& r : results) {
+        std::cout << std::left << std::setw(14) << r.keyType << std::setw(10) << r.digest
+                  << std::right << std::setw(14) << r.signPerSecond << std::setw(14) << r.verifyPerSecond
+                  << std::setw(14) << r.signatureBytes << std::endl;
+    }
+
+    return results.size() == opt.p12Paths.size() ? 0 : 1;
+}
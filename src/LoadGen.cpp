@@ -0,0 +1,454 @@
+#include "Poco/Net/HTTPClientSession.h"
+#include "Poco/Net/HTTPSClientSession.h"
+#include "Poco/Net/Context.h"
+#include "Poco/Net/Session.h"
+#include "Poco/Net/NetSSL.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/JSON/Object.h"
+#include "Poco/Base64Decoder.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/Timespan.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "HdrHistogram.h"
+#include "Utils.h"
+
+using namespace Poco::Net;
+using Clock = std::chrono::steady_clock;
+
+// ------------------------------------------------------------------
+// Gerador de carga para /signature e /verify
+// Uso: Bry_LoadGen --concurrency=8 --rate=200 --duration=30 --sign-ratio=0.3
+//                  --doc-sizes=4k:5,64k:3,1m:1 --json=resultado.json
+// Handshakes TLS: --tls=1 --new-connection=1 --resume=0|1
+// Escala de conexoes: --slow-clients=2000 --trickle-ms=1000
+// ------------------------------------------------------------------
+
+struct Options {
+    std::string host = "127.0.0.1";
+    unsigned short port = 8080;
+    unsigned concurrency = 8;
+    double rate = 0.0;              // requisicoes/s no total; 0 = loop fechado
+    double durationSeconds = 30.0;
+    double warmupSeconds = 2.0;
+    double signRatio = 0.5;         // fracao de /signature no mix
+    std::string docSizes = "4k:1";  // tamanho:peso separados por virgula
+    std::string p12Path = "resources/pkcs12/certificado_teste_hub.pfx";
+    std::string password;
+    std::string jsonPath;           // vazio = nao grava JSON
+    bool tls = false;               // HTTPS
+    bool newConnection = false;     // uma conexao (e um handshake) por requisicao
+    bool resume = true;             // reapresenta a sessao TLS anterior (resumption)
+    unsigned slowClients = 0;       // conexoes extras com upload que nunca termina
+    unsigned trickleMs = 1000;      // intervalo entre os bytes de cada cliente lento
+};
+
+struct DocProfile {
+    size_t size;
+    double weight;
+    std::string signBody;
+    std::string verifyBody;
+};
+
+struct OpStats {
+    HdrHistogram latencyUs{1, 3600000000LL, 3};
+    std::int64_t errors = 0;
+    std::int64_t rejected = 0;      // 503 do controle de admissao
+};
+
+struct WorkerStats {
+    OpStats sign;
+    OpStats verify;
+};
+
+static const std::string kBoundary = "----BryLoadGenBoundary7MA4YWxkTrZu0gW";
+
+size_t parseSize(const std::string& text) {
+    size_t value = std::stoull(text);
+    char suffix = text.empty() ? '\0' : static_cast<char>(std::tolower(static_cast<unsigned char>(text.back())));
+    if (suffix == 'k') value *= 1024;
+    else if (suffix == 'm') value *= 1024 * 1024;
+    return value;
+}
+
+bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            std::cerr << "Argumento invalido: " << arg << std::endl;
+            return false;
+        }
+        std::string key = arg.substr(2, eq - 2);
+        std::string value = arg.substr(eq + 1);
+
+        if (key == "host") opt.host = value;
+        else if (key == "port") opt.port = static_cast<unsigned short>(std::stoi(value));
+        else if (key == "concurrency") opt.concurrency = static_cast<unsigned>(std::max(1, std::stoi(value)));
+        else if (key == "rate") opt.rate = std::stod(value);
+        else if (key == "duration") opt.durationSeconds = std::stod(value);
+        else if (key == "warmup") opt.warmupSeconds = std::stod(value);
+        else if (key == "sign-ratio") opt.signRatio = std::min(1.0, std::max(0.0, std::stod(value)));
+        else if (key == "doc-sizes") opt.docSizes = value;
+        else if (key == "p12") opt.p12Path = value;
+        else if (key == "password") opt.password = value;
+        else if (key == "json") opt.jsonPath = value;
+        else if (key == "tls") opt.tls = value == "1";
+        else if (key == "new-connection") opt.newConnection = value == "1";
+        else if (key == "resume") opt.resume = value == "1";
+        else if (key == "slow-clients") opt.slowClients = static_cast<unsigned>(std::max(0, std::stoi(value)));
+        else if (key == "trickle-ms") opt.trickleMs = static_cast<unsigned>(std::max(1, std::stoi(value)));
+        else {
+            std::cerr << "Opcao desconhecida: --" << key << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// contexto de cliente compartilhado; o cache de sessao permite reapresentar tickets
+Poco::Net::Context::Ptr clientContext() {
+    static Poco::Net::Context::Ptr context = [] {
+        Poco::Net::Context::Params params;
+        params.verificationMode = Poco::Net::Context::VERIFY_NONE;
+        params.loadDefaultCAs = false;
+        Poco::Net::Context::Ptr ctx = new Poco::Net::Context(Poco::Net::Context::TLS_CLIENT_USE, params);
+        ctx->enableSessionCache(true);
+        return ctx;
+    }();
+    return context;
+}
+
+std::unique_ptr<HTTPClientSession> openSession(const Options& opt, Poco::Net::Session::Ptr tlsSession = nullptr) {
+    std::unique_ptr<HTTPClientSession> session;
+    if (opt.tls) {
+        session.reset(new HTTPSClientSession(opt.host, opt.port, clientContext(), tlsSession));
+    } else {
+        session.reset(new HTTPClientSession(opt.host, opt.port));
+    }
+    session->setKeepAlive(!opt.newConnection);
+    session->setTimeout(Poco::Timespan(60, 0));
+    return session;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+// monta o corpo multipart uma unica vez por perfil, fora do caminho medido
+std::string buildMultipart(const std::map<std::string, std::string>& fields,
+                           const std::map<std::string, std::string>& files) {
+    std::string body;
+    for (const auto& field : fields) {
+        body += "--" + kBoundary + "\r\n";
+        body += "Content-Disposition: form-data; name=\"" + field.first + "\"\r\n\r\n";
+        body += field.second + "\r\n";
+    }
+    for (const auto& file : files) {
+        body += "--" + kBoundary + "\r\n";
+        body += "Content-Disposition: form-data; name=\"" + file.first + "\"; filename=\"" + file.first + ".bin\"\r\n";
+        body += "Content-Type: application/octet-stream\r\n\r\n";
+        body += file.second + "\r\n";
+    }
+    body += "--" + kBoundary + "--\r\n";
+    return body;
+}
+
+int post(HTTPClientSession& session, const std::string& path, const std::string& body, std::string* responseBody) {
+    HTTPRequest request(HTTPRequest::HTTP_POST, path, HTTPMessage::HTTP_1_1);
+    request.setContentType("multipart/form-data; boundary=" + kBoundary);
+    request.setContentLength(static_cast<std::streamsize>(body.size()));
+    request.setKeepAlive(true);
+
+    std::ostream& os = session.sendRequest(request);
+    os.write(body.data(), static_cast<std::streamsize>(body.size()));
+
+    HTTPResponse response;
+    std::istream& rs = session.receiveResponse(response);
+    std::string content;
+    Poco::StreamCopier::copyToString(rs, content);
+    if (responseBody) *responseBody = std::move(content);
+    return static_cast<int>(response.getStatus());
+}
+
+// gera os documentos e obtem uma assinatura de cada tamanho para o mix de /verify
+bool prepareProfiles(const Options& opt, std::vector<DocProfile>& profiles) {
+    std::string p12 = readFile(opt.p12Path);
+    if (p12.empty()) {
+        std::cerr << "Nao foi possivel ler o P12: " << opt.p12Path << std::endl;
+        return false;
+    }
+
+    std::mt19937_64 rng(42);
+    std::stringstream spec(opt.docSizes);
+    std::string item;
+    while (std::getline(spec, item, ',')) {
+        size_t colon = item.find(':');
+        DocProfile profile;
+        profile.size = parseSize(item.substr(0, colon));
+        profile.weight = (colon == std::string::npos) ? 1.0 : std::stod(item.substr(colon + 1));
+
+        std::string doc(profile.size, '\0');
+        for (char& c : doc) c = static_cast<char>('a' + rng() % 26);
+
+        profile.signBody = buildMultipart({ { "password", opt.password } }, { { "file", doc }, { "p12", p12 } });
+
+        std::unique_ptr<HTTPClientSession> session = openSession(opt);
+        std::string base64;
+        int status = post(*session, "/signature", profile.signBody, &base64);
+        if (status != HTTPResponse::HTTP_OK) {
+            std::cerr << "Falha ao gerar assinatura de referencia (HTTP " << status << ")" << std::endl;
+            return false;
+        }
+
+        std::istringstream encoded(base64);
+        Poco::Base64Decoder decoder(encoded);
+        std::string der;
+        Poco::StreamCopier::copyToString(decoder, der);
+
+        profile.verifyBody = buildMultipart({}, { { "file", der } });
+        profiles.push_back(std::move(profile));
+    }
+    return !profiles.empty();
+}
+
+void runWorker(const Options& opt, unsigned index, const std::vector<DocProfile>& profiles,
+               Clock::time_point start, Clock::time_point warmupEnd, Clock::time_point end,
+               WorkerStats& stats) {
+    std::mt19937_64 rng(1000 + index);
+    std::bernoulli_distribution pickSign(opt.signRatio);
+    std::vector<double> weights;
+    for (const auto& p : profiles) weights.push_back(p.weight);
+    std::discrete_distribution<size_t> pickDoc(weights.begin(), weights.end());
+
+    std::unique_ptr<HTTPClientSession> session = openSession(opt);
+    Poco::Net::Session::Ptr tlsSession;
+
+    // loop aberto: cada worker atende as chegadas index, index+C, index+2C...
+    // a latencia conta a partir do horario planejado para nao esconder fila (coordinated omission)
+    auto interval = opt.rate > 0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opt.concurrency / opt.rate))
+        : Clock::duration::zero();
+    Clock::time_point intended = start + (opt.rate > 0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(index / opt.rate))
+        : Clock::duration::zero());
+
+    while (true) {
+        if (opt.rate > 0) {
+            std::this_thread::sleep_until(intended);
+        } else {
+            intended = Clock::now();
+        }
+        // um worker atrasado tem o horario planejado no passado: sem olhar o relogio ele
+        // seguiria enviando o atraso acumulado depois do fim e inflaria o throughput
+        if (intended >= end || Clock::now() >= end) break;
+
+        bool isSign = pickSign(rng);
+        const DocProfile& profile = profiles[pickDoc(rng)];
+        OpStats& op = isSign ? stats.sign : stats.verify;
+
+        int status = 0;
+        try {
+            // conexao nova por requisicao mede o custo do handshake (completo ou resumido)
+            if (opt.newConnection) {
+                session = openSession(opt, opt.resume ? tlsSession : nullptr);
+            }
+            status = post(*session, isSign ? "/signature" : "/verify", isSign ? profile.signBody : profile.verifyBody, nullptr);
+            if (opt.tls && opt.resume) {
+                tlsSession = static_cast<HTTPSClientSession&>(*session).sslSession();
+            }
+        } catch (const std::exception&) {
+            session->reset();
+        }
+        Clock::time_point done = Clock::now();
+
+        if (intended >= warmupEnd) {
+            if (status == HTTPResponse::HTTP_OK) {
+                op.latencyUs.record(std::chrono::duration_cast<std::chrono::microseconds>(done - intended).count());
+            } else if (status == HTTPResponse::HTTP_SERVICE_UNAVAILABLE) {
+                ++op.rejected;
+            } else {
+                ++op.errors;
+            }
+        }
+
+        intended += interval;
+    }
+}
+
+Poco::JSON::Object opToJson(const OpStats& op, double seconds) {
+    const HdrHistogram& h = op.latencyUs;
+    Poco::JSON::Object latency;
+    latency.set("min", h.min());
+    latency.set("mean", h.mean());
+    latency.set("p50", h.valueAtPercentile(50.0));
+    latency.set("p90", h.valueAtPercentile(90.0));
+    latency.set("p99", h.valueAtPercentile(99.0));
+    latency.set("p99_9", h.valueAtPercentile(99.9));
+    latency.set("max", h.max());
+
+    Poco::JSON::Object json;
+    json.set("ok", h.totalCount());
+    json.set("errors", op.errors);
+    json.set("rejected", op.rejected);
+    json.set("throughput_rps", seconds > 0 ? h.totalCount() / seconds : 0.0);
+    json.set("latency_us", latency);
+    return json;
+}
+
+// Clientes lentos: N conexoes (HTTP puro) que enviam os cabecalhos de um upload e
+// depois um byte por intervalo, sem nunca completar o corpo. Nao geram CPU no
+// servidor, so ocupam conexoes; a carga normal mede o efeito sobre os demais.
+// Conexoes recusadas ou derrubadas pelo servidor sao reabertas e contadas em drops
+void runSlowClients(const Options& opt, Clock::time_point end, std::int64_t& drops) {
+    std::string head = "POST /verify HTTP/1.1\r\nHost: " + opt.host + "\r\n"
+                       "Content-Type: multipart/form-data; boundary=" + kBoundary + "\r\n"
+                       "Content-Length: 1048576\r\n\r\n--" + kBoundary + "\r\n";
+
+    auto open = [&]() -> std::unique_ptr<StreamSocket> {
+        try {
+            std::unique_ptr<StreamSocket> socket(new StreamSocket(SocketAddress(opt.host, opt.port)));
+            socket->sendBytes(head.data(), static_cast<int>(head.size()));
+            return socket;
+        } catch (const Poco::Exception&) {
+            return nullptr;
+        }
+    };
+
+    std::vector<std::unique_ptr<StreamSocket>> sockets;
+    for (unsigned i = 0; i < opt.slowClients; ++i) sockets.push_back(open());
+
+    while (Clock::now() < end) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(opt.trickleMs));
+        for (auto& socket : sockets) {
+            bool sent = false;
+            if (socket) {
+                try {
+                    sent = socket->sendBytes("a", 1) == 1;
+                } catch (const Poco::Exception&) {}
+            }
+            if (!sent) {
+                ++drops;
+                socket = open();
+            }
+        }
+    }
+}
+
+void printOp(const std::string& name, const OpStats& op, double seconds) {
+    const HdrHistogram& h = op.latencyUs;
+    std::cout << "\n=== " << name << " ===\n"
+              << "ok=" << h.totalCount() << " errors=" << op.errors << " rejected=" << op.rejected
+              << " throughput=" << (seconds > 0 ? h.totalCount() / seconds : 0.0) << " req/s\n"
+              << "p50=" << h.valueAtPercentile(50.0) / 1000.0 << "ms"
+              << " p90=" << h.valueAtPercentile(90.0) / 1000.0 << "ms"
+              << " p99=" << h.valueAtPercentile(99.0) / 1000.0 << "ms"
+              << " p99.9=" << h.valueAtPercentile(99.9) / 1000.0 << "ms\n\n";
+    h.printPercentileDistribution(std::cout, 1000.0);
+}
+
+int main(int argc, char** argv) {
+    Utils::loadEnvFile();
+
+    Options opt;
+    opt.password = Utils::getEnvVar("P12_PASSWORD");
+    if (!parseOptions(argc, argv, opt)) return 1;
+
+    if (opt.tls) Poco::Net::initializeSSL();
+
+    std::vector<DocProfile> profiles;
+    try {
+        if (!prepareProfiles(opt, profiles)) return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Falha ao preparar a carga: " << e.what() << std::endl;
+        return 1;
+    }
+
+    Utils::logInfo("Iniciando carga: " + std::to_string(opt.concurrency) + " conexoes, " +
+                   (opt.rate > 0 ? std::to_string(opt.rate) + " req/s" : std::string("loop fechado")));
+
+    if (opt.slowClients > 0 && opt.tls) {
+        Utils::logInfo("Aviso: --slow-clients usa HTTP puro e foi ignorado com --tls=1");
+        opt.slowClients = 0;
+    }
+
+    std::vector<WorkerStats> stats(opt.concurrency);
+    std::vector<std::thread> workers;
+    std::int64_t slowDrops = 0;
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point warmupEnd = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opt.warmupSeconds));
+    Clock::time_point end = warmupEnd + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opt.durationSeconds));
+
+    // os clientes lentos se conectam durante o aquecimento, antes da janela medida
+    std::thread slowClients;
+    if (opt.slowClients > 0) slowClients = std::thread(runSlowClients, std::cref(opt), end, std::ref(slowDrops));
+
+    for (unsigned i = 0; i < opt.concurrency; ++i) {
+        workers.emplace_back(runWorker, std::cref(opt), i, std::cref(profiles), start, warmupEnd, end, std::ref(stats[i]));
+    }
+    for (auto& t : workers) t.join();
+    if (slowClients.joinable()) slowClients.join();
+
+    WorkerStats total;
+    for (const auto& s : stats) {
+        total.sign.latencyUs.merge(s.sign.latencyUs);
+        total.sign.errors += s.sign.errors;
+        total.sign.rejected += s.sign.rejected;
+        total.verify.latencyUs.merge(s.verify.latencyUs);
+        total.verify.errors += s.verify.errors;
+        total.verify.rejected += s.verify.rejected;
+    }
+
+    double seconds = opt.durationSeconds;
+    printOp("POST /signature", total.sign, seconds);
+    printOp("POST /verify", total.verify, seconds);
+    if (opt.slowClients > 0) {
+        std::cout << "\nclientes lentos=" << opt.slowClients << " conexoes derrubadas/recusadas=" << slowDrops << "\n";
+    }
+
+    if (!opt.jsonPath.empty()) {
+        Poco::JSON::Object config;
+        config.set("concurrency", opt.concurrency);
+        config.set("rate", opt.rate);
+        config.set("duration_s", opt.durationSeconds);
+        config.set("sign_ratio", opt.signRatio);
+        config.set("doc_sizes", opt.docSizes);
+        config.set("tls", opt.tls);
+        config.set("new_connection", opt.newConnection);
+        config.set("resume", opt.resume);
+        config.set("slow_clients", opt.slowClients);
+
+        Poco::JSON::Object json;
+        json.set("config", config);
+        json.set("throughput_rps", (total.sign.latencyUs.totalCount() + total.verify.latencyUs.totalCount()) / seconds);
+        json.set("signature", opToJson(total.sign, seconds));
+        json.set("verify", opToJson(total.verify, seconds));
+        json.set("slow_client_drops", slowDrops);
+
+        std::ofstream out(opt.jsonPath);
+        json.stringify(out, 2);
+        Utils::logInfo("Resultado salvo em " + opt.jsonPath);
+    }
+
+    if (opt.tls) Poco::Net::uninitializeSSL();
+    return 0;
+}
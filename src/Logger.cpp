@@ -0,0 +1,365 @@
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Logger {
+
+    // 256 slots de 512 bytes: 128 KB por thread que loga
+    static const size_t kRingSlots = 256;
+    static const size_t kSlotText = 496;
+    static const size_t kRateSlots = 1024;
+
+    struct Slot {
+        std::int64_t timestampUs;
+        Level level;
+        std::uint16_t length;
+        char text[kSlotText];
+    };
+
+    // Buffer circular de um produtor (a thread dona) e um consumidor (quem drena)
+    struct Ring {
+        alignas(64) std::atomic<size_t> head{0};
+        alignas(64) std::atomic<size_t> tail{0};
+        std::atomic<bool> closed{false};
+        Slot slots[kRingSlots];
+    };
+
+    struct RateSlot {
+        std::atomic<std::int64_t> windowSecond{0};
+        std::atomic<int> count{0};
+        std::atomic<int> suppressed{0};
+    };
+
+    struct Entry {
+        std::int64_t timestampUs;
+        Level level;
+        std::string text;
+    };
+
+    const char* levelName(Level level) {
+        switch (level) {
+            case Level::Debug: return "DEBUG";
+            case Level::Info:  return "INFO";
+            case Level::Warn:  return "WARN";
+            case Level::Error: return "ERROR";
+        }
+        return "INFO";
+    }
+
+    std::int64_t nowMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    std::string formatTimestamp(std::int64_t micros) {
+        std::time_t seconds = static_cast<std::time_t>(micros / 1000000);
+        std::tm tm{};
+#ifdef _WIN32
+        gmtime_s(&tm, &seconds);
+#else
+        gmtime_r(&seconds, &tm);
+#endif
+        char buf[32];
+        std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+        char out[48];
+        std::snprintf(out, sizeof(out), "%s.%03dZ", buf, static_cast<int>((micros / 1000) % 1000));
+        return out;
+    }
+
+    // copia para o slot truncando no limite, sem alocar
+    void appendText(Slot& slot, const char* data, size_t len) {
+        size_t room = kSlotText - slot.length;
+        size_t n = std::min(room, len);
+        std::memcpy(slot.text + slot.length, data, n);
+        slot.length = static_cast<std::uint16_t>(slot.length + n);
+    }
+
+    void appendText(Slot& slot, const std::string& text) {
+        appendText(slot, text.data(), text.size());
+    }
+
+    class AsyncLogger {
+    public:
+        static AsyncLogger& instance() {
+            return *current();
+        }
+
+        // no filho de um fork a thread de escrita nao existe e os mutexes podem ter ficado
+        // travados por ela: cria outra instancia sem tocar na antiga
+        static void resetAfterFork() {
+            AsyncLogger* previous = current();
+            AsyncLogger* fresh = new AsyncLogger();
+            fresh->level_.store(previous->level_.load());
+            fresh->sink_ = previous->sink_;
+            current() = fresh;
+        }
+
+        void push(Level level, const std::string& message, const Fields& fields) {
+            if (static_cast<int>(level) < level_.load(std::memory_order_relaxed)) return;
+
+            if (stopped_.load(std::memory_order_acquire)) {
+                writeDirect(level, message, fields);
+                return;
+            }
+
+            Ring& ring = localRing();
+            size_t head = ring.head.load(std::memory_order_relaxed);
+            size_t tail = ring.tail.load(std::memory_order_acquire);
+            if (head - tail >= kRingSlots) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            Slot& slot = ring.slots[head % kRingSlots];
+            slot.timestampUs = nowMicros();
+            slot.level = level;
+            slot.length = 0;
+            appendText(slot, message);
+            for (const auto& field : fields) {
+                appendText(slot, " ", 1);
+                appendText(slot, field.first);
+                appendText(slot, "=", 1);
+                appendText(slot, field.second);
+            }
+
+            ring.head.store(head + 1, std::memory_order_release);
+        }
+
+        bool allow(const std::string& key, int maxPerSecond, int& suppressedBefore) {
+            RateSlot& slot = rateSlots_[std::hash<std::string>{}(key) % kRateSlots];
+            std::int64_t second = nowMicros() / 1000000;
+
+            std::int64_t window = slot.windowSecond.load(std::memory_order_relaxed);
+            if (window != second && slot.windowSecond.compare_exchange_strong(window, second)) {
+                slot.count.store(0, std::memory_order_relaxed);
+            }
+
+            if (slot.count.fetch_add(1, std::memory_order_relaxed) < maxPerSecond) {
+                suppressedBefore = slot.suppressed.exchange(0, std::memory_order_relaxed);
+                return true;
+            }
+            slot.suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // unico consumidor de todos os rings, serializado por drainMutex_
+        void drain() {
+            std::lock_guard<std::mutex> drainLock(drainMutex_);
+
+            std::vector<std::shared_ptr<Ring>> rings;
+            {
+                std::lock_guard<std::mutex> lock(ringsMutex_);
+                rings = rings_;
+            }
+
+            std::vector<Entry> batch;
+            for (const auto& ring : rings) {
+                size_t tail = ring->tail.load(std::memory_order_relaxed);
+                size_t head = ring->head.load(std::memory_order_acquire);
+                for (; tail != head; ++tail) {
+                    const Slot& slot = ring->slots[tail % kRingSlots];
+                    batch.push_back(Entry{ slot.timestampUs, slot.level, std::string(slot.text, slot.length) });
+                }
+                ring->tail.store(tail, std::memory_order_release);
+            }
+
+            unsigned long long dropped = dropped_.load(std::memory_order_relaxed);
+            if (dropped != reportedDropped_) {
+                batch.push_back(Entry{ nowMicros(), Level::Warn,
+                    "Logger descartou " + std::to_string(dropped - reportedDropped_) + " mensagens (buffer cheio)" });
+                reportedDropped_ = dropped;
+            }
+
+            if (!batch.empty()) {
+                std::stable_sort(batch.begin(), batch.end(),
+                    [](const Entry& a, const Entry& b) { return a.timestampUs < b.timestampUs; });
+                write(batch);
+            }
+
+            // remove rings de threads encerradas ja esvaziados
+            std::lock_guard<std::mutex> lock(ringsMutex_);
+            rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<Ring>& r) {
+                return r->closed.load(std::memory_order_acquire) &&
+                       r->tail.load(std::memory_order_relaxed) == r->head.load(std::memory_order_acquire);
+            }), rings_.end());
+        }
+
+        void shutdown() {
+            if (stopped_.exchange(true)) return;
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex_);
+                running_ = false;
+            }
+            wake_.notify_one();
+            if (writer_.joinable()) writer_.join();
+            drain();
+        }
+
+        void setLevel(Level level) { level_.store(static_cast<int>(level)); }
+
+        void setSink(Sink sink) {
+            std::lock_guard<std::mutex> lock(drainMutex_);
+            sink_ = std::move(sink);
+        }
+
+        unsigned long long dropped() const { return dropped_.load(); }
+
+    private:
+        struct RingHolder {
+            std::shared_ptr<Ring> ring;
+            const AsyncLogger* owner = nullptr;
+            ~RingHolder() {
+                if (ring) ring->closed.store(true, std::memory_order_release);
+            }
+        };
+
+        static AsyncLogger*& current() {
+            // propositalmente nunca destruido: threads do Poco podem logar durante o encerramento
+            static AsyncLogger* logger = new AsyncLogger();
+            return logger;
+        }
+
+        AsyncLogger() {
+            writer_ = std::thread([this] { run(); });
+            std::atexit([] { AsyncLogger::instance().shutdown(); });
+        }
+
+        Ring& localRing() {
+            thread_local RingHolder holder;
+            if (!holder.ring || holder.owner != this) {
+                holder.ring = std::make_shared<Ring>();
+                holder.owner = this;
+                std::lock_guard<std::mutex> lock(ringsMutex_);
+                rings_.push_back(holder.ring);
+            }
+            return *holder.ring;
+        }
+
+        void run() {
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            while (running_) {
+                wake_.wait_for(lock, std::chrono::milliseconds(5));
+                lock.unlock();
+                drain();
+                lock.lock();
+            }
+        }
+
+        std::string formatLine(const Entry& entry) const {
+            std::string line = formatTimestamp(entry.timestampUs);
+            line += " [";
+            line += levelName(entry.level);
+            line += "] ";
+            line += entry.text;
+            return line;
+        }
+
+        // uma escrita e um flush por lote, em vez de um por linha
+        void write(const std::vector<Entry>& batch) {
+            if (sink_) {
+                for (const auto& entry : batch) sink_(entry.level, formatLine(entry));
+                return;
+            }
+
+            std::string out;
+            std::string err;
+            for (const auto& entry : batch) {
+                std::string& target = (entry.level >= Level::Warn) ? err : out;
+                target += formatLine(entry);
+                target += '\n';
+            }
+            if (!out.empty()) {
+                std::fwrite(out.data(), 1, out.size(), stdout);
+                std::fflush(stdout);
+            }
+            if (!err.empty()) {
+                std::fwrite(err.data(), 1, err.size(), stderr);
+                std::fflush(stderr);
+            }
+        }
+
+        void writeDirect(Level level, const std::string& message, const Fields& fields) {
+            std::string text = message;
+            for (const auto& field : fields) text += " " + field.first + "=" + field.second;
+
+            std::lock_guard<std::mutex> lock(drainMutex_);
+            write({ Entry{ nowMicros(), level, text } });
+        }
+
+        std::mutex ringsMutex_;
+        std::vector<std::shared_ptr<Ring>> rings_;
+
+        std::mutex drainMutex_;
+        Sink sink_;
+        unsigned long long reportedDropped_ = 0;
+
+        std::mutex wakeMutex_;
+        std::condition_variable wake_;
+        bool running_ = true;
+        std::atomic<bool> stopped_{false};
+        std::thread writer_;
+
+        std::atomic<int> level_{static_cast<int>(Level::Info)};
+        std::atomic<unsigned long long> dropped_{0};
+        RateSlot rateSlots_[kRateSlots];
+    };
+
+    void log(Level level, const std::string& message, const Fields& fields) {
+        AsyncLogger::instance().push(level, message, fields);
+    }
+
+    bool logRateLimited(Level level, const std::string& key, const std::string& message,
+                        const Fields& fields, int maxPerSecond) {
+        int suppressed = 0;
+        if (!AsyncLogger::instance().allow(key, maxPerSecond, suppressed)) return false;
+
+        if (suppressed > 0) {
+            Fields withCount(fields);
+            withCount.emplace_back("suprimidas", std::to_string(suppressed));
+            AsyncLogger::instance().push(level, message, withCount);
+        } else {
+            AsyncLogger::instance().push(level, message, fields);
+        }
+        return true;
+    }
+
+    void setLevel(Level level) {
+        AsyncLogger::instance().setLevel(level);
+    }
+
+    Level parseLevel(const std::string& name, Level defaultLevel) {
+        std::string upper(name);
+        std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        if (upper == "DEBUG") return Level::Debug;
+        if (upper == "INFO")  return Level::Info;
+        if (upper == "WARN")  return Level::Warn;
+        if (upper == "ERROR") return Level::Error;
+        return defaultLevel;
+    }
+
+    void setSink(Sink sink) {
+        AsyncLogger::instance().setSink(std::move(sink));
+    }
+
+    void flush() {
+        AsyncLogger::instance().drain();
+    }
+
+    unsigned long long droppedCount() {
+        return AsyncLogger::instance().dropped();
+    }
+
+    void afterFork() {
+        AsyncLogger::resetAfterFork();
+    }
+}
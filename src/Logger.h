@@ -0,0 +1,40 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Log assincrono: cada thread escreve num ring buffer proprio (SPSC, sem lock)
+// e uma thread de fundo drena todos os buffers e faz a escrita em lote.
+// Se o buffer da thread estiver cheio a mensagem eh descartada e contabilizada,
+// o chamador nunca bloqueia.
+namespace Logger {
+
+    enum class Level { Debug = 0, Info = 1, Warn = 2, Error = 3 };
+
+    using Fields = std::vector<std::pair<std::string, std::string>>;
+
+    // Destino das linhas ja formatadas (padrao: Info/Debug em stdout, Warn/Error em stderr)
+    using Sink = std::function<void(Level, const std::string&)>;
+
+    void log(Level level, const std::string& message, const Fields& fields = {});
+
+    // Limita mensagens repetidas com a mesma chave a maxPerSecond por segundo;
+    // as suprimidas sao informadas na proxima mensagem aceita. Retorna false se suprimida.
+    bool logRateLimited(Level level, const std::string& key, const std::string& message,
+                        const Fields& fields = {}, int maxPerSecond = 5);
+
+    void setLevel(Level level);
+    Level parseLevel(const std::string& name, Level defaultLevel = Level::Info);
+
+    void setSink(Sink sink);
+
+    // Drena todos os buffers de forma sincrona (testes e encerramento)
+    void flush();
+
+    // Mensagens descartadas por buffer cheio desde o inicio
+    unsigned long long droppedCount();
+
+    // Deve ser chamado no processo filho logo apos o fork, antes de qualquer log
+    void afterFork();
+}
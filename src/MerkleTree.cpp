@@ -0,0 +1,148 @@
+#include "MerkleTree.h"
+#include "OpenSSLPool.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <openssl/evp.h>
+
+namespace MerkleTree {
+
+    static const char kProofMagic[4] = { 'B', 'M', 'P', '1' };
+    static const size_t kProofHeaderSize = 4 + 4 + 4 + 1;
+
+    static Hash digestParts(unsigned char prefix, const unsigned char* a, size_t aLen, const unsigned char* b, size_t bLen) {
+        Hash out{};
+        unsigned int length = 0;
+        EVP_MD_CTX* ctx = OpenSSLPool::threadDigestContext();
+        if (!ctx ||
+            !EVP_DigestInit_ex(ctx, OpenSSLPool::sha512(), nullptr) ||
+            !EVP_DigestUpdate(ctx, &prefix, 1) ||
+            !EVP_DigestUpdate(ctx, a, aLen) ||
+            (bLen > 0 && !EVP_DigestUpdate(ctx, b, bLen)) ||
+            !EVP_DigestFinal_ex(ctx, out.data(), &length) ||
+            length != out.size()) {
+            throw std::runtime_error("Falha ao calcular hash da arvore de Merkle");
+        }
+        return out;
+    }
+
+    Hash leafHash(const unsigned char* digest, size_t len) {
+        return digestParts(0x00, digest, len, nullptr, 0);
+    }
+
+    Hash nodeHash(const Hash& left, const Hash& right) {
+        return digestParts(0x01, left.data(), left.size(), right.data(), right.size());
+    }
+
+    Tree::Tree(std::vector<Hash> leaves) {
+        if (leaves.empty()) throw std::invalid_argument("Lote vazio");
+
+        levels_.push_back(std::move(leaves));
+        while (levels_.back().size() > 1) {
+            const std::vector<Hash>& below = levels_.back();
+            std::vector<Hash> above;
+            above.reserve((below.size() + 1) / 2);
+            for (size_t i = 0; i + 1 < below.size(); i += 2) {
+                above.push_back(nodeHash(below[i], below[i + 1]));
+            }
+            if (below.size() % 2 == 1) above.push_back(below.back());
+            levels_.push_back(std::move(above));
+        }
+    }
+
+    Proof Tree::proof(std::uint32_t index) const {
+        if (index >= leafCount()) throw std::out_of_range("Indice fora do lote");
+
+        Proof proof;
+        proof.index = index;
+        proof.leafCount = static_cast<std::uint32_t>(leafCount());
+
+        size_t pos = index;
+        for (size_t level = 0; level + 1 < levels_.size(); ++level) {
+            const std::vector<Hash>& nodes = levels_[level];
+            size_t sibling = pos ^ 1;
+            if (sibling < nodes.size()) proof.path.push_back(nodes[sibling]);
+            pos /= 2;
+        }
+        return proof;
+    }
+
+    bool verifyProof(const Hash& leaf, const Proof& proof, const Hash& root) {
+        if (proof.leafCount == 0 || proof.index >= proof.leafCount) return false;
+
+        Hash current = leaf;
+        size_t pos = proof.index;
+        size_t width = proof.leafCount;
+        size_t used = 0;
+
+        while (width > 1) {
+            size_t sibling = pos ^ 1;
+            if (sibling < width) {
+                if (used >= proof.path.size()) return false;
+                const Hash& other = proof.path[used++];
+                current = (pos % 2 == 0) ? nodeHash(current, other) : nodeHash(other, current);
+            }
+            pos /= 2;
+            width = (width + 1) / 2;
+        }
+
+        return used == proof.path.size() && current == root;
+    }
+
+    static void appendU32(std::string& out, std::uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    }
+
+    static std::uint32_t readU32(const unsigned char* p) {
+        return (static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16) |
+               (static_cast<std::uint32_t>(p[2]) << 8) | static_cast<std::uint32_t>(p[3]);
+    }
+
+    std::string encodeProof(const Proof& proof) {
+        std::string out(kProofMagic, sizeof(kProofMagic));
+        out.reserve(kProofHeaderSize + proof.path.size() * sizeof(Hash));
+        appendU32(out, proof.leafCount);
+        appendU32(out, proof.index);
+        out.push_back(static_cast<char>(proof.path.size()));
+        for (const Hash& h : proof.path) {
+            out.append(reinterpret_cast<const char*>(h.data()), h.size());
+        }
+        return out;
+    }
+
+    bool decodeProof(const std::string& data, Proof& proof) {
+        if (data.size() < kProofHeaderSize || std::memcmp(data.data(), kProofMagic, sizeof(kProofMagic)) != 0) {
+            return false;
+        }
+
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(data.data());
+        size_t count = p[12];
+        if (data.size() != kProofHeaderSize + count * sizeof(Hash)) return false;
+
+        proof.leafCount = readU32(p + 4);
+        proof.index = readU32(p + 8);
+        proof.path.assign(count, Hash{});
+        for (size_t i = 0; i < count; ++i) {
+            std::memcpy(proof.path[i].data(), p + kProofHeaderSize + i * sizeof(Hash), sizeof(Hash));
+        }
+        return true;
+    }
+
+    bool writeProof(const std::string& path, const Proof& proof) {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) return false;
+        std::string data = encodeProof(proof);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        return static_cast<bool>(out);
+    }
+
+    bool readProof(const std::string& path, Proof& proof) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        return decodeProof(data, proof);
+    }
+}
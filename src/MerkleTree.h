@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Arvore de Merkle sobre SHA-512 usada na assinatura em lote: uma unica
+// assinatura CMS cobre a raiz e cada documento carrega a prova de inclusao.
+// Folhas e nos internos usam prefixos distintos (0x00 e 0x01) para que uma
+// folha nunca possa ser apresentada como no interno. Quando um nivel tem
+// quantidade impar de nos, o ultimo sobe sem ser duplicado.
+namespace MerkleTree {
+
+    using Hash = std::array<unsigned char, 64>;
+
+    struct Proof {
+        std::uint32_t index = 0;        // Posicao do documento no lote
+        std::uint32_t leafCount = 0;    // Tamanho do lote
+        std::vector<Hash> path;         // Irmaos da folha ate a raiz
+    };
+
+    // SHA-512(0x00 || digest do documento)
+    Hash leafHash(const unsigned char* digest, size_t len);
+
+    // SHA-512(0x01 || esquerda || direita)
+    Hash nodeHash(const Hash& left, const Hash& right);
+
+    class Tree {
+    public:
+        explicit Tree(std::vector<Hash> leaves);
+
+        size_t leafCount() const { return levels_.empty() ? 0 : levels_.front().size(); }
+        const Hash& root() const { return levels_.back().front(); }
+        Proof proof(std::uint32_t index) const;
+
+    private:
+        std::vector<std::vector<Hash>> levels_;     // levels_[0] = folhas, levels_.back() = raiz
+    };
+
+    // Recalcula a raiz a partir da folha e da prova e compara com a raiz assinada
+    bool verifyProof(const Hash& leaf, const Proof& proof, const Hash& root);
+
+    // Formato binario compacto: "BMP1" | leafCount (u32 BE) | index (u32 BE) | n (u8) | n x 64 bytes
+    std::string encodeProof(const Proof& proof);
+    bool decodeProof(const std::string& data, Proof& proof);
+
+    bool writeProof(const std::string& path, const Proof& proof);
+    bool readProof(const std::string& path, Proof& proof);
+}
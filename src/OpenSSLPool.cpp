@@ -0,0 +1,260 @@
+#include "OpenSSLPool.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <openssl/buffer.h>
+#include <openssl/crypto.h>
+
+namespace OpenSSLPool {
+
+    // ------------------------------------------------------------------
+    // Recursos por thread
+    // ------------------------------------------------------------------
+    struct ThreadResources {
+        std::unique_ptr<EVP_MD_CTX, FnDeleter<EVP_MD_CTX_free>> digestCtx;
+        std::vector<BIO*> memBios;
+        std::vector<unsigned char> scratch;
+
+        ~ThreadResources() {
+            for (BIO* bio : memBios) BIO_free(bio);
+        }
+    };
+
+    static ThreadResources& threadResources() {
+        thread_local ThreadResources resources;
+        return resources;
+    }
+
+    EVP_MD_CTX* threadDigestContext() {
+        ThreadResources& res = threadResources();
+        if (!res.digestCtx) {
+            res.digestCtx.reset(EVP_MD_CTX_new());
+        } else {
+            EVP_MD_CTX_reset(res.digestCtx.get());
+        }
+        return res.digestCtx.get();
+    }
+
+    const EVP_MD* sha256() {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        static EVP_MD* fetched = EVP_MD_fetch(nullptr, "SHA256", nullptr);
+        if (fetched) return fetched;
+#endif
+        return EVP_sha256();
+    }
+
+    const EVP_MD* sha384() {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        static EVP_MD* fetched = EVP_MD_fetch(nullptr, "SHA384", nullptr);
+        if (fetched) return fetched;
+#endif
+        return EVP_sha384();
+    }
+
+    const EVP_MD* sha512() {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        static EVP_MD* fetched = EVP_MD_fetch(nullptr, "SHA512", nullptr);
+        if (fetched) return fetched;
+#endif
+        return EVP_sha512();
+    }
+
+    std::vector<unsigned char>& scratchBuffer(size_t minSize) {
+        std::vector<unsigned char>& buffer = threadResources().scratch;
+        if (buffer.size() < minSize) buffer.resize(minSize);
+        return buffer;
+    }
+
+    // BIOs que cresceram alem disso sao liberados: o pool nao retem buffers do tamanho de
+    // documentos, e o BIO_reset (que zera o buffer inteiro) fica barato
+    static const size_t kMaxPooledBioBytes = 64 * 1024;
+
+    PooledMemBio::PooledMemBio() {
+        std::vector<BIO*>& pool = threadResources().memBios;
+        if (!pool.empty()) {
+            bio_ = pool.back();
+            pool.pop_back();
+        } else {
+            bio_ = BIO_new(BIO_s_mem());
+        }
+    }
+
+    PooledMemBio::~PooledMemBio() {
+        if (!bio_) return;
+        BUF_MEM* mem = nullptr;
+        BIO_get_mem_ptr(bio_, &mem);
+        std::vector<BIO*>& pool = threadResources().memBios;
+        if (pool.size() < 8 && mem && mem->max <= kMaxPooledBioBytes) {
+            // reset mantem o BUF_MEM alocado, entao a capacidade eh reaproveitada
+            BIO_reset(bio_);
+            pool.push_back(bio_);
+        } else {
+            BIO_free(bio_);
+        }
+    }
+
+    std::string PooledMemBio::str() const {
+        char* data = nullptr;
+        long len = BIO_get_mem_data(bio_, &data);
+        return (len > 0 && data) ? std::string(data, static_cast<size_t>(len)) : std::string();
+    }
+
+    std::string toHex(const unsigned char* bytes, size_t len, bool upper) {
+        const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+        std::string out(len * 2, '0');
+        for (size_t i = 0; i < len; ++i) {
+            out[2 * i] = digits[bytes[i] >> 4];
+            out[2 * i + 1] = digits[bytes[i] & 0x0F];
+        }
+        return out;
+    }
+
+    // ------------------------------------------------------------------
+    // Alocador: classes de tamanho em potencias de 2 (32 B a 4 KB) com listas
+    // livres por thread. Blocos maiores vao direto para o malloc do sistema.
+    // Cada bloco tem um cabecalho de 16 bytes (mantem o alinhamento do malloc).
+    // O cache de cada thread tem teto por classe e teto total: com dezenas de
+    // threads (pool HTTP, workers) a memoria retida fica em kMaxCachedBytesPerThread
+    // por thread, e nao na soma dos tetos das classes
+    // ------------------------------------------------------------------
+    static const int kSizeClasses = 8;
+    static const size_t kMinClassSize = 32;
+    static const size_t kMaxCachedBytesPerClass = 128 * 1024;
+    static const size_t kMaxCachedBytesPerThread = 256 * 1024;
+    static const std::uint32_t kLargeBlock = 0xFFFFFFFFu;
+
+    struct BlockHeader {
+        std::uint32_t sizeClass;
+        std::uint32_t reserved;
+        std::uint64_t size;     // tamanho util do bloco
+    };
+    static_assert(sizeof(BlockHeader) == 16, "cabecalho deve preservar alinhamento de 16 bytes");
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // POD de proposito: continua valido mesmo depois dos destrutores thread_local,
+    // pois o OpenSSL ainda pode liberar memoria durante o encerramento da thread
+    struct FreeLists {
+        FreeBlock* heads[kSizeClasses];
+        size_t counts[kSizeClasses];
+        size_t cachedBytes;
+        bool disabled;
+    };
+
+    static thread_local FreeLists tlsFreeLists;
+
+    // devolve os blocos em cache ao sistema quando a thread termina
+    struct FreeListsReleaser {
+        ~FreeListsReleaser() {
+            tlsFreeLists.disabled = true;
+            for (int c = 0; c < kSizeClasses; ++c) {
+                FreeBlock* block = tlsFreeLists.heads[c];
+                while (block) {
+                    FreeBlock* next = block->next;
+                    std::free(reinterpret_cast<BlockHeader*>(block) - 1);
+                    block = next;
+                }
+                tlsFreeLists.heads[c] = nullptr;
+                tlsFreeLists.counts[c] = 0;
+            }
+            tlsFreeLists.cachedBytes = 0;
+        }
+    };
+
+    static int sizeClassFor(size_t num) {
+        size_t classSize = kMinClassSize;
+        for (int c = 0; c < kSizeClasses; ++c, classSize <<= 1) {
+            if (num <= classSize) return c;
+        }
+        return -1;
+    }
+
+    static size_t classSize(int sizeClass) {
+        return kMinClassSize << sizeClass;
+    }
+
+    static FreeLists& freeLists() {
+        thread_local FreeListsReleaser releaser;
+        (void)releaser;
+        return tlsFreeLists;
+    }
+
+    void* poolMalloc(size_t num, const char*, int) {
+        if (num == 0) num = 1;
+
+        int sizeClass = sizeClassFor(num);
+        if (sizeClass >= 0) {
+            FreeLists& lists = freeLists();
+            if (!lists.disabled && lists.heads[sizeClass]) {
+                FreeBlock* block = lists.heads[sizeClass];
+                lists.heads[sizeClass] = block->next;
+                --lists.counts[sizeClass];
+                lists.cachedBytes -= classSize(sizeClass);
+                return block;
+            }
+        }
+
+        size_t usable = sizeClass >= 0 ? classSize(sizeClass) : num;
+        BlockHeader* header = static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + usable));
+        if (!header) return nullptr;
+        header->sizeClass = sizeClass >= 0 ? static_cast<std::uint32_t>(sizeClass) : kLargeBlock;
+        header->reserved = 0;
+        header->size = usable;
+        return header + 1;
+    }
+
+    void poolFree(void* addr, const char*, int) {
+        if (!addr) return;
+        BlockHeader* header = static_cast<BlockHeader*>(addr) - 1;
+
+        if (header->sizeClass != kLargeBlock) {
+            int sizeClass = static_cast<int>(header->sizeClass);
+            FreeLists& lists = freeLists();
+            size_t size = classSize(sizeClass);
+            if (!lists.disabled && lists.counts[sizeClass] * size < kMaxCachedBytesPerClass &&
+                lists.cachedBytes + size <= kMaxCachedBytesPerThread) {
+                FreeBlock* block = static_cast<FreeBlock*>(addr);
+                block->next = lists.heads[sizeClass];
+                lists.heads[sizeClass] = block;
+                ++lists.counts[sizeClass];
+                lists.cachedBytes += size;
+                return;
+            }
+        }
+        std::free(header);
+    }
+
+    void* poolRealloc(void* addr, size_t num, const char* file, int line) {
+        if (!addr) return poolMalloc(num, file, line);
+        if (num == 0) {
+            poolFree(addr, file, line);
+            return nullptr;
+        }
+
+        BlockHeader* header = static_cast<BlockHeader*>(addr) - 1;
+        if (num <= header->size) return addr;
+
+        if (header->sizeClass == kLargeBlock) {
+            BlockHeader* grown = static_cast<BlockHeader*>(std::realloc(header, sizeof(BlockHeader) + num));
+            if (!grown) return nullptr;
+            grown->size = num;
+            return grown + 1;
+        }
+
+        void* moved = poolMalloc(num, file, line);
+        if (!moved) return nullptr;
+        std::memcpy(moved, addr, static_cast<size_t>(header->size));
+        poolFree(addr, file, line);
+        return moved;
+    }
+
+    size_t threadCachedBytes() {
+        return freeLists().cachedBytes;
+    }
+
+    bool installAllocator() {
+        return CRYPTO_set_mem_functions(poolMalloc, poolRealloc, poolFree) == 1;
+    }
+}
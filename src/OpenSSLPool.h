@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include <openssl/bio.h>
+#include <openssl/cms.h>
+#include <openssl/evp.h>
+#include <openssl/pkcs12.h>
+#include <openssl/x509.h>
+
+namespace OpenSSLPool {
+
+    // ------------------------------------------------------------------
+    // Handles RAII para os tipos do OpenSSL usados nos servicos
+    // ------------------------------------------------------------------
+    template <auto FreeFn>
+    struct FnDeleter {
+        template <typename T>
+        void operator()(T* ptr) const {
+            if (ptr) FreeFn(ptr);
+        }
+    };
+
+    struct X509StackDeleter {
+        void operator()(STACK_OF(X509)* sk) const { sk_X509_pop_free(sk, X509_free); }
+    };
+
+    // pilha cujos certificados pertencem a outro objeto (ex: CMS_get0_signers)
+    struct X509StackRefDeleter {
+        void operator()(STACK_OF(X509)* sk) const { sk_X509_free(sk); }
+    };
+
+    using BioPtr = std::unique_ptr<BIO, FnDeleter<BIO_free_all>>;
+    using CmsPtr = std::unique_ptr<CMS_ContentInfo, FnDeleter<CMS_ContentInfo_free>>;
+    using PkeyPtr = std::unique_ptr<EVP_PKEY, FnDeleter<EVP_PKEY_free>>;
+    using X509Ptr = std::unique_ptr<X509, FnDeleter<X509_free>>;
+    using P12Ptr = std::unique_ptr<PKCS12, FnDeleter<PKCS12_free>>;
+    using X509StackPtr = std::unique_ptr<STACK_OF(X509), X509StackDeleter>;
+    using X509StackRefPtr = std::unique_ptr<STACK_OF(X509), X509StackRefDeleter>;
+
+    // ------------------------------------------------------------------
+    // Recursos reutilizados por thread (cada worker do Poco tem os seus)
+    // ------------------------------------------------------------------
+
+    // EVP_MD_CTX da thread, ja resetado
+    EVP_MD_CTX* threadDigestContext();
+
+    // digests buscados no provider uma unica vez (evita o fetch implicito a cada EVP_DigestInit)
+    const EVP_MD* sha256();
+    const EVP_MD* sha384();
+    const EVP_MD* sha512();
+
+    // buffer de trabalho da thread com pelo menos minSize bytes
+    std::vector<unsigned char>& scratchBuffer(size_t minSize);
+
+    // BIO de memoria emprestado do pool da thread; devolvido (e limpo) no destrutor, ou
+    // liberado se o buffer passou de 64 KB. Para saidas grandes ou descartadas use um BIO proprio
+    class PooledMemBio {
+    public:
+        PooledMemBio();
+        ~PooledMemBio();
+
+        PooledMemBio(const PooledMemBio&) = delete;
+        PooledMemBio& operator=(const PooledMemBio&) = delete;
+
+        BIO* get() const { return bio_; }
+        std::string str() const;
+
+    private:
+        BIO* bio_;
+    };
+
+    // hexadecimal sem stringstream
+    std::string toHex(const unsigned char* bytes, size_t len, bool upper);
+
+    // ------------------------------------------------------------------
+    // Alocador com cache por thread para as alocacoes internas do OpenSSL
+    // ------------------------------------------------------------------
+    void* poolMalloc(size_t num, const char* file, int line);
+    void* poolRealloc(void* addr, size_t num, const char* file, int line);
+    void poolFree(void* addr, const char* file, int line);
+
+    // bytes retidos nas listas livres da thread atual (no maximo 256 KB por thread)
+    size_t threadCachedBytes();
+
+    // precisa ser chamado antes de qualquer outra chamada ao OpenSSL
+    bool installAllocator();
+}
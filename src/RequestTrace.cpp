@@ -0,0 +1,273 @@
+#include "RequestTrace.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace RequestTrace {
+
+    static thread_local Trace* currentTrace = nullptr;
+
+    static std::atomic<double> slowLogThresholdMs{ 0 };
+
+    // Log de lentas: quem chama logIfSlow (inclusive o loop epoll) so enfileira a linha; uma
+    // thread de fundo faz o append e o flush. Com a fila cheia a linha eh descartada, o
+    // chamador nunca espera pelo disco
+    class SlowLogWriter {
+    public:
+        static const size_t kMaxPending = 1024;
+
+        static SlowLogWriter& instance() {
+            // propositalmente nunca destruido: o loop pode registrar durante o encerramento
+            static SlowLogWriter* writer = new SlowLogWriter();
+            return *writer;
+        }
+
+        // espera a fila esvaziar e troca o arquivo (vazio desativa)
+        void configure(const std::string& path) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_.wait(lock, [this] { return pending_.empty() && !writing_; });
+            path_ = path;
+        }
+
+        bool enqueue(std::string line) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (path_.empty() || pending_.size() >= kMaxPending) return false;
+            pending_.push_back(std::move(line));
+            if (!writer_.joinable()) writer_ = std::thread([this] { run(); });
+            wake_.notify_one();
+            return true;
+        }
+
+        void flush() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_.wait(lock, [this] { return pending_.empty() && !writing_; });
+        }
+
+    private:
+        void run() {
+            std::ofstream out;
+            std::string openPath;
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (;;) {
+                wake_.wait(lock, [this] { return !pending_.empty(); });
+                std::deque<std::string> batch;
+                batch.swap(pending_);
+                std::string path = path_;
+                writing_ = true;
+                lock.unlock();
+
+                // append com uma escrita por linha mantem as linhas inteiras mesmo com
+                // varios workers no mesmo arquivo
+                if (path != openPath) {
+                    out.close();
+                    out.clear();
+                    out.open(path, std::ios::app | std::ios::binary);
+                    openPath = path;
+                }
+                for (const std::string& line : batch) out.write(line.data(), static_cast<std::streamsize>(line.size()));
+                out.flush();
+                if (!out) {
+                    out.close();
+                    openPath.clear();   // tenta reabrir no proximo lote
+                }
+
+                lock.lock();
+                writing_ = false;
+                idle_.notify_all();
+            }
+        }
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable idle_;
+        std::deque<std::string> pending_;
+        std::string path_;
+        bool writing_ = false;
+        std::thread writer_;
+    };
+
+    static std::string formatMs(std::int64_t micros) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.3f", static_cast<double>(micros) / 1000.0);
+        return buf;
+    }
+
+    static std::string jsonString(const std::string& text) {
+        std::string out = "\"";
+        for (char c : text) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char esc[8];
+                        std::snprintf(esc, sizeof(esc), "\\u%04x", c);
+                        out += esc;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        return out + "\"";
+    }
+
+    static std::string utcNow() {
+        std::time_t now = std::time(nullptr);
+        std::tm tm{};
+#ifdef _WIN32
+        gmtime_s(&tm, &now);
+#else
+        gmtime_r(&now, &tm);
+#endif
+        char buf[32];
+        std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+        return buf;
+    }
+
+    Trace::Trace(const std::string& route) : route_(route), start_(Clock::now()) {}
+
+    std::int64_t Trace::elapsedUs() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_).count();
+    }
+
+    int Trace::begin(const std::string& name) {
+        int parent = open_.empty() ? -1 : open_.back();
+        spans_.push_back({ name, parent, elapsedUs(), -1 });
+        int id = static_cast<int>(spans_.size()) - 1;
+        open_.push_back(id);
+        return id;
+    }
+
+    void Trace::end(int id) {
+        if (id < 0 || id >= static_cast<int>(spans_.size()) || spans_[id].durationUs >= 0) return;
+        spans_[id].durationUs = elapsedUs() - spans_[id].startUs;
+
+        // spans abertos dentro deste (saida antecipada) sao encerrados junto
+        while (!open_.empty()) {
+            int top = open_.back();
+            open_.pop_back();
+            if (spans_[top].durationUs < 0) spans_[top].durationUs = elapsedUs() - spans_[top].startUs;
+            if (top == id) break;
+        }
+    }
+
+    void Trace::addCompleted(const std::string& name, std::int64_t startUs, std::int64_t durationUs) {
+        int parent = open_.empty() ? -1 : open_.back();
+        spans_.push_back({ name, parent, startUs, durationUs });
+    }
+
+    void Trace::setAttribute(const std::string& key, long long value) {
+        for (auto& attr : attributes_) {
+            if (attr.first == key) {
+                attr.second = value;
+                return;
+            }
+        }
+        attributes_.emplace_back(key, value);
+    }
+
+    std::string Trace::serverTiming() const {
+        std::string header;
+        for (size_t i = 0; i < spans_.size(); ++i) {
+            const SpanRecord& span = spans_[i];
+            if (span.durationUs < 0) continue;
+
+            // Server-Timing eh plano: filhos levam o caminho do pai no nome
+            std::string name = span.name;
+            for (int p = span.parent; p >= 0; p = spans_[p].parent) name = spans_[p].name + "." + name;
+
+            header += name + ";dur=" + formatMs(span.durationUs) + ", ";
+        }
+        return header + "total;dur=" + formatMs(elapsedUs());
+    }
+
+    std::string Trace::toJson(int status) const {
+        // filhos agrupados por pai para serializar a arvore em uma passada
+        std::vector<std::vector<int>> children(spans_.size() + 1);
+        for (size_t i = 0; i < spans_.size(); ++i) {
+            int parent = spans_[i].parent;
+            children[parent < 0 ? spans_.size() : static_cast<size_t>(parent)].push_back(static_cast<int>(i));
+        }
+
+        std::int64_t total = elapsedUs();
+        std::string out = "{\"ts\":" + jsonString(utcNow()) + ",\"route\":" + jsonString(route_) +
+                          ",\"status\":" + std::to_string(status) + ",\"total_ms\":" + formatMs(total) + ",\"attrs\":{";
+        for (size_t i = 0; i < attributes_.size(); ++i) {
+            if (i) out += ",";
+            out += jsonString(attributes_[i].first) + ":" + std::to_string(attributes_[i].second);
+        }
+        out += "},\"spans\":";
+
+        // recursao limitada pela profundidade dos spans (poucos niveis)
+        struct Writer {
+            const std::vector<SpanRecord>& spans;
+            const std::vector<std::vector<int>>& children;
+            std::int64_t total;
+            std::string& out;
+
+            void list(const std::vector<int>& ids) {
+                out += "[";
+                for (size_t i = 0; i < ids.size(); ++i) {
+                    const SpanRecord& span = spans[ids[i]];
+                    std::int64_t duration = span.durationUs >= 0 ? span.durationUs : total - span.startUs;
+                    if (i) out += ",";
+                    out += "{\"name\":" + jsonString(span.name) + ",\"start_ms\":" + formatMs(span.startUs) +
+                           ",\"dur_ms\":" + formatMs(duration);
+                    if (!children[ids[i]].empty()) {
+                        out += ",\"children\":";
+                        list(children[ids[i]]);
+                    }
+                    out += "}";
+                }
+                out += "]";
+            }
+        };
+        Writer{ spans_, children, total, out }.list(children[spans_.size()]);
+        return out + "}";
+    }
+
+    void setCurrent(Trace* trace) {
+        currentTrace = trace;
+    }
+
+    Trace* current() {
+        return currentTrace;
+    }
+
+    Span::Span(const char* name) : trace_(currentTrace), id_(-1) {
+        if (trace_) id_ = trace_->begin(name);
+    }
+
+    Span::~Span() {
+        end();
+    }
+
+    void Span::end() {
+        if (trace_ && id_ >= 0) trace_->end(id_);
+        id_ = -1;
+    }
+
+    void attribute(const std::string& key, long long value) {
+        if (currentTrace) currentTrace->setAttribute(key, value);
+    }
+
+    void configureSlowLog(const std::string& path, double thresholdMs) {
+        SlowLogWriter::instance().configure(path);
+        slowLogThresholdMs = thresholdMs < 0 ? 0 : thresholdMs;
+    }
+
+    bool logIfSlow(const Trace& trace, int status) {
+        if (static_cast<double>(trace.elapsedUs()) < slowLogThresholdMs * 1000.0) return false;
+        return SlowLogWriter::instance().enqueue(trace.toJson(status) + "\n");
+    }
+
+    void flushSlowLog() {
+        SlowLogWriter::instance().flush();
+    }
+}
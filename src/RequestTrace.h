@@ -0,0 +1,93 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Spans por requisicao para diagnosticar requisicoes lentas individualmente.
+// O handler de rota cria um Trace e o torna atual na thread (cada requisicao do
+// Poco roda inteira em uma thread); o codigo da requisicao abre spans com
+// RequestTrace::Span, que nao faz nada quando nao ha trace atual.
+// Os spans ja encerrados vao no cabecalho Server-Timing; a arvore completa
+// (incluindo o envio da resposta) vai para o log de lentas acima do limite.
+namespace RequestTrace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct SpanRecord {
+        std::string name;
+        int parent;                 // -1 na raiz
+        std::int64_t startUs;       // desde o inicio do trace
+        std::int64_t durationUs;    // -1 enquanto aberto
+    };
+
+    class Trace {
+    public:
+        explicit Trace(const std::string& route);
+
+        // abre um span filho do span aberto mais interno; retorna o id
+        int begin(const std::string& name);
+        void end(int id);
+
+        // span medido fora do RAII (ex: soma de varias escritas), filho do span aberto
+        void addCompleted(const std::string& name, std::int64_t startUs, std::int64_t durationUs);
+
+        // tamanhos e contadores da requisicao (bytes recebidos, enviados...)
+        void setAttribute(const std::string& key, long long value);
+
+        std::int64_t elapsedUs() const;
+        const std::string& route() const { return route_; }
+
+        // rota conhecida so depois do inicio do trace (front end epoll: o trace comeca no primeiro byte)
+        void setRoute(const std::string& route) { route_ = route; }
+        const std::vector<SpanRecord>& spans() const { return spans_; }
+
+        // "parse;dur=1.204, parse.temp_write;dur=0.310, total;dur=5.870" (so spans encerrados)
+        std::string serverTiming() const;
+
+        // uma linha JSON com a arvore de spans, atributos, status e duracao total
+        std::string toJson(int status) const;
+
+    private:
+        std::string route_;
+        Clock::time_point start_;
+        std::vector<SpanRecord> spans_;
+        std::vector<int> open_;
+        std::vector<std::pair<std::string, long long>> attributes_;
+    };
+
+    // trace da requisicao em andamento na thread (nulo fora de uma requisicao)
+    void setCurrent(Trace* trace);
+    Trace* current();
+
+    // span RAII no trace atual; encerra no destrutor ou em end()
+    class Span {
+    public:
+        explicit Span(const char* name);
+        ~Span();
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        void end();
+
+    private:
+        Trace* trace_;
+        int id_;
+    };
+
+    // atalho para Trace::setAttribute no trace atual
+    void attribute(const std::string& key, long long value);
+
+    // path vazio desativa; thresholdMs = 0 registra todas as requisicoes. Linhas ainda
+    // pendentes sao gravadas no arquivo anterior antes da troca
+    void configureSlowLog(const std::string& path, double thresholdMs);
+
+    // enfileira a arvore completa se o trace passou do limite; a escrita no arquivo eh feita
+    // por uma thread de fundo. Retorna false abaixo do limite, desativado ou com a fila cheia
+    bool logIfSlow(const Trace& trace, int status);
+
+    // espera as linhas enfileiradas chegarem ao arquivo (testes e encerramento)
+    void flushSlowLog();
+}
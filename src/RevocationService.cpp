@@ -0,0 +1,541 @@
+#include "RevocationService.h"
+#include "Logger.h"
+#include "Utils.h"
+#include <algorithm>
+#include <filesystem>
+#include <openssl/err.h>
+#include <openssl/http.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+
+namespace fs = std::filesystem;
+
+namespace RevocationService {
+
+    using OcspResponsePtr = std::unique_ptr<OCSP_RESPONSE, OpenSSLPool::FnDeleter<OCSP_RESPONSE_free>>;
+    using OcspBasicPtr = std::unique_ptr<OCSP_BASICRESP, OpenSSLPool::FnDeleter<OCSP_BASICRESP_free>>;
+    using OcspRequestPtr = std::unique_ptr<OCSP_REQUEST, OpenSSLPool::FnDeleter<OCSP_REQUEST_free>>;
+    using OcspCertIdPtr = std::unique_ptr<OCSP_CERTID, OpenSSLPool::FnDeleter<OCSP_CERTID_free>>;
+    using StorePtr = std::unique_ptr<X509_STORE, OpenSSLPool::FnDeleter<X509_STORE_free>>;
+
+    static const size_t kMaxOcspResponseBytes = 1024 * 1024;
+    static const size_t kMaxCrlBytes = 32 * 1024 * 1024;
+
+    const char* statusName(Status status) {
+        switch (status) {
+            case Status::Good: return "NAO_REVOGADO";
+            case Status::Revoked: return "REVOGADO";
+            default: return "DESCONHECIDO";
+        }
+    }
+
+    static Result unknown(const std::string& detail) {
+        Result result;
+        result.detail = detail;
+        return result;
+    }
+
+    static std::string derOf(X509_NAME* name) {
+        unsigned char* der = nullptr;
+        int len = i2d_X509_NAME(name, &der);
+        std::string key;
+        if (len > 0) key.assign(reinterpret_cast<char*>(der), static_cast<size_t>(len));
+        OPENSSL_free(der);
+        return key;
+    }
+
+    // CertID do OCSP em DER: hash do nome e da chave do emissor + numero de serie.
+    // Com a chave do emissor na chave, um emissor falso com o mesmo nome nao
+    // alcanca as entradas do verdadeiro
+    static std::string certKey(X509* cert, X509* issuer) {
+        OcspCertIdPtr id(OCSP_cert_to_id(nullptr, cert, issuer));
+        unsigned char* der = nullptr;
+        int len = id ? i2d_OCSP_CERTID(id.get(), &der) : 0;
+        std::string key;
+        if (len > 0) key.assign(reinterpret_cast<char*>(der), static_cast<size_t>(len));
+        OPENSSL_free(der);
+        return key;
+    }
+
+    // instante absoluto a partir da diferenca para agora (evita timegm/_mkgmtime)
+    static std::time_t toTime(const ASN1_TIME* time) {
+        int days = 0;
+        int seconds = 0;
+        if (!time || !ASN1_TIME_diff(&days, &seconds, nullptr, time)) return 0;
+        return std::time(nullptr) + static_cast<std::time_t>(days) * 86400 + seconds;
+    }
+
+    static std::string timeText(const ASN1_TIME* time) {
+        if (!time) return "";
+        OpenSSLPool::PooledMemBio bio;
+        ASN1_TIME_print(bio.get(), time);
+        return bio.str();
+    }
+
+    static std::vector<unsigned char> readAll(BIO* bio, size_t limit) {
+        std::vector<unsigned char> data;
+        unsigned char chunk[8192];
+        int n;
+        while ((n = BIO_read(bio, chunk, sizeof(chunk))) > 0) {
+            data.insert(data.end(), chunk, chunk + n);
+            if (data.size() > limit) return {};
+        }
+        return data;
+    }
+
+    // apenas http: o cliente HTTP do OpenSSL precisa de callback proprio para TLS
+    static bool splitHttpUrl(const std::string& url, std::string& host, std::string& port, std::string& path) {
+        int ssl = 0;
+        char* h = nullptr;
+        char* p = nullptr;
+        char* pa = nullptr;
+        if (!OSSL_HTTP_parse_url(url.c_str(), &ssl, nullptr, &h, &p, nullptr, &pa, nullptr, nullptr)) {
+            ERR_clear_error();
+            return false;
+        }
+        host = h ? h : "";
+        port = p ? p : "80";
+        path = pa ? pa : "/";
+        OPENSSL_free(h);
+        OPENSSL_free(p);
+        OPENSSL_free(pa);
+        return !ssl && !host.empty();
+    }
+
+    Result evaluateOcspResponse(const unsigned char* der, size_t length, X509* cert, X509* issuer, int maxSkewSeconds,
+                                int defaultTtlSeconds) {
+        const unsigned char* p = der;
+        OcspResponsePtr response(d2i_OCSP_RESPONSE(nullptr, &p, static_cast<long>(length)));
+        if (!response) return unknown("resposta OCSP invalida");
+
+        int responseStatus = OCSP_response_status(response.get());
+        if (responseStatus != OCSP_RESPONSE_STATUS_SUCCESSFUL) {
+            return unknown("responder OCSP recusou a consulta (" + std::string(OCSP_response_status_str(responseStatus)) + ")");
+        }
+
+        OcspBasicPtr basic(OCSP_response_get1_basic(response.get()));
+        if (!basic) return unknown("resposta OCSP sem BasicOCSPResponse");
+
+        // o responder eh o proprio emissor ou um delegado assinado por ele; a cadeia termina no emissor
+        StorePtr store(X509_STORE_new());
+        OpenSSLPool::X509StackRefPtr certs(sk_X509_new_null());
+        if (!store || !certs) return unknown("sem memoria");
+        X509_STORE_add_cert(store.get(), issuer);
+        X509_STORE_set_flags(store.get(), X509_V_FLAG_PARTIAL_CHAIN);
+        sk_X509_push(certs.get(), issuer);
+
+        if (OCSP_basic_verify(basic.get(), certs.get(), store.get(), 0) <= 0) {
+            ERR_clear_error();
+            return unknown("assinatura da resposta OCSP invalida");
+        }
+
+        OcspCertIdPtr id(OCSP_cert_to_id(nullptr, cert, issuer));
+        int status = 0;
+        int reason = 0;
+        ASN1_GENERALIZEDTIME* revokedAt = nullptr;
+        ASN1_GENERALIZEDTIME* thisUpdate = nullptr;
+        ASN1_GENERALIZEDTIME* nextUpdate = nullptr;
+        if (!id || !OCSP_resp_find_status(basic.get(), id.get(), &status, &reason, &revokedAt, &thisUpdate, &nextUpdate)) {
+            return unknown("resposta OCSP nao cobre o certificado");
+        }
+        if (!OCSP_check_validity(thisUpdate, nextUpdate, maxSkewSeconds, -1)) {
+            ERR_clear_error();
+            return unknown("resposta OCSP fora da validade");
+        }
+
+        Result result;
+        result.source = "ocsp";
+        result.nextUpdate = nextUpdate ? toTime(nextUpdate) : std::time(nullptr) + defaultTtlSeconds;
+        if (status == V_OCSP_CERTSTATUS_GOOD) {
+            result.status = Status::Good;
+        } else if (status == V_OCSP_CERTSTATUS_REVOKED) {
+            result.status = Status::Revoked;
+            result.detail = "revogado em " + timeText(revokedAt);
+            if (reason >= 0) result.detail += " (" + std::string(OCSP_crl_reason_str(reason)) + ")";
+        } else {
+            result.detail = "responder OCSP nao conhece o certificado";
+        }
+        return result;
+    }
+
+    // CRL do emissor com assinatura valida e ainda dentro do nextUpdate (com tolerancia)
+    static bool crlUsable(X509_CRL* crl, X509* issuer, int maxSkewSeconds) {
+        if (X509_NAME_cmp(X509_CRL_get_issuer(crl), X509_get_subject_name(issuer)) != 0) return false;
+        EVP_PKEY* key = X509_get0_pubkey(issuer);
+        if (!key || X509_CRL_verify(crl, key) != 1) {
+            ERR_clear_error();
+            return false;
+        }
+        const ASN1_TIME* next = X509_CRL_get0_nextUpdate(crl);
+        return !next || toTime(next) + maxSkewSeconds > std::time(nullptr);
+    }
+
+    static Result crlStatus(X509_CRL* crl, X509* cert, const char* source, int defaultTtlSeconds) {
+        Result result;
+        result.source = source;
+        const ASN1_TIME* next = X509_CRL_get0_nextUpdate(crl);
+        result.nextUpdate = next ? toTime(next) : std::time(nullptr) + defaultTtlSeconds;
+
+        X509_REVOKED* revoked = nullptr;
+        // 2 = removeFromCRL (delta CRL): o certificado voltou a valer
+        if (X509_CRL_get0_by_cert(crl, &revoked, cert) == 1) {
+            result.status = Status::Revoked;
+            result.detail = "revogado em " + timeText(X509_REVOKED_get0_revocationDate(revoked));
+        } else {
+            result.status = Status::Good;
+        }
+        return result;
+    }
+
+    Config fromEnv() {
+        Config config;
+        std::string mode = Utils::getEnvVar("REVOCATION_CHECK", "off");
+        config.enabled = mode == "soft" || mode == "hard";
+        config.hardFail = mode == "hard";
+
+        std::string sources = Utils::getEnvVar("REVOCATION_SOURCES", "ocsp,crl");
+        config.useOcsp = sources.find("ocsp") != std::string::npos;
+        config.useCrl = sources.find("crl") != std::string::npos;
+
+        config.ocspUrl = Utils::getEnvVar("REVOCATION_OCSP_URL");
+        config.crlDir = Utils::getEnvVar("REVOCATION_CRL_DIR");
+        config.timeoutSeconds = static_cast<int>(Utils::getEnvNumber("REVOCATION_TIMEOUT_S", config.timeoutSeconds));
+        config.prefetchSeconds = static_cast<int>(Utils::getEnvNumber("REVOCATION_PREFETCH_S", config.prefetchSeconds));
+        return config;
+    }
+
+    Checker::Checker(const Config& config) : config_(config) {
+        if (!config_.crlDir.empty()) loadCrlDirectory(config_.crlDir);
+    }
+
+    Checker::~Checker() {
+        stop();
+    }
+
+    size_t Checker::loadCrlDirectory(const std::string& dir) {
+        std::error_code ec;
+        if (!fs::is_directory(dir, ec)) return 0;
+
+        size_t loaded = 0;
+        for (const auto& entry : fs::directory_iterator(dir, ec)) {
+            if (!entry.is_regular_file()) continue;
+
+            // PEM ou DER, como no CertIndex
+            OpenSSLPool::BioPtr bio(BIO_new_file(entry.path().string().c_str(), "rb"));
+            if (!bio) continue;
+            X509_CRL* crl = PEM_read_bio_X509_CRL(bio.get(), nullptr, nullptr, nullptr);
+            if (!crl) {
+                ERR_clear_error();
+                BIO_reset(bio.get());
+                crl = d2i_X509_CRL_bio(bio.get(), nullptr);
+            }
+            if (!crl) {
+                ERR_clear_error();
+                continue;
+            }
+
+            const ASN1_TIME* next = X509_CRL_get0_nextUpdate(crl);
+            CrlEntry stored{ std::shared_ptr<X509_CRL>(crl, X509_CRL_free), next ? toTime(next) : 0 };
+            std::lock_guard<std::mutex> lock(mutex_);
+            crls_[derOf(X509_CRL_get_issuer(crl))] = stored;
+            ++loaded;
+        }
+        return loaded;
+    }
+
+    Result Checker::check(X509* cert, X509* issuer, const Embedded& embedded, bool issuerTrusted) {
+        ++checks_;
+        if (!cert || !issuer) return unknown("emissor do certificado nao encontrado");
+        if (X509_cmp(cert, issuer) == 0) return unknown("certificado autoassinado");
+
+        // o emissor precisa ter assinado o certificado: nome, AKID e keyUsage iguais nao bastam
+        EVP_PKEY* issuerKey = X509_get0_pubkey(issuer);
+        if (!issuerKey || X509_verify(cert, issuerKey) != 1) {
+            ERR_clear_error();
+            return unknown("certificado nao foi assinado pelo emissor informado");
+        }
+
+        std::string key = certKey(cert, issuer);
+        if (key.empty()) return unknown("falha ao montar o CertID do certificado");
+        std::time_t now = std::time(nullptr);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = entries_.find(key);
+            if (it != entries_.end() && it->second.expires > now) {
+                it->second.lastUsed = now;
+                ++cacheHits_;
+                return it->second.result;
+            }
+        }
+
+        // material embutido no CMS: nao precisa de rede nem de coalescencia. So vai para o
+        // cache compartilhado quando o emissor eh confiavel (indice local); com um emissor
+        // que veio no proprio CMS o resultado vale apenas para esta verificacao
+        if (config_.useOcsp) {
+            for (const auto& der : embedded.ocspResponses) {
+                Result stapled = evaluateOcspResponse(der.data(), der.size(), cert, issuer, config_.maxSkewSeconds,
+                                                      config_.defaultTtlSeconds);
+                if (stapled.status == Status::Unknown) continue;
+                stapled.source = "ocsp_grampeado";
+                ++stapled_;
+                if (issuerTrusted) store(key, stapled, cert, issuer, issuerTrusted);
+                return stapled;
+            }
+        }
+        if (config_.useCrl && embedded.crls) {
+            for (int i = 0; i < sk_X509_CRL_num(embedded.crls); ++i) {
+                X509_CRL* crl = sk_X509_CRL_value(embedded.crls, i);
+                if (!crlUsable(crl, issuer, config_.maxSkewSeconds)) continue;
+                Result result = crlStatus(crl, cert, "crl_embutida", config_.defaultTtlSeconds);
+                if (issuerTrusted) store(key, result, cert, issuer, issuerTrusted);
+                return result;
+            }
+        }
+
+        return coalescedFetch(key, cert, issuer, issuerTrusted, false);
+    }
+
+    Result Checker::coalescedFetch(const std::string& key, X509* cert, X509* issuer, bool issuerTrusted, bool prefetch) {
+        std::promise<Result> promise;
+        std::shared_future<Result> pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = inFlight_.find(key);
+            if (it != inFlight_.end()) {
+                if (!prefetch) ++coalesced_;
+                pending = it->second;
+            } else {
+                inFlight_.emplace(key, promise.get_future().share());
+            }
+        }
+        if (pending.valid()) return pending.get();
+
+        Result result;
+        try {
+            result = fetch(cert, issuer, issuerTrusted);
+        } catch (const std::exception& e) {
+            result = unknown(e.what());
+        }
+
+        // grava no cache antes de liberar quem espera: chegadas posteriores ja encontram a entrada.
+        // Emissor do proprio CMS nunca entra: um certificado forjado por requisicao encheria o
+        // cache (e a renovacao antecipada seguiria consultando por ele)
+        if (issuerTrusted) store(key, result, cert, issuer, issuerTrusted);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            inFlight_.erase(key);
+        }
+        promise.set_value(result);
+        return result;
+    }
+
+    Result Checker::fetch(X509* cert, X509* issuer, bool issuerTrusted) {
+        ++fetches_;
+        std::string reasons;
+
+        if (config_.useOcsp) {
+            Result result = fetchOcsp(cert, issuer, issuerTrusted);
+            if (result.status != Status::Unknown) return result;
+            reasons = result.detail;
+        }
+        if (config_.useCrl) {
+            Result result = fetchCrl(cert, issuer, issuerTrusted);
+            if (result.status != Status::Unknown) return result;
+            reasons += (reasons.empty() ? "" : "; ") + result.detail;
+        }
+        return unknown(reasons.empty() ? "nenhuma fonte de revogacao habilitada" : reasons);
+    }
+
+    // Com um emissor trazido pelo proprio CMS o certificado tambem eh de quem enviou: as URLs
+    // dele (AIA, ponto de distribuicao) levariam o servidor a qualquer endereco (SSRF). Nesse
+    // caso so o responder configurado e as CRLs ja conhecidas sao consultados
+    Result Checker::fetchOcsp(X509* cert, X509* issuer, bool issuerTrusted) {
+        std::string url = config_.ocspUrl;
+        if (url.empty() && !issuerTrusted) return unknown("emissor fora do indice local: AIA do certificado nao consultado");
+        if (url.empty()) {
+            STACK_OF(OPENSSL_STRING)* urls = X509_get1_ocsp(cert);
+            if (urls && sk_OPENSSL_STRING_num(urls) > 0) url = sk_OPENSSL_STRING_value(urls, 0);
+            X509_email_free(urls);
+        }
+        if (url.empty()) return unknown("certificado sem responder OCSP");
+
+        std::string host, port, path;
+        if (!splitHttpUrl(url, host, port, path)) return unknown("URL OCSP nao suportada: " + url);
+
+        OcspRequestPtr request(OCSP_REQUEST_new());
+        OCSP_CERTID* id = OCSP_cert_to_id(nullptr, cert, issuer);
+        if (!request || !id || !OCSP_request_add0_id(request.get(), id)) {
+            OCSP_CERTID_free(id);
+            return unknown("falha ao montar a consulta OCSP");
+        }
+
+        OpenSSLPool::BioPtr body(BIO_new(BIO_s_mem()));
+        if (!body || i2d_OCSP_REQUEST_bio(body.get(), request.get()) <= 0) return unknown("falha ao montar a consulta OCSP");
+
+        OpenSSLPool::BioPtr response(OSSL_HTTP_transfer(nullptr, host.c_str(), port.c_str(), path.c_str(), 0, nullptr, nullptr,
+                                                        nullptr, nullptr, nullptr, nullptr, 0, nullptr,
+                                                        "application/ocsp-request", body.get(), "application/ocsp-response",
+                                                        1, kMaxOcspResponseBytes, config_.timeoutSeconds, 0));
+        if (!response) {
+            ERR_clear_error();
+            Logger::logRateLimited(Logger::Level::Warn, "ocsp_fetch", "Responder OCSP indisponivel", { { "url", url } });
+            return unknown("responder OCSP indisponivel: " + url);
+        }
+
+        std::vector<unsigned char> der = readAll(response.get(), kMaxOcspResponseBytes);
+        return evaluateOcspResponse(der.data(), der.size(), cert, issuer, config_.maxSkewSeconds, config_.defaultTtlSeconds);
+    }
+
+    Result Checker::fetchCrl(X509* cert, X509* issuer, bool issuerTrusted) {
+        std::string issuerKey = derOf(X509_get_subject_name(issuer));
+        std::time_t now = std::time(nullptr);
+
+        // CRL ja conhecida (local ou baixada antes) ainda valida
+        std::shared_ptr<X509_CRL> known;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = crls_.find(issuerKey);
+            if (it != crls_.end() && (it->second.expires == 0 || it->second.expires + config_.maxSkewSeconds > now)) known = it->second.crl;
+        }
+        if (known && crlUsable(known.get(), issuer, config_.maxSkewSeconds)) {
+            return crlStatus(known.get(), cert, "crl", config_.defaultTtlSeconds);
+        }
+
+        if (!issuerTrusted) return unknown("emissor fora do indice local: ponto de distribuicao da CRL nao consultado");
+
+        // ponto de distribuicao do certificado (primeira URL http)
+        std::string url;
+        STACK_OF(DIST_POINT)* points = static_cast<STACK_OF(DIST_POINT)*>(X509_get_ext_d2i(cert, NID_crl_distribution_points, nullptr, nullptr));
+        for (int i = 0; points && url.empty() && i < sk_DIST_POINT_num(points); ++i) {
+            DIST_POINT* point = sk_DIST_POINT_value(points, i);
+            if (!point->distpoint || point->distpoint->type != 0) continue;
+            GENERAL_NAMES* names = point->distpoint->name.fullname;
+            for (int j = 0; url.empty() && j < sk_GENERAL_NAME_num(names); ++j) {
+                GENERAL_NAME* name = sk_GENERAL_NAME_value(names, j);
+                if (name->type != GEN_URI) continue;
+                std::string candidate(reinterpret_cast<const char*>(ASN1_STRING_get0_data(name->d.uniformResourceIdentifier)),
+                                      static_cast<size_t>(ASN1_STRING_length(name->d.uniformResourceIdentifier)));
+                if (candidate.rfind("http://", 0) == 0) url = candidate;
+            }
+        }
+        sk_DIST_POINT_pop_free(points, DIST_POINT_free);
+        if (url.empty()) return unknown("nenhuma CRL disponivel para o emissor");
+
+        OpenSSLPool::BioPtr response(OSSL_HTTP_get(url.c_str(), nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 0, nullptr,
+                                                   nullptr, 1, kMaxCrlBytes, config_.timeoutSeconds));
+        X509_CRL* crl = response ? d2i_X509_CRL_bio(response.get(), nullptr) : nullptr;
+        if (!crl) {
+            ERR_clear_error();
+            Logger::logRateLimited(Logger::Level::Warn, "crl_fetch", "CRL indisponivel", { { "url", url } });
+            return unknown("CRL indisponivel: " + url);
+        }
+
+        std::shared_ptr<X509_CRL> downloaded(crl, X509_CRL_free);
+        if (!crlUsable(crl, issuer, config_.maxSkewSeconds)) return unknown("CRL baixada invalida ou vencida: " + url);
+
+        // as CRLs ficam por nome do emissor: so a de um emissor confiavel substitui a conhecida
+        const ASN1_TIME* next = X509_CRL_get0_nextUpdate(crl);
+        if (issuerTrusted) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            crls_[issuerKey] = CrlEntry{ downloaded, next ? toTime(next) : now + config_.defaultTtlSeconds };
+        }
+        return crlStatus(crl, cert, "crl", config_.defaultTtlSeconds);
+    }
+
+    void Checker::store(const std::string& key, const Result& result, X509* cert, X509* issuer, bool issuerTrusted) {
+        std::time_t now = std::time(nullptr);
+        std::time_t expires = result.status == Status::Unknown ? now + config_.failureTtlSeconds
+                            : result.nextUpdate > 0 ? result.nextUpdate
+                            : now + config_.defaultTtlSeconds;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (entries_.size() >= config_.maxEntries && !entries_.count(key)) {
+            // remove as vencidas; se nao bastar, a menos usada recentemente
+            for (auto it = entries_.begin(); it != entries_.end();) {
+                if (it->second.expires <= now) it = entries_.erase(it);
+                else ++it;
+            }
+            if (entries_.size() >= config_.maxEntries) {
+                auto oldest = std::min_element(entries_.begin(), entries_.end(), [](const auto& a, const auto& b) {
+                    return a.second.lastUsed < b.second.lastUsed;
+                });
+                if (oldest != entries_.end()) entries_.erase(oldest);
+            }
+        }
+
+        X509_up_ref(cert);
+        X509_up_ref(issuer);
+        Entry& entry = entries_[key];
+        entry.result = result;
+        entry.expires = expires;
+        entry.lastUsed = now;
+        entry.cert.reset(cert);
+        entry.issuer.reset(issuer);
+        entry.issuerTrusted = issuerTrusted;
+    }
+
+    size_t Checker::prefetchDue() {
+        struct Due {
+            std::string key;
+            OpenSSLPool::X509Ptr cert;
+            OpenSSLPool::X509Ptr issuer;
+            bool issuerTrusted;
+        };
+
+        std::time_t now = std::time(nullptr);
+        // so renova o que foi usado desde a ultima validade (entradas abandonadas vencem sozinhas)
+        std::time_t recent = now - std::max(config_.defaultTtlSeconds, config_.prefetchSeconds * 2);
+        std::vector<Due> due;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& entry : entries_) {
+                const Entry& e = entry.second;
+                if (e.result.status == Status::Unknown || e.lastUsed < recent) continue;
+                if (e.expires - now > config_.prefetchSeconds) continue;
+                X509_up_ref(e.cert.get());
+                X509_up_ref(e.issuer.get());
+                due.push_back({ entry.first, OpenSSLPool::X509Ptr(e.cert.get()), OpenSSLPool::X509Ptr(e.issuer.get()), e.issuerTrusted });
+            }
+        }
+
+        for (Due& d : due) {
+            ++prefetches_;
+            coalescedFetch(d.key, d.cert.get(), d.issuer.get(), d.issuerTrusted, true);
+        }
+        return due.size();
+    }
+
+    void Checker::prefetchLoop() {
+        auto interval = std::chrono::seconds(std::min(60, std::max(1, config_.prefetchSeconds / 4)));
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(stopMutex_);
+                if (stopCv_.wait_for(lock, interval, [this] { return stopping_; })) return;
+            }
+            if (!config_.crlDir.empty()) loadCrlDirectory(config_.crlDir);
+            prefetchDue();
+        }
+    }
+
+    void Checker::startPrefetch() {
+        if (prefetchThread_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(stopMutex_);
+            stopping_ = false;
+        }
+        prefetchThread_ = std::thread([this] { prefetchLoop(); });
+    }
+
+    void Checker::stop() {
+        {
+            std::lock_guard<std::mutex> lock(stopMutex_);
+            stopping_ = true;
+        }
+        stopCv_.notify_all();
+        if (prefetchThread_.joinable()) prefetchThread_.join();
+    }
+
+    Stats Checker::stats() const {
+        return Stats{ checks_.load(), cacheHits_.load(), fetches_.load(), coalesced_.load(), prefetches_.load(), stapled_.load() };
+    }
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <openssl/ocsp.h>
+#include <openssl/x509.h>
+#include "OpenSSLPool.h"
+
+// Checagem de revogacao (OCSP e CRL) do certificado do signatario.
+// Cada resultado fica num cache compartilhado ate o nextUpdate da resposta, entao
+// apenas a primeira verificacao de um signatario vai para a rede. Verificacoes
+// simultaneas do mesmo certificado esperam a mesma busca (coalescencia), e uma
+// thread de fundo renova as entradas em uso antes de vencerem.
+// Ordem das fontes: cache, OCSP grampeado no CMS, CRL embutida no CMS, OCSP do
+// responder (AIA ou REVOCATION_OCSP_URL), CRL local (REVOCATION_CRL_DIR) e CRL
+// do ponto de distribuicao.
+namespace RevocationService {
+
+    enum class Status { Good, Revoked, Unknown };
+
+    // "NAO_REVOGADO", "REVOGADO" ou "DESCONHECIDO"
+    const char* statusName(Status status);
+
+    struct Result {
+        Status status = Status::Unknown;
+        std::string source;         // ocsp, ocsp_grampeado, crl, crl_embutida ou vazio
+        std::string detail;         // motivo do DESCONHECIDO ou data da revogacao
+        std::time_t nextUpdate = 0; // validade da informacao (0 = desconhecida)
+    };
+
+    struct Config {
+        bool enabled = false;
+        bool hardFail = false;          // DESCONHECIDO invalida a assinatura
+        bool useOcsp = true;
+        bool useCrl = true;
+        std::string ocspUrl;            // sobrepoe o AIA do certificado
+        std::string crlDir;             // CRLs locais (PEM ou DER)
+        int timeoutSeconds = 5;
+        int defaultTtlSeconds = 3600;   // respostas sem nextUpdate
+        int failureTtlSeconds = 60;     // DESCONHECIDO por falha de rede fica pouco tempo no cache
+        int prefetchSeconds = 300;      // renova entradas que vencem em menos que isso
+        int maxSkewSeconds = 300;       // tolerancia de relogio em thisUpdate/nextUpdate
+        size_t maxEntries = 100000;
+    };
+
+    // REVOCATION_CHECK (off, soft ou hard), REVOCATION_SOURCES (ocsp, crl ou ocsp,crl),
+    // REVOCATION_OCSP_URL, REVOCATION_CRL_DIR, REVOCATION_TIMEOUT_S, REVOCATION_PREFETCH_S
+    Config fromEnv();
+
+    struct Stats {
+        unsigned long long checks;
+        unsigned long long cacheHits;
+        unsigned long long fetches;     // buscas de status executadas (rede ou CRL)
+        unsigned long long coalesced;   // verificacoes que esperaram uma busca em andamento
+        unsigned long long prefetches;
+        unsigned long long stapled;     // resolvidas por OCSP grampeado no CMS
+    };
+
+    // Material de revogacao que veio dentro do CMS
+    struct Embedded {
+        std::vector<std::vector<unsigned char>> ocspResponses;  // DER de OCSPResponse (RFC 5940)
+        STACK_OF(X509_CRL)* crls = nullptr;                     // nao pertence ao Embedded
+    };
+
+    class Checker {
+    public:
+        explicit Checker(const Config& config);
+        ~Checker();
+
+        Checker(const Checker&) = delete;
+        Checker& operator=(const Checker&) = delete;
+
+        // status de cert emitido por issuer; seguro para varias threads. O cache eh indexado
+        // pelo CertID (nome e chave do emissor + serie). issuerTrusted: o emissor veio de uma
+        // fonte confiavel (indice local) e nao do proprio CMS; so entao o resultado entra no
+        // cache compartilhado e as URLs do certificado (AIA, CRL-DP) sao consultadas
+        Result check(X509* cert, X509* issuer, const Embedded& embedded = Embedded(), bool issuerTrusted = false);
+
+        // thread de renovacao antecipada; parada no destrutor ou em stop()
+        void startPrefetch();
+        void stop();
+
+        // uma rodada de renovacao (a thread chama periodicamente); retorna quantas entradas renovou
+        size_t prefetchDue();
+
+        size_t loadCrlDirectory(const std::string& dir);
+
+        Stats stats() const;
+        const Config& config() const { return config_; }
+
+    private:
+        struct Entry {
+            Result result;
+            std::time_t expires;
+            std::time_t lastUsed;
+            OpenSSLPool::X509Ptr cert;      // para a renovacao
+            OpenSSLPool::X509Ptr issuer;
+            bool issuerTrusted = false;
+        };
+
+        struct CrlEntry {
+            std::shared_ptr<X509_CRL> crl;
+            std::time_t expires;
+        };
+
+        Result fetch(X509* cert, X509* issuer, bool issuerTrusted);
+        Result fetchOcsp(X509* cert, X509* issuer, bool issuerTrusted);
+        Result fetchCrl(X509* cert, X509* issuer, bool issuerTrusted);
+        Result coalescedFetch(const std::string& key, X509* cert, X509* issuer, bool issuerTrusted, bool prefetch);
+        void store(const std::string& key, const Result& result, X509* cert, X509* issuer, bool issuerTrusted);
+        void prefetchLoop();
+
+        Config config_;
+
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, Entry> entries_;
+        std::unordered_map<std::string, std::shared_future<Result>> inFlight_;
+        std::map<std::string, CrlEntry> crls_;      // por nome do emissor (DER)
+
+        std::atomic<unsigned long long> checks_{ 0 };
+        std::atomic<unsigned long long> cacheHits_{ 0 };
+        std::atomic<unsigned long long> fetches_{ 0 };
+        std::atomic<unsigned long long> coalesced_{ 0 };
+        std::atomic<unsigned long long> prefetches_{ 0 };
+        std::atomic<unsigned long long> stapled_{ 0 };
+
+        std::thread prefetchThread_;
+        std::mutex stopMutex_;
+        std::condition_variable stopCv_;
+        bool stopping_ = false;
+    };
+
+    // Avalia uma resposta OCSP (DER) para cert/issuer: assinatura do responder, validade e status.
+    // Usada para respostas grampeadas e buscadas; Unknown com detail quando nao se aplica
+    Result evaluateOcspResponse(const unsigned char* der, size_t length, X509* cert, X509* issuer, int maxSkewSeconds,
+                                int defaultTtlSeconds);
+}
@@ -4,32 +4,66 @@
 #include "Poco/Net/HTTPServerRequest.h"
 #include "Poco/Net/HTTPServerResponse.h"
 #include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/Net/SecureServerSocket.h"
+#include "Poco/Net/NetSSL.h"
 #include "Poco/Net/HTMLForm.h"
 #include "Poco/Net/PartHandler.h"
 #include "Poco/Net/MessageHeader.h"
-#include "Poco/JSON/Object.h"
-#include "Poco/Base64Encoder.h"
-#include "Poco/StreamCopier.h"
 #include "Poco/URI.h"
 #include "Poco/TemporaryFile.h"
-#include "Poco/Path.h"
+#include "Poco/ThreadPool.h"
 
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <map>
-
-#include "SignerService.h"
-#include "VerifierService.h"
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "ApiHandlers.h"
+#include "AdmissionControl.h"
+#include "EventServer.h"
+#include "OpenSSLPool.h"
+#include "RequestTrace.h"
+#include "RevocationService.h"
+#include "SignatureStore.h"
+#include "TimestampService.h"
+#include "TlsContext.h"
 #include "Utils.h"
+#include "WorkerMetrics.h"
+#include "WorkerSupervisor.h"
 
 using namespace Poco::Net;
 
+// Limites de upload aplicados enquanto o corpo eh lido
+struct UploadLimits {
+    std::streamsize maxFieldBytes;      // Tamanho maximo de cada arquivo enviado
+    std::streamsize maxRequestBytes;    // Soma maxima dos arquivos de uma requisicao
+    int maxValueLength;                 // Tamanho maximo de campos texto (ex: password)
+};
+
+class UploadTooLargeException : public std::runtime_error {
+public:
+    explicit UploadTooLargeException(const std::string& what) : std::runtime_error(what) {}
+};
+
 class TempFilePartHandler : public PartHandler {
 public:
     std::map<std::string, std::string> files;
 
+    explicit TempFilePartHandler(const UploadLimits& limits) : limits_(limits) {}
+
+    // remove arquivos que sobraram caso o handler tenha saido antes da limpeza normal
+    ~TempFilePartHandler() override {
+        for (const auto& entry : files) {
+            std::remove(entry.second.c_str());
+        }
+    }
+
     void handlePart(const MessageHeader& header, std::istream& stream) override {
         if (header.has("Content-Disposition")) {
             std::string disp;
@@ -47,81 +81,167 @@ public:
             tempFile.keepUntilExit();
             std::string tempFileName = tempFile.path();
             
+            // copia em blocos para interromper o upload assim que um limite for excedido
             std::ofstream out(tempFileName, std::ios::binary);
-            Poco::StreamCopier::copyStream(stream, out);
+            char buffer[8192];
+            std::streamsize fieldBytes = 0;
+
+            // a leitura da rede e a escrita em disco se alternam: o trace recebe so a soma das escritas
+            RequestTrace::Trace* trace = RequestTrace::current();
+            std::int64_t writeStartUs = trace ? trace->elapsedUs() : 0;
+            std::int64_t writeUs = 0;
+            while (stream.read(buffer, sizeof(buffer)) || stream.gcount() > 0) {
+                std::streamsize n = stream.gcount();
+                fieldBytes += n;
+                totalBytes_ += n;
+
+                if (fieldBytes > limits_.maxFieldBytes || totalBytes_ > limits_.maxRequestBytes) {
+                    out.close();
+                    std::remove(tempFileName.c_str());
+                    throw UploadTooLargeException("Campo '" + name + "' excede o limite de upload");
+                }
+                if (trace) {
+                    std::int64_t before = trace->elapsedUs();
+                    out.write(buffer, n);
+                    writeUs += trace->elapsedUs() - before;
+                } else {
+                    out.write(buffer, n);
+                }
+            }
             out.close();
 
+            if (trace) {
+                trace->addCompleted("temp_write_" + name, writeStartUs, writeUs);
+                trace->setAttribute(name + "_bytes", static_cast<long long>(fieldBytes));
+            }
             files[name] = tempFileName;
         }
     }
+
+private:
+    UploadLimits limits_;
+    std::streamsize totalBytes_ = 0;
 };
 
+// Configuracao e estado compartilhados pelos handlers
+struct ServerContext {
+    UploadLimits limits;
+    AdmissionControl::Gate signGate;    // Assinatura (chave privada, CPU intensivo)
+    AdmissionControl::Gate verifyGate;  // Verificacao e inspecao
+    ApiHandlers::Context api;           // Modo de certificados e indice de signatarios
+};
+
+// Inclui os spans ja encerrados da requisicao no cabecalho Server-Timing antes de enviar
+std::ostream& sendTimed(HTTPServerResponse& response) {
+    if (RequestTrace::Trace* trace = RequestTrace::current()) {
+        response.set("Server-Timing", trace->serverTiming());
+    }
+    return response.send();
+}
+
+// Recusa rapidamente com 503 quando o gate nao admitiu a requisicao
+bool rejectIfOverloaded(const AdmissionControl::Ticket& ticket, HTTPServerResponse& response) {
+    if (ticket.admitted()) return false;
+
+    response.setStatus(HTTPResponse::HTTP_SERVICE_UNAVAILABLE);
+    response.set("Retry-After", std::to_string(ticket.retryAfterSeconds()));
+    response.setKeepAlive(false);
+    sendTimed(response) << "Servidor sobrecarregado, tente novamente mais tarde.";
+    return true;
+}
+
+// Le o formulario multipart aplicando os limites; responde 413 e retorna false se excedidos
+bool loadForm(HTTPServerRequest& request, HTTPServerResponse& response, 
+              HTMLForm& form, TempFilePartHandler& partHandler, const UploadLimits& limits) {
+    if (request.hasContentLength() && request.getContentLength64() > limits.maxRequestBytes) {
+        response.setStatus(HTTPResponse::HTTP_REQUEST_ENTITY_TOO_LARGE);
+        response.setKeepAlive(false);
+        sendTimed(response) << "Requisicao excede o limite de upload.";
+        return false;
+    }
+
+    try {
+        form.setValueLengthLimit(limits.maxValueLength);
+        form.load(request, request.stream(), partHandler);
+    }
+    catch (const UploadTooLargeException& e) {
+        response.setStatus(HTTPResponse::HTTP_REQUEST_ENTITY_TOO_LARGE);
+        response.setKeepAlive(false);
+        sendTimed(response) << e.what();
+        return false;
+    }
+    return true;
+}
+
+// Envia a resposta montada por ApiHandlers
+void sendResult(HTTPServerResponse& response, const HttpStream::Response& result) {
+    response.setStatus(static_cast<HTTPResponse::HTTPStatus>(result.status));
+    response.setContentType(result.contentType);
+    if (result.bodyData) {
+        // corpo externo (mmap do armazem de assinaturas): vai do buffer direto para o socket
+        for (const auto& header : result.headers) response.set(header.first, header.second);
+        if (RequestTrace::Trace* trace = RequestTrace::current()) {
+            response.set("Server-Timing", trace->serverTiming());
+        }
+        response.sendBuffer(result.bodyData, result.bodyLength);
+        return;
+    }
+    response.setContentLength(static_cast<std::streamsize>(result.body.size()));
+    for (const auto& header : result.headers) response.set(header.first, header.second);
+
+    std::ostream& out = sendTimed(response);
+    RequestTrace::Span send("send");
+    out << result.body;
+}
+
 // ------------------------------------------------------------------
 // Endpoint: POST /signature
 // Expects: file, p12, password
 // ------------------------------------------------------------------
 class SignatureHandler : public HTTPRequestHandler {
 public:
+    explicit SignatureHandler(ServerContext& context) : context_(context) {}
+
     void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) override {
         response.set("Access-Control-Allow-Origin", "*");
 
         if (request.getMethod() != "POST") {
             response.setStatus(HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
-            response.send();
+            sendTimed(response);
             return;
         }
         
         try {
-            TempFilePartHandler partHandler;
-            HTMLForm form(request, request.stream(), partHandler);
-
-            std::string password = form.get("password", "");
-            
-            if (partHandler.files.find("file") == partHandler.files.end() || 
-                partHandler.files.find("p12") == partHandler.files.end() || 
-                password.empty()) {
-                
-                response.setStatus(HTTPResponse::HTTP_BAD_REQUEST);
-                response.send() << "Faltando arquivos: file, p12, or password.";
-                return;
-            }
-
-            std::string docPath = partHandler.files["file"];
-            std::string p12Path = partHandler.files["p12"];
-            
-            Poco::Path docPathObj(docPath);
-            std::string docDir = docPathObj.parent().toString();
-            std::string docBaseName = docPathObj.getBaseName();    
-            std::string sigPath = docDir + docBaseName + "_signed.p7s";
-
-            bool success = SignerService::generateSignature(p12Path, password, docPath, sigPath);
-
-            std::remove(docPath.c_str());
-            std::remove(p12Path.c_str());
-
-            if (success) {
-                std::ifstream sigFile(sigPath, std::ios::binary);
-                std::ostringstream oss;
-                
-                Poco::Base64Encoder encoder(oss);
-                Poco::StreamCopier::copyStream(sigFile, encoder);
-                encoder.close(); 
-
-                response.setContentType("text/plain");
-                response.send() << oss.str();
-
-                std::remove(sigPath.c_str());
-            } else {
-                response.setStatus(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                response.send() << "Failed to sign document.";
+            // o upload (rede e disco) acontece antes do gate: a vaga e o tempo de servico
+            // que estima a fila cobrem apenas credenciais e CMS
+            TempFilePartHandler partHandler(context_.limits);
+            HTMLForm form;
+            RequestTrace::Span parse("parse");
+            if (!loadForm(request, response, form, partHandler, context_.limits)) return;
+            parse.end();
+
+            ApiHandlers::PendingSignature pending;
+            {
+                RequestTrace::Span admission("admission");
+                AdmissionControl::Ticket ticket(context_.signGate);
+                admission.end();
+                if (rejectIfOverloaded(ticket, response)) return;
+
+                ApiHandlers::Fields fields{ { "password", form.get("password", "") }, { "certs", form.get("certs", "") } };
+                pending = ApiHandlers::sign(context_.api, fields, partHandler.files);
             }
+            // a vaga de assinatura ja foi devolvida: a espera pela TSA nao segura o gate
+            sendResult(response, ApiHandlers::finishSignature(context_.api, pending));
         }     
         catch (const std::exception& e) {
-            Utils::logInfo(std::string("Signature error: ") + e.what());
+            Logger::logRateLimited(Logger::Level::Error, "signature_error", "Signature error", { { "erro", e.what() } });
             response.setStatus(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-            response.send() << "Internal server error";
+            sendTimed(response) << "Internal server error";
         }
     }
+
+private:
+    ServerContext& context_;
 };
 
 // ------------------------------------------------------------------
@@ -130,87 +250,506 @@ public:
 // ------------------------------------------------------------------
 class VerifyHandler : public HTTPRequestHandler {
 public:
+    explicit VerifyHandler(ServerContext& context) : context_(context) {}
+
+    void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) override {
+        if (request.getMethod() != "POST") {
+            response.setStatus(HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
+            sendTimed(response);
+            return;
+        }
+
+        // upload antes do gate, como no /signature
+        TempFilePartHandler partHandler(context_.limits);
+        HTMLForm form;
+        RequestTrace::Span parse("parse");
+        if (!loadForm(request, response, form, partHandler, context_.limits)) return;
+        parse.end();
+
+        HttpStream::Response result;
+        {
+            RequestTrace::Span admission("admission");
+            AdmissionControl::Ticket ticket(context_.verifyGate);
+            admission.end();
+            if (rejectIfOverloaded(ticket, response)) return;
+            result = ApiHandlers::verify(context_.api, partHandler.files);
+        }
+        sendResult(response, result);
+    }
+
+private:
+    ServerContext& context_;
+};
+
+// ------------------------------------------------------------------
+// Endpoint: POST /inspect
+// Expects: file (CMS signature)
+// Retorna apenas os metadados, sem verificar a assinatura
+// ------------------------------------------------------------------
+class InspectHandler : public HTTPRequestHandler {
+public:
+    explicit InspectHandler(ServerContext& context) : context_(context) {}
+
     void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) override {
         if (request.getMethod() != "POST") {
             response.setStatus(HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
-            response.send();
+            sendTimed(response);
             return;
         }
 
-        TempFilePartHandler partHandler;
-        HTMLForm form(request, request.stream(), partHandler);
+        // upload antes do gate, como no /signature
+        TempFilePartHandler partHandler(context_.limits);
+        HTMLForm form;
+        if (!loadForm(request, response, form, partHandler, context_.limits)) return;
 
-        if (partHandler.files.find("file") == partHandler.files.end()) {
-            response.setStatus(HTTPResponse::HTTP_BAD_REQUEST);
-            response.send() << "Falta o arquivo assinado (campo 'file').";
+        HttpStream::Response result;
+        {
+            AdmissionControl::Ticket ticket(context_.verifyGate);
+            if (rejectIfOverloaded(ticket, response)) return;
+            result = ApiHandlers::inspect(context_.api, partHandler.files);
+        }
+        sendResult(response, result);
+    }
+
+private:
+    ServerContext& context_;
+};
+
+// ------------------------------------------------------------------
+// Endpoint: GET /signature/{hash}
+// CMS (DER) guardado para o documento com esse SHA-512
+// ------------------------------------------------------------------
+class StoredSignatureHandler : public HTTPRequestHandler {
+public:
+    StoredSignatureHandler(ServerContext& context, const std::string& hash) : context_(context), hash_(hash) {}
+
+    void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) override {
+        if (request.getMethod() != "GET") {
+            response.setStatus(HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
+            sendTimed(response);
             return;
         }
+        sendResult(response, ApiHandlers::storedSignature(context_.api, hash_));
+    }
 
-        std::string sigPath = partHandler.files["file"];
-        
-        auto result = VerifierService::verifyAndGetDetails(sigPath);
-        
-        std::remove(sigPath.c_str());
+private:
+    ServerContext& context_;
+    std::string hash_;
+};
+
+// ------------------------------------------------------------------
+// Endpoint: POST /verify/{hash}
+// Verifica a assinatura guardada, sem upload
+// ------------------------------------------------------------------
+class StoredVerifyHandler : public HTTPRequestHandler {
+public:
+    StoredVerifyHandler(ServerContext& context, const std::string& hash) : context_(context), hash_(hash) {}
+
+    void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) override {
+        if (request.getMethod() != "POST") {
+            response.setStatus(HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
+            sendTimed(response);
+            return;
+        }
+
+        HttpStream::Response result;
+        {
+            RequestTrace::Span admission("admission");
+            AdmissionControl::Ticket ticket(context_.verifyGate);
+            admission.end();
+            if (rejectIfOverloaded(ticket, response)) return;
+            result = ApiHandlers::verifyStored(context_.api, hash_);
+        }
+        sendResult(response, result);
+    }
 
-        Poco::JSON::Object json;
-        json.set("status", result.status);
+private:
+    ServerContext& context_;
+    std::string hash_;
+};
 
-        if (result.isValid) {
-            Poco::JSON::Object infos;
-            infos.set("nome_signatario", result.signerName);
-            infos.set("data_assinatura", result.signingTime);
-            infos.set("hash_documento", result.hashHex);
-            infos.set("algoritmo_hash", result.hashAlgo);
-            json.set("infos", infos);
+// ------------------------------------------------------------------
+// Endpoint: GET /metrics
+// Contadores de todos os workers (formato texto do Prometheus)
+// ------------------------------------------------------------------
+class MetricsHandler : public HTTPRequestHandler {
+public:
+    void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) override {
+        if (request.getMethod() != "GET") {
+            response.setStatus(HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
+            response.send();
+            return;
         }
 
-        response.setContentType("application/json");
-        std::ostream& out = response.send();
-        json.stringify(out, 2);
+        response.setContentType("text/plain; version=0.0.4");
+        response.send() << WorkerMetrics::renderCurrent();
     }
 };
 
+// Conta a requisicao e o tempo de resposta no slot de metricas do processo e
+// mantem o trace da requisicao como atual na thread enquanto o handler roda
+class MeteredHandler : public HTTPRequestHandler {
+public:
+    MeteredHandler(HTTPRequestHandler* inner, WorkerMetrics::Route route) : inner_(inner), route_(route) {}
+
+    void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) override {
+        RequestTrace::Trace trace(Poco::URI(request.getURI()).getPath());
+        if (request.hasContentLength()) trace.setAttribute("request_bytes", static_cast<long long>(request.getContentLength64()));
+
+        RequestTrace::setCurrent(&trace);
+        try {
+            inner_->handleRequest(request, response);
+        } catch (...) {
+            RequestTrace::setCurrent(nullptr);
+            throw;
+        }
+        RequestTrace::setCurrent(nullptr);
+
+        int status = static_cast<int>(response.getStatus());
+        WorkerMetrics::recordRequest(route_, status, static_cast<std::uint64_t>(trace.elapsedUs()));
+        RequestTrace::logIfSlow(trace, status);
+    }
+
+private:
+    std::unique_ptr<HTTPRequestHandler> inner_;
+    WorkerMetrics::Route route_;
+};
+
 class RequestFactory : public HTTPRequestHandlerFactory {
 public:
+    explicit RequestFactory(ServerContext& context) : context_(context) {}
+
     HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) override {
         Poco::URI uri(request.getURI());
         std::string path = uri.getPath();
 
-        if (path == "/signature") return new SignatureHandler();
-        if (path == "/verify")    return new VerifyHandler();
+        if (path == "/signature") return new MeteredHandler(new SignatureHandler(context_), WorkerMetrics::Route::Signature);
+        if (path == "/verify")    return new MeteredHandler(new VerifyHandler(context_), WorkerMetrics::Route::Verify);
+        if (path == "/inspect")   return new MeteredHandler(new InspectHandler(context_), WorkerMetrics::Route::Inspect);
+        if (path == "/metrics")   return new MetricsHandler();
+
+        // rotas do armazem: o restante do caminho eh o SHA-512 do documento
+        static const std::string storedSignature = "/signature/";
+        static const std::string storedVerify = "/verify/";
+        if (path.compare(0, storedSignature.size(), storedSignature) == 0) {
+            return new MeteredHandler(new StoredSignatureHandler(context_, path.substr(storedSignature.size())), WorkerMetrics::Route::Other);
+        }
+        if (path.compare(0, storedVerify.size(), storedVerify) == 0) {
+            return new MeteredHandler(new StoredVerifyHandler(context_, path.substr(storedVerify.size())), WorkerMetrics::Route::Verify);
+        }
 
         return nullptr;
     }
+
+private:
+    ServerContext& context_;
 };
 
+WorkerMetrics::Route metricsRoute(const std::string& path) {
+    if (path == "/signature") return WorkerMetrics::Route::Signature;
+    if (path == "/verify" || path.compare(0, 8, "/verify/") == 0) return WorkerMetrics::Route::Verify;
+    if (path == "/inspect")   return WorkerMetrics::Route::Inspect;
+    return WorkerMetrics::Route::Other;
+}
+
+HttpStream::Response methodNotAllowed() {
+    HttpStream::Response response;
+    response.status = 405;
+    return response;
+}
+
+// Front end epoll (SERVER_FRONTEND=epoll): uma thread de eventos para todas as conexoes e
+// um pool fixo de threads de criptografia. Cada faixa do pool aceita as requisicoes em
+// execucao mais a fila configurada para o gate correspondente; acima disso, 503 imediato
+int runEventServer(ServerContext& context, unsigned cryptoThreads, size_t signPending, size_t verifyPending,
+                   unsigned short port, bool reusePort, const std::function<void()>& waitForStop) {
+    EventServer::Config config;
+    config.port = port;
+    config.reusePort = reusePort;
+    config.cryptoThreads = cryptoThreads;
+    config.lanes = { { "sign", signPending }, { "verify", verifyPending } };
+    config.limits = HttpStream::Limits{
+        static_cast<size_t>(Utils::getEnvNumber("MAX_HEADER_BYTES", 16 * 1024)),
+        static_cast<long long>(context.limits.maxFieldBytes),
+        static_cast<long long>(context.limits.maxRequestBytes),
+        static_cast<size_t>(context.limits.maxValueLength)
+    };
+    config.idleTimeoutSeconds = static_cast<int>(Utils::getEnvNumber("HTTP_IDLE_TIMEOUT", 30));
+    config.headerTimeoutSeconds = static_cast<int>(Utils::getEnvNumber("HTTP_HEADER_TIMEOUT", 10));
+    config.requestTimeoutSeconds = static_cast<int>(Utils::getEnvNumber("HTTP_REQUEST_TIMEOUT", 120));
+    config.writeTimeoutSeconds = static_cast<int>(Utils::getEnvNumber("HTTP_WRITE_TIMEOUT", 30));
+    config.maxConnections = static_cast<size_t>(Utils::getEnvNumber("HTTP_MAX_CONNECTIONS", 10000));
+    config.onComplete = [](const HttpStream::Request& request, int status, const RequestTrace::Trace& trace) {
+        if (request.path == "/metrics") return;
+        WorkerMetrics::recordRequest(metricsRoute(request.path), status, static_cast<std::uint64_t>(trace.elapsedUs()));
+        RequestTrace::logIfSlow(trace, status);
+    };
+
+    const ApiHandlers::Context& api = context.api;
+    std::vector<EventServer::Route> routes = {
+        { "/signature", [&api](const HttpStream::Request& request) {
+            if (request.method != "POST") {
+                HttpStream::Response response = methodNotAllowed();
+                response.headers.emplace_back("Access-Control-Allow-Origin", "*");
+                return response;
+            }
+            ApiHandlers::PendingSignature pending = ApiHandlers::sign(api, request.fields, request.files);
+            // o carimbo espera a TSA fora do pool: a thread de criptografia volta para a fila
+            EventServer::Reply reply = pending.cms && api.timestamps ? EventServer::deferResponse() : EventServer::Reply();
+            if (!reply) return ApiHandlers::finishSignature(api, pending);
+            ApiHandlers::finishSignatureAsync(api, std::move(pending), reply);
+            return HttpStream::Response();
+        }, 0 },
+        { "/verify", [&api](const HttpStream::Request& request) {
+            return request.method != "POST" ? methodNotAllowed() : ApiHandlers::verify(api, request.files);
+        }, 1 },
+        { "/inspect", [&api](const HttpStream::Request& request) {
+            return request.method != "POST" ? methodNotAllowed() : ApiHandlers::inspect(api, request.files);
+        }, 1 },
+        { "/signature/", [&api](const HttpStream::Request& request) {
+            // leitura do mmap, sem criptografia: roda na thread do loop
+            if (request.method != "GET") return methodNotAllowed();
+            return ApiHandlers::storedSignature(api, request.path.substr(std::string("/signature/").size()));
+        }, -1 },
+        { "/verify/", [&api](const HttpStream::Request& request) {
+            if (request.method != "POST") return methodNotAllowed();
+            return ApiHandlers::verifyStored(api, request.path.substr(std::string("/verify/").size()));
+        }, 1 },
+        { "/metrics", [](const HttpStream::Request& request) {
+            if (request.method != "GET") return methodNotAllowed();
+            HttpStream::Response response;
+            response.contentType = "text/plain; version=0.0.4";
+            response.body = WorkerMetrics::renderCurrent();
+            return response;
+        }, -1 }
+    };
+
+    EventServer::Server srv(config, std::move(routes));
+    std::string error;
+    if (!srv.start(error)) {
+        Logger::log(Logger::Level::Error, "Falha ao iniciar o front end epoll", { { "erro", error } });
+        return 1;
+    }
+    Logger::log(Logger::Level::Info, "Servidor ouvindo", {
+        { "porta", std::to_string(port) }, { "frontend", "epoll" }, { "threads_cripto", std::to_string(cryptoThreads) } });
+
+    waitForStop();
+
+    srv.stop();
+    return 0;
+}
+
+// Monta e executa o servidor no processo atual: processo unico ou um worker do modo pre-fork.
+// Com reusePort varios processos escutam a mesma porta e o kernel distribui as conexoes.
+// tlsTicketKeys: chaves de session ticket geradas pelo supervisor (vazio = do proprio SSL_CTX)
+int runServer(unsigned cores, bool reusePort, const std::string& tlsTicketKeys, const std::function<void()>& waitForStop) {
+    // O alocador precisa ser instalado antes de qualquer alocacao do OpenSSL
+    if (Utils::getEnvVar("OPENSSL_POOL_ALLOCATOR", "1") != "0" && !OpenSSLPool::installAllocator()) {
+        Utils::logInfo("Aviso: alocador do OpenSSL ja inicializado, usando o padrao");
+    }
+
+    OpenSSL_add_all_algorithms();
+    ERR_load_crypto_strings();
+
+    double latencyTargetMs = static_cast<double>(Utils::getEnvNumber("QUEUE_LATENCY_TARGET_MS", 500));
+    unsigned signQueue = static_cast<unsigned>(Utils::getEnvNumber("SIGN_MAX_QUEUE", cores * 4));
+    unsigned verifyQueue = static_cast<unsigned>(Utils::getEnvNumber("VERIFY_MAX_QUEUE", cores * 8));
+
+    // requisicoes acima do limite vao com a arvore de spans para o log de lentas (JSON lines)
+    RequestTrace::configureSlowLog(Utils::getEnvVar("SLOW_REQUEST_LOG", "slow_requests.jsonl"),
+                                   static_cast<double>(Utils::getEnvNumber("SLOW_REQUEST_MS", 1000)));
+
+    // carregado antes de atender e so lido depois pelos handlers
+    CertIndex::Index certIndex;
+    std::string certIndexDir = Utils::getEnvVar("CERT_INDEX_DIR");
+    if (!certIndexDir.empty()) {
+        certIndex.loadDirectory(certIndexDir, Utils::getEnvVar("P12_PASSWORD"));
+        Logger::log(Logger::Level::Info, "Indice de certificados carregado", {
+            { "pasta", certIndexDir }, { "certificados", std::to_string(certIndex.size()) } });
+    }
+
+    // cache de revogacao compartilhado pelas threads do processo, com renovacao em segundo plano
+    RevocationService::Config revocationConfig = RevocationService::fromEnv();
+    std::unique_ptr<RevocationService::Checker> revocation;
+    if (revocationConfig.enabled) {
+        revocation.reset(new RevocationService::Checker(revocationConfig));
+        revocation->startPrefetch();
+        Logger::log(Logger::Level::Info, "Checagem de revogacao ativa", {
+            { "modo", revocationConfig.hardFail ? "hard" : "soft" },
+            { "ocsp", revocationConfig.useOcsp ? "1" : "0" }, { "crl", revocationConfig.useCrl ? "1" : "0" } });
+    }
+
+    // carimbo de tempo agregado: uma consulta a TSA por janela de pedidos simultaneos
+    TimestampService::Config tsaConfig = TimestampService::fromEnv();
+    std::unique_ptr<TimestampService::Batcher> timestamps;
+    if (!tsaConfig.url.empty()) {
+        timestamps.reset(new TimestampService::Batcher(tsaConfig, TimestampService::httpTransport(tsaConfig.url, tsaConfig.timeoutSeconds)));
+        Logger::log(Logger::Level::Info, "Carimbo de tempo ativo", {
+            { "tsa", tsaConfig.url }, { "janela_ms", std::to_string(tsaConfig.windowMs) },
+            { "lote_max", std::to_string(tsaConfig.maxBatch) } });
+    }
+    std::string tsaCaFile = Utils::getEnvVar("TSA_CA_FILE");
+    if (!tsaCaFile.empty() && !TimestampService::configureTrust(tsaCaFile)) {
+        Logger::log(Logger::Level::Warn, "TSA_CA_FILE invalido, carimbos conferidos sem cadeia", { { "arquivo", tsaCaFile } });
+    }
+
+    // armazem de assinaturas: um unico processo escreve no diretorio (trava exclusiva),
+    // entao fica desligado no modo pre-fork
+    SignatureStore::Config storeConfig = SignatureStore::fromEnv();
+    std::unique_ptr<SignatureStore::Store> store;
+    if (!storeConfig.dir.empty()) {
+        std::string error;
+        if (reusePort || !SignatureStore::supported()) {
+            Logger::log(Logger::Level::Warn, "Armazem de assinaturas indisponivel com SERVER_WORKERS > 1 ou nesta plataforma");
+        } else {
+            store.reset(new SignatureStore::Store(storeConfig));
+            if (!store->open(error)) {
+                Logger::log(Logger::Level::Warn, "Falha ao abrir o armazem de assinaturas", { { "pasta", storeConfig.dir }, { "erro", error } });
+                store.reset();
+            } else {
+                SignatureStore::Stats stats = store->stats();
+                Logger::log(Logger::Level::Info, "Armazem de assinaturas aberto", {
+                    { "pasta", storeConfig.dir }, { "assinaturas", std::to_string(stats.records) },
+                    { "segmentos", std::to_string(stats.segments) } });
+            }
+        }
+    }
+
+    ServerContext context{
+        UploadLimits{
+            static_cast<std::streamsize>(Utils::getEnvNumber("MAX_FIELD_BYTES", 64LL * 1024 * 1024)),
+            static_cast<std::streamsize>(Utils::getEnvNumber("MAX_REQUEST_BYTES", 128LL * 1024 * 1024)),
+            static_cast<int>(Utils::getEnvNumber("MAX_VALUE_LENGTH", 1024))
+        },
+        AdmissionControl::Gate("sign", AdmissionControl::GateConfig{
+            static_cast<unsigned>(Utils::getEnvNumber("SIGN_MAX_CONCURRENT", cores)),
+            signQueue,
+            latencyTargetMs
+        }),
+        AdmissionControl::Gate("verify", AdmissionControl::GateConfig{
+            static_cast<unsigned>(Utils::getEnvNumber("VERIFY_MAX_CONCURRENT", cores * 2)),
+            verifyQueue,
+            latencyTargetMs
+        }),
+        ApiHandlers::Context{
+            SignerService::parseCertMode(Utils::getEnvVar("SIGN_CERT_MODE", "full")),
+            &certIndex,
+            revocation.get(),
+            timestamps.get(),
+            store.get()
+        }
+    };
+
+    Poco::UInt16 port = static_cast<Poco::UInt16>(Utils::getEnvNumber("SERVER_PORT", 8080));
+    TlsContext::Settings tls = TlsContext::fromEnv();
+    tls.ticketKeys = tlsTicketKeys;
+
+    std::string frontend = Utils::getEnvVar("SERVER_FRONTEND", "poco");
+    if (frontend == "epoll" && (tls.enabled || !EventServer::supported())) {
+        Logger::log(Logger::Level::Warn, "Front end epoll indisponivel (TLS ou plataforma), usando poco");
+        frontend = "poco";
+    }
+    if (frontend == "epoll") {
+        // pool de criptografia do tamanho dos nucleos do processo (no pre-fork, os do worker)
+        unsigned cryptoThreads = static_cast<unsigned>(std::max(1LL, Utils::getEnvNumber("CRYPTO_THREADS", cores)));
+        int code = runEventServer(context, cryptoThreads, cryptoThreads + signQueue, cryptoThreads + verifyQueue,
+                                  port, reusePort, waitForStop);
+        RequestTrace::flushSlowLog();
+        EVP_cleanup();
+        ERR_free_strings();
+        return code;
+    }
+
+    // com TLS o socket de escuta usa um unico Context (SSL_CTX) para todas as conexoes
+    Poco::Net::Context::Ptr tlsContext;
+    if (tls.enabled) {
+        Poco::Net::initializeSSL();
+        tlsContext = TlsContext::createServerContext(tls);
+    }
+    ServerSocket svs = tls.enabled ? SecureServerSocket(tlsContext) : ServerSocket();
+    svs.bind(SocketAddress(port), true, reusePort);
+    svs.listen(64);
+
+    // o pool precisa comportar as vagas e filas dos dois gates, senao a fila do socket vira o gargalo
+    int maxThreads = static_cast<int>(Utils::getEnvNumber("HTTP_MAX_THREADS", static_cast<long long>(cores) * 16));
+    Poco::ThreadPool threadPool(2, maxThreads);
+    HTTPServerParams* params = new HTTPServerParams;
+    params->setMaxThreads(maxThreads);
+    HTTPServer srv(new RequestFactory(context), threadPool, svs, params);
+
+    srv.start();
+    Logger::log(Logger::Level::Info, "Servidor ouvindo", {
+        { "porta", std::to_string(port) }, { "https", tls.enabled ? "1" : "0" }, { "threads", std::to_string(maxThreads) } });
+
+    waitForStop();
+
+    srv.stop();
+
+    if (tls.enabled) {
+        Poco::Net::uninitializeSSL();
+    }
+    RequestTrace::flushSlowLog();
+
+    EVP_cleanup();
+    ERR_free_strings();
+    return 0;
+}
+
 int main() {
     try {
         
         std::srand(std::time(nullptr));
 
-        OpenSSL_add_all_algorithms();
-        ERR_load_crypto_strings();
+        Utils::loadEnvFile();
+        Logger::setLevel(Logger::parseLevel(Utils::getEnvVar("LOG_LEVEL", "INFO")));
 
-        ServerSocket svs(8080);
-        HTTPServer srv(new RequestFactory(), svs, new HTTPServerParams);
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        WorkerSupervisor::Config workers = WorkerSupervisor::fromEnv();
 
-        srv.start();
-        std::cout << ">>> Server running on port 8080 <<<" << std::endl;
-        std::cout << "Press ENTER to stop..." << std::endl;
-        
-        std::cin.get();
-        
-        srv.stop();
+        if (workers.workers > 1 && !WorkerSupervisor::supported()) {
+            Utils::logInfo("Aviso: SERVER_WORKERS ignorado, modo pre-fork indisponivel nesta plataforma");
+            workers.workers = 0;
+        }
 
-        EVP_cleanup();
-        ERR_free_strings();
+        if (workers.workers > 1) {
+            // o supervisor nao inicializa OpenSSL nem Poco: cada worker faz isso depois do fork
+            WorkerMetrics::Region metrics(workers.workers, true);
+            WorkerSupervisor::installStopHandlers();
+            unsigned coresPerWorker = std::max(1u, cores / workers.workers);
+            workers.coresPerWorker = coresPerWorker;
+
+            // o cache de sessao fica em cada worker, mas com as mesmas chaves de ticket a
+            // retomada funciona em qualquer worker que receber a reconexao
+            std::string ticketKeys;
+            if (TlsContext::fromEnv().enabled) {
+                ticketKeys = TlsContext::generateTicketKeys();
+                if (ticketKeys.empty()) Utils::logInfo("Aviso: chaves de session ticket por worker, /dev/urandom indisponivel");
+            }
 
-        std::cout << "Server stopped." << std::endl;
+            std::cout << ">>> Supervisor running " << workers.workers << " workers <<<" << std::endl;
+            std::cout << "Press Ctrl+C to stop..." << std::endl;
+
+            int code = WorkerSupervisor::run(workers, metrics, [coresPerWorker, &ticketKeys](unsigned) {
+                return runServer(coresPerWorker, true, ticketKeys, [] { WorkerSupervisor::waitForStopSignal(); });
+            });
+            std::cout << "Server stopped." << std::endl;
+            return code;
+        }
+
+        WorkerMetrics::Region metrics(1, false);
+        WorkerMetrics::setCurrent(&metrics, 0);
+
+        int code = runServer(cores, false, "", [] {
+            std::cout << ">>> Server running on port " << Utils::getEnvNumber("SERVER_PORT", 8080) << " <<<" << std::endl;
+            std::cout << "Press ENTER to stop..." << std::endl;
+            std::cin.get();
+        });
 
+        std::cout << "Server stopped." << std::endl;
+        return code;
     }
     catch (std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << std::endl;
         return 1;
     }
-    return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,630 @@
+#include "SignatureStore.h"
+#include "Logger.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace SignatureStore {
+
+    bool parseHash(const std::string& hex, Hash& hash) {
+        if (hex.size() != hash.size() * 2) return false;
+        auto nibble = [](char c) -> int {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        };
+        for (size_t i = 0; i < hash.size(); ++i) {
+            int hi = nibble(hex[2 * i]);
+            int lo = nibble(hex[2 * i + 1]);
+            if (hi < 0 || lo < 0) return false;
+            hash[i] = static_cast<unsigned char>((hi << 4) | lo);
+        }
+        return true;
+    }
+
+    std::string hashHex(const Hash& hash) {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex;
+        hex.reserve(hash.size() * 2);
+        for (unsigned char b : hash) {
+            hex += digits[b >> 4];
+            hex += digits[b & 0x0f];
+        }
+        return hex;
+    }
+
+    Config fromEnv() {
+        Config config;
+        config.dir = Utils::getEnvVar("SIGNATURE_STORE_DIR");
+        long long segmentMb = Utils::getEnvNumber("SIGNATURE_STORE_SEGMENT_MB", static_cast<long long>(config.segmentBytes >> 20));
+        config.segmentBytes = static_cast<size_t>(std::max(1LL, segmentMb)) << 20;
+        config.fsync = Utils::getEnvVar("SIGNATURE_STORE_FSYNC", "0") == "1";
+        return config;
+    }
+
+    bool supported() {
+#ifdef __linux__
+        return true;
+#else
+        return false;
+#endif
+    }
+
+#ifdef __linux__
+
+    // Registro no segmento: cabecalho, DER e marca final. Um registro sem a marca
+    // final (gravacao interrompida) eh descartado na recuperacao
+    static const char kRecordMagic[4] = { 'B', 'S', 'R', '1' };
+    static const char kRecordEnd[4] = { 'B', 'S', 'R', 'E' };
+
+    struct RecordHeader {
+        char magic[4];
+        std::uint32_t length;
+        unsigned char hash[64];
+    };
+    static_assert(sizeof(RecordHeader) == 72, "layout do registro");
+
+    static const size_t kRecordOverhead = sizeof(RecordHeader) + sizeof(kRecordEnd);
+
+    // Cabecalho do index.bin; os slots comecam em kSlotsOffset
+    static const char kIndexMagic[8] = { 'B', 'R', 'Y', 'S', 'I', 'D', 'X', '1' };
+
+    struct IndexHeader {
+        char magic[8];
+        std::uint64_t capacity;         // potencia de 2
+        std::uint64_t count;
+        std::uint32_t durableSegment;   // tudo antes desta posicao do log esta no indice
+        std::uint32_t reserved;
+        std::uint64_t durableOffset;
+    };
+
+    struct Slot {
+        unsigned char hash[64];
+        std::uint32_t segment;          // 0: slot livre
+        std::uint32_t length;
+        std::uint64_t offset;           // inicio do registro no segmento
+    };
+    static_assert(sizeof(Slot) == 80, "layout do slot");
+
+    static const size_t kSlotsOffset = 64;
+
+    static std::string errnoMessage(const std::string& prefix) {
+        return prefix + ": " + std::strerror(errno);
+    }
+
+    static std::string segmentName(std::uint32_t id) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "segment-%06u.dat", id);
+        return name;
+    }
+
+    // Segmento mapeado inteiro (tamanho maximo) desde a criacao: o mapeamento
+    // nao muda quando o arquivo cresce, entao os Views continuam validos
+    struct Segment {
+        std::uint32_t id = 0;
+        int fd = -1;
+        unsigned char* map = nullptr;
+        size_t mapLength = 0;
+        std::uint64_t size = 0;         // bytes gravados; so o escritor altera depois do open
+
+        ~Segment() {
+            if (map) munmap(map, mapLength);
+            if (fd >= 0) ::close(fd);
+        }
+    };
+
+    struct IndexFile {
+        int fd = -1;
+        unsigned char* map = nullptr;
+        size_t length = 0;
+
+        IndexHeader* header() const { return reinterpret_cast<IndexHeader*>(map); }
+        Slot* slots() const { return reinterpret_cast<Slot*>(map + kSlotsOffset); }
+
+        void release() {
+            if (map) munmap(map, length);
+            if (fd >= 0) ::close(fd);
+            map = nullptr;
+            fd = -1;
+            length = 0;
+        }
+    };
+
+    static size_t indexBytes(std::uint64_t capacity) {
+        return kSlotsOffset + static_cast<size_t>(capacity) * sizeof(Slot);
+    }
+
+    static bool mapIndex(const std::string& path, int flags, size_t length, IndexFile& index, std::string& error) {
+        int fd = ::open(path.c_str(), flags | O_RDWR | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            error = errnoMessage("Falha ao abrir " + path);
+            return false;
+        }
+        if ((flags & O_CREAT) && ftruncate(fd, static_cast<off_t>(length)) != 0) {
+            error = errnoMessage("Falha ao dimensionar " + path);
+            ::close(fd);
+            return false;
+        }
+        void* map = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            error = errnoMessage("Falha ao mapear " + path);
+            ::close(fd);
+            return false;
+        }
+        index.fd = fd;
+        index.map = static_cast<unsigned char*>(map);
+        index.length = length;
+        return true;
+    }
+
+    // msync das paginas que contem [data, data + length) no mapeamento que comeca em base
+    static bool syncRange(const unsigned char* base, const void* data, size_t length) {
+        static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t start = static_cast<size_t>(static_cast<const unsigned char*>(data) - base);
+        size_t begin = start / page * page;
+        return msync(const_cast<unsigned char*>(base) + begin, start + length - begin, MS_SYNC) == 0;
+    }
+
+    // o registro do slot (cabecalho, DER e marca final) cabe no que ja foi gravado no segmento
+    static bool slotInRange(const Slot& slot, const std::vector<std::shared_ptr<Segment>>& segments) {
+        if (slot.segment == 0 || slot.segment > segments.size() || slot.length == 0) return false;
+        std::uint64_t size = segments[slot.segment - 1]->size;
+        return slot.offset <= size && size - slot.offset >= kRecordOverhead + static_cast<std::uint64_t>(slot.length);
+    }
+
+    static std::uint64_t bucketOf(const unsigned char* hash) {
+        // o hash ja eh SHA-512: os primeiros 8 bytes bastam como posicao
+        std::uint64_t value;
+        std::memcpy(&value, hash, sizeof(value));
+        return value;
+    }
+
+    // Slot do hash ou o slot livre onde ele entraria (sondagem linear)
+    static Slot* probe(const IndexFile& index, const unsigned char* hash) {
+        std::uint64_t mask = index.header()->capacity - 1;
+        Slot* slots = index.slots();
+        for (std::uint64_t i = bucketOf(hash) & mask;; i = (i + 1) & mask) {
+            Slot& slot = slots[i];
+            if (slot.segment == 0 || std::memcmp(slot.hash, hash, sizeof(slot.hash)) == 0) return &slot;
+        }
+    }
+
+    struct Store::Impl {
+        Config config;
+
+        mutable std::shared_mutex mutex;    // indice e lista de segmentos
+        std::mutex writeMutex;              // um put por vez
+        std::vector<std::shared_ptr<Segment>> segments;     // id = posicao + 1
+        IndexFile index;
+        int lockFd = -1;                    // trava exclusiva do diretorio (um processo escritor)
+
+        unsigned long long recovered = 0;
+        unsigned long long truncated = 0;
+
+        explicit Impl(const Config& config_) : config(config_) {}
+        ~Impl() {
+            index.release();
+            if (lockFd >= 0) ::close(lockFd);
+        }
+
+        std::string path(const std::string& name) const { return (std::filesystem::path(config.dir) / name).string(); }
+
+        bool openSegment(std::uint32_t id, bool create, std::string& error);
+        bool openIndex(std::string& error);
+        bool createIndex(const std::string& file, std::uint64_t capacity, IndexFile& out, std::string& error);
+        bool grow(std::string& error);
+        bool insert(const unsigned char* hash, std::uint32_t segment, std::uint64_t offset, std::uint32_t length, std::string& error);
+        bool recover(std::string& error);
+        bool validateSlots();
+        bool rebuildIndex(std::string& error);
+        void syncDir() const;
+    };
+
+    bool Store::Impl::openSegment(std::uint32_t id, bool create, std::string& error) {
+        std::string file = path(segmentName(id));
+        int fd = ::open(file.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_EXCL : 0), 0644);
+        if (fd < 0) {
+            error = errnoMessage("Falha ao abrir " + file);
+            return false;
+        }
+        std::shared_ptr<Segment> segment = std::make_shared<Segment>();
+        segment->id = id;
+        segment->fd = fd;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            error = errnoMessage("Falha ao ler " + file);
+            return false;
+        }
+        segment->size = static_cast<std::uint64_t>(st.st_size);
+        // um segmento antigo pode ser maior que o limite atual (limite reduzido entre execucoes)
+        segment->mapLength = std::max(config.segmentBytes, static_cast<size_t>(st.st_size));
+
+        void* map = mmap(nullptr, segment->mapLength, PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            error = errnoMessage("Falha ao mapear " + file);
+            return false;
+        }
+        segment->map = static_cast<unsigned char*>(map);
+
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        segments.push_back(std::move(segment));
+        return true;
+    }
+
+    bool Store::Impl::createIndex(const std::string& file, std::uint64_t capacity, IndexFile& out, std::string& error) {
+        ::unlink(file.c_str());
+        if (!mapIndex(file, O_CREAT, indexBytes(capacity), out, error)) return false;
+        // arquivo novo vem zerado do ftruncate: todos os slots livres
+        IndexHeader* header = out.header();
+        std::memcpy(header->magic, kIndexMagic, sizeof(kIndexMagic));
+        header->capacity = capacity;
+        header->count = 0;
+        header->durableSegment = 1;
+        header->durableOffset = 0;
+        return true;
+    }
+
+    bool Store::Impl::openIndex(std::string& error) {
+        std::string file = path("index.bin");
+        struct stat st;
+        if (::stat(file.c_str(), &st) == 0 && static_cast<size_t>(st.st_size) >= kSlotsOffset) {
+            IndexFile existing;
+            if (!mapIndex(file, 0, static_cast<size_t>(st.st_size), existing, error)) return false;
+
+            // capacity limitada pelo tamanho do arquivo antes de multiplicar: 2^62 slots
+            // de 80 bytes dariam a volta e bateriam com um arquivo so de cabecalho
+            const IndexHeader* header = existing.header();
+            std::uint64_t capacity = header->capacity;
+            bool valid = std::memcmp(header->magic, kIndexMagic, sizeof(kIndexMagic)) == 0
+                && capacity > 0 && (capacity & (capacity - 1)) == 0
+                && capacity <= (static_cast<size_t>(st.st_size) - kSlotsOffset) / sizeof(Slot)
+                && indexBytes(capacity) == static_cast<size_t>(st.st_size)
+                && header->durableSegment >= 1 && header->durableSegment <= std::max<size_t>(segments.size(), 1)
+                && (!segments.empty() || header->count == 0)
+                && (segments.empty() || header->durableOffset <= segments[header->durableSegment - 1]->size);
+            if (valid) {
+                index = existing;
+                return true;
+            }
+            existing.release();
+            Logger::log(Logger::Level::Warn, "Indice do armazem de assinaturas invalido; reconstruindo", { { "arquivo", file } });
+        }
+
+        size_t slots = std::max<size_t>(config.initialSlots, 16);
+        std::uint64_t capacity = 1;
+        while (capacity < slots) capacity <<= 1;
+        return createIndex(file, capacity, index, error);
+    }
+
+    // Dobra a tabela num arquivo novo e o troca pelo atual (chamado com mutex exclusivo)
+    bool Store::Impl::grow(std::string& error) {
+        const IndexHeader* old = index.header();
+        std::string file = path("index.bin");
+        std::string temp = file + ".tmp";
+
+        IndexFile bigger;
+        if (!createIndex(temp, old->capacity * 2, bigger, error)) return false;
+
+        const Slot* slots = index.slots();
+        for (std::uint64_t i = 0; i < old->capacity; ++i) {
+            if (slots[i].segment == 0) continue;
+            *probe(bigger, slots[i].hash) = slots[i];
+        }
+        IndexHeader* header = bigger.header();
+        header->count = old->count;
+        header->durableSegment = old->durableSegment;
+        header->durableOffset = old->durableOffset;
+
+        if (config.fsync) msync(bigger.map, bigger.length, MS_SYNC);
+        if (::rename(temp.c_str(), file.c_str()) != 0) {
+            error = errnoMessage("Falha ao trocar o indice");
+            bigger.release();
+            ::unlink(temp.c_str());
+            return false;
+        }
+        index.release();
+        index = bigger;
+        return true;
+    }
+
+    // Chamado com mutex exclusivo (ou durante o open)
+    bool Store::Impl::insert(const unsigned char* hash, std::uint32_t segment, std::uint64_t offset, std::uint32_t length,
+                             std::string& error) {
+        Slot* slot = probe(index, hash);
+        if (slot->segment == 0) {
+            IndexHeader* header = index.header();
+            if ((header->count + 1) * 10 > header->capacity * 7) {
+                if (!grow(error)) return false;
+                slot = probe(index, hash);
+            }
+            std::memcpy(slot->hash, hash, sizeof(slot->hash));
+            index.header()->count++;
+        }
+        slot->offset = offset;
+        slot->length = length;
+        slot->segment = segment;
+        return true;
+    }
+
+    // Reindexa os registros gravados depois da posicao duravel do indice
+    bool Store::Impl::recover(std::string& error) {
+        IndexHeader* header = index.header();
+        for (size_t i = header->durableSegment - 1; i < segments.size(); ++i) {
+            Segment& segment = *segments[i];
+            std::uint64_t offset = segment.id == header->durableSegment ? header->durableOffset : 0;
+
+            while (offset + kRecordOverhead <= segment.size) {
+                RecordHeader record;
+                std::memcpy(&record, segment.map + offset, sizeof(record));
+                std::uint64_t total = kRecordOverhead + record.length;
+                if (std::memcmp(record.magic, kRecordMagic, sizeof(kRecordMagic)) != 0 || record.length == 0
+                    || offset + total > segment.size
+                    || std::memcmp(segment.map + offset + sizeof(record) + record.length, kRecordEnd, sizeof(kRecordEnd)) != 0) {
+                    break;
+                }
+                if (!insert(record.hash, segment.id, offset, record.length, error)) return false;
+                recovered++;
+                offset += total;
+            }
+
+            if (offset < segment.size) {
+                // gravacao interrompida: o resto do segmento nao forma um registro
+                Logger::log(Logger::Level::Warn, "Registro incompleto descartado do armazem de assinaturas", {
+                    { "segmento", segmentName(segment.id) }, { "posicao", std::to_string(offset) },
+                    { "bytes", std::to_string(segment.size - offset) } });
+                truncated += segment.size - offset;
+                if (ftruncate(segment.fd, static_cast<off_t>(offset)) != 0) {
+                    error = errnoMessage("Falha ao truncar " + segmentName(segment.id));
+                    return false;
+                }
+                segment.size = offset;
+            }
+            header = index.header();
+            header->durableSegment = segment.id;
+            header->durableOffset = offset;
+        }
+        return true;
+    }
+
+    // Slots apontando fora dos segmentos (indice corrompido ou gravado so em parte antes
+    // de uma queda) fariam o get ler fora do mapeamento. Falso se algum estiver fora; a
+    // contagem divergente apenas eh corrigida
+    bool Store::Impl::validateSlots() {
+        IndexHeader* header = index.header();
+        const Slot* slots = index.slots();
+        std::uint64_t occupied = 0;
+        for (std::uint64_t i = 0; i < header->capacity; ++i) {
+            const Slot& slot = slots[i];
+            if (slot.segment == 0) continue;
+            if (!slotInRange(slot, segments)) return false;
+            occupied++;
+        }
+        // sem slot livre a sondagem de um hash ausente nao terminaria
+        if (occupied >= header->capacity) return false;
+        if (occupied != header->count) {
+            Logger::log(Logger::Level::Warn, "Contagem do indice do armazem de assinaturas corrigida", {
+                { "indice", std::to_string(header->count) }, { "slots", std::to_string(occupied) } });
+            header->count = occupied;
+        }
+        return true;
+    }
+
+    // Indice novo reconstruido do log inteiro
+    bool Store::Impl::rebuildIndex(std::string& error) {
+        Logger::log(Logger::Level::Warn, "Indice do armazem de assinaturas aponta para fora dos segmentos; reconstruindo",
+            { { "arquivo", path("index.bin") } });
+        std::uint64_t capacity = index.header()->capacity;
+        index.release();
+        if (!createIndex(path("index.bin"), capacity, index, error)) return false;
+        recovered = 0;
+        return recover(error);
+    }
+
+    void Store::Impl::syncDir() const {
+        int fd = ::open(config.dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) return;
+        fsync(fd);
+        ::close(fd);
+    }
+
+    Store::Store(const Config& config) : config_(config) {}
+
+    Store::~Store() = default;
+
+    bool Store::open(std::string& error) {
+        if (config_.dir.empty()) {
+            error = "SIGNATURE_STORE_DIR nao definido";
+            return false;
+        }
+        std::unique_ptr<Impl> impl(new Impl(config_));
+
+        std::error_code ec;
+        std::filesystem::create_directories(config_.dir, ec);
+        if (ec) {
+            error = "Falha ao criar " + config_.dir + ": " + ec.message();
+            return false;
+        }
+
+        impl->lockFd = ::open(impl->path("LOCK").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (impl->lockFd < 0) {
+            error = errnoMessage("Falha ao abrir a trava do armazem");
+            return false;
+        }
+        if (flock(impl->lockFd, LOCK_EX | LOCK_NB) != 0) {
+            error = "Armazem de assinaturas em uso por outro processo: " + config_.dir;
+            return false;
+        }
+
+        std::vector<std::uint32_t> ids;
+        for (const auto& entry : std::filesystem::directory_iterator(config_.dir, ec)) {
+            std::string name = entry.path().filename().string();
+            unsigned id = 0;
+            char tail = 0;
+            if (name.size() == segmentName(1).size() && std::sscanf(name.c_str(), "segment-%6u.da%c", &id, &tail) == 2 && tail == 't' && id > 0) {
+                ids.push_back(id);
+            }
+        }
+        if (ec) {
+            error = "Falha ao listar " + config_.dir + ": " + ec.message();
+            return false;
+        }
+        std::sort(ids.begin(), ids.end());
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (ids[i] != i + 1) {
+                error = "Segmento ausente no armazem de assinaturas: " + segmentName(static_cast<std::uint32_t>(i + 1));
+                return false;
+            }
+            if (!impl->openSegment(ids[i], false, error)) return false;
+        }
+
+        if (!impl->openIndex(error)) return false;
+        if (!impl->recover(error)) return false;
+        if (!impl->validateSlots() && !impl->rebuildIndex(error)) return false;
+        if (impl->segments.empty()) {
+            if (!impl->openSegment(1, true, error)) return false;
+            if (config_.fsync) impl->syncDir();
+        }
+
+        if (impl->recovered > 0 || impl->truncated > 0) {
+            Logger::log(Logger::Level::Info, "Armazem de assinaturas recuperado", {
+                { "registros", std::to_string(impl->recovered) }, { "bytes_descartados", std::to_string(impl->truncated) } });
+        }
+        impl_ = std::move(impl);
+        return true;
+    }
+
+    bool Store::put(const Hash& docHash, const unsigned char* der, size_t length, std::string& error) {
+        if (!impl_) {
+            error = "Armazem de assinaturas nao aberto";
+            return false;
+        }
+        if (length == 0 || length > impl_->config.segmentBytes - kRecordOverhead || length > UINT32_MAX) {
+            error = "Assinatura de tamanho invalido para o armazem (" + std::to_string(length) + " bytes)";
+            return false;
+        }
+        std::uint64_t total = kRecordOverhead + length;
+
+        std::lock_guard<std::mutex> writer(impl_->writeMutex);
+        std::shared_ptr<Segment> segment = impl_->segments.back();
+        if (segment->size > 0 && segment->size + total > impl_->config.segmentBytes) {
+            if (!impl_->openSegment(segment->id + 1, true, error)) return false;
+            if (impl_->config.fsync) impl_->syncDir();
+            segment = impl_->segments.back();
+        }
+
+        RecordHeader record;
+        std::memcpy(record.magic, kRecordMagic, sizeof(kRecordMagic));
+        record.length = static_cast<std::uint32_t>(length);
+        std::memcpy(record.hash, docHash.data(), docHash.size());
+
+        iovec parts[3] = {
+            { &record, sizeof(record) },
+            { const_cast<unsigned char*>(der), length },
+            { const_cast<char*>(kRecordEnd), sizeof(kRecordEnd) }
+        };
+        ssize_t written;
+        do {
+            written = pwritev(segment->fd, parts, 3, static_cast<off_t>(segment->size));
+        } while (written < 0 && errno == EINTR);
+        if (written != static_cast<ssize_t>(total)) {
+            error = written < 0 ? errnoMessage("Falha ao gravar assinatura") : "Gravacao parcial da assinatura";
+            // o registro parcial nao pode ficar no meio do log
+            if (ftruncate(segment->fd, static_cast<off_t>(segment->size)) != 0) {
+                Logger::logRateLimited(Logger::Level::Error, "signature_store_truncate", "Falha ao desfazer gravacao parcial",
+                    { { "erro", std::strerror(errno) } });
+            }
+            return false;
+        }
+        if (impl_->config.fsync && fdatasync(segment->fd) != 0) {
+            error = errnoMessage("Falha no fdatasync do segmento");
+            return false;
+        }
+
+        {
+            std::unique_lock<std::shared_mutex> lock(impl_->mutex);
+            if (!impl_->insert(docHash.data(), segment->id, segment->size, static_cast<std::uint32_t>(length), error)) return false;
+            segment->size += total;
+        }
+
+        // o indice so eh trocado (grow) por um put, entao o mapeamento nao muda sem o writeMutex.
+        // Com fsync o slot chega ao disco antes da posicao duravel: o cabecalho nunca
+        // declara indexado um registro cujo slot se perdeu
+        IndexFile& index = impl_->index;
+        if (impl_->config.fsync && !syncRange(index.map, probe(index, docHash.data()), sizeof(Slot))) {
+            error = errnoMessage("Falha no msync do indice");
+            return false;
+        }
+        IndexHeader* header = index.header();
+        header->durableSegment = segment->id;
+        header->durableOffset = segment->size;
+        if (impl_->config.fsync && !syncRange(index.map, header, sizeof(IndexHeader))) {
+            error = errnoMessage("Falha no msync do indice");
+            return false;
+        }
+        return true;
+    }
+
+    View Store::get(const Hash& docHash) const {
+        if (!impl_) return View();
+        std::shared_lock<std::shared_mutex> lock(impl_->mutex);
+        const Slot* slot = probe(impl_->index, docHash.data());
+        // o indice eh um arquivo mapeado: um slot fora do segmento nunca vira leitura fora do mapeamento
+        if (!slotInRange(*slot, impl_->segments)) return View();
+        const std::shared_ptr<Segment>& segment = impl_->segments[slot->segment - 1];
+        return View(segment, segment->map + slot->offset + sizeof(RecordHeader), slot->length);
+    }
+
+    Stats Store::stats() const {
+        Stats stats{ 0, 0, 0, 0, 0 };
+        if (!impl_) return stats;
+        std::shared_lock<std::shared_mutex> lock(impl_->mutex);
+        stats.records = impl_->index.header()->count;
+        stats.segments = impl_->segments.size();
+        stats.indexSlots = impl_->index.header()->capacity;
+        stats.recovered = impl_->recovered;
+        stats.truncated = impl_->truncated;
+        return stats;
+    }
+
+#else
+
+    struct Store::Impl {};
+
+    Store::Store(const Config& config) : config_(config) {}
+
+    Store::~Store() = default;
+
+    bool Store::open(std::string& error) {
+        error = "Armazem de assinaturas disponivel apenas no Linux";
+        return false;
+    }
+
+    bool Store::put(const Hash&, const unsigned char*, size_t, std::string& error) {
+        error = "Armazem de assinaturas disponivel apenas no Linux";
+        return false;
+    }
+
+    View Store::get(const Hash&) const { return View(); }
+
+    Stats Store::stats() const { return Stats{ 0, 0, 0, 0, 0 }; }
+
+#endif
+}
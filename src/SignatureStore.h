@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Armazem de assinaturas enderecado pelo SHA-512 do documento.
+// As assinaturas (CMS DER) sao gravadas em segmentos somente-append
+// (segment-NNNNNN.dat) e lidas direto do mmap do segmento, sem copia: um View
+// segura o segmento mapeado enquanto a resposta eh enviada. O indice (index.bin)
+// eh uma tabela hash de enderecamento aberto, tambem mapeada em memoria, com a
+// posicao do log ja indexada; ao abrir, o que foi gravado depois dela eh
+// reindexado, um registro incompleto no fim do ultimo segmento eh descartado e
+// um indice com slots fora dos segmentos eh reconstruido do log.
+// Um documento assinado de novo aponta para o registro mais recente.
+// Disponivel apenas no Linux; nas demais plataformas supported() retorna false.
+namespace SignatureStore {
+
+    using Hash = std::array<unsigned char, 64>;
+
+    // 128 digitos hexadecimais (maiusculos ou minusculos)
+    bool parseHash(const std::string& hex, Hash& hash);
+    std::string hashHex(const Hash& hash);
+
+    struct Config {
+        std::string dir;                            // vazio desliga o armazem
+        size_t segmentBytes = 256u * 1024 * 1024;   // tamanho maximo de cada segmento
+        bool fsync = false;                         // fdatasync do segmento antes de indexar e msync do indice
+        size_t initialSlots = 1 << 16;              // potencia de 2; o indice dobra com 70% de ocupacao
+    };
+
+    // SIGNATURE_STORE_DIR, SIGNATURE_STORE_SEGMENT_MB, SIGNATURE_STORE_FSYNC
+    Config fromEnv();
+
+    bool supported();
+
+    // Assinatura dentro do mapeamento do segmento; valida enquanto o View
+    // (ou uma copia de owner()) existir
+    class View {
+    public:
+        View() = default;
+        View(std::shared_ptr<const void> owner, const unsigned char* data, size_t size)
+            : owner_(std::move(owner)), data_(data), size_(size) {}
+
+        explicit operator bool() const { return data_ != nullptr; }
+        const unsigned char* data() const { return data_; }
+        size_t size() const { return size_; }
+        const std::shared_ptr<const void>& owner() const { return owner_; }
+
+    private:
+        std::shared_ptr<const void> owner_;
+        const unsigned char* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    struct Stats {
+        unsigned long long records;     // documentos no indice
+        unsigned long long segments;
+        unsigned long long indexSlots;
+        unsigned long long recovered;   // registros reindexados ao abrir
+        unsigned long long truncated;   // bytes descartados de um registro incompleto
+    };
+
+    // Varias threads podem ler (get) enquanto outra grava (put); as gravacoes sao serializadas
+    class Store {
+    public:
+        explicit Store(const Config& config);
+        ~Store();
+
+        Store(const Store&) = delete;
+        Store& operator=(const Store&) = delete;
+
+        // cria o diretorio, mapeia segmentos e indice e recupera o fim do log
+        bool open(std::string& error);
+
+        bool put(const Hash& docHash, const unsigned char* der, size_t length, std::string& error);
+
+        // View vazio se o documento nao esta no armazem
+        View get(const Hash& docHash) const;
+
+        Stats stats() const;
+        const Config& config() const { return config_; }
+
+    private:
+        struct Impl;
+
+        Config config_;
+        std::unique_ptr<Impl> impl_;
+    };
+}
@@ -1,5 +1,10 @@
 #include "SignerService.h"
+#include "CmsEdDSA.h"
+#include "DigestService.h"
+#include "OpenSSLPool.h"
 #include "Utils.h"
+#include <climits>
+#include <cstdint>
 #include <cstdio>
 #include <openssl/bio.h>
 #include <openssl/cms.h>
@@ -10,15 +15,14 @@ namespace SignerService {
     bool loadCredentials(const std::string& p12Path, const std::string& password, 
                          PKCS12** p12, EVP_PKEY** pkey, X509** cert, STACK_OF(X509)** ca) {
         
-        BIO* bio = BIO_new_file(p12Path.c_str(), "rb");
+        OpenSSLPool::BioPtr bio(BIO_new_file(p12Path.c_str(), "rb"));
         if (!bio) {
             Utils::logInfo("No foi possvel abrir o arquivo P12: " + p12Path);
             return false;
         }
 
 
-        *p12 = d2i_PKCS12_bio(bio, nullptr);
-        BIO_free(bio);
+        *p12 = d2i_PKCS12_bio(bio.get(), nullptr);
 
         if (!*p12) {
             Utils::logInfo("Falha ao ler o arquivo P12: " + p12Path);
@@ -30,87 +34,261 @@ namespace SignerService {
             Utils::logInfo("Falha ao processar o arquivo P12: " + p12Path);
             return false;
         }
+
+        if (!*pkey || !*cert || !digestForKey(*pkey)) {
+            Utils::logInfo("Tipo de chave no suportado no P12: " + p12Path);
+            return false;
+        }
         return true;
-    }       
+    }
 
-    CMS_ContentInfo* signData(const std::string& docPath, X509* cert, EVP_PKEY* pkey, STACK_OF(X509)* ca) {
+    const EVP_MD* digestForKey(EVP_PKEY* pkey) {
+        if (!pkey) return nullptr;
 
-        BIO* content = BIO_new_file(docPath.c_str(), "rb");
-        if (!content) {
-            Utils::printOpenSSLError("Arquivo de entrada no encontrado: " + docPath);
-            return nullptr;
+        switch (EVP_PKEY_base_id(pkey)) {
+            case EVP_PKEY_RSA:
+            case EVP_PKEY_RSA_PSS:
+                return OpenSSLPool::sha512();
+
+            // ECDSA usa o digest do mesmo nivel de seguranca da curva
+            case EVP_PKEY_EC: {
+                int bits = EVP_PKEY_bits(pkey);
+                if (bits <= 256) return OpenSSLPool::sha256();
+                if (bits <= 384) return OpenSSLPool::sha384();
+                return OpenSSLPool::sha512();
+            }
+
+            // Ed25519 assina a mensagem inteira; o digest dos atributos assinados eh SHA-512 (RFC 8419)
+            case EVP_PKEY_ED25519:
+                return OpenSSLPool::sha512();
+
+            default:
+                return nullptr;
         }
+    }       
 
-        // flags partial permite configurar o hash sha512 depois e binary evita corrupcao de quebra de linha
+    CertMode parseCertMode(const std::string& name, CertMode defaultMode) {
+        if (name == "full") return CertMode::Full;
+        if (name == "leaf") return CertMode::Leaf;
+        if (name == "none") return CertMode::None;
+        return defaultMode;
+    }
+
+    const char* const kBatchRootOid = "2.25.292873941194165587393522801069018405198";
+
+    using ObjectPtr = std::unique_ptr<ASN1_OBJECT, OpenSSLPool::FnDeleter<ASN1_OBJECT_free>>;
+
+    // contentType: eContentType no lugar de id-data (vai tambem no atributo assinado)
+    static CMS_ContentInfo* signContent(BIO* content, X509* cert, EVP_PKEY* pkey, STACK_OF(X509)* ca,
+                                        CertMode certMode = CertMode::Full, const char* contentType = nullptr) {
+        // flags partial permite configurar o hash depois e binary evita corrupcao de quebra de linha
         int flags = CMS_BINARY | CMS_PARTIAL;
 
-        CMS_ContentInfo* cms = CMS_sign(nullptr, nullptr, ca, content, flags);
+        // a cadeia do P12 so vai no modo completo
+        OpenSSLPool::CmsPtr cms(CMS_sign(nullptr, nullptr, certMode == CertMode::Full ? ca : nullptr, content, flags));
         
         if (!cms) {
             Utils::printOpenSSLError("Falha ao inicializar CMS");
-            BIO_free(content);
             return nullptr;
         }
 
-        // adiciona o signatario forando o uso de sha512
-        if (!CMS_add1_signer(cms, cert, pkey, EVP_sha512(), CMS_BINARY)) {
+        if (contentType) {
+            ObjectPtr type(OBJ_txt2obj(contentType, 1));
+            if (!type || !CMS_set1_eContentType(cms.get(), type.get())) {
+                Utils::printOpenSSLError("Falha ao definir o tipo de conteudo");
+                return nullptr;
+            }
+        }
+
+        const EVP_MD* md = digestForKey(pkey);
+        if (!md) {
+            Utils::logInfo("Tipo de chave no suportado para assinatura");
+            return nullptr;
+        }
+
+        // adiciona o signatario com o digest correspondente ao tipo de chave
+        // o SignerIdentifier (issuer + serial) continua no SignerInfo mesmo sem o certificado
+        int signerFlags = CMS_BINARY | (certMode == CertMode::None ? CMS_NOCERTS : 0);
+        CMS_SignerInfo* si = CMS_add1_signer(cms.get(), cert, pkey, md, signerFlags);
+        if (!si) {
             Utils::printOpenSSLError("Falha ao adicionar signatrio");
-            CMS_ContentInfo_free(cms);
-            BIO_free(content);
             return nullptr;
         }
 
+        // Ed25519 nao passa pelo CMS_final (ver CmsEdDSA)
+        if (CmsEdDSA::isEdDSA(pkey)) {
+            if (!CmsEdDSA::signContent(cms.get(), si, pkey, content)) {
+                Utils::printOpenSSLError("Falha ao finalizar assinatura");
+                return nullptr;
+            }
+            return cms.release();
+        }
+
         // Finalize signature generation
-        if (!CMS_final(cms, content, nullptr, flags)) {
+        if (!CMS_final(cms.get(), content, nullptr, flags)) {
             Utils::printOpenSSLError("Falha ao finalizar assinatura");
-            CMS_ContentInfo_free(cms);
-            BIO_free(content);
             return nullptr;
         }
 
-        BIO_free(content);
-        return cms; 
+        return cms.release(); 
+    }
+
+    CMS_ContentInfo* signData(const std::string& docPath, X509* cert, EVP_PKEY* pkey, STACK_OF(X509)* ca,
+                              CertMode certMode) {
+
+        OpenSSLPool::BioPtr content(BIO_new_file(docPath.c_str(), "rb"));
+        if (!content) {
+            Utils::printOpenSSLError("Arquivo de entrada no encontrado: " + docPath);
+            return nullptr;
+        }
+
+        return signContent(content.get(), cert, pkey, ca, certMode);
+    }
+
+    CMS_ContentInfo* signBuffer(const unsigned char* data, size_t length, X509* cert, EVP_PKEY* pkey, STACK_OF(X509)* ca,
+                                CertMode certMode) {
+        if (length > static_cast<size_t>(INT_MAX)) {
+            Utils::logInfo("Documento grande demais para assinatura em memria");
+            return nullptr;
+        }
+
+        OpenSSLPool::BioPtr content(BIO_new_mem_buf(data, static_cast<int>(length)));
+        if (!content) {
+            Utils::printOpenSSLError("Falha ao preparar o documento em memria");
+            return nullptr;
+        }
+
+        return signContent(content.get(), cert, pkey, ca, certMode);
+    }
+
+    CMS_ContentInfo* signBatch(const std::vector<std::string>& docPaths, X509* cert, EVP_PKEY* pkey, STACK_OF(X509)* ca,
+                               std::vector<MerkleTree::Proof>& proofs) {
+        if (docPaths.empty() || docPaths.size() > UINT32_MAX) {
+            Utils::logInfo("Lote vazio ou grande demais para assinatura");
+            return nullptr;
+        }
+
+        // uma folha por documento: o custo por documento eh so o hash
+        std::vector<MerkleTree::Hash> leaves;
+        leaves.reserve(docPaths.size());
+        for (const std::string& docPath : docPaths) {
+            std::vector<unsigned char> digest = DigestService::calculateSHA512Bytes(docPath);
+            if (digest.empty()) {
+                Utils::logInfo("Arquivo de entrada no encontrado: " + docPath);
+                return nullptr;
+            }
+            leaves.push_back(MerkleTree::leafHash(digest.data(), digest.size()));
+        }
+
+        MerkleTree::Tree tree(std::move(leaves));
+
+        proofs.clear();
+        proofs.reserve(docPaths.size());
+        for (std::uint32_t i = 0; i < tree.leafCount(); ++i) {
+            proofs.push_back(tree.proof(i));
+        }
+
+        // a raiz vai encapsulada: a unica operacao com a chave privada do lote
+        const MerkleTree::Hash& root = tree.root();
+        OpenSSLPool::BioPtr content(BIO_new_mem_buf(root.data(), static_cast<int>(root.size())));
+        if (!content) {
+            Utils::printOpenSSLError("Falha ao preparar a raiz do lote");
+            return nullptr;
+        }
+
+        return signContent(content.get(), cert, pkey, ca, CertMode::Full, kBatchRootOid);
     }
 
-    bool generateSignature(const std::string& p12Path, const std::string& password, const std::string& docPath, const std::string& outPath) {
+    bool generateSignature(const std::string& p12Path, const std::string& password, const std::string& docPath, const std::string& outPath,
+                           CertMode certMode) {
         PKCS12* p12 = nullptr;
         EVP_PKEY* pkey = nullptr;
         X509* cert = nullptr;
         STACK_OF(X509)* ca = nullptr;
+
+        bool loaded = loadCredentials(p12Path, password, &p12, &pkey, &cert, &ca);
+
+        // handles liberam as credenciais em qualquer caminho de saida
+        OpenSSLPool::P12Ptr p12Guard(p12);
+        OpenSSLPool::PkeyPtr pkeyGuard(pkey);
+        OpenSSLPool::X509Ptr certGuard(cert);
+        OpenSSLPool::X509StackPtr caGuard(ca);
             
-        if (!loadCredentials(p12Path, password, &p12, &pkey, &cert, &ca)) {
+        if (!loaded) {
             Utils::printOpenSSLError("Falha ao carregar credenciais P12");
-            if (p12) PKCS12_free(p12);
             return false;
         }
 
-        CMS_ContentInfo* cms = signData(docPath, cert, pkey, ca);
-        bool success = false;
-
-        if (cms) {
-            BIO* out = BIO_new_file(outPath.c_str(), "wb");
-            if (out) {
-                // salva a estrutura cms em formato der binario
-                if (i2d_CMS_bio(out, cms)) {
-                    success = true;
-                }
-                else {
-                    Utils::printOpenSSLError("Falha ao escrever arquivo de assinatura");
-                }
-                BIO_free(out);
-            }
-            else {
-                Utils::logInfo("No foi possvel criar o arquivo de sada: " + outPath);
-            }
-            CMS_ContentInfo_free(cms);
+        OpenSSLPool::CmsPtr cms(signData(docPath, cert, pkey, ca, certMode));
+        if (!cms) {
+            return false;
+        }
+
+        OpenSSLPool::BioPtr out(BIO_new_file(outPath.c_str(), "wb"));
+        if (!out) {
+            Utils::logInfo("No foi possvel criar o arquivo de sada: " + outPath);
+            return false;
+        }
+
+        // salva a estrutura cms em formato der binario
+        if (!i2d_CMS_bio(out.get(), cms.get())) {
+            Utils::printOpenSSLError("Falha ao escrever arquivo de assinatura");
+            return false;
+        }
+
+        return true;
+    }
+
+    bool generateBatchSignature(const std::string& p12Path, const std::string& password,
+                                const std::vector<std::string>& docPaths, const std::string& outPath,
+                                const std::vector<std::string>& proofPaths) {
+        if (proofPaths.size() != docPaths.size()) {
+            Utils::logInfo("Quantidade de provas diferente da quantidade de documentos");
+            return false;
         }
 
-        if (p12) PKCS12_free(p12);
-        if (pkey) EVP_PKEY_free(pkey);
-        if (cert) X509_free(cert);
-        if (ca) sk_X509_pop_free(ca, X509_free);
+        PKCS12* p12 = nullptr;
+        EVP_PKEY* pkey = nullptr;
+        X509* cert = nullptr;
+        STACK_OF(X509)* ca = nullptr;
+
+        bool loaded = loadCredentials(p12Path, password, &p12, &pkey, &cert, &ca);
+
+        OpenSSLPool::P12Ptr p12Guard(p12);
+        OpenSSLPool::PkeyPtr pkeyGuard(pkey);
+        OpenSSLPool::X509Ptr certGuard(cert);
+        OpenSSLPool::X509StackPtr caGuard(ca);
 
-        return success;
+        if (!loaded) {
+            Utils::printOpenSSLError("Falha ao carregar credenciais P12");
+            return false;
+        }
+
+        std::vector<MerkleTree::Proof> proofs;
+        OpenSSLPool::CmsPtr cms(signBatch(docPaths, cert, pkey, ca, proofs));
+        if (!cms) {
+            return false;
+        }
+
+        OpenSSLPool::BioPtr out(BIO_new_file(outPath.c_str(), "wb"));
+        if (!out) {
+            Utils::logInfo("No foi possvel criar o arquivo de sada: " + outPath);
+            return false;
+        }
+
+        if (!i2d_CMS_bio(out.get(), cms.get())) {
+            Utils::printOpenSSLError("Falha ao escrever arquivo de assinatura");
+            return false;
+        }
+
+        for (size_t i = 0; i < proofs.size(); ++i) {
+            if (!MerkleTree::writeProof(proofPaths[i], proofs[i])) {
+                Utils::logInfo("No foi possvel gravar a prova: " + proofPaths[i]);
+                return false;
+            }
+        }
+
+        return true;
     }
 
     bool executeStep2(const std::string& p12Path, const std::string& docPath, const std::string& outPath, const std::string& password) {
@@ -1,15 +1,50 @@
 #pragma once
 #include <string>
+#include <vector>
 #include <openssl/pkcs12.h>
 #include <openssl/cms.h>
+#include "MerkleTree.h"
 
 namespace SignerService {
+
+    // Certificados embutidos no CMS: Full = signatario + cadeia do P12, Leaf = so o signatario,
+    // None = nenhum (CMS_NOCERTS; o verificador precisa do certificado num CertIndex)
+    enum class CertMode { Full, Leaf, None };
+
+    // "full", "leaf" ou "none"; outro valor mantem o padrao
+    CertMode parseCertMode(const std::string& name, CertMode defaultMode = CertMode::Full);
+
     bool loadCredentials(const std::string& p12Path, const std::string& password, 
                          PKCS12** p12, EVP_PKEY** pkey, X509** cert, STACK_OF(X509)** ca);
 
-    CMS_ContentInfo* signData(const std::string& docPath, X509* cert, EVP_PKEY* pkey, STACK_OF(X509)* ca);
+    // Digest usado com cada tipo de chave: RSA -> SHA-512, ECDSA P-256/P-384/P-521 -> SHA-256/384/512,
+    // Ed25519 -> SHA-512. Retorna nulo para tipos nao suportados
+    const EVP_MD* digestForKey(EVP_PKEY* pkey);
+
+    CMS_ContentInfo* signData(const std::string& docPath, X509* cert, EVP_PKEY* pkey, STACK_OF(X509)* ca,
+                              CertMode certMode = CertMode::Full);
+
+    // Mesmo CMS do signData a partir de um documento ja carregado em memoria
+    CMS_ContentInfo* signBuffer(const unsigned char* data, size_t length, X509* cert, EVP_PKEY* pkey, STACK_OF(X509)* ca,
+                                CertMode certMode = CertMode::Full);
+
+    // eContentType (e contentType assinado) do CMS de lote, OID 2.25 derivado de UUID (ITU-T X.667):
+    // o conteudo encapsulado eh uma raiz de Merkle, nunca um documento. Sem essa separacao a
+    // assinatura comum de um documento de 64 bytes valeria como raiz de um lote qualquer
+    extern const char* const kBatchRootOid;
+
+    // Assinatura em lote: um unico CMS sobre a raiz da arvore de Merkle dos SHA-512 dos documentos.
+    // proofs recebe a prova de inclusao de cada documento, na mesma ordem de docPaths
+    CMS_ContentInfo* signBatch(const std::vector<std::string>& docPaths, X509* cert, EVP_PKEY* pkey, STACK_OF(X509)* ca,
+                               std::vector<MerkleTree::Proof>& proofs);
+
+    bool generateSignature(const std::string& p12Path, const std::string& password, const std::string& docPath, const std::string& outPath,
+                           CertMode certMode = CertMode::Full);
 
-    bool generateSignature(const std::string& p12Path, const std::string& password, const std::string& docPath, const std::string& outPath);
+    // Grava a assinatura do lote em outPath e a prova de cada documento em proofPaths[i]
+    bool generateBatchSignature(const std::string& p12Path, const std::string& password,
+                                const std::vector<std::string>& docPaths, const std::string& outPath,
+                                const std::vector<std::string>& proofPaths);
 
     bool executeStep2(const std::string& p12Path, const std::string& docPath, const std::string& outPath, const std::string& password);
 }
\ No newline at end of file
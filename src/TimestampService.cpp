@@ -0,0 +1,505 @@
+#include "TimestampService.h"
+#include "Logger.h"
+#include "OpenSSLPool.h"
+#include "Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/http.h>
+#include <openssl/rand.h>
+#include <openssl/ts.h>
+
+namespace TimestampService {
+
+    const char* const kTokenOid = "1.2.840.113549.1.9.16.2.14";
+    const char* const kProofOid = "2.25.230631557958946278683567578036014024329";
+
+    using ObjectPtr = std::unique_ptr<ASN1_OBJECT, OpenSSLPool::FnDeleter<ASN1_OBJECT_free>>;
+    using TsReqPtr = std::unique_ptr<TS_REQ, OpenSSLPool::FnDeleter<TS_REQ_free>>;
+    using TsRespPtr = std::unique_ptr<TS_RESP, OpenSSLPool::FnDeleter<TS_RESP_free>>;
+    using TsImprintPtr = std::unique_ptr<TS_MSG_IMPRINT, OpenSSLPool::FnDeleter<TS_MSG_IMPRINT_free>>;
+    using TsVerifyPtr = std::unique_ptr<TS_VERIFY_CTX, OpenSSLPool::FnDeleter<TS_VERIFY_CTX_free>>;
+    using TstInfoPtr = std::unique_ptr<TS_TST_INFO, OpenSSLPool::FnDeleter<TS_TST_INFO_free>>;
+    using Pkcs7Ptr = std::unique_ptr<PKCS7, OpenSSLPool::FnDeleter<PKCS7_free>>;
+    using AlgorPtr = std::unique_ptr<X509_ALGOR, OpenSSLPool::FnDeleter<X509_ALGOR_free>>;
+    using IntegerPtr = std::unique_ptr<ASN1_INTEGER, OpenSSLPool::FnDeleter<ASN1_INTEGER_free>>;
+    using StorePtr = std::unique_ptr<X509_STORE, OpenSSLPool::FnDeleter<X509_STORE_free>>;
+
+    static const size_t kMaxReplyBytes = 1024 * 1024;
+
+    static std::mutex trustMutex;
+    static X509_STORE* trustStore = nullptr;
+
+    static std::string openSSLError(const std::string& prefix) {
+        unsigned long code = ERR_get_error();
+        ERR_clear_error();
+        if (code == 0) return prefix;
+        char buf[256];
+        ERR_error_string_n(code, buf, sizeof(buf));
+        return prefix + ": " + buf;
+    }
+
+    Config fromEnv() {
+        Config config;
+        config.url = Utils::getEnvVar("TSA_URL");
+        config.required = Utils::getEnvVar("TSA_REQUIRED", "0") == "1";
+        config.timeoutSeconds = static_cast<int>(Utils::getEnvNumber("TSA_TIMEOUT_S", config.timeoutSeconds));
+        config.windowMs = static_cast<int>(Utils::getEnvNumber("TSA_WINDOW_MS", config.windowMs));
+        config.maxBatch = static_cast<size_t>(std::max(1LL, Utils::getEnvNumber("TSA_MAX_BATCH", static_cast<long long>(config.maxBatch))));
+        config.policy = Utils::getEnvVar("TSA_POLICY");
+        return config;
+    }
+
+    Transport httpTransport(const std::string& url, int timeoutSeconds) {
+        return [url, timeoutSeconds](const std::vector<unsigned char>& query, std::vector<unsigned char>& reply, std::string& error) {
+            int ssl = 0;
+            char* host = nullptr;
+            char* port = nullptr;
+            char* path = nullptr;
+            if (!OSSL_HTTP_parse_url(url.c_str(), &ssl, nullptr, &host, &port, nullptr, &path, nullptr, nullptr) || ssl) {
+                OPENSSL_free(host);
+                OPENSSL_free(port);
+                OPENSSL_free(path);
+                ERR_clear_error();
+                error = "URL da TSA nao suportada: " + url;
+                return false;
+            }
+
+            OpenSSLPool::BioPtr body(BIO_new_mem_buf(query.data(), static_cast<int>(query.size())));
+            OpenSSLPool::BioPtr response(OSSL_HTTP_transfer(nullptr, host, port, path, 0, nullptr, nullptr, nullptr, nullptr,
+                                                            nullptr, nullptr, 0, nullptr, "application/timestamp-query",
+                                                            body.get(), "application/timestamp-reply", 1, kMaxReplyBytes,
+                                                            timeoutSeconds, 0));
+            OPENSSL_free(host);
+            OPENSSL_free(port);
+            OPENSSL_free(path);
+            if (!response) {
+                error = openSSLError("TSA indisponivel (" + url + ")");
+                return false;
+            }
+
+            reply.clear();
+            unsigned char chunk[8192];
+            int n;
+            while ((n = BIO_read(response.get(), chunk, sizeof(chunk))) > 0) reply.insert(reply.end(), chunk, chunk + n);
+            return !reply.empty();
+        };
+    }
+
+    bool requestToken(const MerkleTree::Hash& root, const Transport& transport, const std::string& policy,
+                      std::vector<unsigned char>& token, std::string& error) {
+        TsReqPtr request(TS_REQ_new());
+        TsImprintPtr imprint(TS_MSG_IMPRINT_new());
+        AlgorPtr algo(X509_ALGOR_new());
+        if (!request || !imprint || !algo) {
+            error = "sem memoria";
+            return false;
+        }
+
+        // a raiz ja eh um SHA-512: vai direto como hashedMessage
+        X509_ALGOR_set0(algo.get(), OBJ_nid2obj(NID_sha512), V_ASN1_NULL, nullptr);
+        unsigned char nonceBytes[8];
+        RAND_bytes(nonceBytes, sizeof(nonceBytes));
+        IntegerPtr nonce(ASN1_INTEGER_new());
+        BIGNUM* nonceBn = BN_bin2bn(nonceBytes, sizeof(nonceBytes), nullptr);
+        bool built = nonce && nonceBn && BN_to_ASN1_INTEGER(nonceBn, nonce.get()) &&
+                     TS_MSG_IMPRINT_set_algo(imprint.get(), algo.get()) &&
+                     TS_MSG_IMPRINT_set_msg(imprint.get(), const_cast<unsigned char*>(root.data()), static_cast<int>(root.size())) &&
+                     TS_REQ_set_version(request.get(), 1) && TS_REQ_set_msg_imprint(request.get(), imprint.get()) &&
+                     TS_REQ_set_nonce(request.get(), nonce.get()) && TS_REQ_set_cert_req(request.get(), 1);
+        BN_free(nonceBn);
+        if (built && !policy.empty()) {
+            ObjectPtr policyOid(OBJ_txt2obj(policy.c_str(), 1));
+            built = policyOid && TS_REQ_set_policy_id(request.get(), policyOid.get());
+        }
+        if (!built) {
+            error = openSSLError("falha ao montar a consulta a TSA");
+            return false;
+        }
+
+        unsigned char* der = nullptr;
+        int len = i2d_TS_REQ(request.get(), &der);
+        if (len <= 0) {
+            error = openSSLError("falha ao codificar a consulta a TSA");
+            return false;
+        }
+        std::vector<unsigned char> query(der, der + len);
+        OPENSSL_free(der);
+
+        std::vector<unsigned char> reply;
+        if (!transport(query, reply, error)) return false;
+
+        const unsigned char* p = reply.data();
+        TsRespPtr response(d2i_TS_RESP(nullptr, &p, static_cast<long>(reply.size())));
+        if (!response) {
+            error = openSSLError("resposta da TSA invalida");
+            return false;
+        }
+
+        // status, versao, imprint, nonce e politica; a assinatura da TSA eh conferida na verificacao
+        TsVerifyPtr check(TS_REQ_to_TS_VERIFY_CTX(request.get(), nullptr));
+        if (check) {
+            TS_VERIFY_CTX_set_flags(check.get(), TS_VFY_VERSION | TS_VFY_IMPRINT | TS_VFY_NONCE | (policy.empty() ? 0 : TS_VFY_POLICY));
+        }
+        if (!check || TS_RESP_verify_response(check.get(), response.get()) != 1) {
+            error = openSSLError("TSA recusou o carimbo");
+            return false;
+        }
+
+        der = nullptr;
+        len = i2d_PKCS7(TS_RESP_get_token(response.get()), &der);
+        if (len <= 0) {
+            error = openSSLError("token da TSA invalido");
+            return false;
+        }
+        token.assign(der, der + len);
+        OPENSSL_free(der);
+        return true;
+    }
+
+    bool signatureLeaf(CMS_SignerInfo* si, MerkleTree::Hash& leaf) {
+        ASN1_OCTET_STRING* signature = si ? CMS_SignerInfo_get0_signature(si) : nullptr;
+        if (!signature || ASN1_STRING_length(signature) <= 0) return false;
+
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digestLen = 0;
+        if (!EVP_Digest(ASN1_STRING_get0_data(signature), static_cast<size_t>(ASN1_STRING_length(signature)), digest, &digestLen,
+                        EVP_sha512(), nullptr)) {
+            return false;
+        }
+        leaf = MerkleTree::leafHash(digest, digestLen);
+        return true;
+    }
+
+    static void removeAttributes(CMS_SignerInfo* si, const ASN1_OBJECT* oid) {
+        int index;
+        while ((index = CMS_unsigned_get_attr_by_OBJ(si, oid, -1)) >= 0) {
+            X509_ATTRIBUTE_free(CMS_unsigned_delete_attr(si, index));
+        }
+    }
+
+    bool attach(CMS_SignerInfo* si, const Stamp& stamp) {
+        ObjectPtr tokenOid(OBJ_txt2obj(kTokenOid, 1));
+        ObjectPtr proofOid(OBJ_txt2obj(kProofOid, 1));
+        if (!si || !tokenOid || !proofOid || stamp.token.empty()) return false;
+
+        removeAttributes(si, tokenOid.get());
+        removeAttributes(si, proofOid.get());
+
+        // V_ASN1_SEQUENCE guarda a codificacao inteira: o token entra como esta
+        std::string proof = MerkleTree::encodeProof(stamp.proof);
+        return CMS_unsigned_add1_attr_by_OBJ(si, tokenOid.get(), V_ASN1_SEQUENCE, stamp.token.data(),
+                                             static_cast<int>(stamp.token.size())) &&
+               CMS_unsigned_add1_attr_by_OBJ(si, proofOid.get(), V_ASN1_OCTET_STRING, proof.data(), static_cast<int>(proof.size()));
+    }
+
+    struct Batcher::Batch {
+        std::vector<MerkleTree::Hash> leaves;
+        std::vector<Callback> callbacks;            // um por folha, na mesma ordem
+        std::chrono::steady_clock::time_point deadline;
+
+        // preenchidos pela consulta a TSA
+        std::unique_ptr<MerkleTree::Tree> tree;
+        std::vector<unsigned char> token;
+        std::string error;
+        bool ok = false;
+    };
+
+    Batcher::Batcher(const Config& config, Transport transport) : config_(config), transport_(std::move(transport)) {
+        thread_ = std::thread([this] { stage(); });
+    }
+
+    Batcher::~Batcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        thread_.join();
+    }
+
+    bool Batcher::stamp(const MerkleTree::Hash& leaf, Stamp& out, std::string& error) {
+        std::promise<bool> result;
+        std::future<bool> ready = result.get_future();
+        stampAsync(leaf, [&](bool ok, const Stamp& stamp, const std::string& failure) {
+            if (ok) out = stamp;
+            else error = failure;
+            result.set_value(ok);
+        });
+        return ready.get();
+    }
+
+    void Batcher::stampAsync(const MerkleTree::Hash& leaf, Callback done) {
+        ++requests_;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!stopping_) {
+                if (!open_) {
+                    open_.reset(new Batch());
+                    open_->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config_.windowMs);
+                }
+                open_->leaves.push_back(leaf);
+                open_->callbacks.push_back(std::move(done));
+
+                // lote cheio vai para a consulta sem esperar o resto da janela; o proximo pedido abre outro
+                if (open_->leaves.size() >= config_.maxBatch) sealed_.push_back(std::move(open_));
+                wake_.notify_one();
+                return;
+            }
+        }
+        done(false, Stamp(), "carimbo de tempo encerrado");
+    }
+
+    void Batcher::stage() {
+        while (true) {
+            std::unique_ptr<Batch> batch;
+            bool stopping;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this] { return stopping_ || open_ || !sealed_.empty(); });
+                if (sealed_.empty() && open_) {
+                    wake_.wait_until(lock, open_->deadline, [this] { return stopping_ || !sealed_.empty(); });
+                    if (sealed_.empty() && open_ && (stopping_ || std::chrono::steady_clock::now() >= open_->deadline)) {
+                        sealed_.push_back(std::move(open_));
+                    }
+                }
+                if (sealed_.empty()) {
+                    if (stopping_ && !open_) return;
+                    continue;
+                }
+                batch = std::move(sealed_.front());
+                sealed_.pop_front();
+                stopping = stopping_;
+            }
+
+            if (stopping) {
+                batch->error = "carimbo de tempo encerrado";
+            } else {
+                run(*batch);
+            }
+
+            for (size_t i = 0; i < batch->callbacks.size(); ++i) {
+                Stamp stamp;
+                if (batch->ok) {
+                    stamp.token = batch->token;
+                    stamp.proof = batch->tree->proof(static_cast<std::uint32_t>(i));
+                }
+                try {
+                    batch->callbacks[i](batch->ok, stamp, batch->error);
+                } catch (const std::exception& e) {
+                    Logger::logRateLimited(Logger::Level::Error, "tsa_callback", "Erro ao entregar carimbo", { { "erro", e.what() } });
+                }
+            }
+        }
+    }
+
+    void Batcher::run(Batch& batch) {
+        ++batches_;
+        unsigned long long size = batch.leaves.size();
+        unsigned long long largest = largestBatch_.load();
+        while (size > largest && !largestBatch_.compare_exchange_weak(largest, size)) {}
+
+        try {
+            batch.tree.reset(new MerkleTree::Tree(batch.leaves));
+            batch.ok = requestToken(batch.tree->root(), transport_, config_.policy, batch.token, batch.error);
+        } catch (const std::exception& e) {
+            batch.ok = false;
+            batch.error = e.what();
+        }
+
+        if (!batch.ok) {
+            ++failures_;
+            Logger::logRateLimited(Logger::Level::Warn, "tsa_error", "Falha no carimbo de tempo", {
+                { "erro", batch.error }, { "lote", std::to_string(size) } });
+        }
+    }
+
+    bool Batcher::stampCms(CMS_ContentInfo* cms, std::string& error) {
+        std::promise<bool> result;
+        std::future<bool> ready = result.get_future();
+        stampCmsAsync(cms, [&](bool ok, const std::string& failure) {
+            if (!ok) error = failure;
+            result.set_value(ok);
+        });
+        return ready.get();
+    }
+
+    void Batcher::stampCmsAsync(CMS_ContentInfo* cms, CmsCallback done) {
+        STACK_OF(CMS_SignerInfo)* signers = CMS_get0_SignerInfos(cms);
+        if (!signers || sk_CMS_SignerInfo_num(signers) == 0) {
+            done(false, "CMS sem SignerInfo");
+            return;
+        }
+        std::vector<MerkleTree::Hash> leaves(static_cast<size_t>(sk_CMS_SignerInfo_num(signers)));
+        for (int i = 0; i < sk_CMS_SignerInfo_num(signers); ++i) {
+            if (!signatureLeaf(sk_CMS_SignerInfo_value(signers, i), leaves[static_cast<size_t>(i)])) {
+                done(false, "SignerInfo sem assinatura");
+                return;
+            }
+        }
+
+        // o CMS so eh entregue depois que todos os SignerInfos receberam resposta
+        struct Pending {
+            std::mutex mutex;
+            size_t remaining;
+            bool ok = true;
+            std::string error;
+            CmsCallback done;
+        };
+        std::shared_ptr<Pending> pending = std::make_shared<Pending>();
+        pending->remaining = leaves.size();
+        pending->done = std::move(done);
+
+        for (int i = 0; i < sk_CMS_SignerInfo_num(signers); ++i) {
+            CMS_SignerInfo* si = sk_CMS_SignerInfo_value(signers, i);
+            stampAsync(leaves[static_cast<size_t>(i)], [pending, si](bool ok, const Stamp& stamp, const std::string& error) {
+                std::unique_lock<std::mutex> lock(pending->mutex);
+                if (pending->ok && !ok) {
+                    pending->ok = false;
+                    pending->error = error;
+                } else if (pending->ok && !attach(si, stamp)) {
+                    pending->ok = false;
+                    pending->error = openSSLError("falha ao anexar o carimbo");
+                }
+                if (--pending->remaining > 0) return;
+                lock.unlock();
+                pending->done(pending->ok, pending->error);
+            });
+        }
+    }
+
+    Stats Batcher::stats() const {
+        return Stats{ requests_.load(), batches_.load(), failures_.load(), largestBatch_.load() };
+    }
+
+    bool configureTrust(const std::string& caFile) {
+        if (caFile.empty()) {
+            std::lock_guard<std::mutex> lock(trustMutex);
+            X509_STORE_free(trustStore);
+            trustStore = nullptr;
+            return true;
+        }
+        StorePtr store(X509_STORE_new());
+        if (!store || X509_STORE_load_file(store.get(), caFile.c_str()) != 1) {
+            ERR_clear_error();
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(trustMutex);
+        X509_STORE_free(trustStore);
+        trustStore = store.release();
+        return true;
+    }
+
+    // ancoras configuradas ou, sem elas, os certificados do proprio token (so integridade)
+    static X509_STORE* verificationStore(PKCS7* token, bool& trusted) {
+        {
+            std::lock_guard<std::mutex> lock(trustMutex);
+            if (trustStore && X509_STORE_up_ref(trustStore)) {
+                trusted = true;
+                return trustStore;
+            }
+        }
+        trusted = false;
+        X509_STORE* store = X509_STORE_new();
+        STACK_OF(X509)* certs = PKCS7_type_is_signed(token) ? token->d.sign->cert : nullptr;
+        for (int i = 0; store && i < sk_X509_num(certs); ++i) X509_STORE_add_cert(store, sk_X509_value(certs, i));
+        if (store) X509_STORE_set_flags(store, X509_V_FLAG_PARTIAL_CHAIN);
+        return store;
+    }
+
+    static const ASN1_TYPE* attributeValue(CMS_SignerInfo* si, const char* oid) {
+        ObjectPtr object(OBJ_txt2obj(oid, 1));
+        int index = object ? CMS_unsigned_get_attr_by_OBJ(si, object.get(), -1) : -1;
+        if (index < 0) return nullptr;
+        return X509_ATTRIBUTE_get0_type(CMS_unsigned_get_attr(si, index), 0);
+    }
+
+    Verification verify(CMS_SignerInfo* si) {
+        Verification result;
+        const ASN1_TYPE* tokenValue = si ? attributeValue(si, kTokenOid) : nullptr;
+        if (!tokenValue) return result;
+        result.present = true;
+
+        if (tokenValue->type != V_ASN1_SEQUENCE) {
+            result.detail = "carimbo de tempo malformado";
+            return result;
+        }
+        const unsigned char* p = tokenValue->value.sequence->data;
+        Pkcs7Ptr token(d2i_PKCS7(nullptr, &p, tokenValue->value.sequence->length));
+        TstInfoPtr info(token ? PKCS7_to_TS_TST_INFO(token.get()) : nullptr);
+        if (!info) {
+            ERR_clear_error();
+            result.detail = "carimbo de tempo malformado";
+            return result;
+        }
+
+        OpenSSLPool::PooledMemBio time;
+        ASN1_GENERALIZEDTIME_print(time.get(), TS_TST_INFO_get_time(info.get()));
+        result.genTime = time.str();
+
+        ASN1_OCTET_STRING* signature = CMS_SignerInfo_get0_signature(si);
+        TS_MSG_IMPRINT* imprint = TS_TST_INFO_get_msg_imprint(info.get());
+        ASN1_OCTET_STRING* stamped = TS_MSG_IMPRINT_get_msg(imprint);
+        std::vector<unsigned char> expected;
+
+        const ASN1_TYPE* proofValue = attributeValue(si, kProofOid);
+        if (proofValue) {
+            // carimbo agregado: a prova leva da folha desta assinatura a raiz carimbada
+            MerkleTree::Proof proof;
+            MerkleTree::Hash leaf;
+            MerkleTree::Hash root{};
+            bool decoded = proofValue->type == V_ASN1_OCTET_STRING &&
+                           MerkleTree::decodeProof(std::string(reinterpret_cast<const char*>(proofValue->value.octet_string->data),
+                                                               static_cast<size_t>(proofValue->value.octet_string->length)), proof);
+            if (!decoded || !signatureLeaf(si, leaf) || ASN1_STRING_length(stamped) != static_cast<int>(root.size())) {
+                result.detail = "prova do carimbo de tempo malformada";
+                return result;
+            }
+            std::copy(ASN1_STRING_get0_data(stamped), ASN1_STRING_get0_data(stamped) + root.size(), root.begin());
+            if (!MerkleTree::verifyProof(leaf, proof, root)) {
+                result.detail = "carimbo de tempo nao cobre esta assinatura";
+                return result;
+            }
+            result.batchSize = proof.leafCount;
+            expected.assign(root.begin(), root.end());
+        } else {
+            // signatureTimeStampToken comum (outra ferramenta): imprint = hash do valor da assinatura
+            const ASN1_OBJECT* algo = nullptr;
+            X509_ALGOR_get0(&algo, nullptr, nullptr, TS_MSG_IMPRINT_get_algo(imprint));
+            const EVP_MD* md = algo ? EVP_get_digestbyobj(algo) : nullptr;
+            unsigned char digest[EVP_MAX_MD_SIZE];
+            unsigned int digestLen = 0;
+            if (!md || !signature || !EVP_Digest(ASN1_STRING_get0_data(signature), static_cast<size_t>(ASN1_STRING_length(signature)),
+                                                 digest, &digestLen, md, nullptr)) {
+                result.detail = "algoritmo do carimbo de tempo nao suportado";
+                return result;
+            }
+            result.batchSize = 1;
+            expected.assign(digest, digest + digestLen);
+        }
+
+        TsVerifyPtr ctx(TS_VERIFY_CTX_new());
+        X509_STORE* store = verificationStore(token.get(), result.trusted);
+        unsigned char* imprintCopy = static_cast<unsigned char*>(OPENSSL_memdup(expected.data(), expected.size()));
+        if (!ctx || !store || !imprintCopy) {
+            X509_STORE_free(store);
+            OPENSSL_free(imprintCopy);
+            result.detail = "sem memoria";
+            return result;
+        }
+        // o contexto assume store e imprint
+        TS_VERIFY_CTX_set_flags(ctx.get(), TS_VFY_VERSION | TS_VFY_SIGNATURE | TS_VFY_IMPRINT);
+        TS_VERIFY_CTX_set_store(ctx.get(), store);
+        TS_VERIFY_CTX_set_imprint(ctx.get(), imprintCopy, static_cast<long>(expected.size()));
+
+        if (TS_RESP_verify_token(ctx.get(), token.get()) != 1) {
+            result.detail = openSSLError("token da TSA invalido");
+            result.trusted = false;
+            return result;
+        }
+        result.valid = true;
+        return result;
+    }
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <openssl/cms.h>
+#include "MerkleTree.h"
+
+// Carimbo de tempo RFC 3161 agregado por arvore de Merkle.
+// Assinaturas que chegam dentro de uma janela curta formam um lote; a folha de
+// cada uma eh o hash do valor da assinatura (o mesmo dado que o
+// signatureTimeStampToken carimba) e a TSA recebe uma unica consulta com a raiz
+// como messageImprint (SHA-512). Cada SignerInfo leva dois atributos nao
+// assinados: o TimeStampToken da raiz (id-aa-signatureTimeStampToken) e a prova
+// de inclusao da sua folha (formato MerkleTree::encodeProof).
+// Um lote de tamanho 1 eh um carimbo comum sobre leafHash(assinatura).
+namespace TimestampService {
+
+    // id-aa-signatureTimeStampToken (RFC 3161 apendice A)
+    extern const char* const kTokenOid;
+    // prova de inclusao na raiz carimbada (OID 2.25 derivado de UUID, ITU-T X.667)
+    extern const char* const kProofOid;
+
+    struct Config {
+        std::string url;                // TSA (http); vazio desliga o carimbo
+        bool required = false;          // sem carimbo a assinatura falha (senao segue sem)
+        int timeoutSeconds = 10;
+        int windowMs = 20;              // quanto o primeiro pedido de um lote espera por outros
+        size_t maxBatch = 256;          // lote cheio eh enviado sem esperar a janela
+        std::string policy;             // reqPolicy opcional (OID)
+    };
+
+    // TSA_URL, TSA_REQUIRED, TSA_TIMEOUT_S, TSA_WINDOW_MS, TSA_MAX_BATCH, TSA_POLICY
+    Config fromEnv();
+
+    // Envia um TimeStampReq (DER) e devolve o TimeStampResp (DER)
+    using Transport = std::function<bool(const std::vector<unsigned char>& query, std::vector<unsigned char>& reply,
+                                         std::string& error)>;
+
+    // POST application/timestamp-query (apenas http, como o cliente HTTP do OpenSSL sem TLS)
+    Transport httpTransport(const std::string& url, int timeoutSeconds);
+
+    // Consulta a TSA com root como messageImprint; token recebe o TimeStampToken (ContentInfo DER).
+    // Confere status, versao, imprint e nonce da resposta; a assinatura da TSA fica para a verificacao
+    bool requestToken(const MerkleTree::Hash& root, const Transport& transport, const std::string& policy,
+                      std::vector<unsigned char>& token, std::string& error);
+
+    // leafHash(SHA-512(valor da assinatura do SignerInfo))
+    bool signatureLeaf(CMS_SignerInfo* si, MerkleTree::Hash& leaf);
+
+    struct Stamp {
+        std::vector<unsigned char> token;
+        MerkleTree::Proof proof;
+    };
+
+    // Grava token e prova como atributos nao assinados (substituindo carimbos anteriores)
+    bool attach(CMS_SignerInfo* si, const Stamp& stamp);
+
+    struct Stats {
+        unsigned long long requests;    // assinaturas carimbadas (ou tentadas)
+        unsigned long long batches;     // consultas a TSA
+        unsigned long long failures;    // lotes sem carimbo
+        unsigned long long largestBatch;
+    };
+
+    // Agrupa pedidos concorrentes numa etapa propria de carimbo: a thread do Batcher
+    // fecha o lote quando a janela acaba (ou ele enche), consulta a TSA e entrega a
+    // cada pedido a prova da propria folha. Quem pede nao ocupa uma thread durante a
+    // espera (stampAsync retorna na hora), entao o lote pode ser maior que o numero de
+    // threads de criptografia. Uma consulta por vez: enquanto ela dura, os pedidos
+    // novos se acumulam no proximo lote. Seguro para varias threads.
+    class Batcher {
+    public:
+        // roda na thread do Batcher: deve ser curto e nao pode chamar stamp()
+        using Callback = std::function<void(bool ok, const Stamp& stamp, const std::string& error)>;
+        using CmsCallback = std::function<void(bool ok, const std::string& error)>;
+
+        Batcher(const Config& config, Transport transport);
+        ~Batcher();
+
+        Batcher(const Batcher&) = delete;
+        Batcher& operator=(const Batcher&) = delete;
+
+        // bloqueia ate o lote do pedido ser carimbado
+        bool stamp(const MerkleTree::Hash& leaf, Stamp& out, std::string& error);
+        void stampAsync(const MerkleTree::Hash& leaf, Callback done);
+
+        // carimba todos os SignerInfos do CMS (um pedido por SignerInfo)
+        bool stampCms(CMS_ContentInfo* cms, std::string& error);
+        // done roda depois do ultimo carimbo anexado; cms precisa existir ate la
+        void stampCmsAsync(CMS_ContentInfo* cms, CmsCallback done);
+
+        Stats stats() const;
+        const Config& config() const { return config_; }
+
+    private:
+        struct Batch;
+
+        void stage();
+        void run(Batch& batch);
+
+        Config config_;
+        Transport transport_;
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::unique_ptr<Batch> open_;               // recebendo pedidos ate a janela acabar
+        std::deque<std::unique_ptr<Batch>> sealed_; // cheios, aguardando a consulta
+        bool stopping_ = false;
+        std::thread thread_;
+
+        std::atomic<unsigned long long> requests_{ 0 };
+        std::atomic<unsigned long long> batches_{ 0 };
+        std::atomic<unsigned long long> failures_{ 0 };
+        std::atomic<unsigned long long> largestBatch_{ 0 };
+    };
+
+    struct Verification {
+        bool present = false;           // SignerInfo tem carimbo
+        bool valid = false;             // token integro, imprint = raiz e prova confere
+        bool trusted = false;           // cadeia da TSA confere com TSA_CA_FILE
+        std::string genTime;
+        unsigned batchSize = 0;
+        std::string detail;             // motivo quando invalido
+    };
+
+    // Ancoras para a cadeia da TSA (PEM); sem ancoras o token eh conferido so contra o
+    // certificado que ele mesmo traz (integridade, trusted = false). Caminho vazio remove as ancoras
+    bool configureTrust(const std::string& caFile);
+
+    Verification verify(CMS_SignerInfo* si);
+}
@@ -0,0 +1,85 @@
+#include "TlsContext.h"
+#include "OpenSSLPool.h"
+#include "SignerService.h"
+#include "Utils.h"
+#include <fstream>
+#include <stdexcept>
+#include <openssl/ssl.h>
+
+namespace TlsContext {
+
+    Settings fromEnv() {
+        Settings settings;
+        settings.enabled = Utils::getEnvVar("TLS_ENABLED", "0") == "1";
+        settings.p12Path = Utils::getEnvVar("TLS_P12_FILE", "resources/pkcs12/certificado_teste_hub.pfx");
+        settings.p12Password = Utils::getEnvVar("TLS_P12_PASSWORD", Utils::getEnvVar("P12_PASSWORD"));
+        settings.tls13Only = Utils::getEnvVar("TLS_MIN_VERSION", "1.2") == "1.3";
+        settings.sessionCacheSize = static_cast<int>(Utils::getEnvNumber("TLS_SESSION_CACHE_SIZE", 20480));
+        settings.sessionTimeoutSeconds = static_cast<int>(Utils::getEnvNumber("TLS_SESSION_TIMEOUT_S", 7200));
+        settings.ticketsPerHandshake = static_cast<int>(Utils::getEnvNumber("TLS_TICKETS", 2));
+        return settings;
+    }
+
+    std::string generateTicketKeys() {
+        std::string keys(80, '\0');
+        std::ifstream random("/dev/urandom", std::ios::binary);
+        if (!random.read(&keys[0], static_cast<std::streamsize>(keys.size()))) return "";
+        return keys;
+    }
+
+    Poco::Net::Context::Ptr createServerContext(const Settings& settings) {
+        // sem verificacao de cliente: a autenticacao eh feita na camada de aplicacao
+        Poco::Net::Context::Params params;
+        params.verificationMode = Poco::Net::Context::VERIFY_NONE;
+        params.loadDefaultCAs = false;
+
+        Poco::Net::Context::Ptr context = new Poco::Net::Context(Poco::Net::Context::TLS_SERVER_USE, params);
+        context->requireMinimumProtocol(settings.tls13Only 
+            ? Poco::Net::Context::PROTO_TLSV1_3 
+            : Poco::Net::Context::PROTO_TLSV1_2);
+
+        // certificado e cadeia vem do mesmo formato P12 usado na assinatura
+        PKCS12* p12 = nullptr;
+        EVP_PKEY* pkey = nullptr;
+        X509* cert = nullptr;
+        STACK_OF(X509)* ca = nullptr;
+        bool loaded = SignerService::loadCredentials(settings.p12Path, settings.p12Password, &p12, &pkey, &cert, &ca);
+
+        OpenSSLPool::P12Ptr p12Guard(p12);
+        OpenSSLPool::PkeyPtr pkeyGuard(pkey);
+        OpenSSLPool::X509Ptr certGuard(cert);
+        OpenSSLPool::X509StackPtr caGuard(ca);
+
+        if (!loaded) {
+            throw std::runtime_error("Falha ao carregar o certificado TLS: " + settings.p12Path);
+        }
+
+        SSL_CTX* ctx = context->sslContext();
+        if (SSL_CTX_use_certificate(ctx, cert) != 1 ||
+            SSL_CTX_use_PrivateKey(ctx, pkey) != 1 ||
+            SSL_CTX_check_private_key(ctx) != 1) {
+            Utils::printOpenSSLError("Falha ao configurar o certificado TLS");
+            throw std::runtime_error("Certificado TLS invalido: " + settings.p12Path);
+        }
+        for (int i = 0; ca && i < sk_X509_num(ca); ++i) {
+            SSL_CTX_add1_chain_cert(ctx, sk_X509_value(ca, i));
+        }
+
+        // resumption: cache de sessao com estado (TLS 1.2) e tickets sem estado (TLS 1.2/1.3)
+        context->enableSessionCache(true, "Bry_API");
+        context->setSessionCacheSize(static_cast<std::size_t>(settings.sessionCacheSize));
+        context->setSessionTimeout(settings.sessionTimeoutSeconds);
+        SSL_CTX_clear_options(ctx, SSL_OP_NO_TICKET);
+        SSL_CTX_set_num_tickets(ctx, static_cast<size_t>(settings.ticketsPerHandshake));
+        if (!settings.ticketKeys.empty() &&
+            SSL_CTX_set_tlsext_ticket_keys(ctx, const_cast<char*>(settings.ticketKeys.data()),
+                                           static_cast<long>(settings.ticketKeys.size())) != 1) {
+            Utils::printOpenSSLError("Falha ao configurar as chaves de session ticket");
+            throw std::runtime_error("Chaves de session ticket invalidas");
+        }
+
+        Utils::logInfo("TLS habilitado (minimo " + std::string(settings.tls13Only ? "1.3" : "1.2") + 
+                       ", cache de sessao " + std::to_string(settings.sessionCacheSize) + ")");
+        return context;
+    }
+}
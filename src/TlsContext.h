@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include "Poco/Net/Context.h"
+
+namespace TlsContext {
+
+    struct Settings {
+        bool enabled;
+        std::string p12Path;            // Certificado e chave do servidor
+        std::string p12Password;
+        bool tls13Only;                 // false = TLS 1.2 e 1.3
+        int sessionCacheSize;           // Entradas no cache de sessao do servidor
+        int sessionTimeoutSeconds;      // Validade de sessoes e tickets
+        int ticketsPerHandshake;        // Tickets TLS 1.3 emitidos por handshake completo
+        std::string ticketKeys;         // 80 bytes (nome, HMAC, AES); vazio = chaves proprias do SSL_CTX
+    };
+
+    // Le TLS_* do ambiente (.env ja carregado)
+    Settings fromEnv();
+
+    // Chaves de session ticket sorteadas de /dev/urandom, sem passar pelo OpenSSL (o supervisor
+    // do pre-fork nao o inicializa). Geradas antes do fork, valem para todos os workers: um
+    // ticket emitido por um worker eh aceito pelos outros. Vazio se indisponivel
+    std::string generateTicketKeys();
+
+    // Cria o unico SSL_CTX do servidor, compartilhado por todas as conexoes,
+    // com cache de sessao e session tickets habilitados para resumption
+    Poco::Net::Context::Ptr createServerContext(const Settings& settings);
+}
@@ -1,14 +1,83 @@
 #pragma once
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
 #include <openssl/err.h>
+#include "Logger.h"
 
 namespace Utils {
+    // esvazia a fila de erros do OpenSSL da thread atual em uma unica linha
+    inline std::string drainOpenSSLErrors() {
+        std::string errors;
+        char buf[256];
+        unsigned long code;
+        while ((code = ERR_get_error()) != 0) {
+            ERR_error_string_n(code, buf, sizeof(buf));
+            if (!errors.empty()) errors += " | ";
+            errors += buf;
+        }
+        return errors;
+    }
+
+    // limitado por mensagem: assinaturas invalidas em massa nao podem inundar o log
     inline void printOpenSSLError(const std::string& message) {
-        std::cerr << "[ERROR] " << message << std::endl;
-        ERR_print_errors_fp(stderr);
+        std::string errors = drainOpenSSLErrors();
+        Logger::Fields fields;
+        if (!errors.empty()) fields.emplace_back("openssl", "\"" + errors + "\"");
+        Logger::logRateLimited(Logger::Level::Error, message, message, fields);
     }
 
     inline void logInfo(const std::string& message) {
-        std::cout << "[INFO] " << message << std::endl;
+        Logger::log(Logger::Level::Info, message);
+    }
+
+    inline void loadEnvFile() {
+        std::ifstream file(".env");
+        if (!file.is_open()) {
+            logInfo("Aviso: Arquivo .env nao encontrado. Usando variaveis do sistema ou padroes.");
+            return;
+        }
+
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') continue;
+
+            size_t delimiterPos = line.find('=');
+            if (delimiterPos != std::string::npos) {
+                std::string key = line.substr(0, delimiterPos);
+                std::string value = line.substr(delimiterPos + 1);
+
+                // Remove \r (comum em arquivos editados no Windows)
+                if (!value.empty() && value.back() == '\r') value.pop_back();
+
+                // Lógica Cross-Platform
+                #ifdef _WIN32
+                    _putenv_s(key.c_str(), value.c_str());
+                #else
+                    setenv(key.c_str(), value.c_str(), 1);
+                #endif
+            }
+        }
+        logInfo("Configuracao carregada do arquivo .env");
+    }
+
+    inline std::string getEnvVar(const std::string& key, const std::string& defaultValue = "") {
+        const char* val = std::getenv(key.c_str());
+        if (val == nullptr) {
+            return defaultValue;
+        }
+        return std::string(val);
+    }
+
+    // le variavel numerica do ambiente, mantendo o padrao se ausente ou invalida
+    inline long long getEnvNumber(const std::string& key, long long defaultValue) {
+        std::string val = getEnvVar(key);
+        if (val.empty()) return defaultValue;
+        try {
+            return std::stoll(val);
+        } catch (const std::exception&) {
+            return defaultValue;
+        }
     }
-}
\ No newline at end of file
+}
@@ -1,81 +1,53 @@
 #include "VerifierService.h"
+#include "CmsEdDSA.h"
+#include "DigestService.h"
+#include "MerkleTree.h"
+#include "OpenSSLPool.h"
+#include "SignerService.h"
+#include "TimestampService.h"
 #include "Utils.h"
 #include <openssl/bio.h>
 #include <openssl/x509.h>
 #include <openssl/asn1.h>
 #include <openssl/err.h>
-#include <iomanip>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
 #include <sstream>
+#include <vector>
 
 namespace VerifierService {
 
     CMS_ContentInfo* loadCMS(const std::string& signaturePath) {
-        BIO* in = BIO_new_file(signaturePath.c_str(), "rb");
+        OpenSSLPool::BioPtr in(BIO_new_file(signaturePath.c_str(), "rb"));
         if (!in) return nullptr;
-        CMS_ContentInfo* cms = d2i_CMS_bio(in, nullptr);
-        BIO_free(in);
-        return cms;
+        return d2i_CMS_bio(in.get(), nullptr);
     }
 
     std::string bytesToHex(const unsigned char* bytes, int len) {
-        std::stringstream ss;
-        ss << std::hex << std::uppercase << std::setfill('0');
-        for (int i = 0; i < len; ++i) {
-            ss << std::setw(2) << (int)bytes[i];
-        }
-        return ss.str();
+        return OpenSSLPool::toHex(bytes, static_cast<size_t>(len), true);
     }
 
     std::string asn1TimeToString(ASN1_TIME* time) {
         if (!time) return "";
-        BIO* b = BIO_new(BIO_s_mem());
-        ASN1_TIME_print(b, time);
-        char* data;
-        long len = BIO_get_mem_data(b, &data);
-        std::string str(data, len);
-        BIO_free(b);
-        return str;
+        OpenSSLPool::PooledMemBio b;
+        ASN1_TIME_print(b.get(), time);
+        return b.str();
     }
 
-    VerificationResult verifyAndGetDetails(const std::string& signaturePath) {
-        VerificationResult res;
-        res.isValid = false;
-        res.status = "INVALIDO";
-
-        CMS_ContentInfo* cms = loadCMS(signaturePath);
-        if (!cms) return res;
-
-        // bio de saida eh obrigatorio no verify mesmo descartando conteudo
-        BIO* out = BIO_new(BIO_s_mem()); 
-        if (!out) {
-            CMS_ContentInfo_free(cms);
-            return res;
-        }
-        
-        // verifica apenas integridade ignora cadeia de confianca ca raiz
-        int flags = CMS_BINARY | CMS_NO_SIGNER_CERT_VERIFY;
-        
-        if (CMS_verify(cms, nullptr, nullptr, nullptr, out, flags)) {
-            res.isValid = true;
-            res.status = "VALIDO";
-        } else {
-            fprintf(stderr, "\n[OPENSSL ERROR STACK START]\n");
-            ERR_print_errors_fp(stderr);
-            fprintf(stderr, "[OPENSSL ERROR STACK END]\n\n");
-            Utils::printOpenSSLError("Falha na verificacao da assinatura");
-        }
-
-        BIO_free(out);
-        
-        // extrai metadados como signatario data e hash
+    // preenche signatario, data, hash e algoritmo a partir do primeiro SignerInfo
+    template <typename Result>
+    void fillSignerDetails(CMS_ContentInfo* cms, Result& res) {
         STACK_OF(CMS_SignerInfo)* signers = CMS_get0_SignerInfos(cms);
         if (signers && sk_CMS_SignerInfo_num(signers) > 0) {
             CMS_SignerInfo* si = sk_CMS_SignerInfo_value(signers, 0);
-            
+        
             // retorna pilha nova que precisa ser liberada mas certificados sao ponteiros internos
-            STACK_OF(X509)* certs = CMS_get0_signers(cms);
-            if (certs && sk_X509_num(certs) > 0) {
-                X509* cert = sk_X509_value(certs, 0);
+            OpenSSLPool::X509StackRefPtr certs(CMS_get0_signers(cms));
+            if (certs && sk_X509_num(certs.get()) > 0) {
+                X509* cert = sk_X509_value(certs.get(), 0);
                 X509_NAME* subject = X509_get_subject_name(cert);
 
                 char cn[256] = {0};
@@ -90,7 +62,6 @@ namespace VerifierService {
                         OPENSSL_free(subject_str);
                     }
                 }
-                sk_X509_free(certs); 
             }
 
             int timeIdx = CMS_signed_get_attr_by_NID(si, NID_pkcs9_signingTime, -1);
@@ -122,9 +93,10 @@ namespace VerifierService {
                     }
                 }
             }
-            
+        
             X509_ALGOR* digestAlg = nullptr;
-            CMS_SignerInfo_get0_algs(si, nullptr, nullptr, &digestAlg, nullptr);
+            X509_ALGOR* signatureAlg = nullptr;
+            CMS_SignerInfo_get0_algs(si, nullptr, nullptr, &digestAlg, &signatureAlg);
             if (digestAlg) {
                 const ASN1_OBJECT* oid = nullptr;
                 X509_ALGOR_get0(&oid, nullptr, nullptr, digestAlg);
@@ -134,9 +106,599 @@ namespace VerifierService {
                     res.hashAlgo = std::string(buf);
                 }
             }
+            if (signatureAlg) {
+                const ASN1_OBJECT* oid = nullptr;
+                X509_ALGOR_get0(&oid, nullptr, nullptr, signatureAlg);
+                if (oid) {
+                    char buf[128];
+                    OBJ_obj2txt(buf, sizeof(buf), oid, 0);
+                    res.signatureAlgo = std::string(buf);
+                }
+            }
+        }
+    }
+
+    // carimbo de tempo nao assinado do primeiro signatario; carimbo invalido nao derruba a assinatura,
+    // apenas deixa de servir como prova de existencia
+    static void fillTimestamp(CMS_ContentInfo* cms, VerificationResult& res) {
+        STACK_OF(CMS_SignerInfo)* signers = CMS_get0_SignerInfos(cms);
+        if (!signers || sk_CMS_SignerInfo_num(signers) == 0) return;
+
+        TimestampService::Verification stamp = TimestampService::verify(sk_CMS_SignerInfo_value(signers, 0));
+        if (!stamp.present) return;
+        res.timestamp = stamp.valid ? "VALIDO" : "INVALIDO";
+        res.timestampTime = stamp.genTime;
+        res.timestampTrusted = stamp.trusted;
+        res.timestampBatch = stamp.batchSize;
+        if (!stamp.valid) Utils::logInfo("Carimbo de tempo invalido: " + stamp.detail);
+    }
+
+    // true se issuer assinou cert (X509_check_issued so compara nome, AKID e keyUsage)
+    static bool signedBy(X509* cert, X509* issuer) {
+        if (X509_cmp(issuer, cert) == 0 || X509_check_issued(issuer, cert) != X509_V_OK) return false;
+        EVP_PKEY* key = X509_get0_pubkey(issuer);
+        bool ok = key && X509_verify(cert, key) == 1;
+        ERR_clear_error();
+        return ok;
+    }
+
+    // emissor do signatario: primeiro no indice local (confiavel), depois entre os certificados
+    // do CMS, que qualquer um pode montar; trusted indica de onde ele veio
+    static X509* findIssuer(CMS_ContentInfo* cms, X509* signer, const CertIndex::Index* index, OpenSSLPool::X509StackPtr& embedded,
+                            bool& trusted) {
+        trusted = false;
+        if (X509* known = index ? index->findIssuer(signer) : nullptr) {
+            trusted = true;
+            return known;
+        }
+        embedded.reset(CMS_get1_certs(cms));
+        for (int i = 0; embedded && i < sk_X509_num(embedded.get()); ++i) {
+            X509* candidate = sk_X509_value(embedded.get(), i);
+            if (signedBy(signer, candidate)) return candidate;
         }
+        return nullptr;
+    }
+
+    static std::vector<std::vector<unsigned char>> readStapledOcsp(std::istream& in);
+
+    // streambuf somente leitura sobre memoria de terceiros (sem copia), com seek para os leitores DER
+    class MemoryBuffer : public std::streambuf {
+    public:
+        MemoryBuffer(const unsigned char* data, size_t length) {
+            char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+            setg(begin, begin, begin + length);
+        }
+
+    protected:
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+            if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+            off_type base = dir == std::ios_base::beg ? 0 : dir == std::ios_base::cur ? gptr() - eback() : egptr() - eback();
+            off_type target = base + off;
+            if (target < 0 || target > egptr() - eback()) return pos_type(off_type(-1));
+            setg(eback(), eback() + target, egptr());
+            return pos_type(target);
+        }
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+            return seekoff(off_type(pos), std::ios_base::beg, which);
+        }
+    };
+
+    // raw: a mesma assinatura em bytes, de onde saem as respostas OCSP grampeadas
+    static void applyRevocation(CMS_ContentInfo* cms, std::istream& raw, const CertIndex::Index* index,
+                                RevocationService::Checker& revocation, VerificationResult& res) {
+        OpenSSLPool::X509StackRefPtr signers(CMS_get0_signers(cms));
+        X509* signer = signers && sk_X509_num(signers.get()) > 0 ? sk_X509_value(signers.get(), 0) : nullptr;
+
+        OpenSSLPool::X509StackPtr embeddedCerts;
+        bool issuerTrusted = false;
+        X509* issuer = signer ? findIssuer(cms, signer, index, embeddedCerts, issuerTrusted) : nullptr;
+
+        // OCSP grampeado e CRLs que vieram no proprio CMS evitam ida a rede
+        RevocationService::Embedded embedded;
+        embedded.ocspResponses = readStapledOcsp(raw);
+        STACK_OF(X509_CRL)* crls = CMS_get1_crls(cms);
+        embedded.crls = crls;
+
+        RevocationService::Result status = revocation.check(signer, issuer, embedded, issuerTrusted);
+        sk_X509_CRL_pop_free(crls, X509_CRL_free);
+
+        res.revocation = RevocationService::statusName(status.status);
+        res.revocationDetail = status.detail;
+
+        bool reject = status.status == RevocationService::Status::Revoked ||
+                      (status.status == RevocationService::Status::Unknown && revocation.config().hardFail);
+        if (reject) {
+            res.isValid = false;
+            res.status = "INVALIDO";
+            Utils::logInfo("Certificado do signatario " + res.revocation + ": " + status.detail);
+        }
+    }
+
+    // Assinatura, signatario e carimbo de tempo de um CMS ja carregado
+    static void verifyLoaded(CMS_ContentInfo* cms, const CertIndex::Index* index, VerificationResult& res) {
+        // sem certificado embutido nem no indice o CMS_verify falha com signer certificate not found
+        CertIndex::resolveSigners(cms, index);
+
+        // bio de saida eh obrigatorio no verify mesmo descartando conteudo: o BIO nulo nao
+        // guarda o documento encapsulado
+        OpenSSLPool::BioPtr out(BIO_new(BIO_s_null()));
+        if (!out) {
+            return;
+        }
+        
+        // verifica apenas integridade ignora cadeia de confianca ca raiz
+        int flags = CMS_BINARY | CMS_NO_SIGNER_CERT_VERIFY;
+        
+        if (CmsEdDSA::verify(cms, out.get(), flags)) {
+            res.isValid = true;
+            res.status = "VALIDO";
+        } else {
+            Utils::printOpenSSLError("Falha na verificacao da assinatura");
+        }
+
+        // extrai metadados como signatario data e hash
+        fillSignerDetails(cms, res);
+
+        if (res.isValid) fillTimestamp(cms, res);
+    }
+
+    VerificationResult verifyAndGetDetails(const std::string& signaturePath, const CertIndex::Index* index,
+                                           RevocationService::Checker* revocation) {
+        VerificationResult res;
+        res.isValid = false;
+        res.status = "INVALIDO";
+
+        OpenSSLPool::CmsPtr cms(loadCMS(signaturePath));
+        if (!cms) return res;
+
+        verifyLoaded(cms.get(), index, res);
+        if (res.isValid && revocation) {
+            std::ifstream raw(signaturePath, std::ios::binary);
+            applyRevocation(cms.get(), raw, index, *revocation, res);
+        }
+
+        return res;
+    }
+
+    VerificationResult verifyBuffer(const unsigned char* data, size_t length, const CertIndex::Index* index,
+                                    RevocationService::Checker* revocation) {
+        VerificationResult res;
+        res.isValid = false;
+        res.status = "INVALIDO";
+        if (!data || length == 0 || length > static_cast<size_t>(INT_MAX)) return res;
+
+        // BIO somente leitura sobre o buffer: o d2i le direto dele
+        OpenSSLPool::BioPtr in(BIO_new_mem_buf(data, static_cast<int>(length)));
+        if (!in) return res;
+        OpenSSLPool::CmsPtr cms(d2i_CMS_bio(in.get(), nullptr));
+        if (!cms) return res;
+
+        verifyLoaded(cms.get(), index, res);
+        if (res.isValid && revocation) {
+            MemoryBuffer buffer(data, length);
+            std::istream raw(&buffer);
+            applyRevocation(cms.get(), raw, index, *revocation, res);
+        }
+
+        return res;
+    }
+
+
+    static bool isBatchRoot(CMS_ContentInfo* cms) {
+        using ObjectPtr = std::unique_ptr<ASN1_OBJECT, OpenSSLPool::FnDeleter<ASN1_OBJECT_free>>;
+        ObjectPtr batchRoot(OBJ_txt2obj(SignerService::kBatchRootOid, 1));
+        const ASN1_OBJECT* contentType = CMS_get0_eContentType(cms);
+        STACK_OF(CMS_SignerInfo)* signers = CMS_get0_SignerInfos(cms);
+        if (!batchRoot || !contentType || OBJ_cmp(contentType, batchRoot.get()) != 0 || sk_CMS_SignerInfo_num(signers) <= 0) {
+            return false;
+        }
+        for (int i = 0; i < sk_CMS_SignerInfo_num(signers); ++i) {
+            const ASN1_OBJECT* signedType = static_cast<const ASN1_OBJECT*>(CMS_signed_get0_data_by_OBJ(
+                sk_CMS_SignerInfo_value(signers, i), OBJ_nid2obj(NID_pkcs9_contentType), -3, V_ASN1_OBJECT));
+            if (!signedType || OBJ_cmp(signedType, batchRoot.get()) != 0) return false;
+        }
+        return true;
+    }
+
+    VerificationResult verifyWithProof(const std::string& docPath, const std::string& proofPath, const std::string& signaturePath,
+                                       const CertIndex::Index* index) {
+        VerificationResult res;
+        res.isValid = false;
+        res.status = "INVALIDO";
+
+        MerkleTree::Proof proof;
+        if (!MerkleTree::readProof(proofPath, proof)) {
+            Utils::logInfo("Prova de inclusao invalida: " + proofPath);
+            return res;
+        }
+
+        std::vector<unsigned char> digest = DigestService::calculateSHA512Bytes(docPath);
+        if (digest.empty()) return res;
+
+        OpenSSLPool::CmsPtr cms(loadCMS(signaturePath));
+        if (!cms) return res;
+        CertIndex::resolveSigners(cms.get(), index);
+
+        // o conteudo encapsulado da assinatura do lote eh a raiz da arvore
+        OpenSSLPool::PooledMemBio out;
+        if (!out.get()) {
+            return res;
+        }
+
+        int flags = CMS_BINARY | CMS_NO_SIGNER_CERT_VERIFY;
+        if (!CmsEdDSA::verify(cms.get(), out.get(), flags)) {
+            Utils::printOpenSSLError("Falha na verificacao da assinatura do lote");
+            return res;
+        }
+
+        // so vale como lote o CMS marcado como raiz de lote, no eContentType e no contentType
+        // assinado de cada SignerInfo (o eContentType sozinho nao eh coberto pela assinatura)
+        if (!isBatchRoot(cms.get())) {
+            Utils::logInfo("Assinatura nao corresponde a um lote: " + signaturePath);
+            return res;
+        }
+
+        std::string rootBytes = out.str();
+        MerkleTree::Hash root{};
+        if (rootBytes.size() != root.size()) {
+            Utils::logInfo("Assinatura nao corresponde a um lote: " + signaturePath);
+            return res;
+        }
+        std::copy(rootBytes.begin(), rootBytes.end(), root.begin());
+
+        MerkleTree::Hash leaf = MerkleTree::leafHash(digest.data(), digest.size());
+        if (MerkleTree::verifyProof(leaf, proof, root)) {
+            res.isValid = true;
+            res.status = "VALIDO";
+        } else {
+            Utils::logInfo("Documento nao pertence ao lote assinado: " + docPath);
+        }
+
+        fillSignerDetails(cms.get(), res);
+
+        // o messageDigest assinado eh o da raiz; reporta o hash do proprio documento
+        res.hashHex = bytesToHex(digest.data(), static_cast<int>(digest.size()));
+
+        return res;
+    }
+
+    // ------------------------------------------------------------------
+    // Leitura DER/BER minima usada pela inspecao: permite pular o conteudo
+    // encapsulado com seek, sem passar os bytes pelo parser ASN.1
+    // ------------------------------------------------------------------
+    struct DerHeader {
+        unsigned char tag = 0;      // octeto identificador (apenas low-tag-number)
+        bool indefinite = false;
+        std::uint64_t length = 0;
+    };
+
+    // length cabe nos bytes que restam depois da posicao atual (comparacao sem cast para streamoff)
+    static bool fitsInStream(std::istream& in, std::streamoff size, std::uint64_t length) {
+        std::streamoff pos = in.tellg();
+        return pos >= 0 && size >= pos && length <= static_cast<std::uint64_t>(size - pos);
+    }
+
+    // tamanho do stream, medido uma vez antes do parse; -1 se nao der para medir
+    static std::streamoff streamSize(std::istream& in) {
+        std::streamoff pos = in.tellg();
+        in.seekg(0, std::ios::end);
+        std::streamoff size = in.tellg();
+        in.seekg(pos);
+        return (in && pos >= 0) ? size : -1;
+    }
+
+    // size: tamanho do stream. Um comprimento maior que o resto do arquivo eh recusado aqui,
+    // entao os seeks e as somas tellg + length adiante nunca estouram nem andam para tras
+    bool readDerHeader(std::istream& in, std::streamoff size, DerHeader& h) {
+        int id = in.get();
+        if (id == EOF || (id & 0x1F) == 0x1F) return false;
+        h.tag = static_cast<unsigned char>(id);
+        h.indefinite = false;
+        h.length = 0;
+
+        int first = in.get();
+        if (first == EOF) return false;
+        if (first < 0x80) {
+            h.length = static_cast<std::uint64_t>(first);
+            return fitsInStream(in, size, h.length);
+        }
+        // tamanho indefinido so eh valido em tipos construidos (BER)
+        if (first == 0x80) {
+            h.indefinite = true;
+            return (h.tag & 0x20) != 0;
+        }
+
+        int n = first & 0x7F;
+        if (n > 8) return false;
+        for (int i = 0; i < n; ++i) {
+            int b = in.get();
+            if (b == EOF) return false;
+            h.length = (h.length << 8) | static_cast<std::uint64_t>(b);
+        }
+        return fitsInStream(in, size, h.length);
+    }
+
+    // mesmo limite de aninhamento do decodificador ASN.1 do OpenSSL (ASN1_MAX_CONSTRUCTED_NEST);
+    // sem ele um arquivo de "30 80" repetidos estoura a pilha na recursao abaixo
+    const int kMaxDerDepth = 30;
+
+    // pula o corpo de um elemento cujo cabecalho ja foi lido, somando em payload os bytes primitivos
+    bool skipDerBody(std::istream& in, std::streamoff size, const DerHeader& h, unsigned long long* payload, int depth = 0) {
+        bool constructed = (h.tag & 0x20) != 0;
+        if (!h.indefinite && (!payload || !constructed)) {
+            if (payload) *payload += h.length;
+            in.seekg(static_cast<std::streamoff>(h.length), std::ios::cur);
+            return static_cast<bool>(in);
+        }
+
+        if (depth >= kMaxDerDepth) return false;
+
+        std::streamoff end = h.indefinite ? -1 : static_cast<std::streamoff>(in.tellg()) + static_cast<std::streamoff>(h.length);
+        while (true) {
+            std::streamoff pos = in.tellg();
+            if (pos < 0) return false;
+            if (!h.indefinite && pos >= end) return pos == end;
+            DerHeader child;
+            if (!readDerHeader(in, size, child)) return false;
+            if (h.indefinite && child.tag == 0x00 && child.length == 0) return true; // end-of-contents
+            if (!skipDerBody(in, size, child, payload, depth + 1)) return false;
+            if (in.tellg() <= pos) return false;
+        }
+    }
+
+    // copia o elemento seguinte inteiro (cabecalho e corpo) para out
+    bool copyDerElement(std::istream& in, std::streamoff size, std::vector<unsigned char>& out, unsigned char& tag) {
+        std::streamoff start = in.tellg();
+        DerHeader h;
+        if (!readDerHeader(in, size, h) || !skipDerBody(in, size, h, nullptr)) return false;
+        std::streamoff end = in.tellg();
+        if (end < start) return false;
+
+        tag = h.tag;
+        size_t offset = out.size();
+        out.resize(offset + static_cast<size_t>(end - start));
+        in.seekg(start);
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(out.data() + offset), end - start));
+    }
+
+    void appendDerHeader(std::vector<unsigned char>& out, unsigned char tag, size_t length) {
+        out.push_back(tag);
+        if (length < 0x80) {
+            out.push_back(static_cast<unsigned char>(length));
+            return;
+        }
+        unsigned char bytes[sizeof(size_t)];
+        int n = 0;
+        for (size_t v = length; v > 0; v >>= 8) bytes[n++] = static_cast<unsigned char>(v & 0xFF);
+        out.push_back(static_cast<unsigned char>(0x80 | n));
+        while (n > 0) out.push_back(bytes[--n]);
+    }
+
+    std::vector<unsigned char> wrapDer(unsigned char tag, const std::vector<unsigned char>& body) {
+        std::vector<unsigned char> out;
+        out.reserve(body.size() + 10);
+        appendDerHeader(out, tag, body.size());
+        out.insert(out.end(), body.begin(), body.end());
+        return out;
+    }
+
+    // Partes do SignedData relevantes para o material de revogacao (RFC 5652 secao 5.1)
+    struct SignedDataParts {
+        std::vector<unsigned char> contentType;
+        std::vector<unsigned char> head;            // version, digestAlgorithms e encapContentInfo
+        std::vector<unsigned char> certificates;    // [0] inteiro ou vazio
+        std::vector<std::vector<unsigned char>> revocationInfo;  // filhos de crls [1]
+        std::vector<unsigned char> signerInfos;
+    };
+
+    // keepContent = false pula o encapContentInfo com seek (so interessa o que vem depois)
+    static bool readSignedDataParts(std::istream& in, SignedDataParts& parts, bool keepContent) {
+        static const unsigned char signedDataOid[] = { 0x06, 0x09, 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02 };
+        std::streamoff size = streamSize(in);
+        DerHeader h;
+        unsigned char tag = 0;
+        if (!readDerHeader(in, size, h) || h.tag != 0x30) return false;
+        if (!copyDerElement(in, size, parts.contentType, tag) || tag != 0x06) return false;
+        if (parts.contentType.size() != sizeof(signedDataOid) ||
+            !std::equal(parts.contentType.begin(), parts.contentType.end(), signedDataOid)) {
+            return false;
+        }
+        if (!readDerHeader(in, size, h) || h.tag != 0xA0) return false;
+        if (!readDerHeader(in, size, h) || h.tag != 0x30) return false;
+
+        if (!copyDerElement(in, size, parts.head, tag) || tag != 0x02) return false;
+        if (!copyDerElement(in, size, parts.head, tag) || tag != 0x31) return false;
+        if (keepContent) {
+            if (!copyDerElement(in, size, parts.head, tag) || tag != 0x30) return false;
+        } else {
+            if (!readDerHeader(in, size, h) || h.tag != 0x30 || !skipDerBody(in, size, h, nullptr)) return false;
+        }
+
+        while (true) {
+            std::streamoff start = in.tellg();
+            if (!readDerHeader(in, size, h)) return false;
+            if (h.tag == 0xA0) {
+                in.seekg(start);
+                if (!copyDerElement(in, size, parts.certificates, tag)) return false;
+            } else if (h.tag == 0xA1) {
+                std::streamoff end = h.indefinite ? -1 : static_cast<std::streamoff>(in.tellg()) + static_cast<std::streamoff>(h.length);
+                while (h.indefinite || in.tellg() < end) {
+                    std::streamoff childStart = in.tellg();
+                    if (childStart < 0) return false;
+                    DerHeader child;
+                    if (!readDerHeader(in, size, child)) return false;
+                    if (h.indefinite && child.tag == 0x00 && child.length == 0) break;
+                    in.seekg(childStart);
+                    std::vector<unsigned char> element;
+                    if (!copyDerElement(in, size, element, tag) || in.tellg() <= childStart) return false;
+                    parts.revocationInfo.push_back(std::move(element));
+                }
+            } else if (h.tag == 0x31) {
+                in.seekg(start);
+                return copyDerElement(in, size, parts.signerInfos, tag);
+            } else {
+                return false;
+            }
+        }
+    }
+
+    // RevocationInfoChoice other [1] { otherRevInfoFormat id-ri-ocsp-response, OCSPResponse }
+    static const unsigned char ocspResponseOid[] = { 0x06, 0x08, 0x2B, 0x06, 0x01, 0x05, 0x05, 0x07, 0x10, 0x02 };
+
+    // true se choice eh uma resposta OCSP grampeada; copia o OCSPResponse em response
+    static bool stapledOcsp(const std::vector<unsigned char>& choice, std::vector<unsigned char>* response) {
+        if (choice.empty() || choice[0] != 0xA1) return false;
+        std::istringstream other(std::string(choice.begin(), choice.end()));
+        std::streamoff size = static_cast<std::streamoff>(choice.size());
+        DerHeader h;
+        unsigned char tag = 0;
+        std::vector<unsigned char> format;
+        if (!readDerHeader(other, size, h) || !copyDerElement(other, size, format, tag) || tag != 0x06) return false;
+        if (format.size() != sizeof(ocspResponseOid) || !std::equal(format.begin(), format.end(), ocspResponseOid)) return false;
+        if (!response) return true;
+        return copyDerElement(other, size, *response, tag) && tag == 0x30;
+    }
+
+    static std::vector<std::vector<unsigned char>> readStapledOcsp(std::istream& in) {
+        std::vector<std::vector<unsigned char>> responses;
+        SignedDataParts parts;
+        if (!in || !readSignedDataParts(in, parts, false)) return responses;
+
+        for (const auto& choice : parts.revocationInfo) {
+            std::vector<unsigned char> response;
+            if (stapledOcsp(choice, &response)) responses.push_back(std::move(response));
+        }
+        return responses;
+    }
+
+    std::vector<std::vector<unsigned char>> readStapledOcsp(const std::string& signaturePath) {
+        std::ifstream in(signaturePath, std::ios::binary);
+        return readStapledOcsp(in);
+    }
+
+    bool stapleOcspResponse(const std::string& signaturePath, const std::vector<unsigned char>& ocspDer) {
+        SignedDataParts parts;
+        {
+            std::ifstream in(signaturePath, std::ios::binary);
+            if (!in || !readSignedDataParts(in, parts, true)) return false;
+        }
+
+        // uma resposta grampeada por vez: substitui a anterior (a nova eh mais recente)
+        std::vector<unsigned char> other(ocspResponseOid, ocspResponseOid + sizeof(ocspResponseOid));
+        other.insert(other.end(), ocspDer.begin(), ocspDer.end());
+        std::vector<unsigned char> choice = wrapDer(0xA1, other);
+
+        std::vector<unsigned char> crls;
+        for (const auto& existing : parts.revocationInfo) {
+            if (!stapledOcsp(existing, nullptr)) crls.insert(crls.end(), existing.begin(), existing.end());
+        }
+        crls.insert(crls.end(), choice.begin(), choice.end());
+
+        std::vector<unsigned char> signedData(parts.head);
+        signedData.insert(signedData.end(), parts.certificates.begin(), parts.certificates.end());
+        std::vector<unsigned char> crlsDer = wrapDer(0xA1, crls);
+        signedData.insert(signedData.end(), crlsDer.begin(), crlsDer.end());
+        signedData.insert(signedData.end(), parts.signerInfos.begin(), parts.signerInfos.end());
+
+        std::vector<unsigned char> outer(parts.contentType);
+        std::vector<unsigned char> explicitContent = wrapDer(0xA0, wrapDer(0x30, signedData));
+        outer.insert(outer.end(), explicitContent.begin(), explicitContent.end());
+        std::vector<unsigned char> der = wrapDer(0x30, outer);
+
+        // grava ao lado e troca de uma vez para nao deixar a assinatura pela metade
+        std::string tmpPath = signaturePath + ".staple.tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!out.write(reinterpret_cast<const char*>(der.data()), static_cast<std::streamsize>(der.size()))) {
+                std::remove(tmpPath.c_str());
+                return false;
+            }
+        }
+        std::remove(signaturePath.c_str());
+        return std::rename(tmpPath.c_str(), signaturePath.c_str()) == 0;
+    }
+
+    InspectionResult inspect(const std::string& signaturePath, const CertIndex::Index* index) {
+        InspectionResult res;
+        res.parsed = false;
+        res.contentLength = 0;
+
+        std::ifstream in(signaturePath, std::ios::binary);
+        if (!in) return res;
+        std::streamoff size = streamSize(in);
+
+        // ContentInfo ::= SEQUENCE { contentType, [0] EXPLICIT SignedData }
+        static const unsigned char signedDataOid[] = { 0x06, 0x09, 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02 };
+        DerHeader h;
+        if (!readDerHeader(in, size, h) || h.tag != 0x30) return res;
+
+        unsigned char tag = 0;
+        std::vector<unsigned char> contentType;
+        if (!copyDerElement(in, size, contentType, tag) || tag != 0x06) return res;
+        if (contentType.size() != sizeof(signedDataOid) ||
+            !std::equal(contentType.begin(), contentType.end(), signedDataOid)) {
+            return res;
+        }
+
+        if (!readDerHeader(in, size, h) || h.tag != 0xA0) return res;
+        if (!readDerHeader(in, size, h) || h.tag != 0x30) return res;
+
+        // version e digestAlgorithms sao copiados como estao
+        std::vector<unsigned char> signedData;
+        if (!copyDerElement(in, size, signedData, tag) || tag != 0x02) return res;
+        if (!copyDerElement(in, size, signedData, tag) || tag != 0x31) return res;
+
+        // encapContentInfo: mantem apenas o eContentType e pula o eContent (vira detached)
+        DerHeader encap;
+        if (!readDerHeader(in, size, encap) || encap.tag != 0x30) return res;
+        std::streamoff encapEnd = encap.indefinite ? -1 : static_cast<std::streamoff>(in.tellg()) + static_cast<std::streamoff>(encap.length);
+
+        std::vector<unsigned char> eContentType;
+        if (!copyDerElement(in, size, eContentType, tag) || tag != 0x06) return res;
+
+        while (encap.indefinite || in.tellg() < encapEnd) {
+            std::streamoff pos = in.tellg();
+            if (pos < 0) return res;
+            DerHeader eContent;
+            if (!readDerHeader(in, size, eContent)) return res;
+            if (encap.indefinite && eContent.tag == 0x00 && eContent.length == 0) break;
+            if (!skipDerBody(in, size, eContent, &res.contentLength) || in.tellg() <= pos) return res;
+        }
+        std::vector<unsigned char> encapDer = wrapDer(0x30, eContentType);
+        signedData.insert(signedData.end(), encapDer.begin(), encapDer.end());
+
+        // certificates [0], crls [1] e por fim signerInfos
+        bool hasSignerInfos = false;
+        while (!hasSignerInfos) {
+            if (!copyDerElement(in, size, signedData, tag)) return res;
+            if (tag == 0x31) hasSignerInfos = true;
+            else if (tag != 0xA0 && tag != 0xA1) return res;
+        }
+
+        // remonta um ContentInfo detached apenas com os cabecalhos para reaproveitar o parser do OpenSSL
+        std::vector<unsigned char> outer(contentType);
+        std::vector<unsigned char> explicitContent = wrapDer(0xA0, wrapDer(0x30, signedData));
+        outer.insert(outer.end(), explicitContent.begin(), explicitContent.end());
+        std::vector<unsigned char> der = wrapDer(0x30, outer);
+
+        const unsigned char* p = der.data();
+        OpenSSLPool::CmsPtr cms(d2i_CMS_ContentInfo(nullptr, &p, static_cast<long>(der.size())));
+        if (!cms) return res;
+
+        const ASN1_OBJECT* eType = CMS_get0_eContentType(cms.get());
+        if (eType) {
+            char buf[128];
+            OBJ_obj2txt(buf, sizeof(buf), eType, 0);
+            res.contentType = std::string(buf);
+        }
+
+        // associa os certificados (embutidos ou do indice) aos SignerInfos sem executar CMS_verify
+        CertIndex::resolveSigners(cms.get(), index);
+
+        fillSignerDetails(cms.get(), res);
+        res.parsed = true;
 
-        CMS_ContentInfo_free(cms);
         return res;
     }
 
@@ -159,6 +721,8 @@ namespace VerifierService {
                 Utils::logInfo("    Signing Time: " + res.signingTime);
             if (!res.hashAlgo.empty()) 
                 Utils::logInfo("    Hash Algorithm: " + res.hashAlgo);
+            if (!res.signatureAlgo.empty()) 
+                Utils::logInfo("    Signature Algorithm: " + res.signatureAlgo);
             if (!res.hashHex.empty()) 
                 Utils::logInfo("    Document Hash: " + res.hashHex);
 
@@ -1,6 +1,9 @@
 #pragma once
 #include <string>
+#include <vector>
 #include <openssl/cms.h>
+#include "CertIndex.h"
+#include "RevocationService.h"
 
 namespace VerifierService {
     struct VerificationResult {
@@ -10,11 +13,52 @@ namespace VerifierService {
         std::string signingTime;    // Signing time (UTC)
         std::string hashHex;        // Hexadecimal hash do doc
         std::string hashAlgo;       // Digest algorithm
+        std::string signatureAlgo;  // Algoritmo da chave (RSA, ECDSA, Ed25519)
+        std::string revocation;     // NAO_REVOGADO, REVOGADO, DESCONHECIDO ou vazio (checagem desligada)
+        std::string revocationDetail;
+        std::string timestamp;      // VALIDO, INVALIDO ou vazio (sem carimbo de tempo)
+        std::string timestampTime;  // genTime do TimeStampToken
+        bool timestampTrusted = false; // cadeia da TSA conferida com TSA_CA_FILE
+        unsigned timestampBatch = 0;   // assinaturas carimbadas juntas
+    };
+
+    // Resultado da inspecao: mesmos metadados da verificacao, sem validar a assinatura
+    struct InspectionResult {
+        bool parsed;
+        std::string contentType;    // eContentType (OID)
+        unsigned long long contentLength; // Tamanho do conteudo encapsulado (0 se detached)
+        std::string signerName;
+        std::string signingTime;
+        std::string hashHex;
+        std::string hashAlgo;
+        std::string signatureAlgo;
     };
 
     CMS_ContentInfo* loadCMS(const std::string& signaturePath);
 
-    VerificationResult verifyAndGetDetails(const std::string& signaturePath);
+    // index resolve signatarios de assinaturas compactas (sem certificados embutidos)
+    // revocation consulta o status do certificado do signatario depois da assinatura conferida:
+    // REVOGADO sempre invalida, DESCONHECIDO apenas com REVOCATION_CHECK=hard
+    VerificationResult verifyAndGetDetails(const std::string& signaturePath, const CertIndex::Index* index = nullptr,
+                                           RevocationService::Checker* revocation = nullptr);
+
+    // Mesma verificacao sobre a assinatura (DER) ja em memoria, lida sem copia (ex.: View do SignatureStore)
+    VerificationResult verifyBuffer(const unsigned char* data, size_t length, const CertIndex::Index* index = nullptr,
+                                    RevocationService::Checker* revocation = nullptr);
+
+    // Grampeia uma resposta OCSP (DER) no SignedData como RevocationInfoChoice other
+    // (id-ri-ocsp-response, RFC 5940); a assinatura continua valida pois crls nao eh assinado
+    bool stapleOcspResponse(const std::string& signaturePath, const std::vector<unsigned char>& ocspDer);
+
+    // Respostas OCSP grampeadas no SignedData (vazio se nao houver)
+    std::vector<std::vector<unsigned char>> readStapledOcsp(const std::string& signaturePath);
+
+    // Verifica um documento de um lote: assinatura sobre a raiz + prova de inclusao (hashHex = SHA-512 do documento)
+    VerificationResult verifyWithProof(const std::string& docPath, const std::string& proofPath, const std::string& signaturePath,
+                                       const CertIndex::Index* index = nullptr);
+
+    // Le apenas os cabecalhos do SignedData e os SignerInfos, pulando o conteudo encapsulado sem carrega-lo
+    InspectionResult inspect(const std::string& signaturePath, const CertIndex::Index* index = nullptr);
 
     bool verifyAndExtract(CMS_ContentInfo* cms, const std::string& recoveredPath);
 
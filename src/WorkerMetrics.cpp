@@ -0,0 +1,130 @@
+#include "WorkerMetrics.h"
+#include <new>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+namespace WorkerMetrics {
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "contadores precisam ser lock-free para memoria compartilhada");
+
+    static const char* kRouteNames[kRouteCount] = { "signature", "verify", "inspect", "other" };
+
+    static Region* currentRegion = nullptr;
+    static unsigned currentSlot = 0;
+
+    Region::Region(unsigned slots, bool shared) : slots_(slots == 0 ? 1 : slots), shared_(shared), counters_(nullptr) {
+        size_t bytes = sizeof(Counters) * slots_;
+        void* memory = nullptr;
+#ifndef _WIN32
+        if (shared_) {
+            memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED) throw std::runtime_error("Falha ao criar memoria compartilhada de metricas");
+        }
+#else
+        shared_ = false;
+#endif
+        if (!shared_) memory = ::operator new(bytes);
+
+        counters_ = static_cast<Counters*>(memory);
+        for (unsigned i = 0; i < slots_; ++i) {
+            Counters* c = new (&counters_[i]) Counters;
+            c->pid = 0;
+            c->restarts = 0;
+            for (int r = 0; r < kRouteCount; ++r) {
+                c->requests[r] = 0;
+                c->latencyUs[r] = 0;
+            }
+            c->status2xx = 0;
+            c->status4xx = 0;
+            c->status5xx = 0;
+            c->rejected = 0;
+        }
+    }
+
+    Region::~Region() {
+        if (currentRegion == this) currentRegion = nullptr;
+#ifndef _WIN32
+        if (shared_) {
+            munmap(counters_, sizeof(Counters) * slots_);
+            return;
+        }
+#endif
+        ::operator delete(counters_);
+    }
+
+    void Region::record(unsigned index, Route route, int status, std::uint64_t elapsedUs) {
+        if (index >= slots_) return;
+        Counters& c = counters_[index];
+        int r = static_cast<int>(route);
+        c.requests[r].fetch_add(1, std::memory_order_relaxed);
+        c.latencyUs[r].fetch_add(elapsedUs, std::memory_order_relaxed);
+
+        if (status == 503) c.rejected.fetch_add(1, std::memory_order_relaxed);
+        if (status >= 500) c.status5xx.fetch_add(1, std::memory_order_relaxed);
+        else if (status >= 400) c.status4xx.fetch_add(1, std::memory_order_relaxed);
+        else c.status2xx.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::string Region::render() const {
+        std::ostringstream out;
+
+        std::uint64_t requests[kRouteCount] = {};
+        std::uint64_t latency[kRouteCount] = {};
+        std::uint64_t s2xx = 0, s4xx = 0, s5xx = 0, rejected = 0, restarts = 0;
+        for (unsigned i = 0; i < slots_; ++i) {
+            const Counters& c = counters_[i];
+            for (int r = 0; r < kRouteCount; ++r) {
+                requests[r] += c.requests[r].load(std::memory_order_relaxed);
+                latency[r] += c.latencyUs[r].load(std::memory_order_relaxed);
+            }
+            s2xx += c.status2xx.load(std::memory_order_relaxed);
+            s4xx += c.status4xx.load(std::memory_order_relaxed);
+            s5xx += c.status5xx.load(std::memory_order_relaxed);
+            rejected += c.rejected.load(std::memory_order_relaxed);
+            restarts += c.restarts.load(std::memory_order_relaxed);
+        }
+
+        out << "# TYPE bry_requests_total counter\n";
+        for (int r = 0; r < kRouteCount; ++r) {
+            out << "bry_requests_total{route=\"" << kRouteNames[r] << "\"} " << requests[r] << "\n";
+        }
+        out << "# TYPE bry_request_latency_us_total counter\n";
+        for (int r = 0; r < kRouteCount; ++r) {
+            out << "bry_request_latency_us_total{route=\"" << kRouteNames[r] << "\"} " << latency[r] << "\n";
+        }
+        out << "# TYPE bry_responses_total counter\n";
+        out << "bry_responses_total{class=\"2xx\"} " << s2xx << "\n";
+        out << "bry_responses_total{class=\"4xx\"} " << s4xx << "\n";
+        out << "bry_responses_total{class=\"5xx\"} " << s5xx << "\n";
+        out << "# TYPE bry_rejected_total counter\n";
+        out << "bry_rejected_total " << rejected << "\n";
+        out << "# TYPE bry_worker_restarts_total counter\n";
+        out << "bry_worker_restarts_total " << restarts << "\n";
+
+        out << "# TYPE bry_worker_requests_total counter\n";
+        for (unsigned i = 0; i < slots_; ++i) {
+            const Counters& c = counters_[i];
+            std::uint64_t total = 0;
+            for (int r = 0; r < kRouteCount; ++r) total += c.requests[r].load(std::memory_order_relaxed);
+            out << "bry_worker_requests_total{worker=\"" << i << "\",pid=\"" << c.pid.load() << "\"} " << total << "\n";
+        }
+        return out.str();
+    }
+
+    void setCurrent(Region* region, unsigned slot) {
+        currentRegion = region;
+        currentSlot = slot;
+    }
+
+    void recordRequest(Route route, int status, std::uint64_t elapsedUs) {
+        if (currentRegion) currentRegion->record(currentSlot, route, status, elapsedUs);
+    }
+
+    std::string renderCurrent() {
+        return currentRegion ? currentRegion->render() : std::string();
+    }
+}
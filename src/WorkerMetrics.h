@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Contadores por worker numa regiao de memoria compartilhada entre processos.
+// No modo pre-fork a regiao eh criada pelo supervisor antes do fork, entao
+// qualquer worker consegue somar os contadores de todos no /metrics.
+namespace WorkerMetrics {
+
+    enum class Route { Signature = 0, Verify, Inspect, Other, Count };
+
+    static const int kRouteCount = static_cast<int>(Route::Count);
+
+    // apenas atomics lock-free: valido em memoria compartilhada entre processos
+    struct Counters {
+        std::atomic<std::int64_t> pid;
+        std::atomic<std::uint64_t> restarts;
+        std::atomic<std::uint64_t> requests[kRouteCount];
+        std::atomic<std::uint64_t> latencyUs[kRouteCount];
+        std::atomic<std::uint64_t> status2xx;
+        std::atomic<std::uint64_t> status4xx;
+        std::atomic<std::uint64_t> status5xx;
+        std::atomic<std::uint64_t> rejected;       // 503 do controle de admissao
+    };
+
+    class Region {
+    public:
+        // shared = true usa mmap compartilhado (POSIX); caso contrario memoria do processo
+        Region(unsigned slots, bool shared);
+        ~Region();
+
+        Region(const Region&) = delete;
+        Region& operator=(const Region&) = delete;
+
+        unsigned size() const { return slots_; }
+        Counters& slot(unsigned index) { return counters_[index]; }
+        const Counters& slot(unsigned index) const { return counters_[index]; }
+
+        void record(unsigned index, Route route, int status, std::uint64_t elapsedUs);
+
+        // formato texto do Prometheus: totais agregados e uma serie por worker
+        std::string render() const;
+
+    private:
+        unsigned slots_;
+        bool shared_;
+        Counters* counters_;
+    };
+
+    // regiao e slot usados pelo processo atual
+    void setCurrent(Region* region, unsigned slot);
+
+    void recordRequest(Route route, int status, std::uint64_t elapsedUs);
+
+    std::string renderCurrent();
+}
@@ -0,0 +1,266 @@
+#include "WorkerSupervisor.h"
+#include "Logger.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace WorkerSupervisor {
+
+    static volatile std::sig_atomic_t stopRequested = 0;
+
+    Config fromEnv() {
+        Config config;
+        config.workers = static_cast<unsigned>(std::max(0LL, Utils::getEnvNumber("SERVER_WORKERS", 0)));
+
+        std::string pin = Utils::getEnvVar("SERVER_PIN", "core");
+        if (pin == "none") config.pin = PinMode::None;
+        else if (pin == "node") config.pin = PinMode::Node;
+        else config.pin = PinMode::Core;
+        return config;
+    }
+
+    bool supported() {
+#ifdef _WIN32
+        return false;
+#else
+        return true;
+#endif
+    }
+
+#ifdef __linux__
+    // listas de CPUs do sysfs no formato "0-3,8-11"
+    static std::vector<int> parseCpuList(const std::string& text) {
+        std::vector<int> cpus;
+        std::stringstream ss(text);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            if (range.empty()) continue;
+            size_t dash = range.find('-');
+            try {
+                int first = std::stoi(range.substr(0, dash));
+                int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+            } catch (const std::exception&) {
+                return {};
+            }
+        }
+        return cpus;
+    }
+
+    static std::vector<std::vector<int>> numaNodes() {
+        std::vector<std::vector<int>> nodes;
+        for (int node = 0;; ++node) {
+            std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!in) break;
+            std::string line;
+            std::getline(in, line);
+            std::vector<int> cpus = parseCpuList(line);
+            if (!cpus.empty()) nodes.push_back(cpus);
+        }
+        return nodes;
+    }
+#endif
+
+    bool pinCurrentProcess(unsigned index, PinMode mode, unsigned coresPerWorker) {
+        if (mode == PinMode::None) return true;
+#ifdef __linux__
+        std::vector<int> cpus;
+        if (mode == PinMode::Node) {
+            std::vector<std::vector<int>> nodes = numaNodes();
+            // sem topologia NUMA (ou com um unico no) nao ha o que restringir
+            if (nodes.size() <= 1) return true;
+            cpus = nodes[index % nodes.size()];
+        } else {
+            // respeita o conjunto ja permitido ao processo (taskset, cgroups)
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return false;
+            std::vector<int> available;
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) available.push_back(cpu);
+            }
+            if (available.empty()) return false;
+            // o worker usa coresPerWorker threads (pool de criptografia, front end): um bloco
+            // contiguo de CPUs, nao um unico nucleo disputado por todas elas
+            size_t block = std::min<size_t>(std::max(1u, coresPerWorker), available.size());
+            size_t first = static_cast<size_t>(index) * block;
+            for (size_t i = 0; i < block; ++i) cpus.push_back(available[(first + i) % available.size()]);
+        }
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) CPU_SET(cpu, &set);
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        (void)index;
+        (void)coresPerWorker;
+        return false;
+#endif
+    }
+
+    void requestStop() {
+        stopRequested = 1;
+    }
+
+    void installStopHandlers() {
+#ifndef _WIN32
+        struct sigaction action {};
+        action.sa_handler = [](int) { requestStop(); };
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+#else
+        std::signal(SIGINT, [](int) { requestStop(); });
+        std::signal(SIGTERM, [](int) { requestStop(); });
+#endif
+    }
+
+    void waitForStopSignal() {
+#ifndef _WIN32
+        sigset_t set;
+        sigemptyset(&set);
+        sigaddset(&set, SIGINT);
+        sigaddset(&set, SIGTERM);
+        int signal = 0;
+        sigwait(&set, &signal);
+#endif
+    }
+
+#ifndef _WIN32
+    static std::string describeExit(int status) {
+        if (WIFSIGNALED(status)) return "sinal " + std::to_string(WTERMSIG(status));
+        if (WIFEXITED(status)) return "codigo " + std::to_string(WEXITSTATUS(status));
+        return "status " + std::to_string(status);
+    }
+
+    static pid_t spawn(unsigned index, const Config& config, WorkerMetrics::Region& metrics,
+                       const std::function<int(unsigned)>& worker) {
+        Logger::flush();
+        pid_t pid = fork();
+        if (pid != 0) return pid;
+
+        // filho: sinais de parada voltam ao padrao e ficam bloqueados em todas as threads
+        // que o worker criar; o worker os recebe com waitForStopSignal()
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+        sigset_t set;
+        sigemptyset(&set);
+        sigaddset(&set, SIGINT);
+        sigaddset(&set, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &set, nullptr);
+
+        // a thread de escrita do log nao existe no filho
+        Logger::afterFork();
+
+        if (!pinCurrentProcess(index, config.pin, config.coresPerWorker)) {
+            Logger::log(Logger::Level::Warn, "Nao foi possivel fixar o worker em CPU", { { "worker", std::to_string(index) } });
+        }
+
+        metrics.slot(index).pid = static_cast<std::int64_t>(getpid());
+        WorkerMetrics::setCurrent(&metrics, index);
+
+        int code = 1;
+        try {
+            code = worker(index);
+        } catch (const std::exception& e) {
+            Logger::log(Logger::Level::Error, "Worker encerrado por excecao", { { "worker", std::to_string(index) }, { "erro", e.what() } });
+        }
+        // _exit: os destrutores estaticos e handlers de atexit herdados do supervisor
+        // (e de bibliotecas) nao devem rodar no filho; o log pendente sai antes
+        Logger::flush();
+        _exit(code);
+    }
+#endif
+
+    int run(const Config& config, WorkerMetrics::Region& metrics, const std::function<int(unsigned)>& worker) {
+#ifdef _WIN32
+        (void)config;
+        (void)metrics;
+        (void)worker;
+        return 1;
+#else
+        using Clock = std::chrono::steady_clock;
+
+        stopRequested = 0;
+        int result = 0;
+        unsigned count = std::min(std::max(1u, config.workers), metrics.size());
+        std::vector<pid_t> pids(count, -1);
+        std::vector<Clock::time_point> startedAt(count, Clock::now());
+
+        for (unsigned i = 0; i < count; ++i) {
+            pids[i] = spawn(i, config, metrics, worker);
+            if (pids[i] < 0) {
+                Logger::log(Logger::Level::Error, "Falha ao criar worker", { { "worker", std::to_string(i) } });
+                result = 1;
+                requestStop();
+                break;
+            }
+        }
+        Logger::log(Logger::Level::Info, "Supervisor iniciado", { { "workers", std::to_string(count) } });
+
+        while (!stopRequested) {
+            int status = 0;
+            pid_t pid = waitpid(-1, &status, WNOHANG);
+            if (pid <= 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
+            }
+
+            auto it = std::find(pids.begin(), pids.end(), pid);
+            if (it == pids.end()) continue;
+            unsigned index = static_cast<unsigned>(it - pids.begin());
+
+            metrics.slot(index).restarts.fetch_add(1);
+            Logger::log(Logger::Level::Warn, "Worker encerrado, reiniciando", {
+                { "worker", std::to_string(index) }, { "pid", std::to_string(pid) }, { "saida", describeExit(status) } });
+
+            // evita reinicio em loop quando o worker falha logo ao subir (ex: porta ocupada)
+            if (Clock::now() - startedAt[index] < std::chrono::seconds(1)) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
+            if (stopRequested) {
+                pids[index] = -1;
+                break;
+            }
+
+            pids[index] = spawn(index, config, metrics, worker);
+            startedAt[index] = Clock::now();
+            if (pids[index] < 0) {
+                Logger::log(Logger::Level::Error, "Falha ao recriar worker", { { "worker", std::to_string(index) } });
+                result = 1;
+                requestStop();
+            }
+        }
+
+        for (pid_t pid : pids) {
+            if (pid > 0) kill(pid, SIGTERM);
+        }
+        for (pid_t pid : pids) {
+            if (pid <= 0) continue;
+            int status = 0;
+            while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+        }
+        Logger::log(Logger::Level::Info, "Workers encerrados");
+        return result;
+#endif
+    }
+}
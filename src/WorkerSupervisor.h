@@ -0,0 +1,41 @@
+#pragma once
+#include <functional>
+#include <string>
+#include "WorkerMetrics.h"
+
+// Modo pre-fork: o supervisor cria N processos worker, cada um com seu proprio
+// socket de escuta (SO_REUSEPORT na mesma porta), estado global do OpenSSL e
+// alocador. Workers que terminam sem pedido de parada sao recriados.
+// Disponivel apenas em POSIX; no Windows supported() retorna false.
+namespace WorkerSupervisor {
+
+    enum class PinMode { None, Core, Node };
+
+    struct Config {
+        unsigned workers;
+        PinMode pin;
+        unsigned coresPerWorker = 1;    // tamanho do bloco de CPUs de cada worker no modo Core
+    };
+
+    // Le SERVER_WORKERS e SERVER_PIN (none, core ou node)
+    Config fromEnv();
+
+    bool supported();
+
+    // Fixa o processo atual num bloco contiguo de coresPerWorker CPUs (Core; o worker index fica
+    // com o bloco index) ou nos nucleos de um no NUMA (Node), escolhido por index
+    bool pinCurrentProcess(unsigned index, PinMode mode, unsigned coresPerWorker = 1);
+
+    // Cria os workers e supervisiona ate requestStop(); worker(index) roda no processo filho
+    // e seu retorno vira o codigo de saida do filho
+    int run(const Config& config, WorkerMetrics::Region& metrics, const std::function<int(unsigned)>& worker);
+
+    // No worker: bloqueia ate receber SIGINT ou SIGTERM (bloqueados pelo supervisor em todas as threads)
+    void waitForStopSignal();
+
+    // Seguro para chamar de um signal handler
+    void requestStop();
+
+    // Instala SIGINT/SIGTERM no supervisor para chamar requestStop()
+    void installStopHandlers();
+}
@@ -1,99 +1,170 @@
+#include "BatchPipeline.h"
 #include "DigestService.h"
 #include "SignerService.h"
 #include "VerifierService.h"
+#include "OpenSSLPool.h"
 #include "Utils.h"
 #include <openssl/evp.h>
 #include <openssl/err.h>
+#include <chrono>
 #include <cstdlib> 
 #include <fstream>
 #include <string>
 #include <iostream>
 #include <filesystem>
-
-#ifdef _WIN32
-    #include <direct.h>
-    #define setenv(k, v, o) _putenv_s(k, v)
-#endif
-
-void loadEnvFile() {
-    std::ifstream file(".env");
-    if (!file.is_open()) {
-        Utils::logInfo("Aviso: Arquivo .env nao encontrado. Usando variaveis do sistema ou padroes.");
-        return;
-    }
-
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == '#') continue;
-
-        size_t delimiterPos = line.find('=');
-        if (delimiterPos != std::string::npos) {
-            std::string key = line.substr(0, delimiterPos);
-            std::string value = line.substr(delimiterPos + 1);
-            
-            // Remove \r (comum em arquivos editados no Windows)
-            if (!value.empty() && value.back() == '\r') value.pop_back();
-
-            // Lógica Cross-Platform
-            #ifdef _WIN32
-                _putenv_s(key.c_str(), value.c_str());
-            #else
-                setenv(key.c_str(), value.c_str(), 1);
-            #endif
+#include <vector>
+
+// ------------------------------------------------------------------
+// Modo lote: Bry_CLI --manifest=lista.txt [--dir=pasta] [--report=relatorio.csv]
+//                    [--out-dir=assinaturas] [--p12=...] [--signers=N] [--verifiers=N]
+//                    [--hashers=N] [--queue=N] [--resume=1] [--certs=full|leaf|none]
+//                    [--merkle=lote.p7s]
+// Sem argumentos executa as etapas 1, 2 e 3 sobre o documento de exemplo
+// ------------------------------------------------------------------
+
+static bool parseBatchOptions(int argc, char** argv, BatchPipeline::Config& config, std::string& dir,
+                              std::string& merkle) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            std::cerr << "Argumento invalido: " << arg << std::endl;
+            return false;
         }
+        std::string key = arg.substr(2, eq - 2);
+        std::string value = arg.substr(eq + 1);
+
+        try {
+            if (key == "manifest") config.manifestPath = value;
+            else if (key == "dir") dir = value;
+            else if (key == "merkle") merkle = value;
+            else if (key == "report") config.reportPath = value;
+            else if (key == "out-dir") config.outDir = value;
+            else if (key == "p12") config.p12Path = value;
+            else if (key == "hashers") config.hashers = static_cast<unsigned>(std::stoul(value));
+            else if (key == "signers") config.signers = static_cast<unsigned>(std::stoul(value));
+            else if (key == "verifiers") config.verifiers = static_cast<unsigned>(std::stoul(value));
+            else if (key == "queue") config.queueCapacity = std::stoul(value);
+            else if (key == "memory-mb") config.maxBufferedBytes = std::stoul(value) * 1024 * 1024;
+            else if (key == "resume") config.resume = value != "0";
+            else if (key == "certs") {
+                if (value != "full" && value != "leaf" && value != "none") throw std::invalid_argument(value);
+                config.certMode = SignerService::parseCertMode(value);
+            }
+            else {
+                std::cerr << "Opcao desconhecida: --" << key << std::endl;
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Valor invalido para --" << key << ": " << value << std::endl;
+            return false;
+        }
+    }
+    if (config.manifestPath.empty()) {
+        std::cerr << "Informe --manifest=arquivo" << std::endl;
+        return false;
     }
-    Utils::logInfo("Configuracao carregada do arquivo .env");
+    return true;
 }
 
-/*
-void loadEnvFile() {
-    std::ifstream file(".env");
-    if (!file.is_open()) {
-        Utils::logInfo("Aviso: Arquivo .env nao encontrado. Usando variaveis do sistema ou padroes.");
-        return;
+// prova ao lado de onde iria a assinatura do documento: doc.txt.p7s -> doc.txt.proof
+static std::string proofPath(const std::string& signaturePath) {
+    std::filesystem::path path(signaturePath);
+    if (path.extension() == ".p7s") path.replace_extension();
+    return path.string() + ".proof";
+}
+
+// --merkle: um unico CMS sobre a raiz de Merkle do manifesto e uma prova por documento
+static int runMerkleBatch(const BatchPipeline::Config& config, const std::string& signaturePath) {
+    std::vector<BatchPipeline::Entry> entries = BatchPipeline::readManifest(config.manifestPath, config.outDir);
+    if (entries.empty()) {
+        std::cerr << "Manifesto vazio ou inexistente: " << config.manifestPath << std::endl;
+        return 1;
     }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == '#') continue;
+    std::vector<std::string> docs;
+    std::vector<std::string> proofs;
+    for (const auto& entry : entries) {
+        docs.push_back(entry.docPath);
+        proofs.push_back(proofPath(entry.signaturePath));
+        std::filesystem::path parent = std::filesystem::path(proofs.back()).parent_path();
+        std::error_code ec;
+        if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+    }
 
-        size_t delimiterPos = line.find('=');
-        if (delimiterPos != std::string::npos) {
-            std::string key = line.substr(0, delimiterPos);
-            std::string value = line.substr(delimiterPos + 1);
-            
-            if (!value.empty() && value.back() == '\r') value.pop_back();
+    auto start = std::chrono::steady_clock::now();
+    if (!SignerService::generateBatchSignature(config.p12Path, config.password, docs, signaturePath, proofs)) {
+        Logger::flush();
+        return 1;
+    }
 
-            setenv(key.c_str(), value.c_str(), 1);
-        }
+    size_t valid = 0;
+    for (size_t i = 0; i < docs.size(); ++i) {
+        if (VerifierService::verifyWithProof(docs[i], proofs[i], signaturePath).isValid) valid++;
+        else std::cerr << "Prova invalida: " << docs[i] << std::endl;
     }
-    Utils::logInfo("Configuracao carregada do arquivo .env");
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    Logger::flush();
+
+    std::cout << "Documentos: " << docs.size() << " | validos: " << valid << " | invalidos: " << docs.size() - valid
+              << " | " << seconds << " s" << std::endl;
+    std::cout << "Assinatura do lote: " << signaturePath << std::endl;
+    return valid == docs.size() ? 0 : 2;
 }
-*/
 
-std::string getEnvVar(const std::string& key, const std::string& defaultValue = "") {
-    const char* val = std::getenv(key.c_str());
-    if (val == nullptr) {
-        return defaultValue;
+static int runBatch(int argc, char** argv, const std::string& p12Password) {
+    BatchPipeline::Config config;
+    config.p12Path = "resources/pkcs12/certificado_teste_hub.pfx";
+    config.reportPath = "relatorio_lote.csv";
+    config.password = p12Password;
+
+    std::string dir;
+    std::string merkle;
+    if (!parseBatchOptions(argc, argv, config, dir, merkle)) return 1;
+
+    // a pasta so gera o manifesto uma vez: na retomada a lista continua a mesma
+    if (!dir.empty() && !std::filesystem::exists(config.manifestPath)) {
+        if (!BatchPipeline::writeManifest(dir, config.manifestPath)) return 1;
     }
-    return std::string(val);
+
+    if (!merkle.empty()) return runMerkleBatch(config, merkle);
+
+    BatchPipeline::Summary summary = BatchPipeline::run(config);
+    Logger::flush();
+    if (!summary.ok) return 1;
+
+    std::cout << "Documentos: " << summary.total << " | validos: " << summary.valid
+              << " | invalidos: " << summary.invalid << " | erros: " << summary.errors
+              << " | pulados: " << summary.skipped << " | " << summary.seconds << " s" << std::endl;
+    std::cout << "Relatorio: " << config.reportPath << std::endl;
+    return (summary.invalid == 0 && summary.errors == 0) ? 0 : 2;
 }
 
-int main() {
+int main(int argc, char** argv) {
     
+    Utils::loadEnvFile();
+    Logger::setLevel(Logger::parseLevel(Utils::getEnvVar("LOG_LEVEL", "INFO")));
+
+    // O alocador precisa ser instalado antes de qualquer alocacao do OpenSSL
+    if (Utils::getEnvVar("OPENSSL_POOL_ALLOCATOR", "1") != "0" && !OpenSSLPool::installAllocator()) {
+        Utils::logInfo("Aviso: alocador do OpenSSL ja inicializado, usando o padrao");
+    }
+
     // Global OpenSSL Init
     OpenSSL_add_all_algorithms();
     ERR_load_crypto_strings();
 
-    loadEnvFile();
-
     // Configuration
     const std::string docFile = "resources/arquivos/doc.txt";
     const std::string hashFile = "resultado_etapa1.txt";
     const std::string p12File = "resources/pkcs12/certificado_teste_hub.pfx";
     const std::string signatureFile = "assinatura.p7s";
 
-    std::string p12Password = getEnvVar("P12_PASSWORD");
+    std::string p12Password = Utils::getEnvVar("P12_PASSWORD");
+
+    if (argc > 1) {
+        return runBatch(argc, argv, p12Password);
+    }
 
     // --- Execute Flow ---
 
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include "../src/AdmissionControl.h"
+
+using AdmissionControl::Gate;
+using AdmissionControl::GateConfig;
+using AdmissionControl::Ticket;
+
+// CENARIO 1 Admite ate o limite de concorrencia
+TEST(AdmissionControlTest, Acquire_AdmiteAteMaxConcurrent) {
+    Gate gate("sign", GateConfig{ 2, 0, 100.0 });
+    unsigned retryAfter = 0;
+
+    EXPECT_TRUE(gate.acquire(retryAfter));
+    EXPECT_TRUE(gate.acquire(retryAfter));
+    EXPECT_EQ(gate.stats().active, 2u);
+}
+
+// CENARIO 2 Fila cheia
+// Sem espaco na fila a requisicao deve ser recusada imediatamente com Retry-After
+TEST(AdmissionControlTest, Acquire_RecusaQuandoFilaCheia) {
+    Gate gate("sign", GateConfig{ 1, 0, 1000.0 });
+    unsigned retryAfter = 0;
+
+    ASSERT_TRUE(gate.acquire(retryAfter));
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(gate.acquire(retryAfter));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_GE(retryAfter, 1u);
+    EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), 100);
+    EXPECT_EQ(gate.stats().rejected, 1u);
+}
+
+// CENARIO 3 Espera na fila
+// Uma requisicao enfileirada deve ser admitida quando uma vaga for liberada
+TEST(AdmissionControlTest, Acquire_AdmiteAposRelease) {
+    Gate gate("verify", GateConfig{ 1, 4, 2000.0 });
+    unsigned retryAfter = 0;
+    ASSERT_TRUE(gate.acquire(retryAfter));
+
+    std::thread releaser([&gate] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        gate.release(20.0);
+    });
+
+    EXPECT_TRUE(gate.acquire(retryAfter));
+    releaser.join();
+    EXPECT_EQ(gate.stats().admitted, 2u);
+}
+
+// CENARIO 4 Alvo de latencia
+// Quando o tempo de servico medio ja excede o alvo a fila nao deve aceitar novos pedidos
+TEST(AdmissionControlTest, Acquire_RecusaQuandoEsperaEstimadaExcedeAlvo) {
+    Gate gate("sign", GateConfig{ 1, 100, 50.0 });
+    unsigned retryAfter = 0;
+
+    ASSERT_TRUE(gate.acquire(retryAfter));
+    gate.release(3000.0);
+    ASSERT_TRUE(gate.acquire(retryAfter));
+
+    EXPECT_FALSE(gate.acquire(retryAfter));
+    EXPECT_EQ(retryAfter, 3u);
+}
+
+// CENARIO 5 Ticket RAII
+// O ticket deve liberar a vaga ao sair de escopo
+TEST(AdmissionControlTest, Ticket_LiberaVagaNoDestrutor) {
+    Gate gate("verify", GateConfig{ 1, 0, 100.0 });
+    {
+        Ticket ticket(gate);
+        EXPECT_TRUE(ticket.admitted());
+
+        Ticket rejected(gate);
+        EXPECT_FALSE(rejected.admitted());
+    }
+    EXPECT_EQ(gate.stats().active, 0u);
+
+    Ticket again(gate);
+    EXPECT_TRUE(again.admitted());
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/BatchPipeline.h"
+#include "../src/BoundedQueue.h"
+#include "../src/VerifierService.h"
+
+namespace fs = std::filesystem;
+
+class BatchPipelineTest : public ::testing::Test {
+protected:
+    std::string validP12 = "resources/pkcs12/certificado_teste_hub.pfx";
+    std::string validPass = "bry123456";
+    std::string dir;
+    std::string manifest;
+    std::string report;
+    std::vector<std::string> docs;
+
+    void SetUp() override {
+        std::string testName = testing::UnitTest::GetInstance()->current_test_info()->name();
+        dir = "lote_" + testName;
+        manifest = dir + "_manifesto.txt";
+        report = dir + "_relatorio.csv";
+        fs::create_directories(dir);
+
+        // um documento grande o bastante para passar pelo caminho sem copia em memoria
+        for (int i = 0; i < 5; ++i) {
+            std::string doc = dir + "/doc" + std::to_string(i) + ".txt";
+            std::ofstream out(doc, std::ios::binary);
+            out << std::string(i == 4 ? 4096 : 100, static_cast<char>('a' + i));
+            docs.push_back(doc);
+        }
+        ASSERT_TRUE(BatchPipeline::writeManifest(dir, manifest));
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+        fs::remove(manifest);
+        fs::remove(report);
+    }
+
+    BatchPipeline::Config config() {
+        BatchPipeline::Config c;
+        c.manifestPath = manifest;
+        c.reportPath = report;
+        c.p12Path = validP12;
+        c.password = validPass;
+        c.signers = 2;
+        c.verifiers = 2;
+        c.queueCapacity = 2;
+        c.maxInMemoryBytes = 1024;
+        return c;
+    }
+
+    size_t reportRows() {
+        std::ifstream in(report);
+        std::string line;
+        size_t rows = 0;
+        while (std::getline(in, line)) ++rows;
+        return rows == 0 ? 0 : rows - 1;
+    }
+};
+
+// CENARIO 1 Fila limitada
+// O produtor bloqueia com a fila cheia e close() libera o consumidor depois de esvaziar
+TEST(BoundedQueueTest, PushBloqueia_EClose_EsvaziaAntesDeEncerrar) {
+    BoundedQueue<int> queue(2);
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_TRUE(queue.push(2));
+
+    std::thread producer([&] { queue.push(3); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(queue.size(), 2u);
+
+    int value = 0;
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 1);
+    producer.join();
+
+    queue.close();
+    EXPECT_FALSE(queue.push(4));
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 2);
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 3);
+    EXPECT_FALSE(queue.pop(value));
+}
+
+// CENARIO 2 Lote completo
+// Todos os documentos sao assinados, verificados e aparecem no relatorio
+TEST_F(BatchPipelineTest, Run_AssinaEVerificaTodos) {
+    BatchPipeline::Summary summary = BatchPipeline::run(config());
+
+    ASSERT_TRUE(summary.ok);
+    EXPECT_EQ(summary.total, 5u);
+    EXPECT_EQ(summary.valid, 5u);
+    EXPECT_EQ(summary.errors, 0u);
+    EXPECT_EQ(reportRows(), 5u);
+    for (const std::string& doc : docs) {
+        EXPECT_TRUE(VerifierService::verifyAndGetDetails(doc + ".p7s").isValid) << doc;
+    }
+}
+
+// CENARIO 3 Erro isolado
+// Um documento ausente vira ERRO_LEITURA sem interromper os demais
+TEST_F(BatchPipelineTest, Run_DocumentoAusente_NaoInterrompeLote) {
+    std::ofstream(manifest, std::ios::app) << dir << "/nao_existe.txt\n";
+
+    BatchPipeline::Summary summary = BatchPipeline::run(config());
+
+    ASSERT_TRUE(summary.ok);
+    EXPECT_EQ(summary.valid, 5u);
+    EXPECT_EQ(summary.errors, 1u);
+
+    std::ifstream in(report);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("nao_existe.txt,"), std::string::npos);
+    EXPECT_NE(content.find("ERRO_LEITURA"), std::string::npos);
+}
+
+// CENARIO 4 Retomada
+// Documentos VALIDO sao pulados; um com a assinatura apagada volta a ser processado
+TEST_F(BatchPipelineTest, Run_Retomada_PulaConcluidos) {
+    ASSERT_EQ(BatchPipeline::run(config()).valid, 5u);
+
+    fs::remove(docs[2] + ".p7s");
+    BatchPipeline::Summary summary = BatchPipeline::run(config());
+
+    ASSERT_TRUE(summary.ok);
+    EXPECT_EQ(summary.skipped, 4u);
+    EXPECT_EQ(summary.valid, 1u);
+    EXPECT_TRUE(fs::exists(docs[2] + ".p7s"));
+    EXPECT_EQ(reportRows(), 6u);
+}
+
+// CENARIO 5 Pasta de saida
+// Com outDir as assinaturas espelham a estrutura dos documentos dentro da pasta
+TEST_F(BatchPipelineTest, Run_PastaDeSaida) {
+    BatchPipeline::Config c = config();
+    c.outDir = dir + "/assinaturas";
+
+    ASSERT_EQ(BatchPipeline::run(c).valid, 5u);
+    EXPECT_TRUE(fs::exists(fs::path(c.outDir) / (docs[0] + ".p7s")));
+    EXPECT_FALSE(fs::exists(docs[0] + ".p7s"));
+}
+
+// CENARIO 6 Credenciais invalidas
+// Senha errada impede o inicio do lote
+TEST_F(BatchPipelineTest, Run_SenhaInvalida_RetornaFalha) {
+    BatchPipeline::Config c = config();
+    c.password = "senha_errada";
+
+    BatchPipeline::Summary summary = BatchPipeline::run(c);
+    EXPECT_FALSE(summary.ok);
+    EXPECT_EQ(summary.valid, 0u);
+}
+
+// CENARIO 7 Retomada com documento alterado
+// Um documento reescrito no mesmo caminho depois do lote eh assinado de novo
+TEST_F(BatchPipelineTest, Run_Retomada_DocumentoAlteradoEhAssinadoDeNovo) {
+    ASSERT_EQ(BatchPipeline::run(config()).valid, 5u);
+
+    {
+        std::ofstream out(docs[1], std::ios::binary | std::ios::trunc);
+        out << "conteudo novo, de outro tamanho";
+    }
+    BatchPipeline::Summary summary = BatchPipeline::run(config());
+
+    ASSERT_TRUE(summary.ok);
+    EXPECT_EQ(summary.skipped, 4u);
+    EXPECT_EQ(summary.valid, 1u);
+    EXPECT_EQ(BatchPipeline::completedEntries(report).size(), 5u);
+
+    // mesmo tamanho, data de modificacao diferente
+    {
+        std::ofstream out(docs[3], std::ios::binary | std::ios::trunc);
+        out << std::string(100, 'z');
+    }
+    fs::last_write_time(docs[3], fs::last_write_time(docs[3]) + std::chrono::seconds(5));
+    EXPECT_EQ(BatchPipeline::completedEntries(report).count(docs[3]), 0u);
+    EXPECT_EQ(BatchPipeline::run(config()).valid, 1u);
+}
+
+// CENARIO 8 Orcamento de memoria
+// Com espaco para dois documentos pequenos o lote termina e o pico fica no orcamento
+TEST_F(BatchPipelineTest, Run_OrcamentoDeBytes_LimitaMemoria) {
+    BatchPipeline::Config c = config();
+    c.maxBufferedBytes = 250;
+
+    BatchPipeline::Summary summary = BatchPipeline::run(c);
+    ASSERT_TRUE(summary.ok);
+    EXPECT_EQ(summary.valid, 5u);
+    EXPECT_GT(summary.peakBufferedBytes, 0u);
+    EXPECT_LE(summary.peakBufferedBytes, 250u);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <openssl/pem.h>
+#include "../src/CertIndex.h"
+#include "../src/SignerService.h"
+#include "../src/VerifierService.h"
+
+namespace fs = std::filesystem;
+
+class CertIndexTest : public ::testing::Test {
+protected:
+    std::string validP12 = "resources/pkcs12/certificado_teste_hub.pfx";
+    std::string validPass = "bry123456";
+    std::string tempDoc;
+    std::string compactSig;
+
+    void SetUp() override {
+        std::string testName = testing::UnitTest::GetInstance()->current_test_info()->name();
+        tempDoc = "doc_" + testName + ".txt";
+        compactSig = "sig_" + testName + ".p7s";
+
+        std::ofstream out(tempDoc);
+        out << "Documento pequeno: o certificado seria a maior parte da assinatura";
+        out.close();
+    }
+
+    void TearDown() override {
+        std::remove(tempDoc.c_str());
+        std::remove(compactSig.c_str());
+    }
+
+    CMS_ContentInfo* loadSig(const std::string& path) {
+        return VerifierService::loadCMS(path);
+    }
+};
+
+// CENARIO 1 Busca por issuer e serial
+// O SignerInfo de uma assinatura sem certificados deve achar o certificado do P12 no indice
+TEST_F(CertIndexTest, Find_IssuerSerial_AchaSignatario) {
+    ASSERT_TRUE(SignerService::generateSignature(validP12, validPass, tempDoc, compactSig, SignerService::CertMode::None));
+
+    CertIndex::Index index;
+    ASSERT_TRUE(index.loadPkcs12(validP12, validPass));
+    EXPECT_GE(index.size(), 1u);
+
+    OpenSSLPool::CmsPtr cms(loadSig(compactSig));
+    ASSERT_TRUE(cms);
+    CMS_SignerInfo* si = sk_CMS_SignerInfo_value(CMS_get0_SignerInfos(cms.get()), 0);
+    X509* cert = index.find(si);
+    ASSERT_NE(cert, nullptr);
+    EXPECT_EQ(CMS_SignerInfo_cert_cmp(si, cert), 0);
+}
+
+// CENARIO 2 Verificacao compacta
+// Sem indice a assinatura sem certificados eh invalida; com o indice eh valida e traz o signatario
+TEST_F(CertIndexTest, Verify_Compacta_PrecisaDoIndice) {
+    ASSERT_TRUE(SignerService::generateSignature(validP12, validPass, tempDoc, compactSig, SignerService::CertMode::None));
+
+    EXPECT_FALSE(VerifierService::verifyAndGetDetails(compactSig).isValid);
+
+    CertIndex::Index index;
+    ASSERT_TRUE(index.loadPkcs12(validP12, validPass));
+    VerifierService::VerificationResult res = VerifierService::verifyAndGetDetails(compactSig, &index);
+    EXPECT_TRUE(res.isValid);
+    EXPECT_FALSE(res.signerName.empty());
+
+    VerifierService::InspectionResult info = VerifierService::inspect(compactSig, &index);
+    EXPECT_TRUE(info.parsed);
+    EXPECT_EQ(info.signerName, res.signerName);
+}
+
+// CENARIO 3 Pasta de certificados
+// loadDirectory indexa todos os P12 de teste e resolve uma assinatura Ed25519 compacta
+TEST_F(CertIndexTest, LoadDirectory_IndexaTodosOsP12) {
+    CertIndex::Index index;
+    EXPECT_GE(index.loadDirectory("resources/pkcs12", validPass), 5u);
+
+    std::string edP12 = "resources/pkcs12/certificado_teste_ed25519.pfx";
+    ASSERT_TRUE(SignerService::generateSignature(edP12, validPass, tempDoc, compactSig, SignerService::CertMode::None));
+    EXPECT_TRUE(VerifierService::verifyAndGetDetails(compactSig, &index).isValid);
+}
+
+// CENARIO 4 Certificado em PEM e busca por SKI
+// Um certificado solto em PEM entra no indice e resolve SignerInfo identificado por subjectKeyIdentifier
+TEST_F(CertIndexTest, LoadDirectory_PemEKeyId) {
+    PKCS12* p12 = nullptr;
+    EVP_PKEY* pkey = nullptr;
+    X509* cert = nullptr;
+    STACK_OF(X509)* ca = nullptr;
+    ASSERT_TRUE(SignerService::loadCredentials(validP12, validPass, &p12, &pkey, &cert, &ca));
+    OpenSSLPool::P12Ptr p12Guard(p12);
+    OpenSSLPool::PkeyPtr pkeyGuard(pkey);
+    OpenSSLPool::X509Ptr certGuard(cert);
+    OpenSSLPool::X509StackPtr caGuard(ca);
+
+    std::string dir = "certs_" + compactSig;
+    fs::create_directories(dir);
+    {
+        OpenSSLPool::BioPtr out(BIO_new_file((dir + "/signatario.pem").c_str(), "w"));
+        ASSERT_TRUE(out && PEM_write_bio_X509(out.get(), cert));
+    }
+
+    CertIndex::Index index;
+    EXPECT_EQ(index.loadDirectory(dir, ""), 1u);
+    fs::remove_all(dir);
+
+    if (!X509_get0_subject_key_id(cert)) GTEST_SKIP() << "Certificado de teste sem subjectKeyIdentifier";
+
+    OpenSSLPool::BioPtr content(BIO_new_mem_buf("abc", 3));
+    OpenSSLPool::CmsPtr cms(CMS_sign(cert, pkey, nullptr, content.get(), CMS_BINARY | CMS_NOCERTS | CMS_USE_KEYID));
+    ASSERT_TRUE(cms);
+    CMS_SignerInfo* si = sk_CMS_SignerInfo_value(CMS_get0_SignerInfos(cms.get()), 0);
+    EXPECT_NE(index.find(si), nullptr);
+}
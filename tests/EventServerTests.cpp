@@ -0,0 +1,427 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/EventServer.h"
+#include "../src/TimestampService.h"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static int connectTo(unsigned short port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    timeval timeout{ 5, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        sent += static_cast<size_t>(n);
+    }
+}
+
+// le ate ter `count` respostas completas (usa o Content-Length) ou o socket fechar
+static std::vector<std::string> readResponses(int fd, size_t count) {
+    std::vector<std::string> responses;
+    std::string buffer;
+    char chunk[4096];
+    while (responses.size() < count) {
+        size_t headEnd = buffer.find("\r\n\r\n");
+        if (headEnd != std::string::npos) {
+            size_t lengthPos = buffer.find("Content-Length: ");
+            size_t length = std::stoul(buffer.substr(lengthPos + 16));
+            if (buffer.size() >= headEnd + 4 + length) {
+                responses.push_back(buffer.substr(0, headEnd + 4 + length));
+                buffer.erase(0, headEnd + 4 + length);
+                continue;
+            }
+        }
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) break;
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+    return responses;
+}
+
+static std::string multipartRequest(const std::string& path, const std::string& content) {
+    std::string boundary = "----BryEvent";
+    std::string body = "--" + boundary + "\r\nContent-Disposition: form-data; name=\"file\"; filename=\"a.bin\"\r\n\r\n" +
+                       content + "\r\n--" + boundary + "--\r\n";
+    return "POST " + path + " HTTP/1.1\r\nHost: t\r\nContent-Type: multipart/form-data; boundary=" + boundary +
+           "\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+// rota /size devolve o tamanho do arquivo recebido; /slow segura a thread do pool
+static EventServer::Config testConfig(unsigned threads, size_t maxPending) {
+    EventServer::Config config;
+    config.port = 0;
+    config.cryptoThreads = threads;
+    config.lanes = { { "cpu", maxPending } };
+    config.idleTimeoutSeconds = 60;
+    return config;
+}
+
+static std::vector<EventServer::Route> testRoutes(std::atomic<int>* slowCalls = nullptr) {
+    return {
+        { "/size", [](const HttpStream::Request& request) {
+            HttpStream::Response response;
+            auto it = request.fileBytes.find("file");
+            response.body = it == request.fileBytes.end() ? "0" : std::to_string(it->second);
+            return response;
+        }, 0 },
+        { "/slow", [slowCalls](const HttpStream::Request&) {
+            if (slowCalls) ++*slowCalls;
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            HttpStream::Response response;
+            response.body = "lento";
+            return response;
+        }, 0 },
+        { "/ping", [](const HttpStream::Request&) {
+            HttpStream::Response response;
+            response.body = "pong";
+            return response;
+        }, -1 }
+    };
+}
+#endif
+
+// CENARIO 1 Upload lento em pedacos
+// O corpo chega em varios envios espacados; o handler so roda com a requisicao
+// completa e a resposta traz o Server-Timing com parse e fila
+TEST(EventServerTest, Upload_EmPedacosComKeepAlive) {
+#ifndef __linux__
+    GTEST_SKIP() << "Front end epoll apenas no Linux";
+#else
+    EventServer::Server server(testConfig(2, 8), testRoutes());
+    std::string error;
+    ASSERT_TRUE(server.start(error)) << error;
+
+    int fd = connectTo(server.port());
+    ASSERT_GE(fd, 0);
+
+    std::string request = multipartRequest("/size", std::string(100000, 'z'));
+    for (size_t offset = 0; offset < request.size(); offset += 7000) {
+        sendAll(fd, request.substr(offset, 7000));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    std::vector<std::string> responses = readResponses(fd, 1);
+    ASSERT_EQ(responses.size(), 1u);
+    EXPECT_EQ(responses[0].rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_NE(responses[0].find("Connection: Keep-Alive"), std::string::npos);
+    EXPECT_NE(responses[0].find("Server-Timing: parse;dur="), std::string::npos);
+    EXPECT_NE(responses[0].find("queue;dur="), std::string::npos);
+    EXPECT_EQ(responses[0].substr(responses[0].size() - 6), "100000");
+
+    // a mesma conexao atende a proxima requisicao
+    sendAll(fd, "GET /ping HTTP/1.1\r\nHost: t\r\n\r\n");
+    responses = readResponses(fd, 1);
+    ASSERT_EQ(responses.size(), 1u);
+    EXPECT_EQ(responses[0].substr(responses[0].size() - 4), "pong");
+
+    ::close(fd);
+    server.stop();
+#endif
+}
+
+// CENARIO 2 Pipelining e rotas desconhecidas
+// Tres requisicoes num unico envio sao respondidas na ordem, incluindo o 404
+TEST(EventServerTest, Pipelining_RespondeNaOrdem) {
+#ifndef __linux__
+    GTEST_SKIP() << "Front end epoll apenas no Linux";
+#else
+    EventServer::Server server(testConfig(2, 8), testRoutes());
+    std::string error;
+    ASSERT_TRUE(server.start(error)) << error;
+
+    int fd = connectTo(server.port());
+    ASSERT_GE(fd, 0);
+    sendAll(fd, multipartRequest("/size", "abc") + "GET /nada HTTP/1.1\r\n\r\n" + "GET /ping HTTP/1.1\r\n\r\n");
+
+    std::vector<std::string> responses = readResponses(fd, 3);
+    ASSERT_EQ(responses.size(), 3u);
+    EXPECT_EQ(responses[0].substr(responses[0].size() - 1), "3");
+    EXPECT_EQ(responses[1].rfind("HTTP/1.1 404", 0), 0u);
+    EXPECT_EQ(responses[2].substr(responses[2].size() - 4), "pong");
+
+    ::close(fd);
+#endif
+}
+
+// CENARIO 3 Fila do pool cheia
+// Com uma thread e no maximo uma requisicao pendente, a segunda simultanea
+// recebe 503 com Retry-After sem esperar a primeira
+TEST(EventServerTest, PoolCheio_Responde503) {
+#ifndef __linux__
+    GTEST_SKIP() << "Front end epoll apenas no Linux";
+#else
+    std::atomic<int> slowCalls{ 0 };
+    EventServer::Server server(testConfig(1, 1), testRoutes(&slowCalls));
+    std::string error;
+    ASSERT_TRUE(server.start(error)) << error;
+
+    int first = connectTo(server.port());
+    int second = connectTo(server.port());
+    sendAll(first, "GET /slow HTTP/1.1\r\n\r\n");
+    while (slowCalls.load() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    auto start = std::chrono::steady_clock::now();
+    sendAll(second, "GET /slow HTTP/1.1\r\n\r\n");
+    std::vector<std::string> rejected = readResponses(second, 1);
+    auto waitedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    ASSERT_EQ(rejected.size(), 1u);
+    EXPECT_EQ(rejected[0].rfind("HTTP/1.1 503", 0), 0u);
+    EXPECT_NE(rejected[0].find("Retry-After: 1"), std::string::npos);
+    EXPECT_LT(waitedMs, 250);
+
+    std::vector<std::string> accepted = readResponses(first, 1);
+    ASSERT_EQ(accepted.size(), 1u);
+    EXPECT_EQ(accepted[0].rfind("HTTP/1.1 200", 0), 0u);
+
+    ::close(first);
+    ::close(second);
+#endif
+}
+
+// CENARIO 4 Conexoes ociosas nao ocupam o pool
+// Centenas de clientes com requisicoes pela metade nao impedem um cliente novo
+// de ser atendido; todas ficam abertas na thread de eventos
+TEST(EventServerTest, ConexoesOciosas_NaoBloqueiam) {
+#ifndef __linux__
+    GTEST_SKIP() << "Front end epoll apenas no Linux";
+#else
+    EventServer::Server server(testConfig(1, 4), testRoutes());
+    std::string error;
+    ASSERT_TRUE(server.start(error)) << error;
+
+    std::vector<int> idle;
+    std::string partial = multipartRequest("/size", std::string(1000, 'a')).substr(0, 300);
+    for (int i = 0; i < 200; ++i) {
+        int fd = connectTo(server.port());
+        ASSERT_GE(fd, 0);
+        sendAll(fd, partial);
+        idle.push_back(fd);
+    }
+
+    int fd = connectTo(server.port());
+    sendAll(fd, multipartRequest("/size", "12345"));
+    std::vector<std::string> responses = readResponses(fd, 1);
+    ASSERT_EQ(responses.size(), 1u);
+    EXPECT_EQ(responses[0].substr(responses[0].size() - 1), "5");
+    EXPECT_GE(server.openConnections(), 200u);
+
+    ::close(fd);
+    for (int idleFd : idle) ::close(idleFd);
+#endif
+}
+
+// CENARIO 5 Erro de protocolo
+// Content-Length acima do limite responde 413 e fecha a conexao
+TEST(EventServerTest, CorpoGrande_Responde413EFecha) {
+#ifndef __linux__
+    GTEST_SKIP() << "Front end epoll apenas no Linux";
+#else
+    EventServer::Config config = testConfig(1, 4);
+    config.limits.maxRequestBytes = 1000;
+    EventServer::Server server(config, testRoutes());
+    std::string error;
+    ASSERT_TRUE(server.start(error)) << error;
+
+    int fd = connectTo(server.port());
+    sendAll(fd, "POST /size HTTP/1.1\r\nContent-Length: 5000\r\n\r\n");
+    std::vector<std::string> responses = readResponses(fd, 1);
+    ASSERT_EQ(responses.size(), 1u);
+    EXPECT_EQ(responses[0].rfind("HTTP/1.1 413", 0), 0u);
+    EXPECT_NE(responses[0].find("Connection: close"), std::string::npos);
+
+    char byte;
+    EXPECT_EQ(::recv(fd, &byte, 1, 0), 0);
+    ::close(fd);
+#endif
+}
+
+// CENARIO 6 Rota de prefixo com corpo externo
+// /blob/{nome} responde com um buffer de 4 MB fora da string do corpo (enviado sem
+// copia, em varios EPOLLOUT); /blobabc, sem a barra, nao casa com a rota
+TEST(EventServerTest, RotaDePrefixo_CorpoExternoGrande) {
+#ifndef __linux__
+    GTEST_SKIP() << "Front end epoll apenas no Linux";
+#else
+    auto blob = std::make_shared<std::string>(4 * 1024 * 1024, 'x');
+    (*blob)[0] = 'a';
+    blob->back() = 'z';
+
+    std::vector<EventServer::Route> routes = testRoutes();
+    routes.push_back({ "/blob/", [blob](const HttpStream::Request& request) {
+        HttpStream::Response response;
+        response.contentType = "application/octet-stream";
+        response.headers.emplace_back("X-Nome", request.path.substr(6));
+        response.bodyOwner = blob;
+        response.bodyData = blob->data();
+        response.bodyLength = blob->size();
+        return response;
+    }, -1 });
+
+    EventServer::Server server(testConfig(1, 4), std::move(routes));
+    std::string error;
+    ASSERT_TRUE(server.start(error)) << error;
+
+    int fd = connectTo(server.port());
+    ASSERT_GE(fd, 0);
+    sendAll(fd, "GET /blob/abc HTTP/1.1\r\n\r\nGET /blobabc HTTP/1.1\r\n\r\nGET /ping HTTP/1.1\r\n\r\n");
+
+    std::vector<std::string> responses = readResponses(fd, 3);
+    ASSERT_EQ(responses.size(), 3u);
+    EXPECT_EQ(responses[0].rfind("HTTP/1.1 200", 0), 0u);
+    EXPECT_NE(responses[0].find("X-Nome: abc"), std::string::npos);
+    EXPECT_NE(responses[0].find("Content-Length: 4194304"), std::string::npos);
+    std::string body = responses[0].substr(responses[0].find("\r\n\r\n") + 4);
+    EXPECT_TRUE(body == *blob);
+    EXPECT_EQ(responses[1].rfind("HTTP/1.1 404", 0), 0u);
+    EXPECT_EQ(responses[2].substr(responses[2].size() - 4), "pong");
+
+    ::close(fd);
+    server.stop();
+#endif
+}
+
+// CENARIO 7 Resposta adiada durante o carimbo de tempo
+// Com duas threads de criptografia, oito pedidos que esperam a TSA liberam o pool
+// (deferResponse) e entram juntos no mesmo lote do Batcher: o lote (8) eh maior que
+// o pool e fecha por estar cheio, sem esperar a janela longa
+TEST(EventServerTest, RespostaAdiada_LoteMaiorQueOPool) {
+#ifndef __linux__
+    GTEST_SKIP() << "Front end epoll apenas no Linux";
+#else
+    EXPECT_FALSE(EventServer::deferResponse());
+
+    TimestampService::Config tsa;
+    tsa.windowMs = 4000;
+    tsa.maxBatch = 8;
+    TimestampService::Batcher batcher(tsa, [](const std::vector<unsigned char>&, std::vector<unsigned char>&, std::string& error) {
+        error = "TSA de teste";
+        return false;
+    });
+
+    std::vector<EventServer::Route> routes = testRoutes();
+    routes.push_back({ "/stamp", [&batcher](const HttpStream::Request&) {
+        EventServer::Reply reply = EventServer::deferResponse();
+        MerkleTree::Hash leaf{};
+        batcher.stampAsync(leaf, [reply](bool ok, const TimestampService::Stamp&, const std::string& error) {
+            HttpStream::Response response;
+            response.body = ok ? "carimbado" : error;
+            reply(response);
+        });
+        return HttpStream::Response();
+    }, 0 });
+
+    EventServer::Server server(testConfig(2, 16), std::move(routes));
+    std::string error;
+    ASSERT_TRUE(server.start(error)) << error;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int> fds;
+    for (int i = 0; i < 8; ++i) {
+        int fd = connectTo(server.port());
+        ASSERT_GE(fd, 0);
+        sendAll(fd, "GET /stamp HTTP/1.1\r\nHost: t\r\n\r\n");
+        fds.push_back(fd);
+    }
+    for (int fd : fds) {
+        std::vector<std::string> responses = readResponses(fd, 1);
+        ASSERT_EQ(responses.size(), 1u);
+        EXPECT_EQ(responses[0].rfind("HTTP/1.1 200", 0), 0u);
+        EXPECT_NE(responses[0].find("deferred"), std::string::npos);
+        EXPECT_EQ(responses[0].substr(responses[0].size() - 12), "TSA de teste");
+        ::close(fd);
+    }
+    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    TimestampService::Stats stats = batcher.stats();
+    EXPECT_EQ(stats.batches, 1u);
+    EXPECT_EQ(stats.largestBatch, 8u);
+    EXPECT_LT(elapsedMs, 4000);
+    server.stop();
+#endif
+}
+
+// CENARIO 8 Prazos por requisicao e por escrita
+// Cabecalhos a conta-gotas, corpo a conta-gotas e um cliente que nunca le a resposta
+// mantem a conexao ativa, mas sao fechados pelos prazos; um cliente normal segue atendido
+TEST(EventServerTest, Prazos_FechamClientesLentos) {
+#ifndef __linux__
+    GTEST_SKIP() << "Front end epoll apenas no Linux";
+#else
+    auto blob = std::make_shared<std::string>(16 * 1024 * 1024, 'x');
+    std::vector<EventServer::Route> routes = testRoutes();
+    routes.push_back({ "/blob", [blob](const HttpStream::Request&) {
+        HttpStream::Response response;
+        response.bodyOwner = blob;
+        response.bodyData = blob->data();
+        response.bodyLength = blob->size();
+        return response;
+    }, -1 });
+
+    EventServer::Config config = testConfig(1, 4);
+    config.headerTimeoutSeconds = 1;
+    config.requestTimeoutSeconds = 2;
+    config.writeTimeoutSeconds = 1;
+    EventServer::Server server(config, std::move(routes));
+    std::string error;
+    ASSERT_TRUE(server.start(error)) << error;
+
+    std::string request = multipartRequest("/size", std::string(1000, 'a'));
+    size_t headEnd = request.find("\r\n\r\n") + 4;
+    int headerFd = connectTo(server.port());
+    int bodyFd = connectTo(server.port());
+    int readerFd = connectTo(server.port());
+    ASSERT_GE(headerFd, 0);
+    ASSERT_GE(bodyFd, 0);
+    ASSERT_GE(readerFd, 0);
+    sendAll(bodyFd, request.substr(0, headEnd));
+    sendAll(readerFd, "GET /blob HTTP/1.1\r\n\r\n");
+    for (int i = 0; i < 100 && server.openConnections() < 3; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_EQ(server.openConnections(), 3u);
+
+    // um byte por conexao a cada 200 ms: o prazo de inatividade (60 s) nunca venceria
+    auto start = std::chrono::steady_clock::now();
+    for (size_t sent = 0; server.openConnections() > 0 && sent < headEnd; ++sent) {
+        if (std::chrono::steady_clock::now() - start > std::chrono::seconds(8)) break;
+        ::send(headerFd, request.data() + sent, 1, MSG_NOSIGNAL);
+        ::send(bodyFd, request.data() + headEnd + sent, 1, MSG_NOSIGNAL);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    EXPECT_EQ(server.openConnections(), 0u);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+
+    int fd = connectTo(server.port());
+    sendAll(fd, multipartRequest("/size", "12345"));
+    std::vector<std::string> responses = readResponses(fd, 1);
+    ASSERT_EQ(responses.size(), 1u);
+    EXPECT_EQ(responses[0].substr(responses[0].size() - 1), "5");
+
+    for (int open : { fd, headerFd, bodyFd, readerFd }) ::close(open);
+    server.stop();
+#endif
+}
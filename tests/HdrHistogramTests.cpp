@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "../src/HdrHistogram.h"
+
+// CENARIO 1 Histograma vazio
+TEST(HdrHistogramTest, Vazio_RetornaZeros) {
+    HdrHistogram h(1, 3600000000LL, 3);
+    EXPECT_EQ(h.totalCount(), 0);
+    EXPECT_EQ(h.valueAtPercentile(99.0), 0);
+    EXPECT_EQ(h.max(), 0);
+}
+
+// CENARIO 2 Precisao
+// Valores devem ser preservados dentro de 3 digitos significativos
+TEST(HdrHistogramTest, Record_PreservaDigitosSignificativos) {
+    HdrHistogram h(1, 3600000000LL, 3);
+    h.record(1);
+    h.record(1000);
+    h.record(123456);
+    h.record(3599999999LL);
+
+    EXPECT_EQ(h.min(), 1);
+    EXPECT_NEAR(static_cast<double>(h.valueAtPercentile(50.0)), 1000.0, 1.0);
+    EXPECT_NEAR(static_cast<double>(h.valueAtPercentile(75.0)), 123456.0, 123456.0 * 0.001);
+    EXPECT_NEAR(static_cast<double>(h.max()), 3599999999.0, 3599999999.0 * 0.001);
+}
+
+// CENARIO 3 Percentis
+// Distribuicao uniforme 1..10000 deve ter percentis proximos do valor teorico
+TEST(HdrHistogramTest, ValueAtPercentile_DistribuicaoUniforme) {
+    HdrHistogram h(1, 3600000000LL, 3);
+    for (int i = 1; i <= 10000; ++i) h.record(i);
+
+    EXPECT_EQ(h.totalCount(), 10000);
+    EXPECT_NEAR(static_cast<double>(h.valueAtPercentile(50.0)), 5000.0, 5.0);
+    EXPECT_NEAR(static_cast<double>(h.valueAtPercentile(99.0)), 9900.0, 10.0);
+    EXPECT_NEAR(static_cast<double>(h.valueAtPercentile(99.9)), 9990.0, 10.0);
+    EXPECT_NEAR(h.mean(), 5000.5, 5.0);
+}
+
+// CENARIO 4 Merge
+// Histogramas por thread combinados devem equivaler a um unico histograma
+TEST(HdrHistogramTest, Merge_SomaContagens) {
+    HdrHistogram a(1, 3600000000LL, 3);
+    HdrHistogram b(1, 3600000000LL, 3);
+    for (int i = 0; i < 100; ++i) a.record(10);
+    for (int i = 0; i < 100; ++i) b.record(5000000);
+
+    a.merge(b);
+    EXPECT_EQ(a.totalCount(), 200);
+    EXPECT_EQ(a.valueAtPercentile(50.0), 10);
+    EXPECT_NEAR(static_cast<double>(a.valueAtPercentile(99.0)), 5000000.0, 5000.0);
+}
+
+// CENARIO 5 Saida da distribuicao
+TEST(HdrHistogramTest, PrintPercentileDistribution_GeraTabela) {
+    HdrHistogram h(1, 3600000000LL, 3);
+    for (int i = 1; i <= 1000; ++i) h.record(i);
+
+    std::ostringstream out;
+    h.printPercentileDistribution(out, 1000.0);
+    EXPECT_NE(out.str().find("Percentile"), std::string::npos);
+    EXPECT_NE(out.str().find("#[Total count    =         1000]"), std::string::npos);
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "../src/HttpStream.h"
+
+static const std::string kBoundary = "----BryTestBoundary";
+
+static HttpStream::Limits testLimits() {
+    return HttpStream::Limits{ 4096, 1024 * 1024, 2 * 1024 * 1024, 64 };
+}
+
+static std::string tempDir() {
+    return std::filesystem::temp_directory_path().string();
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+static std::string multipartBody(const std::string& fileContent, const std::string& password) {
+    std::string body;
+    body += "--" + kBoundary + "\r\n";
+    body += "Content-Disposition: form-data; name=\"file\"; filename=\"doc.txt\"\r\n";
+    body += "Content-Type: application/octet-stream\r\n\r\n";
+    body += fileContent + "\r\n";
+    body += "--" + kBoundary + "\r\n";
+    body += "Content-Disposition: form-data; name=\"password\"\r\n\r\n";
+    body += password + "\r\n";
+    body += "--" + kBoundary + "--\r\n";
+    return body;
+}
+
+static std::string postRequest(const std::string& body, const std::string& extraHeaders = "") {
+    return "POST /signature HTTP/1.1\r\nHost: localhost\r\n"
+           "Content-Type: multipart/form-data; boundary=" + kBoundary + "\r\n"
+           "Content-Length: " + std::to_string(body.size()) + "\r\n" + extraHeaders + "\r\n" + body;
+}
+
+// CENARIO 1 Bytes em pedacos arbitrarios
+// A mesma requisicao entregue de 1 em 1 byte (delimitador partido em todas as
+// posicoes) deve gerar o mesmo arquivo e os mesmos campos que em um unico feed
+TEST(HttpStreamTest, Parser_RequisicaoPartidaByteAByte) {
+    // conteudo com trechos parecidos com o delimitador
+    std::string content = "linha 1\r\n--" + kBoundary.substr(0, 10) + "\r\nlinha 2\r\n-";
+    std::string raw = postRequest(multipartBody(content, "bry123456"));
+
+    for (size_t step : { raw.size(), static_cast<size_t>(1), static_cast<size_t>(7) }) {
+        HttpStream::RequestParser parser(testLimits(), tempDir());
+        size_t offset = 0;
+        while (offset < raw.size() && parser.state() != HttpStream::RequestParser::State::Complete) {
+            size_t length = std::min(step, raw.size() - offset);
+            offset += parser.feed(raw.data() + offset, length);
+        }
+
+        ASSERT_EQ(parser.state(), HttpStream::RequestParser::State::Complete) << "passo " << step;
+        std::unique_ptr<HttpStream::Request> request = parser.take();
+        EXPECT_EQ(request->method, "POST");
+        EXPECT_EQ(request->path, "/signature");
+        EXPECT_EQ(request->fields["password"], "bry123456");
+        ASSERT_EQ(request->files.count("file"), 1u);
+
+        std::string path = request->files["file"];
+        EXPECT_EQ(readFile(path), content);
+        EXPECT_EQ(request->fileBytes["file"], static_cast<long long>(content.size()));
+
+        // o destrutor da requisicao remove o temporario
+        request.reset();
+        EXPECT_FALSE(std::filesystem::exists(path));
+    }
+}
+
+// CENARIO 2 Pipelining
+// Duas requisicoes no mesmo buffer: o parser para no fim da primeira e a segunda
+// eh lida depois do take()
+TEST(HttpStreamTest, Parser_DuasRequisicoesEncadeadas) {
+    std::string first = "GET /metrics HTTP/1.1\r\nHost: a\r\n\r\n";
+    std::string second = postRequest(multipartBody("abc", "x"), "Connection: close\r\n");
+    std::string raw = first + second;
+
+    HttpStream::RequestParser parser(testLimits(), tempDir());
+    size_t used = parser.feed(raw.data(), raw.size());
+    ASSERT_EQ(parser.state(), HttpStream::RequestParser::State::Complete);
+    EXPECT_EQ(used, first.size());
+
+    std::unique_ptr<HttpStream::Request> request = parser.take();
+    EXPECT_EQ(request->path, "/metrics");
+    EXPECT_TRUE(request->keepAlive);
+
+    used += parser.feed(raw.data() + used, raw.size() - used);
+    ASSERT_EQ(parser.state(), HttpStream::RequestParser::State::Complete);
+    EXPECT_EQ(used, raw.size());
+    request = parser.take();
+    EXPECT_EQ(request->fields["password"], "x");
+    EXPECT_FALSE(request->keepAlive);
+}
+
+// CENARIO 3 Limites
+// Content-Length acima do limite responde 413 antes do corpo; arquivo acima do
+// limite por campo interrompe a leitura e nao deixa temporario para tras
+TEST(HttpStreamTest, Parser_LimitesRespondem413) {
+    HttpStream::Limits limits = testLimits();
+    {
+        HttpStream::RequestParser parser(limits, tempDir());
+        std::string head = "POST /verify HTTP/1.1\r\nContent-Length: 999999999\r\n\r\n";
+        parser.feed(head.data(), head.size());
+        ASSERT_EQ(parser.state(), HttpStream::RequestParser::State::Error);
+        EXPECT_EQ(parser.error().status, 413);
+        EXPECT_TRUE(parser.error().close);
+    }
+    {
+        limits.maxFieldBytes = 100;
+        HttpStream::RequestParser parser(limits, tempDir());
+        std::string raw = postRequest(multipartBody(std::string(500, 'a'), "x"));
+        parser.feed(raw.data(), raw.size());
+        ASSERT_EQ(parser.state(), HttpStream::RequestParser::State::Error);
+        EXPECT_EQ(parser.error().status, 413);
+    }
+    {
+        HttpStream::RequestParser parser(testLimits(), tempDir());
+        std::string raw = postRequest(multipartBody("abc", std::string(200, 'p')));
+        parser.feed(raw.data(), raw.size());
+        ASSERT_EQ(parser.state(), HttpStream::RequestParser::State::Error);
+        EXPECT_EQ(parser.error().status, 413);
+    }
+}
+
+// CENARIO 4 Requisicoes malformadas
+// Corpo chunked, multipart sem o delimitador final e cabecalhos grandes demais
+TEST(HttpStreamTest, Parser_RequisicoesMalformadas) {
+    {
+        HttpStream::RequestParser parser(testLimits(), tempDir());
+        std::string raw = "POST /verify HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
+        parser.feed(raw.data(), raw.size());
+        ASSERT_EQ(parser.state(), HttpStream::RequestParser::State::Error);
+        EXPECT_EQ(parser.error().status, 411);
+    }
+    {
+        std::string body = multipartBody("abc", "x");
+        body.resize(body.size() - (kBoundary.size() + 6));   // sem "--boundary--\r\n"
+        HttpStream::RequestParser parser(testLimits(), tempDir());
+        std::string raw = postRequest(body);
+        parser.feed(raw.data(), raw.size());
+        ASSERT_EQ(parser.state(), HttpStream::RequestParser::State::Error);
+        EXPECT_EQ(parser.error().status, 400);
+    }
+    {
+        HttpStream::RequestParser parser(testLimits(), tempDir());
+        std::string raw = "GET / HTTP/1.1\r\nX-Grande: " + std::string(5000, 'x');
+        parser.feed(raw.data(), raw.size());
+        ASSERT_EQ(parser.state(), HttpStream::RequestParser::State::Error);
+        EXPECT_EQ(parser.error().status, 431);
+    }
+}
+
+// CENARIO 5 Serializacao da resposta
+// Content-Length, Connection e cabecalhos extras no formato HTTP/1.1
+TEST(HttpStreamTest, Response_Serializa) {
+    HttpStream::Response response;
+    response.status = 503;
+    response.body = "ocupado";
+    response.headers.emplace_back("Retry-After", "1");
+
+    std::string text = response.serialize(true);
+    EXPECT_EQ(text.rfind("HTTP/1.1 503 Service Unavailable\r\n", 0), 0u);
+    EXPECT_NE(text.find("Content-Length: 7\r\n"), std::string::npos);
+    EXPECT_NE(text.find("Connection: Keep-Alive\r\n"), std::string::npos);
+    EXPECT_NE(text.find("Retry-After: 1\r\n"), std::string::npos);
+    EXPECT_EQ(text.substr(text.size() - 11), "\r\n\r\nocupado");
+
+    response.close = true;
+    EXPECT_NE(response.serialize(true).find("Connection: close\r\n"), std::string::npos);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/Logger.h"
+
+class LoggerTest : public ::testing::Test {
+protected:
+    std::mutex mutex;
+    std::vector<std::string> lines;
+
+    void SetUp() override {
+        Logger::flush();
+        Logger::setLevel(Logger::Level::Debug);
+        Logger::setSink([this](Logger::Level, const std::string& line) {
+            std::lock_guard<std::mutex> lock(mutex);
+            lines.push_back(line);
+        });
+    }
+
+    void TearDown() override {
+        Logger::flush();
+        Logger::setSink(nullptr);
+        Logger::setLevel(Logger::Level::Info);
+    }
+
+    size_t countContaining(const std::string& text) {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t n = 0;
+        for (const auto& line : lines) {
+            if (line.find(text) != std::string::npos) ++n;
+        }
+        return n;
+    }
+};
+
+// CENARIO 1 Formato
+// Linha deve conter nivel, mensagem e campos estruturados
+TEST_F(LoggerTest, Log_FormataNivelMensagemECampos) {
+    Logger::log(Logger::Level::Info, "assinatura gerada", { { "bytes", "1024" } });
+    Logger::flush();
+
+    ASSERT_EQ(countContaining("[INFO] assinatura gerada bytes=1024"), 1u);
+}
+
+// CENARIO 2 Nivel minimo
+// Mensagens abaixo do nivel configurado sao descartadas
+TEST_F(LoggerTest, SetLevel_FiltraMensagensAbaixoDoNivel) {
+    Logger::setLevel(Logger::Level::Warn);
+    Logger::log(Logger::Level::Info, "mensagem_filtrada");
+    Logger::log(Logger::Level::Error, "mensagem_mantida");
+    Logger::flush();
+
+    EXPECT_EQ(countContaining("mensagem_filtrada"), 0u);
+    EXPECT_EQ(countContaining("[ERROR] mensagem_mantida"), 1u);
+}
+
+// CENARIO 3 Varias threads
+// Nenhuma mensagem pode se perder ou ser contada duas vezes
+TEST_F(LoggerTest, Log_VariasThreadsSemPerda) {
+    unsigned long long droppedBefore = Logger::droppedCount();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < 500; ++i) {
+                Logger::log(Logger::Level::Debug, "thread_msg", { { "t", std::to_string(t) } });
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    Logger::flush();
+
+    unsigned long long dropped = Logger::droppedCount() - droppedBefore;
+    EXPECT_EQ(countContaining("thread_msg") + dropped, 2000u);
+}
+
+// CENARIO 4 Rate limit
+// Erros repetidos acima do limite sao suprimidos
+TEST_F(LoggerTest, LogRateLimited_SuprimeRepetidos) {
+    int accepted = 0;
+    for (int i = 0; i < 100; ++i) {
+        if (Logger::logRateLimited(Logger::Level::Error, "chave_teste_rate", "erro_repetido", {}, 3)) ++accepted;
+    }
+    Logger::flush();
+
+    EXPECT_LE(accepted, 6);     // pode virar o segundo durante o laco
+    EXPECT_EQ(countContaining("erro_repetido"), static_cast<size_t>(accepted));
+}
+
+// CENARIO 5 Parse de nivel
+TEST(LoggerParseTest, ParseLevel_AceitaNomesEPadrao) {
+    EXPECT_EQ(Logger::parseLevel("debug"), Logger::Level::Debug);
+    EXPECT_EQ(Logger::parseLevel("WARN"), Logger::Level::Warn);
+    EXPECT_EQ(Logger::parseLevel("xyz", Logger::Level::Error), Logger::Level::Error);
+}
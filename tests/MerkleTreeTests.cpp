@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "../src/MerkleTree.h"
+
+static std::vector<MerkleTree::Hash> makeLeaves(size_t count) {
+    std::vector<MerkleTree::Hash> leaves;
+    for (size_t i = 0; i < count; ++i) {
+        std::string doc = "documento " + std::to_string(i);
+        leaves.push_back(MerkleTree::leafHash(reinterpret_cast<const unsigned char*>(doc.data()), doc.size()));
+    }
+    return leaves;
+}
+
+// CENARIO 1 Provas validas
+// Toda folha deve provar inclusao, inclusive em lotes de tamanho impar
+TEST(MerkleTreeTest, Proof_ValidaTodasAsFolhas) {
+    for (size_t count : { 1u, 2u, 3u, 5u, 8u, 13u, 100u }) {
+        std::vector<MerkleTree::Hash> leaves = makeLeaves(count);
+        MerkleTree::Tree tree(leaves);
+        for (std::uint32_t i = 0; i < count; ++i) {
+            MerkleTree::Proof proof = tree.proof(i);
+            EXPECT_TRUE(MerkleTree::verifyProof(leaves[i], proof, tree.root())) << "lote " << count << " folha " << i;
+        }
+    }
+}
+
+// CENARIO 2 Prova de outra folha
+// A prova nao pode ser reaproveitada para outro documento nem outro indice
+TEST(MerkleTreeTest, Proof_RejeitaFolhaOuIndiceErrado) {
+    std::vector<MerkleTree::Hash> leaves = makeLeaves(7);
+    MerkleTree::Tree tree(leaves);
+
+    MerkleTree::Proof proof = tree.proof(2);
+    EXPECT_FALSE(MerkleTree::verifyProof(leaves[3], proof, tree.root()));
+
+    proof.index = 3;
+    EXPECT_FALSE(MerkleTree::verifyProof(leaves[2], proof, tree.root()));
+}
+
+// CENARIO 3 Prova adulterada
+// Alterar um irmao, truncar o caminho ou mudar o tamanho do lote invalida a prova
+TEST(MerkleTreeTest, Proof_RejeitaAdulteracao) {
+    std::vector<MerkleTree::Hash> leaves = makeLeaves(10);
+    MerkleTree::Tree tree(leaves);
+
+    MerkleTree::Proof tampered = tree.proof(4);
+    tampered.path[1][0] ^= 0x01;
+    EXPECT_FALSE(MerkleTree::verifyProof(leaves[4], tampered, tree.root()));
+
+    MerkleTree::Proof truncated = tree.proof(4);
+    truncated.path.pop_back();
+    EXPECT_FALSE(MerkleTree::verifyProof(leaves[4], truncated, tree.root()));
+
+    MerkleTree::Proof resized = tree.proof(4);
+    resized.leafCount = 5;
+    EXPECT_FALSE(MerkleTree::verifyProof(leaves[4], resized, tree.root()));
+}
+
+// CENARIO 4 Folha como no interno
+// Um no interno apresentado como folha nao deve gerar a mesma raiz
+TEST(MerkleTreeTest, LeafHash_DiferenteDeNoInterno) {
+    std::vector<MerkleTree::Hash> leaves = makeLeaves(2);
+    MerkleTree::Hash node = MerkleTree::nodeHash(leaves[0], leaves[1]);
+    MerkleTree::Tree single({ MerkleTree::leafHash(node.data(), node.size()) });
+    MerkleTree::Tree pair(leaves);
+    EXPECT_NE(single.root(), pair.root());
+}
+
+// CENARIO 5 Serializacao
+// A prova codificada deve ser compacta e voltar identica
+TEST(MerkleTreeTest, EncodeDecode_RoundTrip) {
+    std::vector<MerkleTree::Hash> leaves = makeLeaves(1000);
+    MerkleTree::Tree tree(leaves);
+    MerkleTree::Proof proof = tree.proof(517);
+
+    std::string encoded = MerkleTree::encodeProof(proof);
+    EXPECT_EQ(encoded.size(), 13u + proof.path.size() * 64);
+    EXPECT_EQ(proof.path.size(), 10u);
+
+    MerkleTree::Proof decoded;
+    ASSERT_TRUE(MerkleTree::decodeProof(encoded, decoded));
+    EXPECT_EQ(decoded.index, proof.index);
+    EXPECT_EQ(decoded.leafCount, proof.leafCount);
+    EXPECT_EQ(decoded.path, proof.path);
+    EXPECT_TRUE(MerkleTree::verifyProof(leaves[517], decoded, tree.root()));
+
+    EXPECT_FALSE(MerkleTree::decodeProof(encoded.substr(0, encoded.size() - 1), decoded));
+    EXPECT_FALSE(MerkleTree::decodeProof("XXXX" + encoded.substr(4), decoded));
+}
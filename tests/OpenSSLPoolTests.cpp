@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <openssl/buffer.h>
+#include "../src/OpenSSLPool.h"
+
+// CENARIO 1 BIO do pool
+// O BIO devolvido deve ser reaproveitado pela mesma thread e voltar vazio
+TEST(OpenSSLPoolTest, PooledMemBio_ReaproveitaELimpa) {
+    BIO* first = nullptr;
+    {
+        OpenSSLPool::PooledMemBio bio;
+        ASSERT_NE(bio.get(), nullptr);
+        BIO_puts(bio.get(), "conteudo temporario");
+        EXPECT_EQ(bio.str(), "conteudo temporario");
+        first = bio.get();
+    }
+
+    OpenSSLPool::PooledMemBio again;
+    EXPECT_EQ(again.get(), first);
+    EXPECT_EQ(again.str(), "");
+}
+
+// CENARIO 2 Contexto de digest por thread
+// Mesma thread recebe o mesmo contexto, threads diferentes recebem contextos distintos
+TEST(OpenSSLPoolTest, ThreadDigestContext_UmPorThread) {
+    EVP_MD_CTX* a = OpenSSLPool::threadDigestContext();
+    EVP_MD_CTX* b = OpenSSLPool::threadDigestContext();
+    EXPECT_EQ(a, b);
+
+    EVP_MD_CTX* other = nullptr;
+    std::thread t([&other] { other = OpenSSLPool::threadDigestContext(); });
+    t.join();
+    EXPECT_NE(other, a);
+}
+
+// CENARIO 3 Hexadecimal
+TEST(OpenSSLPoolTest, ToHex_MaiusculoEMinusculo) {
+    const unsigned char bytes[] = { 0x00, 0xAB, 0x7F, 0xFF };
+    EXPECT_EQ(OpenSSLPool::toHex(bytes, sizeof(bytes), true), "00AB7FFF");
+    EXPECT_EQ(OpenSSLPool::toHex(bytes, sizeof(bytes), false), "00ab7fff");
+}
+
+// CENARIO 4 Alocador reaproveita blocos
+// Um bloco liberado deve ser devolvido na proxima alocacao da mesma classe
+TEST(OpenSSLPoolTest, PoolMalloc_ReaproveitaBlocoLiberado) {
+    void* block = OpenSSLPool::poolMalloc(100, __FILE__, __LINE__);
+    ASSERT_NE(block, nullptr);
+    OpenSSLPool::poolFree(block, __FILE__, __LINE__);
+
+    void* reused = OpenSSLPool::poolMalloc(120, __FILE__, __LINE__);
+    EXPECT_EQ(reused, block);
+    OpenSSLPool::poolFree(reused, __FILE__, __LINE__);
+}
+
+// CENARIO 5 Realloc preserva conteudo
+// Crescimento dentro da classe, entre classes e para blocos grandes deve manter os dados
+TEST(OpenSSLPoolTest, PoolRealloc_PreservaDados) {
+    char* data = static_cast<char*>(OpenSSLPool::poolMalloc(10, __FILE__, __LINE__));
+    std::memcpy(data, "abcdefghi", 10);
+
+    data = static_cast<char*>(OpenSSLPool::poolRealloc(data, 30, __FILE__, __LINE__));
+    EXPECT_STREQ(data, "abcdefghi");
+
+    data = static_cast<char*>(OpenSSLPool::poolRealloc(data, 1000, __FILE__, __LINE__));
+    EXPECT_STREQ(data, "abcdefghi");
+
+    data = static_cast<char*>(OpenSSLPool::poolRealloc(data, 1024 * 1024, __FILE__, __LINE__));
+    EXPECT_STREQ(data, "abcdefghi");
+    data[1024 * 1024 - 1] = 'z';
+
+    OpenSSLPool::poolFree(data, __FILE__, __LINE__);
+    OpenSSLPool::poolFree(nullptr, __FILE__, __LINE__);
+}
+
+// CENARIO 6 Handles RAII
+// Os handles devem liberar os objetos ao sair de escopo e aceitar nulo
+TEST(OpenSSLPoolTest, Handles_LiberamEAceitamNulo) {
+    OpenSSLPool::BioPtr bio(BIO_new(BIO_s_mem()));
+    EXPECT_NE(bio.get(), nullptr);
+
+    OpenSSLPool::X509StackPtr stack(sk_X509_new_null());
+    sk_X509_push(stack.get(), X509_new());
+    EXPECT_EQ(sk_X509_num(stack.get()), 1);
+
+    OpenSSLPool::CmsPtr empty;
+    EXPECT_EQ(empty.get(), nullptr);
+}
+
+// CENARIO 7 Teto do cache por thread
+// Liberar muitos blocos de todas as classes nao retem mais que 256 KB na thread;
+// o que passa do teto volta ao sistema e a thread seguinte comeca sem cache
+TEST(OpenSSLPoolTest, PoolFree_RespeitaTetoPorThread) {
+    std::thread([] {
+        std::vector<void*> blocks;
+        for (size_t size = 32; size <= 4096; size <<= 1) {
+            for (int i = 0; i < 300; ++i) blocks.push_back(OpenSSLPool::poolMalloc(size, __FILE__, __LINE__));
+        }
+        for (void* block : blocks) OpenSSLPool::poolFree(block, __FILE__, __LINE__);
+
+        size_t cached = OpenSSLPool::threadCachedBytes();
+        EXPECT_GT(cached, 0u);
+        EXPECT_LE(cached, 256u * 1024);
+
+        void* reused = OpenSSLPool::poolMalloc(64, __FILE__, __LINE__);
+        EXPECT_EQ(OpenSSLPool::threadCachedBytes(), cached - 64);
+        OpenSSLPool::poolFree(reused, __FILE__, __LINE__);
+    }).join();
+
+    std::thread([] { EXPECT_EQ(OpenSSLPool::threadCachedBytes(), 0u); }).join();
+}
+
+// CENARIO 8 BIO grande nao volta ao pool
+// Um BIO que cresceu alem do limite eh liberado: o proximo emprestimo nao herda o buffer
+TEST(OpenSSLPoolTest, PooledMemBio_GrandeNaoFicaRetido) {
+    {
+        OpenSSLPool::PooledMemBio big;
+        std::string chunk(1024 * 1024, 'x');
+        ASSERT_EQ(BIO_write(big.get(), chunk.data(), static_cast<int>(chunk.size())), static_cast<int>(chunk.size()));
+    }
+
+    OpenSSLPool::PooledMemBio again;
+    BUF_MEM* mem = nullptr;
+    BIO_get_mem_ptr(again.get(), &mem);
+    ASSERT_NE(mem, nullptr);
+    EXPECT_LE(mem->max, 64u * 1024);
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/RequestTrace.h"
+
+static size_t countLines(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    size_t lines = 0;
+    while (std::getline(in, line)) ++lines;
+    return lines;
+}
+
+// CENARIO 1 Arvore de spans
+// Spans abertos dentro de outro viram filhos e aparecem aninhados no JSON
+TEST(RequestTraceTest, Spans_AninhadosNoJson) {
+    RequestTrace::Trace trace("/signature");
+    RequestTrace::setCurrent(&trace);
+    {
+        RequestTrace::Span parse("parse");
+        RequestTrace::Span inner("temp_write");
+    }
+    {
+        RequestTrace::Span sign("cms_sign");
+    }
+    RequestTrace::attribute("file_bytes", 1234);
+    RequestTrace::setCurrent(nullptr);
+
+    ASSERT_EQ(trace.spans().size(), 3u);
+    EXPECT_EQ(trace.spans()[1].parent, 0);
+    EXPECT_EQ(trace.spans()[2].parent, -1);
+
+    std::string json = trace.toJson(200);
+    EXPECT_NE(json.find("\"route\":\"/signature\""), std::string::npos);
+    EXPECT_NE(json.find("\"status\":200"), std::string::npos);
+    EXPECT_NE(json.find("\"file_bytes\":1234"), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"parse\",\"start_ms\""), std::string::npos);
+    EXPECT_NE(json.find("\"children\":[{\"name\":\"temp_write\""), std::string::npos);
+}
+
+// CENARIO 2 Server-Timing
+// Apenas spans encerrados entram, filhos com o caminho do pai, e o total sempre no fim
+TEST(RequestTraceTest, ServerTiming_SoSpansEncerrados) {
+    RequestTrace::Trace trace("/verify");
+    int parse = trace.begin("parse");
+    trace.addCompleted("temp_write_file", 0, 1500);
+    trace.end(parse);
+    trace.begin("send");
+
+    std::string header = trace.serverTiming();
+    EXPECT_NE(header.find("parse;dur="), std::string::npos);
+    EXPECT_NE(header.find("parse.temp_write_file;dur=1.500"), std::string::npos);
+    EXPECT_EQ(header.find("send"), std::string::npos);
+    EXPECT_NE(header.rfind("total;dur="), std::string::npos);
+}
+
+// CENARIO 3 Sem trace atual
+// Span e attribute fora de uma requisicao nao fazem nada
+TEST(RequestTraceTest, Span_SemTraceAtual_NaoFazNada) {
+    RequestTrace::setCurrent(nullptr);
+    RequestTrace::Span span("parse");
+    RequestTrace::attribute("x", 1);
+    span.end();
+    EXPECT_EQ(RequestTrace::current(), nullptr);
+}
+
+// CENARIO 4 Log de requisicoes lentas
+// Somente traces acima do limite sao gravados, uma linha JSON por requisicao
+TEST(RequestTraceTest, LogIfSlow_RespeitaLimite) {
+    std::string path = "slow_test.jsonl";
+    std::remove(path.c_str());
+
+    RequestTrace::configureSlowLog(path, 20);
+    RequestTrace::Trace fast("/verify");
+    EXPECT_FALSE(RequestTrace::logIfSlow(fast, 200));
+
+    RequestTrace::Trace slow("/signature");
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_TRUE(RequestTrace::logIfSlow(slow, 500));
+
+    RequestTrace::configureSlowLog("", 0);
+    EXPECT_FALSE(RequestTrace::logIfSlow(slow, 500));
+
+    EXPECT_EQ(countLines(path), 1u);
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    EXPECT_EQ(line.front(), '{');
+    EXPECT_NE(line.find("\"status\":500"), std::string::npos);
+    in.close();
+    std::remove(path.c_str());
+}
+
+// CENARIO 5 Log de lentas em segundo plano
+// Varias threads enfileiram ao mesmo tempo; depois do flush cada linha aceita esta no arquivo, inteira
+TEST(RequestTraceTest, LogIfSlow_VariasThreads_LinhasInteiras) {
+    std::string path = "slow_threads_test.jsonl";
+    std::remove(path.c_str());
+    RequestTrace::configureSlowLog(path, 0);
+
+    std::atomic<size_t> accepted{ 0 };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&accepted] {
+            for (int i = 0; i < 50; ++i) {
+                RequestTrace::Trace trace("/verify");
+                trace.end(trace.begin("verify"));
+                if (RequestTrace::logIfSlow(trace, 200)) ++accepted;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    RequestTrace::flushSlowLog();
+
+    EXPECT_GT(accepted.load(), 0u);
+    EXPECT_EQ(countLines(path), accepted.load());
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        EXPECT_EQ(line.front(), '{');
+        EXPECT_EQ(line.back(), '}');
+    }
+    in.close();
+
+    RequestTrace::configureSlowLog("", 0);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,389 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <openssl/pem.h>
+#include "../src/CertIndex.h"
+#include "../src/RevocationService.h"
+#include "../src/SignerService.h"
+#include "../src/VerifierService.h"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// PKI local: CA EC, um signatario valido (serial 1001) e um revogado (1002), com o
+// AIA apontando para um `openssl ocsp` em 127.0.0.1 e uma CRL gerada por `openssl ca`
+class RevocationTest : public ::testing::Test {
+protected:
+    static inline fs::path dir;
+    static inline int port = 0;
+    static inline int deadPort = 0;
+    static inline bool ready = false;
+    static inline std::string skipReason;
+
+    std::string tempDoc;
+    std::string sig;
+
+#ifndef _WIN32
+    static int freePort() {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        ::close(fd);
+        return ntohs(addr.sin_port);
+    }
+#endif
+
+    static bool run(const std::string& command) {
+        std::string full = "cd \"" + dir.string() + "\" && " + command + " > /dev/null 2>&1";
+        return std::system(full.c_str()) == 0;
+    }
+
+    static bool responderReady() {
+        std::ifstream log(dir / "ocsp.log");
+        std::stringstream ss;
+        ss << log.rdbuf();
+        return ss.str().find("waiting for OCSP client connections") != std::string::npos;
+    }
+
+    static void write(const std::string& name, const std::string& content) {
+        std::ofstream out(dir / name, std::ios::binary);
+        out << content;
+    }
+
+    static void SetUpTestSuite() {
+#ifdef _WIN32
+        skipReason = "Responder OCSP local apenas em POSIX";
+#else
+        if (std::system("openssl version > /dev/null 2>&1") != 0) {
+            skipReason = "openssl de linha de comando indisponivel";
+            return;
+        }
+        dir = fs::temp_directory_path() / ("bry_revocation_" + std::to_string(::getpid()));
+        fs::remove_all(dir);
+        fs::create_directories(dir / "crls");
+        port = freePort();
+        deadPort = freePort();
+
+        const std::string ec = "-newkey ec -pkeyopt ec_paramgen_curve:P-256 -nodes";
+        bool ok = run("openssl req -x509 " + ec + " -keyout ca.key -out ca.pem -subj \"/CN=Bry Teste CA\" -days 30"
+                      " -addext basicConstraints=critical,CA:TRUE -addext keyUsage=critical,keyCertSign,cRLSign,digitalSignature");
+        write("ext.cnf", "authorityInfoAccess=OCSP;URI:http://127.0.0.1:" + std::to_string(port) + "\n");
+        for (std::string serial : { "1001", "1002" }) {
+            ok = ok && run("openssl req -new " + ec + " -keyout l" + serial + ".key -subj \"/CN=Signatario " + serial + "\" -out l" + serial + ".csr");
+            ok = ok && run("openssl x509 -req -in l" + serial + ".csr -CA ca.pem -CAkey ca.key -set_serial 0x" + serial +
+                           " -days 30 -extfile ext.cnf -out l" + serial + ".pem");
+            ok = ok && run("openssl pkcs12 -export -inkey l" + serial + ".key -in l" + serial + ".pem -certfile ca.pem"
+                           " -passout pass:bry123456 -out l" + serial + ".p12");
+        }
+
+        // banco do responder e da CRL: 1001 valido, 1002 revogado
+        write("index.txt", "V\t351231235959Z\t\t1001\tunknown\t/CN=Signatario 1001\n"
+                           "R\t351231235959Z\t260101000000Z\t1002\tunknown\t/CN=Signatario 1002\n");
+        write("crlnumber", "01\n");
+        write("ca.cnf", "[ ca ]\ndefault_ca = d\n[ d ]\ndatabase = index.txt\ncrlnumber = crlnumber\ncertificate = ca.pem\n"
+                        "private_key = ca.key\ndefault_md = sha256\ndefault_crl_days = 1\n");
+        ok = ok && run("openssl ca -config ca.cnf -gencrl -out crls/ca.crl");
+
+        // respostas com nextUpdate de 5 minutos
+        std::string responder = "cd \"" + dir.string() + "\" && (openssl ocsp -index index.txt -port " + std::to_string(port) +
+                                " -rsigner ca.pem -rkey ca.key -CA ca.pem -nmin 5 > ocsp.log 2>&1 & echo $! > ocsp.pid)";
+        ok = ok && std::system(responder.c_str()) == 0;
+        // espera o aviso no log: uma conexao de sondagem vazia trava o responder do openssl
+        for (int i = 0; ok && i < 100 && !responderReady(); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        // resposta para grampear, obtida enquanto o responder esta no ar
+        ok = ok && run("openssl ocsp -issuer ca.pem -cert l1002.pem -url http://127.0.0.1:" + std::to_string(port) +
+                       " -CAfile ca.pem -respout l1002.ocsp");
+
+        // emissor forjado: mesmo nome da CA com outra chave, um certificado com o mesmo
+        // emissor e serie do 1001 e uma resposta OCSP (revogado) assinada pela CA falsa
+        ok = ok && run("openssl req -x509 " + ec + " -keyout fake.key -out fake.pem -subj \"/CN=Bry Teste CA\" -days 30"
+                       " -addext basicConstraints=critical,CA:TRUE -addext keyUsage=critical,keyCertSign,cRLSign,digitalSignature");
+        ok = ok && run("openssl req -new " + ec + " -keyout f1001.key -subj \"/CN=Signatario 1001\" -out f1001.csr");
+        ok = ok && run("openssl x509 -req -in f1001.csr -CA fake.pem -CAkey fake.key -set_serial 0x1001 -days 30 -out f1001.pem");
+        write("fake_index.txt", "R\t351231235959Z\t260101000000Z\t1001\tunknown\t/CN=Signatario 1001\n");
+        ok = ok && run("openssl ocsp -issuer fake.pem -cert f1001.pem -no_nonce -reqout f1001.req");
+        ok = ok && run("openssl ocsp -index fake_index.txt -rsigner fake.pem -rkey fake.key -CA fake.pem -reqin f1001.req"
+                       " -respout f1001.ocsp");
+
+        ready = ok && responderReady();
+        if (!ready) skipReason = "falha ao montar a PKI de teste";
+#endif
+    }
+
+    static void TearDownTestSuite() {
+#ifndef _WIN32
+        if (dir.empty()) return;
+        std::system(("kill $(cat \"" + (dir / "ocsp.pid").string() + "\") > /dev/null 2>&1").c_str());
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+#endif
+    }
+
+    void SetUp() override {
+        if (!ready) GTEST_SKIP() << skipReason;
+        std::string testName = testing::UnitTest::GetInstance()->current_test_info()->name();
+        tempDoc = "doc_" + testName + ".txt";
+        sig = "sig_" + testName + ".p7s";
+        std::ofstream out(tempDoc);
+        out << "Documento com checagem de revogacao";
+    }
+
+    void TearDown() override {
+        std::remove(tempDoc.c_str());
+        std::remove(sig.c_str());
+    }
+
+    static OpenSSLPool::X509Ptr loadCert(const std::string& name) {
+        OpenSSLPool::BioPtr bio(BIO_new_file((dir / name).string().c_str(), "rb"));
+        return OpenSSLPool::X509Ptr(bio ? PEM_read_bio_X509(bio.get(), nullptr, nullptr, nullptr) : nullptr);
+    }
+
+    static RevocationService::Config baseConfig() {
+        RevocationService::Config config;
+        config.enabled = true;
+        config.timeoutSeconds = 2;
+        return config;
+    }
+
+    static std::string deadUrl() {
+        return "http://127.0.0.1:" + std::to_string(deadPort);
+    }
+};
+
+// CENARIO 1 OCSP pelo AIA do certificado
+// Valido e revogado vem do responder; a segunda consulta do mesmo certificado sai do cache
+TEST_F(RevocationTest, Ocsp_ValidoERevogado_ComCache) {
+    OpenSSLPool::X509Ptr ca = loadCert("ca.pem");
+    OpenSSLPool::X509Ptr good = loadCert("l1001.pem");
+    OpenSSLPool::X509Ptr revoked = loadCert("l1002.pem");
+
+    RevocationService::Config config = baseConfig();
+    config.useCrl = false;
+    RevocationService::Checker checker(config);
+
+    RevocationService::Result result = checker.check(good.get(), ca.get(), {}, true);
+    EXPECT_EQ(result.status, RevocationService::Status::Good) << result.detail;
+    EXPECT_EQ(result.source, "ocsp");
+    EXPECT_GT(result.nextUpdate, std::time(nullptr));
+
+    result = checker.check(revoked.get(), ca.get(), {}, true);
+    EXPECT_EQ(result.status, RevocationService::Status::Revoked) << result.detail;
+    EXPECT_NE(result.detail.find("2026"), std::string::npos);
+
+    EXPECT_EQ(checker.check(good.get(), ca.get(), {}, true).status, RevocationService::Status::Good);
+    RevocationService::Stats stats = checker.stats();
+    EXPECT_EQ(stats.fetches, 2u);
+    EXPECT_EQ(stats.cacheHits, 1u);
+}
+
+// CENARIO 2 Coalescencia
+// Oito verificacoes simultaneas do mesmo certificado geram uma unica consulta ao responder
+TEST_F(RevocationTest, Ocsp_ConsultasSimultaneas_UmaBusca) {
+    OpenSSLPool::X509Ptr ca = loadCert("ca.pem");
+    OpenSSLPool::X509Ptr good = loadCert("l1001.pem");
+
+    RevocationService::Config config = baseConfig();
+    config.useCrl = false;
+    RevocationService::Checker checker(config);
+
+    std::atomic<int> goodCount{ 0 };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&] {
+            if (checker.check(good.get(), ca.get(), {}, true).status == RevocationService::Status::Good) ++goodCount;
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    RevocationService::Stats stats = checker.stats();
+    EXPECT_EQ(goodCount.load(), 8);
+    EXPECT_EQ(stats.fetches, 1u);
+    EXPECT_EQ(stats.coalesced + stats.cacheHits, 7u);
+}
+
+// CENARIO 3 CRL local
+// Com OCSP desligado o status vem da CRL em REVOCATION_CRL_DIR, conferida com a chave da CA
+TEST_F(RevocationTest, Crl_PastaLocal) {
+    OpenSSLPool::X509Ptr ca = loadCert("ca.pem");
+
+    RevocationService::Config config = baseConfig();
+    config.useOcsp = false;
+    config.crlDir = (dir / "crls").string();
+    RevocationService::Checker checker(config);
+
+    RevocationService::Result result = checker.check(loadCert("l1001.pem").get(), ca.get());
+    EXPECT_EQ(result.status, RevocationService::Status::Good) << result.detail;
+    EXPECT_EQ(result.source, "crl");
+
+    result = checker.check(loadCert("l1002.pem").get(), ca.get());
+    EXPECT_EQ(result.status, RevocationService::Status::Revoked) << result.detail;
+}
+
+// CENARIO 4 Responder fora do ar
+// DESCONHECIDO fica no cache negativo; no modo soft a assinatura segue VALIDO, no hard vira INVALIDO
+TEST_F(RevocationTest, ResponderForaDoAr_SoftEHard) {
+    ASSERT_TRUE(SignerService::generateSignature((dir / "l1001.p12").string(), "bry123456", tempDoc, sig));
+
+    RevocationService::Config config = baseConfig();
+    config.useCrl = false;
+    config.ocspUrl = deadUrl();
+    RevocationService::Checker soft(config);
+
+    // emissor vindo do indice local: so assim o DESCONHECIDO vai para o cache
+    CertIndex::Index index;
+    ASSERT_TRUE(index.add(loadCert("ca.pem").get()));
+
+    VerifierService::VerificationResult res = VerifierService::verifyAndGetDetails(sig, &index, &soft);
+    EXPECT_TRUE(res.isValid);
+    EXPECT_EQ(res.revocation, "DESCONHECIDO");
+    EXPECT_FALSE(res.revocationDetail.empty());
+
+    VerifierService::verifyAndGetDetails(sig, &index, &soft);
+    EXPECT_EQ(soft.stats().fetches, 1u);
+    EXPECT_EQ(soft.stats().cacheHits, 1u);
+
+    config.hardFail = true;
+    RevocationService::Checker hard(config);
+    res = VerifierService::verifyAndGetDetails(sig, nullptr, &hard);
+    EXPECT_FALSE(res.isValid);
+    EXPECT_EQ(res.status, "INVALIDO");
+}
+
+// CENARIO 5 OCSP grampeado
+// A resposta dentro do CMS decide sem rede: a assinatura continua integra, mas o
+// signatario revogado a torna INVALIDO mesmo com o responder inacessivel
+TEST_F(RevocationTest, OcspGrampeado_SemRede) {
+    ASSERT_TRUE(SignerService::generateSignature((dir / "l1002.p12").string(), "bry123456", tempDoc, sig));
+
+    std::ifstream in(dir / "l1002.ocsp", std::ios::binary);
+    std::vector<unsigned char> ocsp((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    ASSERT_FALSE(ocsp.empty());
+    ASSERT_TRUE(VerifierService::stapleOcspResponse(sig, ocsp));
+    ASSERT_EQ(VerifierService::readStapledOcsp(sig).size(), 1u);
+
+    // grampear de novo substitui a resposta anterior
+    ASSERT_TRUE(VerifierService::stapleOcspResponse(sig, ocsp));
+    EXPECT_EQ(VerifierService::readStapledOcsp(sig).size(), 1u);
+    EXPECT_TRUE(VerifierService::verifyAndGetDetails(sig).isValid);
+
+    RevocationService::Config config = baseConfig();
+    config.useCrl = false;
+    config.ocspUrl = deadUrl();
+    RevocationService::Checker checker(config);
+
+    VerifierService::VerificationResult res = VerifierService::verifyAndGetDetails(sig, nullptr, &checker);
+    EXPECT_FALSE(res.isValid);
+    EXPECT_EQ(res.revocation, "REVOGADO");
+    EXPECT_EQ(checker.stats().stapled, 1u);
+    EXPECT_EQ(checker.stats().fetches, 0u);
+}
+
+// CENARIO 6 Renovacao antecipada
+// Entradas que vencem dentro da janela de prefetch sao consultadas de novo em segundo plano
+TEST_F(RevocationTest, Prefetch_RenovaAntesDeVencer) {
+    OpenSSLPool::X509Ptr ca = loadCert("ca.pem");
+    OpenSSLPool::X509Ptr good = loadCert("l1001.pem");
+
+    RevocationService::Config config = baseConfig();
+    config.useCrl = false;
+    config.prefetchSeconds = 600;   // maior que os 5 minutos de validade das respostas
+    RevocationService::Checker checker(config);
+
+    ASSERT_EQ(checker.check(good.get(), ca.get(), {}, true).status, RevocationService::Status::Good);
+    EXPECT_EQ(checker.prefetchDue(), 1u);
+    EXPECT_EQ(checker.stats().fetches, 2u);
+    EXPECT_EQ(checker.stats().prefetches, 1u);
+
+    EXPECT_EQ(checker.check(good.get(), ca.get(), {}, true).status, RevocationService::Status::Good);
+    EXPECT_EQ(checker.stats().cacheHits, 1u);
+}
+
+// CENARIO 7 Emissor forjado
+// Uma CA falsa com o mesmo nome da verdadeira e uma resposta OCSP assinada por ela nao
+// alcancam a entrada do certificado verdadeiro: a CA falsa nao assinou o verdadeiro, o
+// cache eh indexado pelo CertID (com a chave do emissor) e material embutido de um
+// emissor nao confiavel nao entra no cache
+TEST_F(RevocationTest, EmissorForjado_NaoEnvenenaOCache) {
+    OpenSSLPool::X509Ptr ca = loadCert("ca.pem");
+    OpenSSLPool::X509Ptr fake = loadCert("fake.pem");
+    OpenSSLPool::X509Ptr good = loadCert("l1001.pem");
+    OpenSSLPool::X509Ptr forged = loadCert("f1001.pem");
+    ASSERT_TRUE(fake && forged);
+
+    std::ifstream in(dir / "f1001.ocsp", std::ios::binary);
+    RevocationService::Embedded embedded;
+    embedded.ocspResponses.emplace_back((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    ASSERT_FALSE(embedded.ocspResponses[0].empty());
+
+    RevocationService::Config config = baseConfig();
+    config.useCrl = false;
+    RevocationService::Checker checker(config);
+
+    // nome igual, chave diferente: a CA falsa nao eh emissora do certificado verdadeiro
+    RevocationService::Result result = checker.check(good.get(), fake.get(), embedded);
+    EXPECT_EQ(result.status, RevocationService::Status::Unknown);
+
+    // o certificado forjado eh avaliado pela resposta grampeada, mas nada vai para o cache
+    result = checker.check(forged.get(), fake.get(), embedded);
+    EXPECT_EQ(result.status, RevocationService::Status::Revoked) << result.detail;
+    EXPECT_EQ(result.source, "ocsp_grampeado");
+    checker.check(forged.get(), fake.get(), embedded);
+    EXPECT_EQ(checker.stats().cacheHits, 0u);
+    EXPECT_EQ(checker.stats().stapled, 2u);
+
+    result = checker.check(good.get(), ca.get(), {}, true);
+    EXPECT_EQ(result.status, RevocationService::Status::Good) << result.detail;
+    EXPECT_EQ(result.source, "ocsp");
+
+    // mesmo gravado como confiavel, o resultado forjado fica sob o CertID da chave falsa
+    checker.check(forged.get(), fake.get(), embedded, true);
+    result = checker.check(good.get(), ca.get(), {}, true);
+    EXPECT_EQ(result.status, RevocationService::Status::Good);
+    EXPECT_EQ(checker.stats().cacheHits, 1u);
+    EXPECT_EQ(checker.stats().fetches, 1u);
+}
+
+// CENARIO 8 Emissor fora do indice local
+// O emissor trazido pelo CMS nao leva o servidor as URLs do certificado (AIA, CRL-DP):
+// sem responder configurado o status fica DESCONHECIDO sem consulta; com REVOCATION_OCSP_URL
+// o responder configurado eh consultado, mas o resultado nao entra no cache
+TEST_F(RevocationTest, EmissorNaoConfiavel_SemUrlsDoCertificadoESemCache) {
+    OpenSSLPool::X509Ptr ca = loadCert("ca.pem");
+    OpenSSLPool::X509Ptr good = loadCert("l1001.pem");
+
+    RevocationService::Checker checker(baseConfig());
+    RevocationService::Result result = checker.check(good.get(), ca.get());
+    EXPECT_EQ(result.status, RevocationService::Status::Unknown);
+    EXPECT_NE(result.detail.find("fora do indice local"), std::string::npos) << result.detail;
+    checker.check(good.get(), ca.get());
+    EXPECT_EQ(checker.stats().cacheHits, 0u);
+
+    RevocationService::Config config = baseConfig();
+    config.useCrl = false;
+    config.ocspUrl = "http://127.0.0.1:" + std::to_string(port);
+    RevocationService::Checker configured(config);
+    result = configured.check(good.get(), ca.get());
+    EXPECT_EQ(result.status, RevocationService::Status::Good) << result.detail;
+    configured.check(good.get(), ca.get());
+    EXPECT_EQ(configured.stats().fetches, 2u);
+    EXPECT_EQ(configured.stats().cacheHits, 0u);
+}
@@ -0,0 +1,329 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/DigestService.h"
+#include "../src/SignatureStore.h"
+#include "../src/SignerService.h"
+#include "../src/VerifierService.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+class SignatureStoreTest : public ::testing::Test {
+protected:
+    fs::path dir;
+
+    void SetUp() override {
+#ifndef __linux__
+        GTEST_SKIP() << "Armazem de assinaturas apenas no Linux";
+#else
+        std::string name = testing::UnitTest::GetInstance()->current_test_info()->name();
+        dir = fs::temp_directory_path() / ("bry_store_" + std::to_string(::getpid()) + "_" + name);
+        fs::remove_all(dir);
+#endif
+    }
+
+    void TearDown() override {
+        if (dir.empty()) return;
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+    }
+
+    SignatureStore::Config config(size_t segmentBytes = 1024 * 1024, size_t initialSlots = 16) const {
+        SignatureStore::Config config;
+        config.dir = dir.string();
+        config.segmentBytes = segmentBytes;
+        config.initialSlots = initialSlots;
+        return config;
+    }
+
+    // hash e conteudo deterministicos por numero
+    static SignatureStore::Hash hashOf(unsigned n) {
+        SignatureStore::Hash hash{};
+        for (size_t i = 0; i < hash.size(); ++i) hash[i] = static_cast<unsigned char>((n * 2654435761u) >> (i % 4 * 8)) ^ static_cast<unsigned char>(i);
+        hash[60] = static_cast<unsigned char>(n);
+        hash[61] = static_cast<unsigned char>(n >> 8);
+        return hash;
+    }
+
+    static std::string payloadOf(unsigned n, size_t size = 300) {
+        std::string payload(size + n % 17, static_cast<char>('a' + n % 26));
+        payload[0] = static_cast<char>(n);
+        return payload;
+    }
+
+    static bool put(SignatureStore::Store& store, unsigned n, size_t size = 300) {
+        std::string payload = payloadOf(n, size);
+        std::string error;
+        bool ok = store.put(hashOf(n), reinterpret_cast<const unsigned char*>(payload.data()), payload.size(), error);
+        EXPECT_TRUE(ok) << error;
+        return ok;
+    }
+
+    static std::string read(const SignatureStore::Store& store, unsigned n) {
+        SignatureStore::View view = store.get(hashOf(n));
+        return view ? std::string(reinterpret_cast<const char*>(view.data()), view.size()) : "";
+    }
+};
+
+// CENARIO 1 Gravacao e leitura
+// O conteudo volta igual pelo hash, um hash desconhecido nao encontra nada e
+// regravar o mesmo documento aponta para o registro novo
+TEST_F(SignatureStoreTest, PutGet_DevolveOConteudoPeloHash) {
+    SignatureStore::Store store(config());
+    std::string error;
+    ASSERT_TRUE(store.open(error)) << error;
+
+    ASSERT_TRUE(put(store, 1));
+    ASSERT_TRUE(put(store, 2));
+    EXPECT_EQ(read(store, 1), payloadOf(1));
+    EXPECT_EQ(read(store, 2), payloadOf(2));
+    EXPECT_FALSE(store.get(hashOf(3)));
+
+    std::string novo = "assinatura nova";
+    ASSERT_TRUE(store.put(hashOf(1), reinterpret_cast<const unsigned char*>(novo.data()), novo.size(), error)) << error;
+    EXPECT_EQ(read(store, 1), novo);
+    EXPECT_EQ(store.stats().records, 2u);
+
+    SignatureStore::Hash parsed;
+    std::string hex = SignatureStore::hashHex(hashOf(7));
+    ASSERT_EQ(hex.size(), 128u);
+    EXPECT_TRUE(SignatureStore::parseHash(hex, parsed));
+    EXPECT_EQ(parsed, hashOf(7));
+    EXPECT_FALSE(SignatureStore::parseHash(hex.substr(1), parsed));
+    EXPECT_FALSE(SignatureStore::parseHash(std::string(128, 'g'), parsed));
+
+    // um segundo processo (ou instancia) nao pode escrever no mesmo diretorio
+    SignatureStore::Store other(config());
+    EXPECT_FALSE(other.open(error));
+}
+
+// CENARIO 2 Reabertura e recuperacao
+// Registros sobrevivem a reabertura; um registro cortado no fim do segmento
+// (queda no meio da gravacao) eh descartado e o indice apagado eh reconstruido
+TEST_F(SignatureStoreTest, Reabertura_DescartaRegistroIncompleto) {
+    {
+        SignatureStore::Store store(config());
+        std::string error;
+        ASSERT_TRUE(store.open(error)) << error;
+        for (unsigned n = 1; n <= 20; ++n) ASSERT_TRUE(put(store, n));
+    }
+
+    fs::path segment = dir / "segment-000001.dat";
+    auto goodSize = fs::file_size(segment);
+    {
+        // cabecalho de registro valido seguido de apenas parte do conteudo
+        std::ofstream out(segment, std::ios::binary | std::ios::app);
+        out.write("BSR1", 4);
+        unsigned length = 1000;
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        SignatureStore::Hash hash = hashOf(99);
+        out.write(reinterpret_cast<const char*>(hash.data()), hash.size());
+        out << std::string(100, 'p');
+    }
+
+    {
+        SignatureStore::Store store(config());
+        std::string error;
+        ASSERT_TRUE(store.open(error)) << error;
+        EXPECT_EQ(fs::file_size(segment), goodSize);
+        EXPECT_GT(store.stats().truncated, 0u);
+        EXPECT_FALSE(store.get(hashOf(99)));
+        for (unsigned n = 1; n <= 20; ++n) EXPECT_EQ(read(store, n), payloadOf(n)) << n;
+        ASSERT_TRUE(put(store, 21));
+    }
+
+    fs::remove(dir / "index.bin");
+    SignatureStore::Store store(config());
+    std::string error;
+    ASSERT_TRUE(store.open(error)) << error;
+    EXPECT_EQ(store.stats().recovered, 21u);
+    for (unsigned n = 1; n <= 21; ++n) EXPECT_EQ(read(store, n), payloadOf(n)) << n;
+}
+
+// CENARIO 3 Crescimento do indice e troca de segmento
+// Com 16 slots e segmentos de 64 KB, 600 registros dobram o indice varias vezes
+// e ocupam varios segmentos; um View obtido antes continua valido
+TEST_F(SignatureStoreTest, Crescimento_IndiceESegmentos) {
+    SignatureStore::Store store(config(64 * 1024, 16));
+    std::string error;
+    ASSERT_TRUE(store.open(error)) << error;
+
+    ASSERT_TRUE(put(store, 0, 1000));
+    SignatureStore::View first = store.get(hashOf(0));
+    ASSERT_TRUE(first);
+
+    for (unsigned n = 1; n < 600; ++n) ASSERT_TRUE(put(store, n, 1000));
+
+    SignatureStore::Stats stats = store.stats();
+    EXPECT_EQ(stats.records, 600u);
+    EXPECT_GE(stats.indexSlots, 1024u);
+    EXPECT_GT(stats.segments, 5u);
+    for (unsigned n = 0; n < 600; ++n) ASSERT_EQ(read(store, n), payloadOf(n, 1000)) << n;
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(first.data()), first.size()), payloadOf(0, 1000));
+
+    // assinatura maior que um segmento eh recusada sem corromper o armazem
+    std::string big(64 * 1024, 'b');
+    EXPECT_FALSE(store.put(hashOf(1000), reinterpret_cast<const unsigned char*>(big.data()), big.size(), error));
+    EXPECT_EQ(store.stats().records, 600u);
+}
+
+// CENARIO 4 Leitores concorrentes com um escritor
+// Leituras simultaneas a gravacoes (e a trocas do indice) sempre veem o conteudo certo
+TEST_F(SignatureStoreTest, Concorrencia_LeitoresDuranteGravacao) {
+    SignatureStore::Store store(config(256 * 1024, 16));
+    std::string error;
+    ASSERT_TRUE(store.open(error)) << error;
+    for (unsigned n = 0; n < 50; ++n) ASSERT_TRUE(put(store, n));
+
+    std::atomic<bool> done{ false };
+    std::atomic<int> wrong{ 0 };
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t] {
+            unsigned n = static_cast<unsigned>(t);
+            while (!done) {
+                if (read(store, n % 50) != payloadOf(n % 50)) wrong++;
+                n += 7;
+            }
+        });
+    }
+    for (unsigned n = 50; n < 2000; ++n) {
+        if (!put(store, n)) break;
+    }
+    done = true;
+    for (auto& reader : readers) reader.join();
+
+    EXPECT_EQ(wrong.load(), 0);
+    EXPECT_EQ(store.stats().records, 2000u);
+}
+
+// CENARIO 5 Verificacao direto do armazem
+// A assinatura guardada pelo SHA-512 do documento eh verificada do mmap, sem
+// arquivo, com o mesmo resultado da verificacao pelo arquivo
+TEST_F(SignatureStoreTest, VerifyBuffer_AssinaturaGuardada) {
+    std::string doc = "doc_store.txt";
+    std::string sig = "sig_store.p7s";
+    {
+        std::ofstream out(doc);
+        out << "Documento guardado no armazem";
+    }
+    ASSERT_TRUE(SignerService::executeStep2("resources/pkcs12/certificado_teste_hub.pfx", doc, sig, "bry123456"));
+
+    std::ifstream in(sig, std::ios::binary);
+    std::string der((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::vector<unsigned char> digest = DigestService::calculateSHA512Bytes(doc);
+    ASSERT_EQ(digest.size(), 64u);
+    SignatureStore::Hash hash;
+    std::copy(digest.begin(), digest.end(), hash.begin());
+
+    SignatureStore::Store store(config());
+    std::string error;
+    ASSERT_TRUE(store.open(error)) << error;
+    ASSERT_TRUE(store.put(hash, reinterpret_cast<const unsigned char*>(der.data()), der.size(), error)) << error;
+
+    SignatureStore::View view = store.get(hash);
+    ASSERT_TRUE(view);
+    VerifierService::VerificationResult fromStore = VerifierService::verifyBuffer(view.data(), view.size());
+    VerifierService::VerificationResult fromFile = VerifierService::verifyAndGetDetails(sig);
+    EXPECT_TRUE(fromStore.isValid);
+    EXPECT_EQ(fromStore.status, "VALIDO");
+    EXPECT_EQ(fromStore.signerName, fromFile.signerName);
+    EXPECT_EQ(fromStore.hashHex, fromFile.hashHex);
+
+    // bytes corrompidos no buffer nao passam
+    std::string broken = der;
+    broken[broken.size() - 10] ^= 0x01;
+    EXPECT_FALSE(VerifierService::verifyBuffer(reinterpret_cast<const unsigned char*>(broken.data()), broken.size()).isValid);
+    EXPECT_FALSE(VerifierService::verifyBuffer(nullptr, 0).isValid);
+
+    std::remove(doc.c_str());
+    std::remove(sig.c_str());
+}
+
+// CENARIO 6 Indice corrompido
+// Um slot apontando para fora do segmento nao vira leitura fora do mapeamento: o get
+// devolve vazio e a reabertura reconstroi o indice a partir do log (com fsync ligado)
+TEST_F(SignatureStoreTest, IndiceCorrompido_ReconstroiDoLog) {
+    SignatureStore::Config cfg = config();
+    cfg.fsync = true;
+    auto corrupt = [this](unsigned n, std::uint32_t segment, std::uint64_t offset) {
+        // slot: hash (64) | segmento (u32) | tamanho (u32) | posicao (u64), a partir do byte 64
+        std::fstream index(dir / "index.bin", std::ios::in | std::ios::out | std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(index)), std::istreambuf_iterator<char>());
+        SignatureStore::Hash hash = hashOf(n);
+        for (size_t pos = 64; pos + 80 <= bytes.size(); pos += 80) {
+            if (bytes.compare(pos, hash.size(), reinterpret_cast<const char*>(hash.data()), hash.size()) != 0) continue;
+            index.seekp(static_cast<std::streamoff>(pos + 64));
+            index.write(reinterpret_cast<const char*>(&segment), sizeof(segment));
+            index.seekp(static_cast<std::streamoff>(pos + 72));
+            index.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+            return true;
+        }
+        return false;
+    };
+
+    {
+        SignatureStore::Store store(cfg);
+        std::string error;
+        ASSERT_TRUE(store.open(error)) << error;
+        for (unsigned n = 1; n <= 10; ++n) ASSERT_TRUE(put(store, n));
+
+        // o indice eh MAP_SHARED: a escrita no arquivo aparece no get em andamento
+        ASSERT_TRUE(corrupt(3, 1, 1ULL << 40));
+        ASSERT_TRUE(corrupt(4, 7, 0));
+        EXPECT_FALSE(store.get(hashOf(3)));
+        EXPECT_FALSE(store.get(hashOf(4)));
+        EXPECT_EQ(read(store, 5), payloadOf(5));
+    }
+
+    SignatureStore::Store store(cfg);
+    std::string error;
+    ASSERT_TRUE(store.open(error)) << error;
+    EXPECT_EQ(store.stats().recovered, 10u);
+    EXPECT_EQ(store.stats().records, 10u);
+    for (unsigned n = 1; n <= 10; ++n) EXPECT_EQ(read(store, n), payloadOf(n)) << n;
+}
+
+// CENARIO 7 Capacidade do indice fora do arquivo
+// Um cabecalho com 2^62 slots (64 + 2^62 * 80 da a volta em 64 bits e bate com um arquivo
+// so de cabecalho) nao eh aceito: a abertura reconstroi o indice a partir do log
+TEST_F(SignatureStoreTest, CapacidadeEstourada_ReconstroiDoLog) {
+    {
+        SignatureStore::Store store(config());
+        std::string error;
+        ASSERT_TRUE(store.open(error)) << error;
+        for (unsigned n = 1; n <= 5; ++n) ASSERT_TRUE(put(store, n));
+    }
+
+    // cabecalho: magic | capacity | count | segmento duravel (u32) | reservado | posicao duravel
+    std::string header("BRYSIDX1", 8);
+    std::uint64_t capacity = 1ULL << 62, count = 0, durableOffset = 0;
+    std::uint32_t durableSegment = 1, reserved = 0;
+    header.append(reinterpret_cast<const char*>(&capacity), sizeof(capacity));
+    header.append(reinterpret_cast<const char*>(&count), sizeof(count));
+    header.append(reinterpret_cast<const char*>(&durableSegment), sizeof(durableSegment));
+    header.append(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+    header.append(reinterpret_cast<const char*>(&durableOffset), sizeof(durableOffset));
+    header.resize(64, '\0');
+    {
+        std::ofstream index(dir / "index.bin", std::ios::binary | std::ios::trunc);
+        index.write(header.data(), static_cast<std::streamsize>(header.size()));
+    }
+
+    SignatureStore::Store store(config());
+    std::string error;
+    ASSERT_TRUE(store.open(error)) << error;
+    EXPECT_LT(store.stats().indexSlots, 1ULL << 62);
+    EXPECT_EQ(store.stats().records, 5u);
+    for (unsigned n = 1; n <= 5; ++n) EXPECT_EQ(read(store, n), payloadOf(n)) << n;
+}
@@ -2,6 +2,7 @@
 #include <fstream>
 #include <cstdio>
 #include <string>
+#include <vector>
 #include <openssl/pkcs12.h>
 #include <openssl/evp.h>
 #include <openssl/x509.h>
@@ -117,4 +118,109 @@ TEST_F(SignerServiceTest, GenerateSignature_Falha_CaminhoInvalido) {
 TEST_F(SignerServiceTest, ExecuteStep2_FluxoCompleto) {
     bool result = SignerService::executeStep2(validP12, tempDoc, tempSig, validPass);
     EXPECT_TRUE(result);
-}
\ No newline at end of file
+}
+// CENARIO 7 Assinatura em lote
+// Deve gerar um unico arquivo de assinatura e uma prova por documento
+TEST_F(SignerServiceTest, GenerateBatchSignature_CriaAssinaturaEProvas) {
+    std::vector<std::string> docs;
+    std::vector<std::string> proofs;
+    for (int i = 0; i < 5; ++i) {
+        docs.push_back("doc_lote_" + std::to_string(i) + ".txt");
+        proofs.push_back(docs.back() + ".proof");
+        std::ofstream out(docs.back());
+        out << "Documento do lote " << i;
+    }
+
+    EXPECT_TRUE(SignerService::generateBatchSignature(validP12, validPass, docs, tempSig, proofs));
+    EXPECT_TRUE(std::ifstream(tempSig).good());
+    for (const std::string& proof : proofs) {
+        EXPECT_TRUE(std::ifstream(proof).good());
+    }
+
+    for (size_t i = 0; i < docs.size(); ++i) {
+        std::remove(docs[i].c_str());
+        std::remove(proofs[i].c_str());
+    }
+}
+
+// CENARIO 8 Assinatura em lote com arquivo faltando
+// Nenhum documento do lote pode ficar de fora
+TEST_F(SignerServiceTest, GenerateBatchSignature_Falha_ArquivoFaltando) {
+    std::vector<std::string> docs = { tempDoc, "ghost_file.txt" };
+    std::vector<std::string> proofs = { tempDoc + ".proof", "ghost_file.txt.proof" };
+    EXPECT_FALSE(SignerService::generateBatchSignature(validP12, validPass, docs, tempSig, proofs));
+    std::remove(proofs[0].c_str());
+}
+
+// CENARIO 9 Digest por tipo de chave
+// Cada P12 de teste deve carregar e usar o digest correspondente a chave
+TEST_F(SignerServiceTest, DigestForKey_CorrespondeAoTipoDeChave) {
+    const std::vector<std::pair<std::string, int>> keys = {
+        { "resources/pkcs12/certificado_teste_hub.pfx", NID_sha512 },
+        { "resources/pkcs12/certificado_teste_rsa4096.pfx", NID_sha512 },
+        { "resources/pkcs12/certificado_teste_ecdsa_p256.pfx", NID_sha256 },
+        { "resources/pkcs12/certificado_teste_ecdsa_p384.pfx", NID_sha384 },
+        { "resources/pkcs12/certificado_teste_ed25519.pfx", NID_sha512 },
+    };
+
+    for (const auto& key : keys) {
+        PKCS12* p12 = nullptr;
+        EVP_PKEY* pkey = nullptr;
+        X509* cert = nullptr;
+        STACK_OF(X509)* ca = nullptr;
+
+        EXPECT_TRUE(SignerService::loadCredentials(key.first, validPass, &p12, &pkey, &cert, &ca)) << key.first;
+        const EVP_MD* md = SignerService::digestForKey(pkey);
+        ASSERT_NE(md, nullptr) << key.first;
+        EXPECT_EQ(EVP_MD_type(md), key.second) << key.first;
+
+        PKCS12_free(p12);
+        EVP_PKEY_free(pkey);
+        X509_free(cert);
+        sk_X509_pop_free(ca, X509_free);
+    }
+}
+
+// CENARIO 10 Gerar Assinatura com ECDSA e Ed25519
+TEST_F(SignerServiceTest, GenerateSignature_Sucesso_ECDSAeEd25519) {
+    EXPECT_TRUE(SignerService::generateSignature("resources/pkcs12/certificado_teste_ecdsa_p256.pfx", validPass, tempDoc, tempSig));
+    EXPECT_TRUE(SignerService::generateSignature("resources/pkcs12/certificado_teste_ecdsa_p384.pfx", validPass, tempDoc, tempSig));
+    EXPECT_TRUE(SignerService::generateSignature("resources/pkcs12/certificado_teste_ed25519.pfx", validPass, tempDoc, tempSig));
+}
+
+// CENARIO 11 Assinatura compacta
+// Sem a cadeia (leaf) e sem certificados (none) o CMS encolhe e o SignerIdentifier continua presente
+TEST_F(SignerServiceTest, GenerateSignature_ModosDeCertificado) {
+    std::string leafSig = "leaf_" + tempSig;
+    std::string noneSig = "none_" + tempSig;
+
+    ASSERT_TRUE(SignerService::generateSignature(validP12, validPass, tempDoc, tempSig, SignerService::CertMode::Full));
+    ASSERT_TRUE(SignerService::generateSignature(validP12, validPass, tempDoc, leafSig, SignerService::CertMode::Leaf));
+    ASSERT_TRUE(SignerService::generateSignature(validP12, validPass, tempDoc, noneSig, SignerService::CertMode::None));
+
+    auto fileSize = [](const std::string& path) {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        return static_cast<long long>(in.tellg());
+    };
+    EXPECT_GE(fileSize(tempSig), fileSize(leafSig));
+    EXPECT_LT(fileSize(noneSig), fileSize(leafSig));
+
+    auto certCount = [](const std::string& path) {
+        BIO* in = BIO_new_file(path.c_str(), "rb");
+        CMS_ContentInfo* cms = in ? d2i_CMS_bio(in, nullptr) : nullptr;
+        BIO_free(in);
+        STACK_OF(X509)* certs = cms ? CMS_get1_certs(cms) : nullptr;
+        int count = certs ? sk_X509_num(certs) : 0;
+        sk_X509_pop_free(certs, X509_free);
+        CMS_ContentInfo_free(cms);
+        return count;
+    };
+    EXPECT_EQ(certCount(leafSig), 1);
+    EXPECT_EQ(certCount(noneSig), 0);
+
+    EXPECT_EQ(SignerService::parseCertMode("none"), SignerService::CertMode::None);
+    EXPECT_EQ(SignerService::parseCertMode("outro", SignerService::CertMode::Leaf), SignerService::CertMode::Leaf);
+
+    std::remove(leafSig.c_str());
+    std::remove(noneSig.c_str());
+}
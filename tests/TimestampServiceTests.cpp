@@ -0,0 +1,318 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/OpenSSLPool.h"
+#include "../src/SignerService.h"
+#include "../src/TimestampService.h"
+#include "../src/VerifierService.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// TSA local: `openssl ts -reply` responde cada TimeStampReq com um certificado de
+// TSA (EKU timeStamping) emitido por uma raiz de teste
+class TimestampTest : public ::testing::Test {
+protected:
+    static inline fs::path dir;
+    static inline bool ready = false;
+
+    std::string validP12 = "resources/pkcs12/certificado_teste_hub.pfx";
+    std::string validPass = "bry123456";
+    std::string tempDoc;
+
+    std::atomic<int> tsaCalls{ 0 };
+
+    static bool run(const std::string& command) {
+        std::string full = "cd \"" + dir.string() + "\" && " + command + " > /dev/null 2>&1";
+        return std::system(full.c_str()) == 0;
+    }
+
+    static void write(const std::string& name, const std::string& content) {
+        std::ofstream out(dir / name, std::ios::binary);
+        out << content;
+    }
+
+    static void SetUpTestSuite() {
+#ifndef _WIN32
+        if (std::system("openssl version > /dev/null 2>&1") != 0) return;
+        dir = fs::temp_directory_path() / ("bry_tsa_" + std::to_string(::getpid()));
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+
+        const std::string ec = "-newkey ec -pkeyopt ec_paramgen_curve:P-256 -nodes";
+        write("tsa.ext", "extendedKeyUsage=critical,timeStamping\nkeyUsage=critical,digitalSignature\n");
+        write("ts.cnf", "[ tsa ]\ndefault_tsa = t\n[ t ]\nserial = tsaserial\nsigner_cert = tsa.pem\ncerts = ca.pem\n"
+                        "signer_key = tsa.key\nsigner_digest = sha256\ndefault_policy = 1.2.3.4.1\ndigests = sha256, sha512\n"
+                        "accuracy = secs:1\nordering = no\ntsa_name = yes\ness_cert_id_chain = no\ness_cert_id_alg = sha256\n");
+        write("tsaserial", "01\n");
+        ready = run("openssl req -x509 " + ec + " -keyout ca.key -out ca.pem -subj \"/CN=Bry TSA Raiz\" -days 30"
+                    " -addext basicConstraints=critical,CA:TRUE -addext keyUsage=critical,keyCertSign") &&
+                run("openssl req -new " + ec + " -keyout tsa.key -subj \"/CN=Bry TSA\" -out tsa.csr") &&
+                run("openssl x509 -req -in tsa.csr -CA ca.pem -CAkey ca.key -set_serial 7 -days 30 -extfile tsa.ext -out tsa.pem");
+#endif
+    }
+
+    static void TearDownTestSuite() {
+        if (dir.empty()) return;
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+    }
+
+    void SetUp() override {
+        if (!ready) GTEST_SKIP() << "openssl de linha de comando indisponivel";
+        tempDoc = "doc_" + std::string(testing::UnitTest::GetInstance()->current_test_info()->name()) + ".txt";
+        std::ofstream out(tempDoc);
+        out << "Documento com carimbo de tempo";
+    }
+
+    void TearDown() override {
+        std::remove(tempDoc.c_str());
+        TimestampService::configureTrust("");
+    }
+
+    // cada chamada vira um `openssl ts -reply`; o arquivo de serial exige uma chamada por vez
+    TimestampService::Transport localTsa() {
+        return [this](const std::vector<unsigned char>& query, std::vector<unsigned char>& reply, std::string& error) {
+            static std::mutex tsaMutex;
+            std::lock_guard<std::mutex> lock(tsaMutex);
+            ++tsaCalls;
+            {
+                std::ofstream out(dir / "q.tsq", std::ios::binary);
+                out.write(reinterpret_cast<const char*>(query.data()), static_cast<std::streamsize>(query.size()));
+            }
+            if (!run("openssl ts -reply -queryfile q.tsq -config ts.cnf -out r.tsr")) {
+                error = "openssl ts falhou";
+                return false;
+            }
+            std::ifstream in(dir / "r.tsr", std::ios::binary);
+            reply.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            return true;
+        };
+    }
+
+    OpenSSLPool::CmsPtr sign() {
+        PKCS12* p12 = nullptr;
+        EVP_PKEY* pkey = nullptr;
+        X509* cert = nullptr;
+        STACK_OF(X509)* ca = nullptr;
+        if (!SignerService::loadCredentials(validP12, validPass, &p12, &pkey, &cert, &ca)) return nullptr;
+        OpenSSLPool::P12Ptr p12Guard(p12);
+        OpenSSLPool::PkeyPtr pkeyGuard(pkey);
+        OpenSSLPool::X509Ptr certGuard(cert);
+        OpenSSLPool::X509StackPtr caGuard(ca);
+        return OpenSSLPool::CmsPtr(SignerService::signData(tempDoc, cert, pkey, ca));
+    }
+
+    static bool save(CMS_ContentInfo* cms, const std::string& path) {
+        OpenSSLPool::BioPtr out(BIO_new_file(path.c_str(), "wb"));
+        return out && i2d_CMS_bio(out.get(), cms);
+    }
+
+    static CMS_SignerInfo* firstSigner(CMS_ContentInfo* cms) {
+        return sk_CMS_SignerInfo_value(CMS_get0_SignerInfos(cms), 0);
+    }
+
+    static TimestampService::Config config(int windowMs, size_t maxBatch) {
+        TimestampService::Config config;
+        config.windowMs = windowMs;
+        config.maxBatch = maxBatch;
+        return config;
+    }
+};
+
+// CENARIO 1 Carimbo de uma assinatura
+// Lote de tamanho 1: a assinatura continua VALIDO, o carimbo confere e o token
+// eh aceito pelo `openssl ts -verify` com a folha como digest; com a raiz da
+// TSA configurada o carimbo passa a ser confiavel
+TEST_F(TimestampTest, Stamp_AssinaturaUnica) {
+    TimestampService::Batcher batcher(config(0, 16), localTsa());
+    OpenSSLPool::CmsPtr cms = sign();
+    ASSERT_TRUE(cms);
+
+    std::string error;
+    ASSERT_TRUE(batcher.stampCms(cms.get(), error)) << error;
+    std::string sigPath = "sig_carimbo_unico.p7s";
+    ASSERT_TRUE(save(cms.get(), sigPath));
+
+    VerifierService::VerificationResult res = VerifierService::verifyAndGetDetails(sigPath);
+    EXPECT_TRUE(res.isValid);
+    EXPECT_EQ(res.timestamp, "VALIDO");
+    EXPECT_FALSE(res.timestampTime.empty());
+    EXPECT_EQ(res.timestampBatch, 1u);
+    EXPECT_FALSE(res.timestampTrusted);
+
+    ASSERT_TRUE(TimestampService::configureTrust((dir / "ca.pem").string()));
+    EXPECT_TRUE(VerifierService::verifyAndGetDetails(sigPath).timestampTrusted);
+
+    // interoperabilidade: o token isolado confere com a ferramenta do OpenSSL
+    MerkleTree::Hash leaf;
+    ASSERT_TRUE(TimestampService::signatureLeaf(firstSigner(cms.get()), leaf));
+    TimestampService::Stamp stamp;
+    ASSERT_TRUE(batcher.stamp(leaf, stamp, error)) << error;
+    {
+        std::ofstream out(dir / "token.der", std::ios::binary);
+        out.write(reinterpret_cast<const char*>(stamp.token.data()), static_cast<std::streamsize>(stamp.token.size()));
+    }
+    std::ostringstream hex;
+    for (unsigned char b : leaf) hex << std::hex << (b < 16 ? "0" : "") << static_cast<int>(b);
+    EXPECT_TRUE(run("openssl ts -verify -digest " + hex.str() + " -in token.der -token_in -CAfile ca.pem -untrusted tsa.pem"));
+
+    std::remove(sigPath.c_str());
+}
+
+// CENARIO 2 Agregacao
+// Dezesseis assinaturas simultaneas dentro da janela viram uma unica consulta a
+// TSA; cada uma recebe a prova da propria folha e verifica sozinha
+TEST_F(TimestampTest, Batcher_AssinaturasSimultaneas_UmaConsulta) {
+    TimestampService::Batcher batcher(config(300, 64), localTsa());
+    const int count = 16;
+    std::vector<OpenSSLPool::CmsPtr> signatures(count);
+    for (auto& cms : signatures) {
+        cms = sign();
+        ASSERT_TRUE(cms);
+    }
+
+    std::atomic<int> stamped{ 0 };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < count; ++i) {
+        threads.emplace_back([&, i] {
+            std::string error;
+            if (batcher.stampCms(signatures[i].get(), error)) ++stamped;
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    EXPECT_EQ(stamped.load(), count);
+    EXPECT_EQ(tsaCalls.load(), 1);
+    TimestampService::Stats stats = batcher.stats();
+    EXPECT_EQ(stats.batches, 1u);
+    EXPECT_EQ(stats.largestBatch, static_cast<unsigned long long>(count));
+
+    for (int i = 0; i < count; ++i) {
+        std::string sigPath = "sig_lote_" + std::to_string(i) + ".p7s";
+        ASSERT_TRUE(save(signatures[i].get(), sigPath));
+        VerifierService::VerificationResult res = VerifierService::verifyAndGetDetails(sigPath);
+        EXPECT_TRUE(res.isValid);
+        EXPECT_EQ(res.timestamp, "VALIDO") << i;
+        EXPECT_EQ(res.timestampBatch, static_cast<unsigned>(count));
+        std::remove(sigPath.c_str());
+    }
+}
+
+// CENARIO 3 Lote cheio
+// Com TSA_MAX_BATCH = 4 oito pedidos geram duas consultas sem esperar a janela longa
+TEST_F(TimestampTest, Batcher_LoteCheio_NaoEsperaJanela) {
+    TimestampService::Batcher batcher(config(5000, 4), localTsa());
+    MerkleTree::Hash leaf{};
+
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<int> stamped{ 0 };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&, i] {
+            MerkleTree::Hash own = leaf;
+            own[0] = static_cast<unsigned char>(i);
+            TimestampService::Stamp stamp;
+            std::string error;
+            if (batcher.stamp(own, stamp, error) && stamp.proof.leafCount == 4) ++stamped;
+        });
+    }
+    for (auto& t : threads) t.join();
+    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(stamped.load(), 8);
+    EXPECT_EQ(batcher.stats().batches, 2u);
+    EXPECT_LT(elapsedMs, 5000);
+}
+
+// CENARIO 4 Carimbo de outra assinatura
+// Token e prova copiados de uma assinatura para outra nao conferem: o carimbo
+// fica INVALIDO, mas a assinatura em si continua VALIDO
+TEST_F(TimestampTest, Verify_CarimboTrocado_Invalido) {
+    TimestampService::Batcher batcher(config(0, 16), localTsa());
+    OpenSSLPool::CmsPtr first = sign();
+    {
+        // RSA PKCS#1 v1.5 eh deterministico: outro documento para outra assinatura
+        std::ofstream out(tempDoc);
+        out << "Outro documento";
+    }
+    OpenSSLPool::CmsPtr second = sign();
+    ASSERT_TRUE(first && second);
+
+    MerkleTree::Hash leaf;
+    TimestampService::Stamp stamp;
+    std::string error;
+    ASSERT_TRUE(TimestampService::signatureLeaf(firstSigner(first.get()), leaf));
+    ASSERT_TRUE(batcher.stamp(leaf, stamp, error)) << error;
+    ASSERT_TRUE(TimestampService::attach(firstSigner(second.get()), stamp));
+
+    TimestampService::Verification check = TimestampService::verify(firstSigner(second.get()));
+    EXPECT_TRUE(check.present);
+    EXPECT_FALSE(check.valid);
+
+    std::string sigPath = "sig_carimbo_trocado.p7s";
+    ASSERT_TRUE(save(second.get(), sigPath));
+    VerifierService::VerificationResult res = VerifierService::verifyAndGetDetails(sigPath);
+    EXPECT_TRUE(res.isValid);
+    EXPECT_EQ(res.timestamp, "INVALIDO");
+    std::remove(sigPath.c_str());
+}
+
+// CENARIO 5 Falhas da TSA
+// Transporte fora do ar e resposta de outra consulta (nonce e imprint diferentes)
+// falham para todos do lote; sem carimbo o verificador nao reporta carimbo
+TEST_F(TimestampTest, Batcher_FalhaDaTsa_TodosRecebemErro) {
+    TimestampService::Batcher offline(config(50, 16), [](const std::vector<unsigned char>&, std::vector<unsigned char>&, std::string& error) {
+        error = "TSA indisponivel";
+        return false;
+    });
+
+    std::atomic<int> failed{ 0 };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            MerkleTree::Hash leaf{};
+            TimestampService::Stamp stamp;
+            std::string error;
+            if (!offline.stamp(leaf, stamp, error) && error == "TSA indisponivel") ++failed;
+        });
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_EQ(failed.load(), 4);
+    EXPECT_EQ(offline.stats().failures, 1u);
+
+    // responde sempre com a resposta de uma consulta antiga
+    std::vector<unsigned char> stale;
+    TimestampService::Transport tsa = localTsa();
+    TimestampService::Batcher replay(config(0, 16), [&](const std::vector<unsigned char>& query, std::vector<unsigned char>& reply,
+                                                        std::string& error) {
+        if (stale.empty() && !tsa(query, stale, error)) return false;
+        reply = stale;
+        return true;
+    });
+    MerkleTree::Hash a{};
+    MerkleTree::Hash b{};
+    b[0] = 1;
+    TimestampService::Stamp stamp;
+    std::string error;
+    EXPECT_TRUE(replay.stamp(a, stamp, error)) << error;
+    EXPECT_FALSE(replay.stamp(b, stamp, error));
+
+    OpenSSLPool::CmsPtr cms = sign();
+    std::string sigPath = "sig_sem_carimbo.p7s";
+    ASSERT_TRUE(save(cms.get(), sigPath));
+    EXPECT_TRUE(VerifierService::verifyAndGetDetails(sigPath).timestamp.empty());
+    std::remove(sigPath.c_str());
+}
@@ -2,6 +2,9 @@
 #include <fstream>
 #include <cstdio>
 #include <string>
+#include <vector>
+#include "../src/DigestService.h"
+#include "../src/MerkleTree.h"
 #include "../src/VerifierService.h"
 #include "../src/SignerService.h"
 
@@ -78,4 +81,179 @@ TEST_F(VerifierServiceTest, VerifyDetails_ReturnsInvalidForMissingFile) {
 TEST_F(VerifierServiceTest, ExecuteStep3_ReturnsTrueOnSuccess) {
     bool success = VerifierService::executeStep3(validSig);
     EXPECT_TRUE(success);
-}
\ No newline at end of file
+}
+
+// CENARIO 6: Inspect (Assinatura valida)
+// Deve extrair os mesmos metadados da verificacao completa sem executar CMS_verify
+TEST_F(VerifierServiceTest, Inspect_ReturnsSameDetailsAsVerify) {
+    VerifierService::VerificationResult verified = VerifierService::verifyAndGetDetails(validSig);
+    VerifierService::InspectionResult inspected = VerifierService::inspect(validSig);
+
+    ASSERT_TRUE(inspected.parsed);
+    EXPECT_EQ(inspected.signerName, verified.signerName);
+    EXPECT_EQ(inspected.signingTime, verified.signingTime);
+    EXPECT_EQ(inspected.hashHex, verified.hashHex);
+    EXPECT_EQ(inspected.hashAlgo, verified.hashAlgo);
+    EXPECT_EQ(inspected.contentLength, std::string("Conteudo critico para verificacao").size());
+}
+
+// CENARIO 7: Inspect (Documento grande)
+// O conteudo encapsulado deve ser pulado e apenas contabilizado
+TEST_F(VerifierServiceTest, Inspect_SkipsLargeContent) {
+    std::string bigDoc = "doc_inspect_big.bin";
+    std::string bigSig = "sig_inspect_big.p7s";
+    {
+        std::ofstream out(bigDoc, std::ios::binary);
+        std::string block(1024 * 1024, 'x');
+        for (int i = 0; i < 16; ++i) out << block;
+    }
+    ASSERT_TRUE(SignerService::generateSignature(validP12, validPass, bigDoc, bigSig));
+
+    VerifierService::InspectionResult res = VerifierService::inspect(bigSig);
+    EXPECT_TRUE(res.parsed);
+    EXPECT_EQ(res.contentLength, 16ull * 1024 * 1024);
+    EXPECT_FALSE(res.signerName.empty());
+    EXPECT_FALSE(res.hashHex.empty());
+
+    std::remove(bigDoc.c_str());
+    std::remove(bigSig.c_str());
+}
+
+// CENARIO 8: Inspect (Arquivo invalido)
+TEST_F(VerifierServiceTest, Inspect_ReturnsNotParsedForInvalidFile) {
+    EXPECT_FALSE(VerifierService::inspect("ghost_sig.p7s").parsed);
+    EXPECT_FALSE(VerifierService::inspect(tempDoc).parsed);
+
+    // BER com um milhao de SEQUENCEs de tamanho indefinido aninhadas: recusado sem estourar a pilha
+    std::string nestedSig = "nested_sig.p7s";
+    {
+        std::ofstream out(nestedSig, std::ios::binary);
+        for (int i = 0; i < 1000000; ++i) out.write("\x30\x80", 2);
+    }
+    EXPECT_FALSE(VerifierService::inspect(nestedSig).parsed);
+    EXPECT_TRUE(VerifierService::readStapledOcsp(nestedSig).empty());
+    std::remove(nestedSig.c_str());
+
+    // eContent com comprimento declarado de 2^64 - 10 (vira -10 como streamoff) e de 2^63:
+    // recusados em vez de voltar o seek para o proprio cabecalho e repetir para sempre
+    const std::string head("\x30\x80\x06\x09\x2A\x86\x48\x86\xF7\x0D\x01\x07\x02\xA0\x80\x30\x80"
+                           "\x02\x01\x01\x31\x00\x30\x80\x06\x03\x2A\x03\x04", 29);
+    for (const std::string& length : { std::string("\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xF6", 8), std::string("\x80\0\0\0\0\0\0\0", 8) }) {
+        std::string hugeSig = "huge_length_sig.p7s";
+        {
+            std::ofstream out(hugeSig, std::ios::binary);
+            out << head << std::string("\x04\x88", 2) << length << std::string(8, '\0');
+        }
+        EXPECT_FALSE(VerifierService::inspect(hugeSig).parsed);
+        EXPECT_TRUE(VerifierService::readStapledOcsp(hugeSig).empty());
+        std::remove(hugeSig.c_str());
+    }
+}
+
+// CENARIO 9: Verify With Proof (Lote valido)
+// Cada documento do lote deve validar com a assinatura unica e a propria prova
+TEST_F(VerifierServiceTest, VerifyWithProof_ValidaCadaDocumentoDoLote) {
+    std::vector<std::string> docs;
+    std::vector<std::string> proofs;
+    for (int i = 0; i < 6; ++i) {
+        docs.push_back("doc_lote_verif_" + std::to_string(i) + ".txt");
+        proofs.push_back(docs.back() + ".proof");
+        std::ofstream out(docs.back());
+        out << "Documento do lote " << i;
+    }
+    std::string batchSig = "sig_lote_verif.p7s";
+    ASSERT_TRUE(SignerService::generateBatchSignature(validP12, validPass, docs, batchSig, proofs));
+
+    for (size_t i = 0; i < docs.size(); ++i) {
+        VerifierService::VerificationResult res = VerifierService::verifyWithProof(docs[i], proofs[i], batchSig);
+        EXPECT_TRUE(res.isValid) << docs[i];
+        EXPECT_EQ(res.status, "VALIDO");
+        EXPECT_FALSE(res.signerName.empty());
+        EXPECT_EQ(res.hashHex.size(), 128u);
+    }
+
+    // prova de outro documento do mesmo lote
+    EXPECT_FALSE(VerifierService::verifyWithProof(docs[0], proofs[1], batchSig).isValid);
+
+    for (size_t i = 0; i < docs.size(); ++i) {
+        std::remove(docs[i].c_str());
+        std::remove(proofs[i].c_str());
+    }
+    std::remove(batchSig.c_str());
+}
+
+// CENARIO 10: Verify With Proof (Documento alterado ou assinatura comum)
+TEST_F(VerifierServiceTest, VerifyWithProof_RejeitaDocumentoAlterado) {
+    std::vector<std::string> docs = { tempDoc };
+    std::vector<std::string> proofs = { tempDoc + ".proof" };
+    std::string batchSig = "sig_lote_alterado.p7s";
+    ASSERT_TRUE(SignerService::generateBatchSignature(validP12, validPass, docs, batchSig, proofs));
+    EXPECT_TRUE(VerifierService::verifyWithProof(tempDoc, proofs[0], batchSig).isValid);
+
+    {
+        std::ofstream out(tempDoc, std::ios::app);
+        out << " alterado";
+    }
+    EXPECT_FALSE(VerifierService::verifyWithProof(tempDoc, proofs[0], batchSig).isValid);
+
+    // assinatura de documento unico nao tem raiz de lote
+    EXPECT_FALSE(VerifierService::verifyWithProof(tempDoc, proofs[0], validSig).isValid);
+
+    std::remove(proofs[0].c_str());
+    std::remove(batchSig.c_str());
+}
+
+// CENARIO 11: Verify and Get Details (Outros tipos de chave)
+// Assinaturas RSA-4096, ECDSA e Ed25519 devem validar com o digest e algoritmo corretos
+TEST_F(VerifierServiceTest, VerifyDetails_ValidaTodosOsTiposDeChave) {
+    struct KeyCase { std::string p12; std::string hashAlgo; std::string signatureAlgo; };
+    const std::vector<KeyCase> keys = {
+        { "resources/pkcs12/certificado_teste_rsa4096.pfx", "sha512", "rsaEncryption" },
+        { "resources/pkcs12/certificado_teste_ecdsa_p256.pfx", "sha256", "ecdsa-with-SHA256" },
+        { "resources/pkcs12/certificado_teste_ecdsa_p384.pfx", "sha384", "ecdsa-with-SHA384" },
+        { "resources/pkcs12/certificado_teste_ed25519.pfx", "sha512", "ED25519" },
+    };
+
+    for (const KeyCase& key : keys) {
+        ASSERT_TRUE(SignerService::generateSignature(key.p12, validPass, tempDoc, validSig)) << key.p12;
+
+        VerifierService::VerificationResult res = VerifierService::verifyAndGetDetails(validSig);
+        EXPECT_TRUE(res.isValid) << key.p12;
+        EXPECT_EQ(res.hashAlgo, key.hashAlgo) << key.p12;
+        EXPECT_EQ(res.signatureAlgo, key.signatureAlgo) << key.p12;
+        EXPECT_FALSE(res.signerName.empty()) << key.p12;
+    }
+}
+
+// CENARIO 12: Verify With Proof (Separacao de dominio)
+// Uma assinatura comum sobre um arquivo de 64 bytes igual a raiz do lote nao vale
+// como lote; o CMS do lote eh aceito tambem com chave Ed25519
+TEST_F(VerifierServiceTest, VerifyWithProof_ExigeTipoDeConteudoDoLote) {
+    std::vector<std::string> docs = { tempDoc };
+    std::vector<std::string> proofs = { tempDoc + ".proof" };
+    std::string batchSig = "sig_lote_dominio.p7s";
+    ASSERT_TRUE(SignerService::generateBatchSignature(validP12, validPass, docs, batchSig, proofs));
+    ASSERT_TRUE(VerifierService::verifyWithProof(tempDoc, proofs[0], batchSig).isValid);
+
+    // lote de um documento: a raiz eh a propria folha
+    std::vector<unsigned char> digest = DigestService::calculateSHA512Bytes(tempDoc);
+    ASSERT_EQ(digest.size(), 64u);
+    MerkleTree::Hash root = MerkleTree::leafHash(digest.data(), digest.size());
+    std::string rootDoc = "raiz_lote_dominio.bin";
+    std::string forged = "sig_raiz_dominio.p7s";
+    {
+        std::ofstream out(rootDoc, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(root.data()), root.size());
+    }
+    ASSERT_TRUE(SignerService::generateSignature(validP12, validPass, rootDoc, forged));
+    ASSERT_TRUE(VerifierService::verifyAndGetDetails(forged).isValid);
+    EXPECT_FALSE(VerifierService::verifyWithProof(tempDoc, proofs[0], forged).isValid);
+
+    ASSERT_TRUE(SignerService::generateBatchSignature("resources/pkcs12/certificado_teste_ed25519.pfx", validPass, docs, batchSig, proofs));
+    EXPECT_TRUE(VerifierService::verifyWithProof(tempDoc, proofs[0], batchSig).isValid);
+
+    std::remove(proofs[0].c_str());
+    std::remove(batchSig.c_str());
+    std::remove(rootDoc.c_str());
+    std::remove(forged.c_str());
+}
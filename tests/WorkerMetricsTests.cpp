@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "../src/WorkerMetrics.h"
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// CENARIO 1 Registro por classe de status
+// 2xx, 4xx e 5xx sao separados e 503 tambem conta como rejeitada
+TEST(WorkerMetricsTest, Record_SeparaStatusERotas) {
+    WorkerMetrics::Region region(2, false);
+    region.record(0, WorkerMetrics::Route::Verify, 200, 1000);
+    region.record(0, WorkerMetrics::Route::Verify, 400, 10);
+    region.record(1, WorkerMetrics::Route::Signature, 503, 5);
+
+    EXPECT_EQ(region.slot(0).requests[static_cast<int>(WorkerMetrics::Route::Verify)].load(), 2u);
+    EXPECT_EQ(region.slot(0).latencyUs[static_cast<int>(WorkerMetrics::Route::Verify)].load(), 1010u);
+    EXPECT_EQ(region.slot(0).status2xx.load(), 1u);
+    EXPECT_EQ(region.slot(0).status4xx.load(), 1u);
+    EXPECT_EQ(region.slot(1).status5xx.load(), 1u);
+    EXPECT_EQ(region.slot(1).rejected.load(), 1u);
+}
+
+// CENARIO 2 Agregacao
+// O texto exportado soma todos os workers e mantem uma serie por worker
+TEST(WorkerMetricsTest, Render_AgregaWorkers) {
+    WorkerMetrics::Region region(3, false);
+    for (unsigned i = 0; i < 3; ++i) {
+        region.record(i, WorkerMetrics::Route::Verify, 200, 100);
+    }
+    region.slot(2).restarts = 4;
+
+    std::string text = region.render();
+    EXPECT_NE(text.find("bry_requests_total{route=\"verify\"} 3"), std::string::npos);
+    EXPECT_NE(text.find("bry_worker_restarts_total 4"), std::string::npos);
+    EXPECT_NE(text.find("bry_worker_requests_total{worker=\"2\""), std::string::npos);
+}
+
+// CENARIO 3 Slot atual
+// Sem regiao definida o registro eh ignorado
+TEST(WorkerMetricsTest, RecordRequest_UsaSlotAtual) {
+    WorkerMetrics::setCurrent(nullptr, 0);
+    WorkerMetrics::recordRequest(WorkerMetrics::Route::Inspect, 200, 1);
+    EXPECT_EQ(WorkerMetrics::renderCurrent(), "");
+
+    WorkerMetrics::Region region(2, false);
+    WorkerMetrics::setCurrent(&region, 1);
+    WorkerMetrics::recordRequest(WorkerMetrics::Route::Inspect, 200, 1);
+    EXPECT_EQ(region.slot(1).requests[static_cast<int>(WorkerMetrics::Route::Inspect)].load(), 1u);
+    WorkerMetrics::setCurrent(nullptr, 0);
+}
+
+// CENARIO 4 Memoria compartilhada
+// Contadores gravados por um processo filho devem ser vistos pelo pai
+TEST(WorkerMetricsTest, SharedRegion_VisivelEntreProcessos) {
+#ifdef _WIN32
+    GTEST_SKIP() << "Memoria compartilhada entre processos apenas em POSIX";
+#else
+    WorkerMetrics::Region region(2, true);
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        region.record(1, WorkerMetrics::Route::Signature, 200, 42);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    EXPECT_EQ(region.slot(1).requests[static_cast<int>(WorkerMetrics::Route::Signature)].load(), 1u);
+    EXPECT_EQ(region.slot(1).latencyUs[static_cast<int>(WorkerMetrics::Route::Signature)].load(), 42u);
+#endif
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "../src/WorkerSupervisor.h"
+
+#ifndef _WIN32
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// espera ate a condicao ficar verdadeira ou o tempo acabar
+template <typename Cond>
+static bool waitUntil(Cond cond, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (cond()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return cond();
+}
+
+// CENARIO 1 Reinicio de worker
+// Um worker que cai deve ser recriado no mesmo slot; a parada encerra todos
+TEST(WorkerSupervisorTest, Run_ReiniciaWorkerQueCai) {
+#ifdef _WIN32
+    GTEST_SKIP() << "Modo pre-fork apenas em POSIX";
+#else
+    WorkerMetrics::Region metrics(2, true);
+    WorkerSupervisor::Config config{ 2, WorkerSupervisor::PinMode::None };
+
+    int result = -1;
+    std::thread supervisor([&] {
+        result = WorkerSupervisor::run(config, metrics, [&](unsigned index) {
+            // o worker 1 cai na primeira execucao
+            if (index == 1 && metrics.slot(1).restarts.load() == 0) std::abort();
+            WorkerSupervisor::waitForStopSignal();
+            return 0;
+        });
+    });
+
+    bool restarted = waitUntil([&] {
+        return metrics.slot(1).restarts.load() == 1 && metrics.slot(1).pid.load() > 0 &&
+               kill(static_cast<pid_t>(metrics.slot(1).pid.load()), 0) == 0;
+    }, 5000);
+
+    WorkerSupervisor::requestStop();
+    supervisor.join();
+
+    EXPECT_TRUE(restarted);
+    EXPECT_EQ(result, 0);
+    EXPECT_EQ(metrics.slot(0).restarts.load(), 0u);
+    EXPECT_EQ(metrics.slot(1).restarts.load(), 1u);
+#endif
+}
+
+// CENARIO 2 Fixacao em CPU
+// Sem fixacao sempre funciona; fixar em um nucleo funciona em Linux
+TEST(WorkerSupervisorTest, PinCurrentProcess_Nucleo) {
+    EXPECT_TRUE(WorkerSupervisor::pinCurrentProcess(0, WorkerSupervisor::PinMode::None));
+#ifdef __linux__
+    std::thread pinned([] {
+        // sched_setaffinity(0) atua apenas na thread chamadora
+        EXPECT_TRUE(WorkerSupervisor::pinCurrentProcess(3, WorkerSupervisor::PinMode::Core));
+    });
+    pinned.join();
+#endif
+}
+
+// CENARIO 3 Bloco de nucleos por worker
+// Com coresPerWorker = 2 o worker 1 fica com o segundo par de CPUs permitidas
+TEST(WorkerSupervisorTest, PinCurrentProcess_BlocoDeNucleos) {
+#ifndef __linux__
+    GTEST_SKIP() << "Fixacao em CPU apenas no Linux";
+#else
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+    std::vector<int> available;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) available.push_back(cpu);
+    }
+    if (available.size() < 4) GTEST_SKIP() << "Menos de 4 CPUs disponiveis";
+
+    std::thread pinned([&] {
+        ASSERT_TRUE(WorkerSupervisor::pinCurrentProcess(1, WorkerSupervisor::PinMode::Core, 2));
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        ASSERT_EQ(sched_getaffinity(0, sizeof(set), &set), 0);
+        EXPECT_EQ(CPU_COUNT(&set), 2);
+        EXPECT_TRUE(CPU_ISSET(available[2], &set));
+        EXPECT_TRUE(CPU_ISSET(available[3], &set));
+    });
+    pinned.join();
+#endif
+}